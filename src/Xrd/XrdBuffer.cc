@@ -34,10 +34,13 @@
 #endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include "XrdOuc/XrdOucUtils.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysNuma.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "Xrd/XrdBuffer.hh"
@@ -47,6 +50,76 @@
 #define XRD_TRACE XrdTrace->
 #include "Xrd/XrdTrace.hh"
 
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+// A thread cache holds a couple of released buffers of each size for reuse by
+// the same thread. Only the owning thread adds buffers but they may be taken
+// by the owner as well as by the reshaper, so each slot is claimed with an
+// atomic compare-and-swap and no lock is ever needed. The bytes held by all
+// of the caches together are limited to a share of the pool's memory limit.
+//
+class XrdBuffCache
+{
+public:
+
+XrdBuffer *Get(int bindex)
+              {
+#ifdef HAVE_ATOMICS
+               XrdBuffer *bp;
+               for (int i = 0; i < tcSlots; i++)
+                   if ((bp = slot[bindex][i])
+                   &&  AtomicCAS(slot[bindex][i], bp, (XrdBuffer *)0))
+                      {AtomicSub(numBytes, bp->bsize);
+                       AtomicSub(Owner->tcBytes, bp->bsize);
+                       return bp;
+                      }
+#endif
+               return 0;
+              }
+
+bool       Put(XrdBuffer *bp, int maxBytes, long long maxAll)
+              {
+#ifdef HAVE_ATOMICS
+               long long na;
+               int i, nb;
+               AtomicFAdd(nb, numBytes, bp->bsize);
+               AtomicFAdd(na, Owner->tcBytes, bp->bsize);
+               if (nb + bp->bsize <= maxBytes && na + bp->bsize <= maxAll)
+                  for (i = 0; i < tcSlots; i++)
+                      if (!slot[bp->bindex][i]
+                      &&  AtomicCAS(slot[bp->bindex][i], (XrdBuffer *)0, bp))
+                         return true;
+               AtomicSub(numBytes, bp->bsize);
+               AtomicSub(Owner->tcBytes, bp->bsize);
+#endif
+               return false;
+              }
+
+static const int tcSlots = 2;
+
+XrdBuffManager *Owner;
+XrdBuffCache   *Next;
+XrdBuffer      *slot[XRD_BUCKETS][tcSlots];
+int             numBytes;              // Bytes held in the slots
+int             node;                  // NUMA node the owner last ran on
+long long       numReqs;               // Owner only: requests seen
+long long       numHits;               // Owner only: requests satisfied
+long long       numRemote;             // Owner only: hits from another node
+int             bktHits[XRD_BUCKETS];  // Owner only: hits per bucket
+int             bktSeen[XRD_BUCKETS];  // Reshaper only: hits accounted for
+
+                XrdBuffCache(XrdBuffManager *bmP) : Owner(bmP), Next(0),
+                             numBytes(0), node(0), numReqs(0), numHits(0),
+                             numRemote(0)
+                            {memset(slot,    0, sizeof(slot));
+                             memset(bktHits, 0, sizeof(bktHits));
+                             memset(bktSeen, 0, sizeof(bktSeen));
+                            }
+               ~XrdBuffCache() {}
+};
+
 /******************************************************************************/
 /*                     E x t e r n a l   L i n k a g e s                      */
 /******************************************************************************/
@@ -67,6 +140,7 @@ const char *XrdBuffManager::TraceID = "BuffManager";
 namespace
 {
 static const int minBuffSz = 1 << XRD_BUSHIFT;
+static const int tcBuffSz  = 4*1024*1024;  // Default thread cache size
 }
 
 namespace XrdGlobal
@@ -104,7 +178,24 @@ XrdBuffManager::XrdBuffManager(XrdSysError *lP, XrdOucTrace *tP, int minrst) :
 #endif
    rsinprog = 0;
    minrsw   = minrst;
-   memset(static_cast<void *>(bucket), 0, sizeof(bucket));
+   memset(static_cast<void *>(bucket0), 0, sizeof(bucket0));
+   bucket   = &bucket0;
+   numNodes = 1;
+   nmLocal  = 0;
+   nmRemote = 0;
+
+// Thread caches need atomics and a key to find them (-1 means unavailable)
+//
+   tcFirst  = 0;
+   tcBytes  = 0;
+   tcReqs   = 0;
+   tcHits   = 0;
+   tcRemote = 0;
+#ifdef HAVE_ATOMICS
+   tcMax    = (pthread_key_create(&tcKey, tcExit) ? -1 : tcBuffSz);
+#else
+   tcMax    = -1;
+#endif
 }
 
 /******************************************************************************/
@@ -112,10 +203,28 @@ XrdBuffManager::XrdBuffManager(XrdSysError *lP, XrdOucTrace *tP, int minrst) :
 /******************************************************************************/
 
 void XrdBuffManager::Init()
+{
+   Init(1);
+}
+
+/******************************************************************************/
+
+void XrdBuffManager::Init(int numnodes)
 {
    pthread_t tid;
    int rc;
 
+// When running NUMA aware, keep a separate set of buckets for each node so
+// that buffers are handed out from memory local to the requesting thread.
+//
+   if (numnodes > 1 && numnodes <= XrdSysNuma::maxNodes)
+      {bucket = new BuckVec[numnodes][XRD_BUCKETS];
+       memset(static_cast<void *>(bucket), 0,
+              sizeof(BuckVec)*XRD_BUCKETS*numnodes);
+       numNodes = numnodes;
+       TRACE(MEM, "Using NUMA aware buffer pools for " <<numNodes <<" nodes");
+      }
+
 // Start the reshaper thread
 //
    if ((rc = XrdSysThread::Run(&tid, XrdReshaper, static_cast<void *>(this), 0,
@@ -129,9 +238,10 @@ void XrdBuffManager::Init()
   
 XrdBuffer *XrdBuffManager::Obtain(int sz)
 {
+   XrdBuffCache *tcP;
    XrdBuffer *bp;
    char *memp;
-   int mk, pk, bindex;
+   int mk, pk, bindex, node = 0;
 
 // Make sure the request is within our limits
 //
@@ -146,13 +256,30 @@ XrdBuffer *XrdBuffManager::Obtain(int sz)
    if (mk < sz) {bindex++; mk = mk << 1;}
    if (bindex >= slots) return 0;    // Should never happen!
 
+// Determine the node we are running on
+//
+   if (numNodes > 1) node = XrdSysNuma::CurNode();
+
+// Try to reuse a buffer from this thread's cache, which needs no lock
+//
+   if (tcMax > 0 && (tcP = tcGet()))
+      {tcP->numReqs++; tcP->node = node;
+       if ((bp = tcP->Get(bindex)))
+          {tcP->numHits++; tcP->bktHits[bindex]++;
+           if (bp->bnode != node) tcP->numRemote++;
+           return bp;
+          }
+      }
+
 // Obtain a lock on the bucket array and try to give away an existing buffer
 //
     Reshaper.Lock();
     totreq++;
-    bucket[bindex].numreq++;
-    if ((bp = bucket[bindex].bnext))
-       {bucket[bindex].bnext = bp->next; bucket[bindex].numbuf--;}
+    bucket[node][bindex].numreq++;
+    if ((bp = bucket[node][bindex].bnext))
+       {bucket[node][bindex].bnext = bp->next; bucket[node][bindex].numbuf--;
+        nmLocal++;
+       }
     Reshaper.UnLock();
 
 // Check if we really allocated a buffer
@@ -164,9 +291,16 @@ XrdBuffer *XrdBuffManager::Obtain(int sz)
    pk = (mk < pagsz ? mk : pagsz);
    if (!(memp = static_cast<char *>(memalign(pk, mk)))) return 0;
 
+// Place whole pages on our node before they are touched. Smaller buffers
+// share pages and are left to the kernel's first touch placement.
+//
+   if (numNodes > 1 && mk >= pagsz && !XrdSysNuma::Bind(memp, mk, node))
+      {Reshaper.Lock(); nmRemote++; Reshaper.UnLock();}
+
 // Wrap the memory with a buffer object
 //
    if (!(bp = new XrdBuffer(memp, mk, bindex))) {free(memp); return 0;}
+   bp->bnode = node;
 
 // Update statistics
 //
@@ -210,18 +344,24 @@ int XrdBuffManager::Recalc(int sz)
   
 void XrdBuffManager::Release(XrdBuffer *bp)
 {
+   XrdBuffCache *tcP;
    int bindex = bp->bindex;
 
 // Check if we should release this via the big buffer object
 //
    if (bindex >= slots) {xlBuff.Release(bp); return;}
 
+// Keep the buffer in this thread's cache if there is room for it. All of the
+// caches together may hold at most a quarter of the pool's memory limit.
+//
+   if (tcMax > 0 && (tcP = tcGet()) && tcP->Put(bp, tcMax, maxalo/4)) return;
+
 // Obtain a lock on the bucket array and reclaim the buffer
 //
     Reshaper.Lock();
-    bp->next = bucket[bp->bindex].bnext;
-    bucket[bp->bindex].bnext = bp;
-    bucket[bindex].numbuf++;
+    bp->next = bucket[bp->bnode][bindex].bnext;
+    bucket[bp->bnode][bindex].bnext = bp;
+    bucket[bp->bnode][bindex].numbuf++;
     Reshaper.UnLock();
 }
  
@@ -231,7 +371,8 @@ void XrdBuffManager::Release(XrdBuffer *bp)
   
 void XrdBuffManager::Reshape()
 {
-int i, bufprof[XRD_BUCKETS], numfreed;
+XrdBuffCache *tcP;
+int i, n, bufprof[XrdSysNuma::maxNodes][XRD_BUCKETS], numfreed;
 time_t delta, lastshape = time(0);
 long long memslot, memhave, memtarget = (long long)(.80*(float)maxalo);
 XrdSysTimer Timer;
@@ -250,14 +391,21 @@ while(1)
           Reshaper.Lock();
          }
 
-      // We have the lock so compute the request profile
+      // Return all buffers held by thread caches to the buckets so that the
+      // pool can be reshaped as a whole. This also accounts for their hits.
+      //
+      for (tcP = tcFirst; tcP; tcP = tcP->Next) tcDrain(tcP);
+
+      // We have the lock so compute the request profile (per node)
       //
       if (totreq > slots)
          {requests = (float)totreq;
           buffers  = (float)totbuf;
+          for (n = 0; n < numNodes; n++)
           for (i = 0; i < slots; i++)
-              {bufprof[i] = (int)(buffers*(((float)bucket[i].numreq)/requests));
-               bucket[i].numreq = 0;
+              {bufprof[n][i] = (int)(buffers*
+                               (((float)bucket[n][i].numreq)/requests));
+               bucket[n][i].numreq = 0;
               }
           totreq = 0; memhave = totalo;
          } else memhave = 0;
@@ -268,13 +416,14 @@ while(1)
       memslot = maxsz; numfreed = 0;
       for (i = slots-1; i >= 0 && memhave > memtarget; i--)
           {Reshaper.Lock();
-           while(bucket[i].numbuf > bufprof[i])
-                if ((bp = bucket[i].bnext))
-                   {bucket[i].bnext = bp->next;
+           for (n = 0; n < numNodes; n++)
+           while(bucket[n][i].numbuf > bufprof[n][i])
+                if ((bp = bucket[n][i].bnext))
+                   {bucket[n][i].bnext = bp->next;
                     delete bp;
-                    bucket[i].numbuf--; numfreed++;
+                    bucket[n][i].numbuf--; numfreed++;
                     memhave -= memslot; totalo  -= memslot;
-                   } else {bucket[i].numbuf = 0; break;}
+                   } else {bucket[n][i].numbuf = 0; break;}
            Reshaper.UnLock();
            memslot = memslot>>1;
           }
@@ -295,6 +444,13 @@ while(1)
 /******************************************************************************/
   
 void XrdBuffManager::Set(int maxmem, int minw)
+{
+   Set(maxmem, minw, -1);
+}
+
+/******************************************************************************/
+  
+void XrdBuffManager::Set(int maxmem, int minw, int tcsz)
 {
 
 // Obtain a lock and set the values
@@ -302,6 +458,7 @@ void XrdBuffManager::Set(int maxmem, int minw)
    Reshaper.Lock();
    if (maxmem > 0) maxalo = (long long)maxmem;
    if (minw   > 0) minrsw = minw;
+   if (tcsz  >= 0 && tcMax >= 0) tcMax = tcsz;
    Reshaper.UnLock();
 }
  
@@ -312,19 +469,125 @@ void XrdBuffManager::Set(int maxmem, int minw)
 int XrdBuffManager::Stats(char *buff, int blen, int do_sync)
 {
     static char statfmt[] = "<stats id=\"buff\"><reqs>%d</reqs>"
-                "<mem>%lld</mem><buffs>%d</buffs><adj>%d</adj>%s</stats>";
-    char xlStats[1024];
+                "<mem>%lld</mem><buffs>%d</buffs><adj>%d</adj>"
+                "<tc><reqs>%lld</reqs><hits>%lld</hits><mem>%lld</mem></tc>"
+                "%s%s</stats>";
+    static char numafmt[] = "<numa><nodes>%d</nodes><local>%lld</local>"
+                "<remote>%lld</remote></numa>";
+    XrdBuffCache *tcP;
+    long long numReqs, numHits, numRemote, tcMem = 0;
+    char xlStats[1024], nmStats[sizeof(numafmt) + 16*3] = "";
     int nlen;
 
 // If only size wanted, return it
 //
-   if (!buff) return sizeof(statfmt) + 16*4 + xlBuff.Stats(0,0);
+   if (!buff) return sizeof(statfmt) + sizeof(nmStats) + 16*7
+                   + xlBuff.Stats(0,0);
+
+// Sum up the thread caches (the list must be locked to run it)
+//
+   Reshaper.Lock();
+   numReqs = tcReqs; numHits = tcHits; numRemote = tcRemote;
+   for (tcP = tcFirst; tcP; tcP = tcP->Next)
+       {numReqs   += tcP->numReqs;
+        numHits   += tcP->numHits;
+        numRemote += tcP->numRemote;
+        tcMem     += tcP->numBytes;
+       }
+   if (numNodes > 1)
+      snprintf(nmStats, sizeof(nmStats), numafmt, numNodes,
+               nmLocal + numHits - numRemote, nmRemote + numRemote);
+   Reshaper.UnLock();
 
 // Return formatted stats
 //
    if (do_sync) Reshaper.Lock();
    xlBuff.Stats(xlStats, sizeof(xlStats), do_sync);
-   nlen = snprintf(buff,blen,statfmt,totreq,totalo,totbuf,totadj,xlStats);
+   nlen = snprintf(buff,blen,statfmt,totreq,totalo,totbuf,totadj,
+                   numReqs,numHits,tcMem,nmStats,xlStats);
    if (do_sync) Reshaper.UnLock();
    return nlen;
 }
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                               t c D r a i n                                */
+/******************************************************************************/
+
+// The Reshaper must be locked on entry!
+//
+void XrdBuffManager::tcDrain(XrdBuffCache *tcP)
+{
+   XrdBuffer *bp;
+   int i, nhits, tnode;
+
+// Account for cache hits in the request profile of the node the cache is used
+// on and move every cached buffer back into its bucket.
+//
+   tnode = tcP->node;
+   if (tnode < 0 || tnode >= numNodes) tnode = 0;
+   for (i = 0; i < slots; i++)
+       {nhits = tcP->bktHits[i] - tcP->bktSeen[i];
+        tcP->bktSeen[i] += nhits;
+        bucket[tnode][i].numreq += nhits;
+        totreq += nhits;
+        while((bp = tcP->Get(i)))
+             {bp->next = bucket[bp->bnode][i].bnext;
+              bucket[bp->bnode][i].bnext = bp;
+              bucket[bp->bnode][i].numbuf++;
+             }
+       }
+}
+
+/******************************************************************************/
+/*                                t c E x i t                                 */
+/******************************************************************************/
+
+// Called when a thread that has a cache exits
+//
+void XrdBuffManager::tcExit(void *tcV)
+{
+   XrdBuffCache *tcP = static_cast<XrdBuffCache *>(tcV), *cP, *pP = 0;
+   XrdBuffManager *bmP = tcP->Owner;
+
+// Remove the cache from the list and return its buffers
+//
+   bmP->Reshaper.Lock();
+   cP = bmP->tcFirst;
+   while(cP && cP != tcP) {pP = cP; cP = cP->Next;}
+   if (cP) {if (pP) pP->Next = cP->Next;
+               else bmP->tcFirst = cP->Next;
+           }
+   bmP->tcDrain(tcP);
+   bmP->tcReqs += tcP->numReqs;
+   bmP->tcHits += tcP->numHits;
+   bmP->tcRemote += tcP->numRemote;
+   bmP->Reshaper.UnLock();
+   delete tcP;
+}
+
+/******************************************************************************/
+/*                                 t c G e t                                  */
+/******************************************************************************/
+
+XrdBuffCache *XrdBuffManager::tcGet()
+{
+   XrdBuffCache *tcP;
+
+// Return the cache for this thread if it has one
+//
+   if ((tcP = static_cast<XrdBuffCache *>(pthread_getspecific(tcKey))))
+      return tcP;
+
+// Create a new cache and add it to the list
+//
+   tcP = new XrdBuffCache(this);
+   if (pthread_setspecific(tcKey, tcP)) {delete tcP; return 0;}
+   Reshaper.Lock();
+   tcP->Next = tcFirst;
+   tcFirst   = tcP;
+   Reshaper.UnLock();
+   return tcP;
+}
@@ -29,6 +29,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -46,17 +47,22 @@ char *   buff;     // -> buffer
 int      bsize;    // size of this buffer
 
          XrdBuffer(char *bp, int sz, int ix)
-                      {buff = bp; bsize = sz; bindex = ix; next = 0;}
+                      {buff = bp; bsize = sz; bindex = ix; next = 0; bnode = 0;}
 
         ~XrdBuffer() {if (buff) free(buff);}
 
          friend class XrdBuffManager;
+         friend class XrdBuffCache;
          friend class XrdBuffXL;
 private:
 
 int        bindex;
 XrdBuffer *next;
 static int pagesz;
+
+// Members added after this point so that the ones above keep their offsets
+//
+int        bnode;
 };
   
 /******************************************************************************/
@@ -68,6 +74,7 @@ static int pagesz;
 
 // There should be only one instance of this class per buffer pool.
 //
+class XrdBuffCache;
 class XrdOucTrace;
 class XrdSysError;
   
@@ -77,6 +84,8 @@ public:
 
 void        Init();
 
+void        Init(int numnodes);
+
 XrdBuffer  *Obtain(int bsz);
 
 int         Recalc(int bsz);
@@ -89,6 +98,8 @@ void        Reshape();
 
 void        Set(int maxmem=-1, int minw=-1);
 
+void        Set(int maxmem, int minw, int tcsz);
+
 int         Stats(char *buff, int blen, int do_sync=0);
 
             XrdBuffManager(XrdSysError *lP, XrdOucTrace *tP, int minrst=20*60);
@@ -105,10 +116,16 @@ const int  shift;
 const int  pagsz;
 const int  maxsz;
 
-struct {XrdBuffer *bnext;
+struct BuckVec
+       {XrdBuffer *bnext;
         int         numbuf;
         int         numreq;
-       } bucket[XRD_BUCKETS];          // 1K to 1<<(szshift+slots-1)M buffers
+       };
+BuckVec (*bucket)[XRD_BUCKETS];       // [node][1K to 1<<(szshift+slots-1)M]
+BuckVec   bucket0[XRD_BUCKETS];       // The buckets when there is one node
+int       numNodes;                   // Number of NUMA nodes with buckets
+long long nmLocal;                    // Buffers given out on the caller's node
+long long nmRemote;                   // Buffers given out from another node
 
 int       totreq;
 int       totbuf;
@@ -118,6 +135,24 @@ int       minrsw;
 int       rsinprog;
 int       totadj;
 
+// Each thread keeps a small cache of released buffers that it can reuse
+// without going through the bucket lock. The caches are drained back into
+// the buckets by Reshape() and when a thread exits.
+//
+XrdBuffCache  *tcFirst;  // All thread caches (protected by Reshaper)
+pthread_key_t  tcKey;    // Key locating the calling thread's cache
+int            tcMax;    // Maximum bytes held by a thread cache (0 -> none)
+long long      tcBytes;  // Bytes held by all thread caches (atomic)
+long long      tcReqs;   // Requests seen by caches of exited threads
+long long      tcHits;   // Requests satisfied by caches of exited threads
+long long      tcRemote; // Remote node hits by caches of exited threads
+
+friend class  XrdBuffCache;
+
+XrdBuffCache *tcGet();
+void          tcDrain(XrdBuffCache *tcP);
+static void   tcExit(void *tcP);
+
 XrdSysCondVar      Reshaper;
 static const char *TraceID;
 };
@@ -66,6 +66,7 @@
 #include "XrdOuc/XrdOucUtils.hh"
 
 #include "XrdSys/XrdSysHeaders.hh"
+#include "XrdSys/XrdSysNuma.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdSys/XrdSysUtils.hh"
 
@@ -166,6 +167,7 @@ XrdConfig::XrdConfig() : Log(&Logger, "Xrd"), Trace(&Log), Sched(&Log, &Trace),
    repInt     = 600;
    repOpts    = 0;
    ppNet      = 0;
+   numaOn     = 0;
    NetTCPlep  = -1;
    NetADM     = 0;
    coreV      = 1;
@@ -573,6 +575,8 @@ int XrdConfig::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError *eDest)
    {
    TS_Xeq("adminpath",     xapath);
    TS_Xeq("allow",         xallow);
+   TS_Xeq("numa",          xnuma);
+   TS_Xeq("poll",          xpoll);
    TS_Xeq("port",          xport);
    TS_Xeq("protocol",      xprot);
    TS_Xeq("report",        xrep);
@@ -908,7 +912,7 @@ int XrdConfig::Setup(char *dfltp)
 {
    XrdInet *NetWAN;
    XrdConfigProt *cp;
-   int i, wsz, arbNet;
+   int i, wsz, arbNet, numNodes = 1;
 
 // Establish the FD limit
 //
@@ -932,9 +936,20 @@ int XrdConfig::Setup(char *dfltp)
 //
    TRACE(NET,"sendfile " <<(XrdLink::sfOK ? "enabled." : "disabled!"));
 
+// Discover the NUMA topology if we are to take advantage of it
+//
+   if (numaOn)
+      {if ((numNodes = XrdSysNuma::Init()) > 1)
+          {char buff[16];
+           sprintf(buff, "%d", numNodes);
+           Log.Say("Config NUMA aware operation enabled for ", buff, " nodes.");
+          } else Log.Say("Config warning: NUMA not supported or single node; "
+                         "numa directive ignored.");
+      }
+
 // Initialize the buffer manager
 //
-   BuffPool.Init();
+   BuffPool.Init(numNodes);
 
 // Start the scheduler
 //
@@ -945,7 +960,7 @@ int XrdConfig::Setup(char *dfltp)
    XrdLink::Init(&Log, &Trace, &Sched);
    XrdPoll::Init(&Log, &Trace, &Sched);
    if (!XrdLink::Setup(ProtInfo.ConnMax, ProtInfo.idleWait)
-   ||  !XrdPoll::Setup(ProtInfo.ConnMax)) return 1;
+   ||  !XrdPoll::Setup(ProtInfo.ConnMax, numNodes)) return 1;
 
 // Modify the AdminPath to account for any instance name. Note that there is
 // a negligible memory leak under ceratin path combinations. Not enough to
@@ -1162,11 +1177,17 @@ int XrdConfig::xallow(XrdSysError *eDest, XrdOucStream &Config)
 
 /* Function: xbuf
 
-   Purpose:  To parse the directive: buffers [maxbsz <bsz>] <memsz> [<rint>]
+   Purpose:  To parse the directive: buffers [maxbsz <bsz>] [tcache <tcsz>]
+                                             <memsz> [<rint>]
 
              <bsz>      maximum size of an individualbuffer. The default is 2m.
                         Specify any value 2m < bsz <= 1g; if specified, it must
                         appear before the <memsz> and <memsz> becomes optional.
+             <tcsz>     maximum amount of memory each thread may keep in its
+                        own buffer cache; 0 turns thread caching off. The
+                        default is 4m. All caches together hold at most a
+                        quarter of <memsz>. If specified, it must appear before
+                        the <memsz> and <memsz> becomes optional.
              <memsz>    maximum amount of memory devoted to buffers
              <rint>     minimum buffer reshape interval in seconds
 
@@ -1176,6 +1197,7 @@ int XrdConfig::xbuf(XrdSysError *eDest, XrdOucStream &Config)
 {
     static const long long minBSZ = 1024*1024*2+1;  // 2mb
     static const long long maxBSZ = 1024*1024*1024; // 1gb
+    static const long long maxTCZ = 1024*1024*1024; // 1gb
     int bint = -1;
     long long blim;
     char *val;
@@ -1183,12 +1205,24 @@ int XrdConfig::xbuf(XrdSysError *eDest, XrdOucStream &Config)
     if (!(val = Config.GetWord()))
        {eDest->Emsg("Config", "buffer memory limit not specified"); return 1;}
 
-    if (!strcmp("maxbsz", val))
-       {if (!(val = Config.GetWord()))
-           {eDest->Emsg("Config", "max buffer size not specified"); return 1;}
-        if (XrdOuca2x::a2sz(*eDest,"maxbz value",val,&blim,minBSZ,maxBSZ))
-           return 1;
-        XrdGlobal::xlBuff.Init(blim);
+    while(!strcmp("maxbsz", val) || !strcmp("tcache", val))
+       {if (!strcmp("maxbsz", val))
+           {if (!(val = Config.GetWord()))
+               {eDest->Emsg("Config", "max buffer size not specified");
+                return 1;
+               }
+            if (XrdOuca2x::a2sz(*eDest,"maxbz value",val,&blim,minBSZ,maxBSZ))
+               return 1;
+            XrdGlobal::xlBuff.Init(blim);
+           } else {
+            if (!(val = Config.GetWord()))
+               {eDest->Emsg("Config", "thread cache size not specified");
+                return 1;
+               }
+            if (XrdOuca2x::a2sz(*eDest,"tcache value",val,&blim,0,maxTCZ))
+               return 1;
+            BuffPool.Set(-1, -1, (int)blim);
+           }
         if (!(val = Config.GetWord())) return 0;
        }
 
@@ -1370,6 +1404,75 @@ int XrdConfig::xnkap(XrdSysError *eDest, char *val)
    return 0;
 }
   
+/******************************************************************************/
+/*                                 x n u m a                                  */
+/******************************************************************************/
+
+/* Function: xnuma
+
+   Purpose:  To parse the directive: numa {off | on}
+
+             off        do not take the NUMA topology into account (default).
+             on         keep buffer pools and pollers per NUMA node so that
+                        memory is allocated and links are polled on the node
+                        handling the work.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdConfig::xnuma(XrdSysError *eDest, XrdOucStream &Config)
+{
+    char *val;
+
+    if (!(val = Config.GetWord()))
+       {eDest->Emsg("Config", "numa option not specified"); return 1;}
+
+         if (!strcmp(val, "on"))  numaOn = 1;
+    else if (!strcmp(val, "off")) numaOn = 0;
+    else {eDest->Emsg("Config", "invalid numa option -", val); return 1;}
+
+    return 0;
+}
+  
+/******************************************************************************/
+/*                                 x p o l l                                  */
+/******************************************************************************/
+
+/* Function: xpoll
+
+   Purpose:  To parse the directive: poll {edge | oneshot}
+
+             edge       keep links armed in edge triggered mode so that a link
+                        whose socket was drained is re-enabled without a
+                        system call. Only supported by the epoll poller.
+             oneshot    disarm links when they are dispatched and re-arm them
+                        when enabled (default).
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdConfig::xpoll(XrdSysError *eDest, XrdOucStream &Config)
+{
+    char *val;
+
+    if (!(val = Config.GetWord()))
+       {eDest->Emsg("Config", "poll mode not specified"); return 1;}
+
+         if (!strcmp(val, "oneshot")) XrdPoll::edgeMode = 0;
+    else if (!strcmp(val, "edge"))
+            {
+#if defined(__linux__) && defined(HAVE_ATOMICS)
+             XrdPoll::edgeMode = 1;
+#else
+             eDest->Say("Config warning: edge triggered polling not supported;"
+                        " poll directive ignored.");
+#endif
+            }
+    else {eDest->Emsg("Config", "invalid poll mode -", val); return 1;}
+
+    return 0;
+}
+  
 /******************************************************************************/
 /*                                 x p o r t                                  */
 /******************************************************************************/
@@ -1625,6 +1728,7 @@ int XrdConfig::xrep(XrdSysError *eDest, XrdOucStream &Config)
 
    Purpose:  To parse directive: sched [mint <mint>] [maxt <maxt>] [avlt <at>]
                                        [idle <idle>] [stksz <qnt>] [core <cv>]
+                                       [queues <nq>]
 
              <mint>   is the minimum number of threads that we need. Once
                       this number of threads is created, it does not decrease.
@@ -1641,6 +1745,9 @@ int XrdConfig::xrep(XrdSysError *eDest, XrdOucStream &Config)
              <idle>   The time (in time spec) between checks for underused
                       threads. Those found will be terminated. Default is 780.
              <qnt>    The thread stack size in bytes or K, M, or G.
+             <nq>     The number of work queues. When greater than one, each
+                      worker drains its own queue first and steals work from
+                      the others when it is empty. The default is 1.
 
    Output: 0 upon success or 1 upon failure.
 */
@@ -1650,7 +1757,7 @@ int XrdConfig::xsched(XrdSysError *eDest, XrdOucStream &Config)
     char *val;
     long long lpp;
     int  i, ppp = 0;
-    int  V_mint = -1, V_maxt = -1, V_idle = -1, V_avlt = -1;
+    int  V_mint = -1, V_maxt = -1, V_idle = -1, V_avlt = -1, V_numq = -1;
     struct schedopts {const char *opname; int minv; int *oploc;
                       const char *opmsg;} scopts[] =
        {
@@ -1659,7 +1766,8 @@ int XrdConfig::xsched(XrdSysError *eDest, XrdOucStream &Config)
         {"maxt",       1, &V_maxt, "sched maxt"},
         {"avlt",       1, &V_avlt, "sched avlt"},
         {"core",       1,       0, "sched core"},
-        {"idle",       0, &V_idle, "sched idle"}
+        {"idle",       0, &V_idle, "sched idle"},
+        {"queues",     1, &V_numq, "sched queues"}
        };
     int numopts = sizeof(scopts)/sizeof(struct schedopts);
 
@@ -1715,9 +1823,20 @@ int XrdConfig::xsched(XrdSysError *eDest, XrdOucStream &Config)
          }
      }
 
+  if (V_numq > MAX_SCHED_QUEUES)
+     {char buff[16];
+      sprintf(buff, "%d", MAX_SCHED_QUEUES);
+      eDest->Emsg("Config", "sched queues may not be greater than", buff);
+      return 1;
+     }
+
 // Establish scheduler options
 //
    Sched.setParms(V_mint, V_maxt, V_avlt, V_idle);
+   if (V_numq > 0 && Sched.setQueues(V_numq))
+      {eDest->Emsg("Config", "sched queues can no longer be changed");
+       return 1;
+      }
    return 0;
 }
 
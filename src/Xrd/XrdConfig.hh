@@ -75,6 +75,8 @@ int   xapath(XrdSysError *edest, XrdOucStream &Config);
 int   xbuf(XrdSysError *edest, XrdOucStream &Config);
 int   xnet(XrdSysError *edest, XrdOucStream &Config);
 int   xnkap(XrdSysError *edest, char *val);
+int   xnuma(XrdSysError *edest, XrdOucStream &Config);
+int   xpoll(XrdSysError *edest, XrdOucStream &Config);
 int   xlog(XrdSysError *edest, XrdOucStream &Config);
 int   xport(XrdSysError *edest, XrdOucStream &Config);
 int   xprot(XrdSysError *edest, XrdOucStream &Config);
@@ -117,6 +119,7 @@ int                 AdminMode;
 int                 repInt;
 char                repOpts;
 char                ppNet;
+char                numaOn;
 signed char         coreV;
 };
 #endif
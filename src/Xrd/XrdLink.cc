@@ -175,6 +175,8 @@ void XrdLink::Reset()
   PollEnt  = 0;
   isEnabled= 0;
   isIdle   = 0;
+  isDrained= 0;
+  etState  = 0;
   inQ      = 0;
   isBridged= 0;
   BytesOut = BytesIn = BytesOutTot = BytesInTot = 0;
@@ -557,8 +559,10 @@ int XrdLink::Recv(char *Buff, int Blen)
 //
    if (LockReads) rdMutex.Lock();
    isIdle = 0;
+   etReset();
    do {rlen = read(FD, Buff, Blen);} while(rlen < 0 && errno == EINTR);
    if (rlen > 0) AtomicAdd(BytesIn, rlen);
+   isDrained = (rlen >= 0 && rlen < Blen);
    if (LockReads) rdMutex.UnLock();
 
    if (rlen >= 0) return int(rlen);
@@ -583,10 +587,13 @@ int XrdLink::Recv(char *Buff, int Blen, int timeout)
 //
    isIdle = 0;
    while(Blen > 0)
-        {do {retc = poll(&polltab,1,timeout);} while(retc < 0 && errno == EINTR);
+        {etReset();
+         do {retc = poll(&polltab,1,timeout);}
+            while(retc < 0 && errno == EINTR);
          if (retc != 1)
             {if (retc == 0)
                 {tardyCnt++;
+                 if (!totlen) isDrained = 1;
                  if (totlen)
                     {if ((++stallCnt & 0xff) == 1) TRACEI(DEBUG,"read timed out");
                      AtomicAdd(BytesIn, totlen);
@@ -612,6 +619,7 @@ int XrdLink::Recv(char *Buff, int Blen, int timeout)
             {if (!rlen) return -ENOMSG;
              return (FD<0 ? -1 : XrdLog->Emsg("Link",-errno,"receive from",ID));
             }
+         isDrained = (rlen < Blen);
          totlen += rlen; Blen -= rlen; Buff += rlen;
         }
 
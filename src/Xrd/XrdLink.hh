@@ -35,6 +35,7 @@
 
 #include "XrdNet/XrdNetAddr.hh"
 #include "XrdOuc/XrdOucSFVec.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
 #include "Xrd/XrdJob.hh"
@@ -247,6 +248,13 @@ int           hasBridge() {return isBridged;}
 
 private:
 
+inline
+void   etReset()
+              {
+#ifdef HAVE_ATOMICS
+               if (etState == etPending) AtomicCAS(etState, etPending, etIdle);
+#endif
+              }
 void   Reset();
 int    sendData(const char *Buff, int Blen);
 
@@ -322,5 +330,19 @@ char                KillCnt;        // Protected by opMutex!
 static const char   KillMax =   60;
 static const char   KillMsk = 0x7f;
 static const char   KillXwt = 0x80;
+
+// Members added after this point so that the ones above keep their offsets
+//
+char                isDrained;      // Last read left no data queued
+char                etState;        // Edge triggered poll state, see below
+
+// In edge triggered mode etState is one of the following. Only the poller
+// moves a link from etArmed to etIdle or from etIdle to etPending. Enable()
+// moves it back to etArmed and a read that may find the socket empty moves
+// it from etPending to etIdle beforehand, as any later data causes an event.
+//
+static const char   etIdle    = 0;  // Dispatched or disabled
+static const char   etArmed   = 1;  // Enabled, next event dispatches the link
+static const char   etPending = 2;  // An event arrived while not enabled
 };
 #endif
@@ -33,6 +33,7 @@
   
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysFD.hh"
+#include "XrdSys/XrdSysNuma.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "Xrd/XrdLink.hh"
@@ -76,7 +77,10 @@ int           Stats(char *buff, int blen, int do_sync=0) {return 0;}
 /*                           G l o b a l   D a t a                            */
 /******************************************************************************/
   
-       XrdPoll   *XrdPoll::Pollers[XRD_NUMPOLLERS] = {0, 0, 0};
+       XrdPoll  **XrdPoll::Pollers    = 0;
+       int        XrdPoll::numPollers = 0;
+       int        XrdPoll::numNodes   = 1;
+       int        XrdPoll::edgeMode   = 0;
 
        XrdSysMutex  XrdPoll::doingAttach;
 
@@ -93,6 +97,7 @@ int           Stats(char *buff, int blen, int do_sync=0) {return 0;}
 struct XrdPollArg
        {XrdPoll      *Poller;
         int            retcode;
+        int            pincode;
         XrdSysSemaphore PollSync;
 
         XrdPollArg() : PollSync(0, "poll sync") {}
@@ -103,6 +108,12 @@ struct XrdPollArg
 void *XrdStartPolling(void *parg)
 {
      struct XrdPollArg *PArg = (struct XrdPollArg *)parg;
+
+// Keep NUMA node pollers on their node so that events are handled close to
+// the memory and the network queue servicing their links.
+//
+     if (XrdPoll::numNodes > 1 && !XrdSysNuma::Pin(PArg->Poller->Node))
+        PArg->pincode = errno;
      PArg->Poller->Start(&(PArg->PollSync), PArg->retcode);
      return (void *)0;
 }
@@ -115,8 +126,8 @@ XrdPoll::XrdPoll()
 {
    int fildes[2];
 
-   TID=0;
-   numAttached=numEnabled=numEvents=numInterrupts=0;
+   TID=0; PID=0; Node=0;
+   numAttached=numEnabled=numEvents=numInterrupts=numCtlOps=0;
 
    if (XrdSysFD_Pipe(fildes) == 0)
       {CmdFD = fildes[1];
@@ -139,18 +150,32 @@ int XrdPoll__Attach(XrdLink *lp) {return XrdPoll::Attach(lp);}
 
 int XrdPoll::Attach(XrdLink *lp)
 {
-   int i;
-   XrdPoll *pp;
+   int i, node = 0;
+   XrdPoll *pp = 0;
+
+// When NUMA aware, prefer the pollers on the node receiving the link's traffic
+// (or failing that, the node accepting the connection).
+//
+   if (numNodes > 1 && (node = XrdSysNuma::FDNode(lp->FD)) < 0)
+      node = XrdSysNuma::CurNode();
 
 // We allow only one attach at a time to simplify the processing
 //
    doingAttach.Lock();
 
-// Find a poller with the smallest number of entries
+// Find a poller with the smallest number of entries on our node
 //
-   pp = Pollers[0];
-   for (i = 1; i < XRD_NUMPOLLERS; i++)
-       if (pp->numAttached > Pollers[i]->numAttached) pp = Pollers[i];
+   for (i = 0; i < numPollers; i++)
+       if (Pollers[i]->Node == node
+       &&  (!pp || pp->numAttached > Pollers[i]->numAttached)) pp = Pollers[i];
+
+// If there is no poller on that node, use any poller
+//
+   if (!pp)
+      {pp = Pollers[0];
+       for (i = 1; i < numPollers; i++)
+           if (pp->numAttached > Pollers[i]->numAttached) pp = Pollers[i];
+      }
 
 // Include this FD into the poll set of the poller
 //
@@ -285,32 +310,56 @@ char *XrdPoll::Poll2Text(short events)
 /*                                 S e t u p                                  */
 /******************************************************************************/
   
-int XrdPoll::Setup(int numfd)
+int XrdPoll::Setup(int numfd, int numnodes)
 {
    pthread_t tid;
-   int maxfd, retc, i;
+   int maxfd, retc, i, node, cpuNodes = 0, perNode;
    struct XrdPollArg PArg;
 
+// Determine the number of pollers. When NUMA aware, each node with processors
+// gets an equal share of the normal number of pollers but never less than one.
+// Memory-only nodes get none as a poller could not be pinned to them.
+//
+   if (numnodes > 1)
+      for (i = 0; i < numnodes; i++) if (XrdSysNuma::CPUs(i)) cpuNodes++;
+
+   if (cpuNodes > 0)
+      {perNode    = (XRD_NUMPOLLERS + cpuNodes - 1) / cpuNodes;
+       numPollers = perNode * cpuNodes;
+       numNodes   = numnodes;
+      } else {
+       perNode    = XRD_NUMPOLLERS;
+       numPollers = XRD_NUMPOLLERS;
+       numNodes   = 1;
+      }
+   Pollers = new XrdPoll *[numPollers];
+
 // Calculate the number of table entries per poller
 //
-   maxfd  = (numfd / XRD_NUMPOLLERS) + 16;
+   maxfd  = (numfd / numPollers) + 16;
 
 // Verify that we initialized the poller table
 //
-   for (i = 0; i < XRD_NUMPOLLERS; i++)
+   for (i = 0, node = -1; i < numPollers; i++)
        {if (!(Pollers[i] = newPoller(i, maxfd))) return 0;
-        Pollers[i]->PID = i;
+        if (!(i % perNode))
+           do node++; while(numNodes > 1 && !XrdSysNuma::CPUs(node));
+        Pollers[i]->PID  = i;
+        Pollers[i]->Node = node;
 
    // Now start a thread to handle this poller object
    //
         PArg.Poller = Pollers[i];
         PArg.retcode= 0;
-        TRACE(POLL, "Starting poller " <<i);
+        PArg.pincode= 0;
+        TRACE(POLL, "Starting poller " <<i <<" on node " <<Pollers[i]->Node);
         if ((retc = XrdSysThread::Run(&tid,XrdStartPolling,(void *)&PArg,
                                       XRDSYSTHREAD_BIND, "Poller")))
            {XrdLog->Emsg("Poll", retc, "create poller thread"); return 0;}
         Pollers[i]->TID = tid;
         PArg.PollSync.Wait();
+        if (PArg.pincode)
+           XrdLog->Emsg("Poll", PArg.pincode, "pin poller to its NUMA node");
         if (PArg.retcode)
            {XrdLog->Emsg("Poll", PArg.retcode, "start poller");
             return 0;
@@ -329,29 +378,30 @@ int XrdPoll::Setup(int numfd)
 int XrdPoll::Stats(char *buff, int blen, int do_sync)
 {
    static const char statfmt[] = "<stats id=\"poll\"><att>%d</att>"
-   "<en>%d</en><ev>%d</ev><int>%d</int></stats>";
-   int i, numatt = 0, numen = 0, numev = 0, numint = 0;
+   "<en>%d</en><ev>%d</ev><int>%d</int><ctl>%d</ctl></stats>";
+   int i, numatt = 0, numen = 0, numev = 0, numint = 0, numctl = 0;
    XrdPoll *pp;
 
 // Return number of bytes if so wanted
 //
-   if (!buff) return (sizeof(statfmt)+(4*16))*XRD_NUMPOLLERS;
+   if (!buff) return (sizeof(statfmt)+(5*16))*numPollers;
 
 // Get statistics. While we wish we could honor do_sync, doing so would be
 // costly and hardly worth it. So, we do not include code such as:
 //    x = pp->y; if (do_sync) while(x != pp->y) x = pp->y; tot += x;
 //
-   for (i = 0; i < XRD_NUMPOLLERS; i++)
+   for (i = 0; i < numPollers; i++)
        {pp = Pollers[i];
         numatt += pp->numAttached; 
         numen  += pp->numEnabled;
         numev  += pp->numEvents;
         numint += pp->numInterrupts;
+        numctl += pp->numCtlOps;
        }
 
 // Format and return
 //
-   return snprintf(buff, blen, statfmt, numatt, numen, numev, numint);
+   return snprintf(buff, blen, statfmt, numatt, numen, numev, numint, numctl);
 }
   
 /******************************************************************************/
@@ -73,9 +73,11 @@ static  void  Init(XrdSysError *eP, XrdOucTrace *tP, XrdScheduler *sP)
 //
 static  char *Poll2Text(short events); // Implementation supplied
 
-// Setup() is called at config time to perform poller configuration
+// Setup() is called at config time to perform poller configuration. When
+//         numnodes is greater than one, pollers are created for each NUMA
+//         node that has processors and pinned to those processors.
 //
-static  int   Setup(int numfd);        // Implementation supplied
+static  int   Setup(int numfd, int numnodes=1); // Implementation supplied
 
 // Start() is called via a thread for each poller that was created
 //
@@ -85,14 +87,22 @@ virtual void  Start(XrdSysSemaphore *syncp, int &rc) = 0;
 //
 static  int   Stats(char *buff, int blen, int do_sync=0);
 
+// When edgeMode is set, pollers that support it keep links armed in edge
+// triggered mode and avoid re-arming a link whose socket has been drained.
+//
+static     int         edgeMode;
+
 // Identification of the thread handling this object
 //
            int         PID;       // Poller ID
+           int         Node;      // NUMA node the poller runs on
            pthread_t   TID;       // Thread ID
 
 // The following table reference the pollers in effect
 //
-static     XrdPoll   *Pollers[XRD_NUMPOLLERS];
+static     XrdPoll  **Pollers;
+static     int        numPollers;
+static     int        numNodes;
 
            XrdPoll();
 virtual   ~XrdPoll() {}
@@ -143,6 +153,7 @@ int           PipeBlen;
            int         numEnabled;     // Count of Enable() calls
            int         numEvents;      // Count of poll fd's dispatched
            int         numInterrupts;  // Number of interrupts (e.g., signals)
+           int         numCtlOps;      // Count of poll set changes
 
 private:
 
@@ -31,6 +31,7 @@
 
 #include <sys/epoll.h>
 
+#include "Xrd/XrdLink.hh"
 #include "Xrd/XrdPoll.hh"
 
 #ifndef EPOLLRDHUP
@@ -48,7 +49,9 @@ public:
        void Start(XrdSysSemaphore *syncp, int &rc);
 
             XrdPollE(struct epoll_event *ptab, int numfd, int pfd)
-                       {PollTab = ptab; PollMax = numfd; PollDfd = pfd;}
+                       {PollTab = ptab; PollMax = numfd; PollDfd = pfd;
+                        pollEvents = (edgeMode ? ePollEdge : ePollEvents);
+                       }
            ~XrdPollE();
 
 protected:
@@ -57,6 +60,7 @@ protected:
 const  char *x2Text(unsigned int evf, char *buff);
 
 private:
+bool etClaim(XrdLink *lp);
 void remFD(XrdLink *lp, unsigned int events);
 
 #ifdef EPOLLONESHOT
@@ -66,9 +70,16 @@ void remFD(XrdLink *lp, unsigned int events);
 #endif
    static const int ePollEvents = EPOLLIN  | EPOLLHUP | EPOLLPRI | EPOLLERR |
                                   EPOLLRDHUP | ePollOneShot;
+   static const int ePollEdge   = EPOLLIN  | EPOLLHUP | EPOLLPRI | EPOLLERR |
+                                  EPOLLRDHUP | EPOLLET;
+
+   static const char etIdle    = XrdLink::etIdle;
+   static const char etArmed   = XrdLink::etArmed;
+   static const char etPending = XrdLink::etPending;
 
 struct epoll_event *PollTab;
        int          PollDfd;
        int          PollMax;
+       int          pollEvents;
 };
 #endif
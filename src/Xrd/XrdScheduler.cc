@@ -29,10 +29,13 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #ifdef __APPLE__
@@ -41,11 +44,27 @@
 
 #include "Xrd/XrdJob.hh"
 #include "Xrd/XrdScheduler.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysError.hh"
 
 #define XRD_TRACE XrdTrace->
 #include "Xrd/XrdTrace.hh"
 
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+long long msTime()
+{
+   struct timeval tnow;
+
+   gettimeofday(&tnow, 0);
+   return static_cast<long long>(tnow.tv_sec)*1000 + tnow.tv_usec/1000;
+}
+}
+
 /******************************************************************************/
 /*                        S t a t i c   O b j e c t s                         */
 /******************************************************************************/
@@ -65,6 +84,69 @@ class XrdSchedulerPID
                         {next = prev; pid = newpid;}
      ~XrdSchedulerPID() {}
      };
+
+// A timed job is held in the timer wheel by one of these entries. They are
+// recycled through a free list and never deleted.
+//
+class XrdSchedulerTimer
+     {public:
+      XrdSchedulerTimer  *Next;     // -> Next entry in the wheel slot
+      XrdSchedulerTimer  *Prev;     // -> Previous entry in the wheel slot
+      XrdSchedulerTimer **Slot;     // -> Wheel slot holding the entry
+      XrdSchedulerTimer  *HashNext; // -> Next entry in the job hash chain
+      XrdJob             *Job;      // -> Job to be scheduled
+      long long           When;     // Time (milliseconds) job is to be run
+
+      XrdSchedulerTimer() : Next(0), Prev(0), Slot(0), HashNext(0), Job(0),
+                            When(0) {}
+     ~XrdSchedulerTimer() {}
+     };
+
+// Work is kept in one or more queues. Each worker has a home queue it drains
+// first and then steals work from the other queues when its own is empty.
+// Each queue has its own lock so that producers and consumers spread out
+// instead of all serializing on a single mutex. Queues are padded so that
+// they do not share cache lines.
+//
+class XrdSchedulerQ
+     {public:
+
+      void    Add(int num, XrdJob *jfirst, XrdJob *jlast)
+                 {jlast->NextJob = 0;
+                  qMutex.Lock();
+                  if (First) Last->NextJob = jfirst;
+                     else    First = jfirst;
+                  Last = jlast;
+                  numInQ  += num;
+                  numJobs += num;
+                  qMutex.UnLock();
+                 }
+
+      XrdJob *Get(bool isSteal)
+                 {XrdJob *jp;
+                  if (!First) return 0;
+                  qMutex.Lock();
+                  if ((jp = First))
+                     {if (!(First = jp->NextJob)) Last = 0;
+                      numInQ--;
+                      if (isSteal) numSteals++;
+                     }
+                  qMutex.UnLock();
+                  return jp;
+                 }
+
+      XrdSysMutex  qMutex;
+      XrdJob      *First;
+      XrdJob      *Last;
+      int          numInQ;    // Number of jobs in this queue
+      int          numJobs;   // Number of jobs placed in this queue
+      int          numSteals; // Number of jobs run by a non-home worker
+      char         pad[64];
+
+      XrdSchedulerQ() : First(0), Last(0), numInQ(0), numJobs(0),
+                        numSteals(0) {}
+     ~XrdSchedulerQ() {}
+     };
   
 /******************************************************************************/
 /*            E x t e r n a l   T h r e a d   I n t e r f a c e s             */
@@ -95,7 +177,7 @@ void *XrdStartWorking(void *carg)
 XrdScheduler::XrdScheduler(XrdSysError *eP, XrdOucTrace *tP,
                            int minw, int maxw, int maxi)
               : XrdJob("underused thread monitor"),
-                WorkAvail(0, "sched work")
+                WorkAvail(0, "sched work"), TimerRings(0, "sched timer")
 {
     struct rlimit rlim;
 
@@ -115,7 +197,20 @@ XrdScheduler::XrdScheduler(XrdSysError *eP, XrdOucTrace *tP,
     num_Layoffs =  0;
     num_Limited =  0;
     firstPID    =  0;
-    WorkFirst = WorkLast = TimerQueue = 0;
+    TimerTick   =  msTime()/twTick;
+    TimerNext   =  TimerTick;
+    num_Timers  =  0;
+    memset(TimerWheel0, 0, sizeof(TimerWheel0));
+    memset(TimerWheelN, 0, sizeof(TimerWheelN));
+    TimerHSize  =  1021;
+    TimerHNum   =  0;
+    TimerHash   =  new XrdSchedulerTimer *[TimerHSize]();
+    TimerFree   =  0;
+    WorkQueue   =  new XrdSchedulerQ[MAX_SCHED_QUEUES];
+    num_Queues  =  1;
+    nxt_Queue   =  0;
+    nxt_Home    =  0;
+    isStarted   =  0;
 
 // Make sure we are using the maximum number of threads allowed (Linux only)
 //
@@ -176,28 +271,20 @@ XrdScheduler::~XrdScheduler()  // The scheduler is never deleted!
 
 void XrdScheduler::Cancel(XrdJob *jp)
 {
-   XrdJob *p, *pp = 0;
+   XrdSchedulerTimer *tp;
 
-// Lock the queue
+// Lock the timer wheel and remove the job if it is in it
 //
-   TimerMutex.Lock();
-
-// Find the matching job, if any
-//
-   p = TimerQueue;
-   while(p && p != jp) {pp = p; p = p->NextJob;}
-
-// Delete the job element
-//
-   if (p)
-      {if (pp) pp->NextJob = p->NextJob;
-          else  TimerQueue = p->NextJob;
+   TimerRings.Lock();
+   if ((tp = timerFind(jp, 1)))
+      {timerDel(tp);
+       tp->HashNext = TimerFree; TimerFree = tp;
        TRACE(SCHED, "time event " <<jp->Comment <<" cancelled");
       }
 
 // All done
 //
-   TimerMutex.UnLock();
+   TimerRings.UnLock();
 }
   
 /******************************************************************************/
@@ -320,21 +407,38 @@ void *XrdScheduler::Reaper()
   
 void XrdScheduler::Run()
 {
-   int waiting;
+   int waiting, inQ;
+   unsigned int home;
    XrdJob *jp;
 
+// Pick our home queue. We always look there first for work.
+//
+   AtomicBeg(QueueMutex);
+   AtomicFAdd(home, nxt_Home, 1);
+   AtomicEnd(QueueMutex);
+   home = home % num_Queues;
+
 // Wait for work then do it (an endless task for a worker thread)
 //
    do {do {DispatchMutex.Lock();          idl_Workers++;DispatchMutex.UnLock();
            WorkAvail.Wait();
            DispatchMutex.Lock();waiting = --idl_Workers;DispatchMutex.UnLock();
-           SchedMutex.Lock();
-           if ((jp = WorkFirst))
-              {if (!(WorkFirst = jp->NextJob)) WorkLast = 0;
-               if (num_JobsinQ) num_JobsinQ--;
-                  else XrdLog->Emsg("Scheduler","Job queue count underflow!");
-              } else {
-               num_JobsinQ = 0;
+
+       // Find a job. Should we come up empty while jobs are still counted as
+       // queued, another worker took ours but the one it was posted for is
+       // still in some queue; so look again rather than lose the wakeup.
+       //
+           do {if ((jp = getJob(static_cast<int>(home)))) break;
+               AtomicBeg(QueueMutex);
+               inQ = AtomicGet(num_JobsinQ);
+               AtomicEnd(QueueMutex);
+               if (inQ > 0) sched_yield();
+              } while(inQ > 0);
+
+       // If there is no work, this must have been a layoff notice
+       //
+           if (!jp)
+              {SchedMutex.Lock();
                if (num_Layoffs > 0)
                   {num_Layoffs--;
                    if (waiting)
@@ -344,8 +448,8 @@ void XrdScheduler::Run()
                        return;
                       }
                   }
+               SchedMutex.UnLock();
               }
-           SchedMutex.UnLock();
           } while(!jp);
 
     // Check if we should hire a new worker (we always want 1 idle thread)
@@ -364,99 +468,79 @@ void XrdScheduler::Run()
   
 void XrdScheduler::Schedule(XrdJob *jp)
 {
-// Lock down our data area
-//
-   SchedMutex.Lock();
+   int inQ;
 
-// Place the request on the queue and broadcast it
+// Place the request on a queue
 //
-   jp->NextJob  = 0;
-   if (WorkFirst)
-      {WorkLast->NextJob = jp;
-       WorkLast = jp;
-      } else {
-       WorkFirst = jp;
-       WorkLast  = jp;
-      }
-   WorkAvail.Post();
+   WorkQueue[pickQueue()].Add(1, jp, jp);
 
 // Calculate statistics
 //
-   num_Jobs++;
-   num_JobsinQ++;
-   if (num_JobsinQ > max_QLength) max_QLength = num_JobsinQ;
+   AtomicBeg(QueueMutex);
+   AtomicInc(num_Jobs);
+   AtomicFAdd(inQ, num_JobsinQ, 1);
+   AtomicEnd(QueueMutex);
+   if (inQ >= max_QLength) max_QLength = inQ+1;
 
-// Unlock the data area and return
+// Tell a worker there is something to do
 //
-   SchedMutex.UnLock();
+   WorkAvail.Post();
 }
 
 /******************************************************************************/
   
 void XrdScheduler::Schedule(int numjobs, XrdJob *jfirst, XrdJob *jlast)
 {
+   XrdJob *jp, *jnext;
+   int inQ, n, perQ, qNum = pickQueue();
 
-// Lock down our data area
-//
-   SchedMutex.Lock();
-
-// Place the request list on the queue
+// Place the request list on the queues. When sharded, the list is dealt out
+// in contiguous pieces so that idle workers need not all steal from one queue.
 //
-   jlast->NextJob = 0;
-   if (WorkFirst)
-      {WorkLast->NextJob = jfirst;
-       WorkLast = jlast;
-      } else {
-       WorkFirst = jfirst;
-       WorkLast  = jlast;
-      }
+   if (num_Queues == 1 || numjobs <= 1)
+      WorkQueue[qNum].Add(numjobs, jfirst, jlast);
+      else {perQ = (numjobs + num_Queues - 1) / num_Queues;
+            while(jfirst)
+                 {jp = jfirst; n = 1;
+                  while(n < perQ && jp != jlast && jp->NextJob)
+                       {jp = jp->NextJob; n++;}
+                  jnext = (jp == jlast ? 0 : jp->NextJob);
+                  WorkQueue[qNum].Add(n, jfirst, jp);
+                  if (++qNum >= num_Queues) qNum = 0;
+                  jfirst = jnext;
+                 }
+           }
 
 // Calculate statistics
 //
-   num_Jobs    += numjobs;
-   num_JobsinQ += numjobs;
-   if (num_JobsinQ > max_QLength) max_QLength = num_JobsinQ;
+   AtomicBeg(QueueMutex);
+   AtomicAdd(num_Jobs, numjobs);
+   AtomicFAdd(inQ, num_JobsinQ, numjobs);
+   AtomicEnd(QueueMutex);
+   inQ += numjobs;
+   if (inQ > max_QLength) max_QLength = inQ;
 
 // Indicate number of jobs to work on
 //
    while(numjobs--) WorkAvail.Post();
-
-// Unlock the data area and return
-//
-   SchedMutex.UnLock();
 }
 
 /******************************************************************************/
 
 void XrdScheduler::Schedule(XrdJob *jp, time_t atime)
 {
-   XrdJob *pp = 0, *p;
-
-// Cancel this event, if scheduled
-//
-   Cancel(jp);
-
-// Lock the queue
-//
    if (TRACING(TRACE_SCHED) && *(jp->Comment) != '.')
       {TRACE(SCHED, "scheduling " <<jp->Comment <<" in " <<atime-time(0) <<" seconds");}
-   jp->SchedTime = atime;
-   TimerMutex.Lock();
-
-// Find the insertion point for the work element
-//
-   p = TimerQueue;
-   while(p && p->SchedTime <= atime) {pp = p; p = p->NextJob;}
+   timerPut(jp, static_cast<long long>(atime)*1000);
+}
 
-// Insert the job element
-//
-   jp->NextJob = p;
-   if (pp)  pp->NextJob = jp;
-      else {TimerQueue = jp; TimerRings.Signal();}
+/******************************************************************************/
 
-// All done
-//
-   TimerMutex.UnLock();
+void XrdScheduler::ScheduleMS(XrdJob *jp, int msecs)
+{
+   if (TRACING(TRACE_SCHED) && *(jp->Comment) != '.')
+      {TRACE(SCHED, "scheduling " <<jp->Comment <<" in " <<msecs <<" msecs");}
+   timerPut(jp, msTime() + msecs);
 }
 
 /******************************************************************************/
@@ -505,6 +589,37 @@ void XrdScheduler::setParms(int minw, int maxw, int avlw, int maxi, int once)
    TRACE(SCHED,"Set stk_Workers=" <<stk_Workers <<" max_Workidl=" <<max_Workidl);
 }
 
+/******************************************************************************/
+/*                             s e t Q u e u e s                              */
+/******************************************************************************/
+  
+int XrdScheduler::setQueues(int numq)
+{
+   XrdJob *jp;
+   int i;
+
+// Validate the number of queues
+//
+   if (numq < 1 || numq > MAX_SCHED_QUEUES) return -EINVAL;
+
+// The number of queues may only change before any worker is started
+//
+   SchedMutex.Lock();
+   if (isStarted) {SchedMutex.UnLock(); return -EBUSY;}
+
+// Move anything scheduled on queues we will no longer use to the first queue
+//
+   for (i = numq; i < num_Queues; i++)
+       while((jp = WorkQueue[i].Get(false))) WorkQueue[0].Add(1, jp, jp);
+   num_Queues = numq;
+   SchedMutex.UnLock();
+
+// All done
+//
+   TRACE(SCHED, "Set num_Queues=" <<num_Queues);
+   return 0;
+}
+
 /******************************************************************************/
 /*                                 S t a r t                                  */
 /******************************************************************************/
@@ -514,6 +629,10 @@ void XrdScheduler::Start() // Serialized one time call!
     int retc, numw;
     pthread_t tid;
 
+// Freeze the queue configuration
+//
+   SchedMutex.Lock(); isStarted = 1; SchedMutex.UnLock();
+
 // Start a time based scheduler
 //
    if ((retc = XrdSysThread::Run(&tid, XrdStartTSched, (void *)this,
@@ -540,17 +659,23 @@ void XrdScheduler::Start() // Serialized one time call!
   
 int XrdScheduler::Stats(char *buff, int blen, int do_sync)
 {
+    XrdSchedulerQ *qP;
     int cnt_Jobs, cnt_JobsinQ, xam_QLength, cnt_Workers, cnt_idl;
     int cnt_TCreate, cnt_TDestroy, cnt_Limited;
+    int q_Jobs, q_InQ, q_Steals, i, n;
     static char statfmt[] = "<stats id=\"sched\"><jobs>%d</jobs>"
                 "<inq>%d</inq><maxinq>%d</maxinq>"
                 "<threads>%d</threads><idle>%d</idle>"
                 "<tcr>%d</tcr><tde>%d</tde>"
-                "<tlimr>%d</tlimr></stats>";
+                "<tlimr>%d</tlimr>";
+    static char qfmt[]    = "<queue id=\"%d\"><jobs>%d</jobs>"
+                "<inq>%d</inq><steals>%d</steals></queue>";
+    static char endfmt[]  = "</stats>";
 
 // If only length wanted, do so
 //
-   if (!buff) return sizeof(statfmt) + 16*8;
+   if (!buff) return sizeof(statfmt) + 16*8 + sizeof(endfmt)
+                   + (num_Queues > 1 ? num_Queues*(sizeof(qfmt) + 16*4) : 0);
 
 // Get values protected by the Dispatch lock (avoid lock if no sync needed)
 //
@@ -570,11 +695,27 @@ int XrdScheduler::Stats(char *buff, int blen, int do_sync)
    cnt_Limited = num_Limited;
    if (do_sync) SchedMutex.UnLock();
 
-// Format the stats and return them
+// Format the stats
+//
+   n = snprintf(buff, blen, statfmt, cnt_Jobs, cnt_JobsinQ, xam_QLength,
+                cnt_Workers, cnt_idl, cnt_TCreate, cnt_TDestroy,
+                cnt_Limited);
+
+// When the work queue is sharded, report the depth and steals of each queue
+//
+   if (num_Queues > 1)
+      for (i = 0; i < num_Queues && n < blen; i++)
+          {qP = &WorkQueue[i];
+           if (do_sync) qP->qMutex.Lock();
+           q_Jobs = qP->numJobs; q_InQ = qP->numInQ; q_Steals = qP->numSteals;
+           if (do_sync) qP->qMutex.UnLock();
+           n += snprintf(buff+n, blen-n, qfmt, i, q_Jobs, q_InQ, q_Steals);
+          }
+
+// Close off the stats and return them
 //
-   return snprintf(buff, blen, statfmt, cnt_Jobs, cnt_JobsinQ, xam_QLength,
-                   cnt_Workers, cnt_idl, cnt_TCreate, cnt_TDestroy,
-                   cnt_Limited);
+   if (n < blen) n += snprintf(buff+n, blen-n, "%s", endfmt);
+   return n;
 }
 
 /******************************************************************************/
@@ -583,29 +724,58 @@ int XrdScheduler::Stats(char *buff, int blen, int do_sync)
   
 void XrdScheduler::TimeSched()
 {
-   XrdJob *jp;
-   int wtime;
+   XrdJob *jfirst, *jlast;
+   long long tNow, tLim, tick;
+   int numJobs, wtime;
 
-// Continuous loop until we find some work here
+// Continuous loop running whatever has come due and then sleeping until the
+// next occupied slot or the next time level 0 turns over (as that is when work
+// moves down from the upper levels), whichever is first.
 //
-   do {TimerMutex.Lock();
-       if (TimerQueue) wtime = TimerQueue->SchedTime-time(0);
-          else wtime = 60*60;
-       if (wtime > 0)
-          {TimerMutex.UnLock();
-           TimerRings.Wait(wtime);
-          } else {
-           jp = TimerQueue;
-           TimerQueue = jp->NextJob;
-           Schedule(jp);
-           TimerMutex.UnLock();
-          }
-       } while(1);
+   TimerRings.Lock();
+   do {tNow = msTime();
+       if ((numJobs = timerRun(tNow/twTick, jfirst, jlast)))
+          Schedule(numJobs, jfirst, jlast);
+       if (!num_Timers) TimerNext = TimerTick + 60*60*1000/twTick;
+          else {tLim = (TimerTick + (1<<tw0Bits) - 1) & ~((1LL<<tw0Bits)-1);
+                for (tick = TimerTick; tick < tLim; tick++)
+                    if (TimerWheel0[tick & ((1<<tw0Bits)-1)]) break;
+                TimerNext = tick;
+               }
+       if ((wtime = static_cast<int>(TimerNext*twTick - tNow)) > 0)
+          TimerRings.WaitMS(wtime);
+      } while(1);
 }
 
 /******************************************************************************/
 /*                       P r i v a t e   M e t h o d s                        */
 /******************************************************************************/
+/******************************************************************************/
+/*                                g e t J o b                                 */
+/******************************************************************************/
+  
+XrdJob *XrdScheduler::getJob(int home)
+{
+   XrdJob *jp;
+   int i, qNum = home;
+
+// Look in our home queue first and then steal from the others
+//
+   for (i = 0; i < num_Queues; i++)
+       {if ((jp = WorkQueue[qNum].Get(qNum != home)))
+           {AtomicBeg(QueueMutex);
+            AtomicDec(num_JobsinQ);
+            AtomicEnd(QueueMutex);
+            return jp;
+           }
+        if (++qNum >= num_Queues) qNum = 0;
+       }
+
+// Nothing found
+//
+   return 0;
+}
+
 /******************************************************************************/
 /*                           h i r e   W o r k e r                            */
 /******************************************************************************/
@@ -648,6 +818,213 @@ void XrdScheduler::hireWorker(int dotrace)
       } else if (dotrace) TRACE(SCHED, "Now have " <<num_Workers <<" workers" );
 }
  
+/******************************************************************************/
+/*                             p i c k Q u e u e                              */
+/******************************************************************************/
+  
+int XrdScheduler::pickQueue()
+{
+   unsigned int qNum;
+
+// New work is spread round-robin over all of the queues
+//
+   if (num_Queues == 1) return 0;
+   AtomicBeg(QueueMutex);
+   AtomicFAdd(qNum, nxt_Queue, 1);
+   AtomicEnd(QueueMutex);
+   return static_cast<int>(qNum % num_Queues);
+}
+ 
+/******************************************************************************/
+/*                              t i m e r A d d                               */
+/******************************************************************************/
+
+// The timer wheel must be locked on entry!
+//
+void XrdScheduler::timerAdd(XrdSchedulerTimer *tp)
+{
+   XrdSchedulerTimer **slot;
+   long long expires = (tp->When + twTick - 1)/twTick;
+   long long idx = expires - TimerTick;
+   int i, shift;
+
+// Find the slot for this job. Anything that is already due goes in the slot
+// to be processed next. Anything beyond the last level is parked in the last
+// slot and placed again when that slot is cascaded.
+//
+   if (idx < 0) slot = &TimerWheel0[TimerTick & ((1<<tw0Bits)-1)];
+      else if (idx < (1LL<<tw0Bits)) slot = &TimerWheel0[expires & ((1<<tw0Bits)-1)];
+      else {shift = tw0Bits;
+            for (i = 0; i < twLevels-1; i++, shift += twNBits)
+                if (idx < (1LL<<(shift+twNBits))) break;
+            if (idx >= (1LL<<(shift+twNBits)))
+               expires = TimerTick + (1LL<<(shift+twNBits)) - 1;
+            slot = &TimerWheelN[i][(expires >> shift) & ((1<<twNBits)-1)];
+           }
+
+// Insert the entry at the front of the slot
+//
+   tp->Prev = 0;
+   if ((tp->Next = *slot)) (*slot)->Prev = tp;
+   *slot = tp;
+   tp->Slot = slot;
+   num_Timers++;
+}
+
+/******************************************************************************/
+/*                              t i m e r D e l                               */
+/******************************************************************************/
+  
+// The timer wheel must be locked on entry!
+//
+void XrdScheduler::timerDel(XrdSchedulerTimer *tp)
+{
+   if (tp->Prev) tp->Prev->Next = tp->Next;
+      else *(tp->Slot) = tp->Next;
+   if (tp->Next) tp->Next->Prev = tp->Prev;
+   tp->Next = tp->Prev = 0;
+   tp->Slot = 0;
+   num_Timers--;
+}
+
+/******************************************************************************/
+/*                             t i m e r F i n d                              */
+/******************************************************************************/
+  
+// The timer wheel must be locked on entry! When doRemove is set the entry is
+// also taken out of the job hash.
+//
+XrdSchedulerTimer *XrdScheduler::timerFind(XrdJob *jp, int doRemove)
+{
+   XrdSchedulerTimer *tp, **tpp;
+   tpp = &TimerHash[timerHash(jp)];
+   while((tp = *tpp) && tp->Job != jp) tpp = &(tp->HashNext);
+   if (tp && doRemove) {*tpp = tp->HashNext; tp->HashNext = 0; TimerHNum--;}
+   return tp;
+}
+
+/******************************************************************************/
+/*                             t i m e r H G r o w                            */
+/******************************************************************************/
+  
+// The timer wheel must be locked on entry!
+//
+void XrdScheduler::timerHGrow()
+{
+   XrdSchedulerTimer **oldHash = TimerHash, *tp;
+   int i, oldSize = TimerHSize;
+
+// Rehash every entry into a table twice the size (kept odd)
+//
+   TimerHSize = oldSize*2 + 1;
+   TimerHash  = new XrdSchedulerTimer *[TimerHSize]();
+   for (i = 0; i < oldSize; i++)
+       while((tp = oldHash[i]))
+            {oldHash[i] = tp->HashNext;
+             tp->HashNext = TimerHash[timerHash(tp->Job)];
+             TimerHash[timerHash(tp->Job)] = tp;
+            }
+   delete [] oldHash;
+}
+
+/******************************************************************************/
+/*                              t i m e r P u t                               */
+/******************************************************************************/
+  
+void XrdScheduler::timerPut(XrdJob *jp, long long when)
+{
+   XrdSchedulerTimer *tp;
+
+// Lock the timer wheel and (re)place the job
+//
+   TimerRings.Lock();
+   if ((tp = timerFind(jp))) timerDel(tp);
+      else {if ((tp = TimerFree)) TimerFree = tp->HashNext;
+               else tp = new XrdSchedulerTimer;
+            if (TimerHNum >= TimerHSize*2) timerHGrow();
+            tp->Job = jp;
+            tp->HashNext = TimerHash[timerHash(jp)];
+            TimerHash[timerHash(jp)] = tp;
+            TimerHNum++;
+           }
+   tp->When = when;
+   timerAdd(tp);
+
+// Wake up the time scheduler if this job is due before it would wake up
+//
+   if ((when + twTick - 1)/twTick < TimerNext)
+      {TimerNext = (when + twTick - 1)/twTick;
+       TimerRings.Signal();
+      }
+
+// All done
+//
+   TimerRings.UnLock();
+}
+
+/******************************************************************************/
+/*                              t i m e r R u n                               */
+/******************************************************************************/
+
+// The timer wheel must be locked on entry!
+//
+int XrdScheduler::timerRun(long long tnow, XrdJob *&jfirst, XrdJob *&jlast)
+{
+   XrdSchedulerTimer *tp, *tnext;
+   XrdJob *jp;
+   int i, idx, shift, numJobs = 0;
+
+// If there is nothing pending, simply move the wheel forward
+//
+   jfirst = jlast = 0;
+   if (!num_Timers)
+      {if (TimerTick <= tnow) TimerTick = tnow+1;
+       return 0;
+      }
+
+// Process each tick that has come due
+//
+   while(TimerTick <= tnow)
+        {idx = static_cast<int>(TimerTick & ((1<<tw0Bits)-1));
+
+     // When level 0 turns over, redistribute the next slot of the level above
+     // (and so on upward whenever that level turns over as well).
+     //
+         if (!idx)
+            {shift = tw0Bits;
+             for (i = 0; i < twLevels; i++, shift += twNBits)
+                 {int n = static_cast<int>((TimerTick >> shift)
+                                           & ((1<<twNBits)-1));
+                  tp = TimerWheelN[i][n]; TimerWheelN[i][n] = 0;
+                  while(tp)
+                       {tnext = tp->Next; num_Timers--;
+                        timerAdd(tp);
+                        tp = tnext;
+                       }
+                  if (n) break;
+                 }
+            }
+
+     // Everything in the current level 0 slot is now due
+     //
+         while((tp = TimerWheel0[idx]))
+              {timerDel(tp);
+               jp = tp->Job;
+               timerFind(jp, 1);
+               tp->HashNext = TimerFree; TimerFree = tp;
+               if (jlast) jlast->NextJob = jp;
+                  else    jfirst = jp;
+               jlast = jp;
+               numJobs++;
+              }
+         TimerTick++;
+        }
+
+// Return number of jobs that have come due
+//
+   return numJobs;
+}
+
 /******************************************************************************/
 /*                             t r a c e E x i t                              */
 /******************************************************************************/
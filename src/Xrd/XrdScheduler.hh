@@ -37,9 +37,12 @@
 
 class XrdOucTrace;
 class XrdSchedulerPID;
+class XrdSchedulerQ;
+class XrdSchedulerTimer;
 class XrdSysError;
 
 #define MAX_SCHED_PROCS 30000
+#define MAX_SCHED_QUEUES  256
 
 class XrdScheduler : public XrdJob
 {
@@ -63,9 +66,12 @@ void          Run();
 void          Schedule(XrdJob *jp);
 void          Schedule(int num, XrdJob *jfirst, XrdJob *jlast);
 void          Schedule(XrdJob *jp, time_t atime);
+void          ScheduleMS(XrdJob *jp, int msecs);
 
 void          setParms(int minw, int maxw, int avlt, int maxi, int once=0);
 
+int           setQueues(int numq);
+
 void          Start();
 
 int           Stats(char *buff, int blen, int do_sync=0);
@@ -102,19 +108,54 @@ int        stk_Workers;   // Sched: Number of sticky workers we can have
 int        num_JobsinQ;   // Sched: Number of outstanding jobs in the queue
 int        num_Layoffs;   // Sched: Number of threads to terminate
 
-XrdJob                *WorkFirst;  // Pending work
-XrdJob                *WorkLast;
+XrdSchedulerQ         *WorkQueue;  // Pending work, one list per queue
+int                    num_Queues; // Number of work queues (1 unless sharded)
+unsigned int           nxt_Queue;  // Round-robin queue selector for Schedule()
+unsigned int           nxt_Home;   // Round-robin home queue for new workers
+int                    isStarted;  // Start() has been called
 XrdSysSemaphore        WorkAvail;
 XrdSysMutex            SchedMutex; // Protects private area
+XrdSysMutex            QueueMutex; // Protects queue counters sans atomics
 
-XrdJob                *TimerQueue; // Pending work
-XrdSysCondVar          TimerRings;
-XrdSysMutex            TimerMutex; // Protects scheduler area
+// Timed work is kept in a hierarchical timer wheel. Level 0 has one slot per
+// tick and each level above it has slots spanning a full turn of the one below.
+//
+static const int       tw0Bits  = 8;  // Level 0 has 256 slots
+static const int       twNBits  = 6;  // Levels 1-4 have 64 slots each
+static const int       twLevels = 4;  // Number of levels above level 0
+static const int       twTick   = 10; // Milliseconds per tick
+
+// Jobs are linked into the wheel through timer entries so that XrdJob keeps
+// its layout. The entry for a job is found through a hash on its address,
+// which is doubled in size whenever it holds twice as many entries as buckets.
+//
+XrdSchedulerTimer     *TimerWheel0[1<<tw0Bits];
+XrdSchedulerTimer     *TimerWheelN[twLevels][1<<twNBits];
+XrdSchedulerTimer    **TimerHash;  // Job to timer entry hash
+int                    TimerHSize; // Number of buckets in the hash
+int                    TimerHNum;  // Number of entries in the hash
+XrdSchedulerTimer     *TimerFree;  // Unused timer entries
+long long              TimerTick;  // Next tick to be processed
+long long              TimerNext;  // Tick at which the time scheduler wakes
+int                    num_Timers; // Number of jobs in the timer wheel
+XrdSysCondVar          TimerRings; // Protects timer wheel (caller locks)
 
 XrdSchedulerPID       *firstPID;
 XrdSysMutex            ReaperMutex;
 
+XrdJob *getJob(int home);
 void hireWorker(int dotrace=1);
+int  pickQueue();
+void timerAdd(XrdSchedulerTimer *tp);
+void timerDel(XrdSchedulerTimer *tp);
+XrdSchedulerTimer *timerFind(XrdJob *jp, int doRemove=0);
+int  timerHash(XrdJob *jp)
+              {return static_cast<int>((reinterpret_cast<unsigned long>(jp)>>4)
+                                       % TimerHSize);
+              }
+void timerHGrow();
+void timerPut(XrdJob *jp, long long when);
+int  timerRun(long long tnow, XrdJob *&jfirst, XrdJob *&jlast);
 void Monitor();
 void traceExit(pid_t pid, int status);
 static const char *TraceID;
@@ -72,6 +72,82 @@ target_link_libraries(
   XrdServer
   XrdUtils )
 
+#-------------------------------------------------------------------------------
+# xrdschedbench
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdschedbench
+  XrdApps/XrdSchedBench.cc )
+
+target_link_libraries(
+  xrdschedbench
+  XrdUtils
+  pthread
+  ${EXTRA_LIBS} )
+
+#-------------------------------------------------------------------------------
+# xrdossbench
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdossbench
+  XrdApps/XrdOssBench.cc )
+
+target_link_libraries(
+  xrdossbench
+  XrdServer
+  XrdUtils
+  pthread )
+
+#-------------------------------------------------------------------------------
+# xrdofsbench
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdofsbench
+  XrdApps/XrdOfsBench.cc )
+
+target_link_libraries(
+  xrdofsbench
+  XrdServer
+  XrdUtils
+  pthread )
+
+#-------------------------------------------------------------------------------
+# xrdclreadvbench
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdclreadvbench
+  XrdApps/XrdClReadvBench.cc )
+
+target_link_libraries(
+  xrdclreadvbench
+  XrdCl
+  XrdUtils
+  pthread )
+
+#-------------------------------------------------------------------------------
+# xrdcksbench
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdcksbench
+  XrdApps/XrdCksBench.cc )
+
+target_link_libraries(
+  xrdcksbench
+  XrdUtils
+  pthread )
+
+#-------------------------------------------------------------------------------
+# xrdcmsselbench
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdcmsselbench
+  XrdApps/XrdCmsSelBench.cc )
+
+set_target_properties(
+  xrdcmsselbench
+  PROPERTIES
+  COMPILE_DEFINITIONS "XRDCMS_STMAX=4096" )
+
 #-------------------------------------------------------------------------------
 # xrdmapc
 #-------------------------------------------------------------------------------
@@ -0,0 +1,324 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d C k s B e n c h . c c                         */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+/* This utility compares the throughput of the checksum kernels used by the
+   server, and of the original byte at a time implementations they replace,
+   on the same buffer, verifying that all of them agree. The syntax is:
+
+   xrdcksbench [-n <num>] [-s <size>] [-u <update>]
+
+   <num>     the number of passes over the buffer (default 10).
+   <size>    the size of the buffer in megabytes (default 64).
+   <update>  the number of bytes passed to each Update() call (default
+             1048576), to mimic how the data is fed by the checksum manager.
+*/
+
+/******************************************************************************/
+/*                         i n c l u d e   f i l e s                          */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/time.h>
+
+#include "XrdCks/XrdCksCalcadler32.hh"
+#include "XrdCks/XrdCksCalccrc32.hh"
+#include "XrdCks/XrdCksCalccrc32C.hh"
+#include "XrdCks/XrdCksCalcmd5.hh"
+#include "XrdOuc/XrdOucCRC.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+namespace
+{
+int           numPass = 10, bufSize = 64, updSize = 1048576;
+unsigned char *theBuff;
+
+unsigned int  crcTab[256];      // crc32 (cksum), not reflected
+unsigned int  zcrcTab[256];     // zlib crc32, reflected
+unsigned int  ccrcTab[256];     // crc32c, reflected
+}
+
+/******************************************************************************/
+/*                 R e f e r e n c e   I m p l e m e n t a t i o n s          */
+/******************************************************************************/
+
+namespace
+{
+void MakeTables()
+{
+   unsigned int crc;
+   int i, j;
+
+   for (i = 0; i < 256; i++)
+       {crc = i << 24;
+        for (j = 0; j < 8; j++) crc = (crc << 1) ^ (crc & 0x80000000 ? 0x04C11DB7 : 0);
+        crcTab[i] = crc;
+        crc = i;
+        for (j = 0; j < 8; j++) crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0);
+        zcrcTab[i] = crc;
+        crc = i;
+        for (j = 0; j < 8; j++) crc = (crc >> 1) ^ (crc & 1 ? 0x82F63B78 : 0);
+        ccrcTab[i] = crc;
+       }
+}
+
+/******************************************************************************/
+
+// The original XrdCksCalccrc32, byte at a time with the length appended.
+//
+class RefCrc32 : public XrdCksCalc
+{
+public:
+
+char *Final() {char buff[sizeof(long long)];
+               long long tLcs = TotLen;
+               int i = 0;
+               while(tLcs) {buff[i++] = tLcs & 0xff ; tLcs >>= 8;}
+               Update(buff, i);
+               TheResult = htonl(C32Result ^ 0xffffffff);
+               return (char *)&TheResult;
+              }
+void        Init() {C32Result = 0; TotLen = 0;}
+XrdCksCalc *New() {return new RefCrc32;}
+void        Update(const char *p, int reclen)
+                  {TotLen += reclen;
+                   while(reclen-- > 0)
+                        C32Result = (C32Result<<8)
+                                  ^ crcTab[(unsigned char)((C32Result>>24)^*p++)];
+                  }
+const char *Type(int &csSz) {csSz = sizeof(TheResult); return "crc32";}
+
+            RefCrc32() {Init();}
+private:
+unsigned int C32Result, TheResult;
+long long    TotLen;
+};
+
+/******************************************************************************/
+
+// The original XrdCksCalcadler32, scalar and unrolled by 16.
+//
+class RefAdler32 : public XrdCksCalc
+{
+public:
+
+char *Final() {AdlerValue = htonl((unSum2 << 16) | unSum1);
+               return (char *)&AdlerValue;
+              }
+void        Init() {unSum1 = 1; unSum2 = 0;}
+XrdCksCalc *New() {return new RefAdler32;}
+void        Update(const char *Buff, int BLen)
+                  {int k;
+                   unsigned char *buff = (unsigned char *)Buff;
+                   while(BLen > 0)
+                        {k = (BLen < 5552 ? BLen : 5552);
+                         BLen -= k;
+                         while(k >= 16) {DO16(buff); k -= 16;}
+                         if (k != 0) do {DO1(buff);} while (--k);
+                         unSum1 %= 0xFFF1; unSum2 %= 0xFFF1;
+                        }
+                  }
+const char *Type(int &csSz) {csSz = sizeof(AdlerValue); return "adler32";}
+
+            RefAdler32() {Init();}
+private:
+unsigned int AdlerValue, unSum1, unSum2;
+};
+
+/******************************************************************************/
+
+// Byte at a time reflected crc's, as XrdOucCRC::CRC32 used to be.
+//
+class RefRCrc : public XrdCksCalc
+{
+public:
+
+char *Final() {TheResult = htonl(Crc ^ 0xffffffff); return (char *)&TheResult;}
+void        Init() {Crc = 0xffffffff;}
+XrdCksCalc *New() {return new RefRCrc(Tab, Name);}
+void        Update(const char *Buff, int BLen)
+                  {const unsigned char *p = (const unsigned char *)Buff;
+                   while(BLen-- > 0) Crc = Tab[(Crc ^ *p++) & 0xff] ^ (Crc >> 8);
+                  }
+const char *Type(int &csSz) {csSz = sizeof(TheResult); return Name;}
+
+            RefRCrc(const unsigned int *tab, const char *name)
+                   : Tab(tab), Name(name) {Init();}
+private:
+const unsigned int *Tab;
+const char         *Name;
+unsigned int        Crc, TheResult;
+};
+
+/******************************************************************************/
+
+// XrdOucCRC::CRC32 cannot be fed in pieces, so it gets the whole buffer.
+//
+class OucCrc32 : public XrdCksCalc
+{
+public:
+
+char *Final() {TheResult = htonl(Crc); return (char *)&TheResult;}
+void        Init() {Crc = 0;}
+XrdCksCalc *New() {return new OucCrc32;}
+void        Update(const char *Buff, int BLen)
+                  {Crc = XrdOucCRC::CRC32((const unsigned char *)Buff, BLen);}
+const char *Type(int &csSz) {csSz = sizeof(TheResult); return "zcrc32";}
+
+            OucCrc32() {Init();}
+private:
+unsigned int Crc, TheResult;
+};
+}
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+// Checksum the buffer numPass times and return the rate in MB/s; the result
+// of the last pass is returned in csVal.
+//
+double Run(XrdCksCalc &cks, unsigned int &csVal, int uSize)
+{
+   struct timeval tBeg, tEnd;
+   long long      bLen = (long long)bufSize * 1048576, off;
+   double         secs;
+   int            i, n;
+
+   gettimeofday(&tBeg, 0);
+   for (i = 0; i < numPass; i++)
+       {cks.Init();
+        for (off = 0; off < bLen; off += n)
+            {n = (bLen - off < uSize ? bLen - off : uSize);
+             cks.Update((const char *)theBuff + off, n);
+            }
+        memcpy(&csVal, cks.Final(), sizeof(csVal));
+       }
+   gettimeofday(&tEnd, 0);
+
+   secs = (tEnd.tv_sec - tBeg.tv_sec) + (tEnd.tv_usec - tBeg.tv_usec)/1.0e6;
+   return (double)bufSize * numPass / secs;
+}
+
+/******************************************************************************/
+
+// Compare a kernel against its reference implementation.
+//
+bool Compare(const char *what, XrdCksCalc &ref, XrdCksCalc &cks, int uSize)
+{
+   unsigned int refVal, cksVal;
+   double       refRate, cksRate;
+
+   refRate = Run(ref, refVal, uSize);
+   cksRate = Run(cks, cksVal, uSize);
+   printf("%-8s old %8.1f MB/s  new %8.1f MB/s  speedup %5.1fx  %08x %s\n",
+          what, refRate, cksRate, cksRate / refRate, ntohl(cksVal),
+          (refVal == cksVal ? "ok" : "MISMATCH"));
+   return refVal == cksVal;
+}
+
+/******************************************************************************/
+
+void Usage()
+{
+   fprintf(stderr, "Usage: xrdcksbench [-n <num>] [-s <size>] [-u <update>]\n");
+   exit(1);
+}
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   XrdCksCalcmd5 md5;
+   unsigned int  md5Val;
+   long long     i, bLen;
+   int           c, bad = 0;
+
+// Process the options
+//
+   while ((c = getopt(argc, argv, "n:s:u:")) != -1)
+         {switch(c)
+                {case 'n': if ((numPass = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 's': if ((bufSize = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 'u': if ((updSize = atoi(optarg)) <= 0) Usage();
+                           break;
+                 default:  Usage();
+                }
+         }
+   if (optind < argc) Usage();
+
+// Fill the buffer with reproducible junk
+//
+   bLen = (long long)bufSize * 1048576;
+   if (!(theBuff = (unsigned char *)malloc(bLen)))
+      {fprintf(stderr, "xrdcksbench: unable to allocate %d MB\n", bufSize);
+       return 1;
+      }
+   srand(17);
+   for (i = 0; i < bLen; i++) theBuff[i] = rand() >> 7;
+   MakeTables();
+
+// Run each kernel against its reference
+//
+   printf("%d passes over %d MB in %d byte updates\n", numPass, bufSize, updSize);
+
+   {RefCrc32 ref; XrdCksCalccrc32 cks;
+    if (!Compare("crc32", ref, cks, updSize)) bad++;
+   }
+   {RefAdler32 ref; XrdCksCalcadler32 cks;
+    if (!Compare("adler32", ref, cks, updSize)) bad++;
+   }
+   {RefRCrc ref(ccrcTab, "crc32c"); XrdCksCalccrc32C cks;
+    if (!Compare("crc32c", ref, cks, updSize)) bad++;
+   }
+   if (bLen <= 0x7fffffff)
+      {RefRCrc ref(zcrcTab, "zcrc32"); OucCrc32 cks;
+       if (!Compare("zcrc32", ref, cks, (int)bLen)) bad++;
+      }
+
+// MD5 has no alternative kernel, show it for comparison
+//
+   printf("%-8s                    new %8.1f MB/s\n", "md5",
+          Run(md5, md5Val, updSize));
+
+   free(theBuff);
+   return (bad ? 1 : 0);
+}
@@ -0,0 +1,271 @@
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d C l R e a d v B e n c h . c c                     */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+/* This utility measures the client cost of decoding kXR_readv responses, as
+   done on the poller thread, by feeding synthetic responses through the
+   XRootD message handler over a local socket pair. The syntax is:
+
+   xrdclreadvbench [-c <chunks>] [-l <length>] [-m <msgsize>] [-n <num>] [-s]
+
+   <chunks>  the number of chunks in each readv (default 1024).
+   <length>  the length of each chunk (default 64).
+   <msgsize> the maximum size of a response message; larger responses are
+             split into kXR_oksofar messages (default 2097152).
+   <num>     the number of readv responses decoded (default 1000).
+   -s        send the chunks in random order instead of the requested order.
+*/
+
+/******************************************************************************/
+/*                         i n c l u d e   f i l e s                          */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <vector>
+#include <algorithm>
+
+#include "XProtocol/XProtocol.hh"
+#include "XrdCl/XrdClMessage.hh"
+#include "XrdCl/XrdClMessageUtils.hh"
+#include "XrdCl/XrdClURL.hh"
+#include "XrdCl/XrdClXRootDMsgHandler.hh"
+#include "XrdSys/XrdSysPlatform.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+namespace
+{
+int   numChunks = 1024, chunkLen = 64, msgSize = 2097152, numReadv = 1000;
+bool  doShuffle = false;
+
+struct RespMsg
+{      int       status;
+       uint32_t  dlen;
+};
+
+std::vector<RespMsg> respMsgs;
+std::vector<char>    respData;
+int                  sockFD[2];
+}
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+double Elapsed(struct timeval &tBeg)
+{
+   struct timeval tEnd;
+
+   gettimeofday(&tEnd, 0);
+   return (tEnd.tv_sec - tBeg.tv_sec) + (tEnd.tv_usec - tBeg.tv_usec)/1.0e6;
+}
+
+/******************************************************************************/
+
+// Build the response stream: a chunk header followed by its data, for every
+// chunk, split into messages of at most msgSize bytes.
+//
+void BuildResponse()
+{
+   std::vector<int> order(numChunks);
+   uint32_t dlen = 0;
+   int i, k;
+
+   for (i = 0; i < numChunks; i++) order[i] = i;
+   if (doShuffle)
+      {srand(7);
+       for (i = numChunks-1; i > 0; i--)
+           {k = rand() % (i+1); std::swap(order[i], order[k]);}
+      }
+
+   for (i = 0; i < numChunks; i++)
+       {readahead_list rh;
+        if (dlen && dlen + sizeof(rh) + chunkLen > (uint32_t)msgSize)
+           {RespMsg rm = {kXR_oksofar, dlen}; respMsgs.push_back(rm); dlen = 0;}
+        memset(&rh, 0, sizeof(rh));
+        rh.rlen   = htonl(chunkLen);
+        rh.offset = htonll((long long)order[i] * chunkLen * 2);
+        respData.insert(respData.end(), (char *)&rh, (char *)&rh + sizeof(rh));
+        respData.insert(respData.end(), chunkLen, (char)order[i]);
+        dlen += sizeof(rh) + chunkLen;
+       }
+   RespMsg rm = {kXR_ok, dlen};
+   respMsgs.push_back(rm);
+}
+
+/******************************************************************************/
+
+// Feed the response stream into the socket once for every readv.
+//
+void *Writer(void *carg)
+{
+   const char *bP;
+   int i, n, left;
+
+   for (i = 0; i < numReadv; i++)
+       {bP = &respData[0]; left = respData.size();
+        while (left > 0)
+              {if ((n = write(sockFD[1], bP, left)) < 0)
+                  {if (errno == EINTR) continue;
+                   perror("xrdclreadvbench: write"); exit(1);
+                  }
+               bP += n; left -= n;
+              }
+       }
+   return (void *)0;
+}
+
+/******************************************************************************/
+
+// Decode one readv response the way the socket handler drives the message
+// handler: examine the header, then read the body in raw mode.
+//
+bool Decode(XrdCl::ChunkList &chunks, XrdCl::URL &url)
+{
+   XrdCl::Message     *msg;
+   ClientReadVRequest *req;
+   unsigned int        m;
+
+   XrdCl::MessageUtils::CreateRequest(msg, req, numChunks*sizeof(readahead_list));
+   req->streamid[0] = 0;
+   req->streamid[1] = 1;
+   req->requestid   = htons(kXR_readv);
+
+   XrdCl::XRootDMsgHandler *handler = new XrdCl::XRootDMsgHandler(msg, 0, &url, 0);
+   handler->SetChunkList(&chunks);
+
+   for (m = 0; m < respMsgs.size(); m++)
+       {XrdCl::Message *rsp = new XrdCl::Message(8);
+        ServerResponseHeader *hdr = (ServerResponseHeader *)rsp->GetBuffer();
+        hdr->streamid[0] = 0;
+        hdr->streamid[1] = 1;
+        hdr->status      = respMsgs[m].status;
+        hdr->dlen        = respMsgs[m].dlen;
+        if (!(handler->Examine(rsp) & XrdCl::IncomingMsgHandler::Raw))
+           {delete handler; return false;}
+
+        XrdCl::Status st;
+        uint32_t      bytesRead = 0;
+        do {st = handler->ReadMessageBody(rsp, sockFD[0], bytesRead);}
+           while (st.IsOK() && st.code == XrdCl::suRetry);
+        if (!st.IsOK()) {delete handler; return false;}
+       }
+
+   delete handler;
+   return true;
+}
+
+/******************************************************************************/
+
+void Usage()
+{
+   fprintf(stderr, "Usage: xrdclreadvbench [-c <chunks>] [-l <length>] "
+                   "[-m <msgsize>] [-n <num>] [-s]\n");
+   exit(1);
+}
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   XrdCl::URL       url("root://localhost:1094");
+   XrdCl::ChunkList chunks;
+   std::vector<char> buffer;
+   pthread_t        tid;
+   struct timeval   tBeg;
+   double           secs;
+   int              c, i, bad = 0;
+
+// Process the options
+//
+   while ((c = getopt(argc, argv, "c:l:m:n:s")) != -1)
+         {switch(c)
+                {case 'c': if ((numChunks = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 'l': if ((chunkLen  = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 'm': if ((msgSize   = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 'n': if ((numReadv  = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 's': doShuffle = true;
+                           break;
+                 default:  Usage();
+                }
+         }
+   if (optind < argc || msgSize < (int)sizeof(readahead_list) + chunkLen)
+      Usage();
+
+// Set up the request, every other chunk length of the file
+//
+   buffer.resize((size_t)numChunks * chunkLen);
+   for (i = 0; i < numChunks; i++)
+       chunks.push_back(XrdCl::ChunkInfo((uint64_t)i * chunkLen * 2, chunkLen,
+                                         &buffer[(size_t)i * chunkLen]));
+   BuildResponse();
+
+   if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockFD))
+      {perror("xrdclreadvbench: socketpair"); return 1;}
+   if (XrdSysThread::Run(&tid, Writer, (void *)0, XRDSYSTHREAD_BIND, "writer"))
+      {perror("xrdclreadvbench: thread"); return 1;}
+
+// Decode the responses
+//
+   gettimeofday(&tBeg, 0);
+   for (i = 0; i < numReadv; i++)
+       if (!Decode(chunks, url))
+          {fprintf(stderr, "xrdclreadvbench: readv %d failed\n", i); return 1;}
+   secs = Elapsed(tBeg);
+   XrdSysThread::Join(tid, 0);
+
+// Check that every chunk landed in its own buffer
+//
+   for (i = 0; i < numChunks; i++)
+       if (buffer[(size_t)i * chunkLen] != (char)i) bad++;
+
+   printf("%d readv of %d x %d bytes in %d messages%s: %.3f s, "
+          "%.0f ns/chunk, %.0f chunks/s, %d misplaced\n",
+          numReadv, numChunks, chunkLen, (int)respMsgs.size(),
+          (doShuffle ? " shuffled" : ""), secs,
+          secs * 1.0e9 / ((double)numReadv * numChunks),
+          (double)numReadv * numChunks / secs, bad);
+   return (bad ? 1 : 0);
+}
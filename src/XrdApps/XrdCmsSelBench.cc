@@ -0,0 +1,205 @@
+/******************************************************************************/
+/*                                                                            */
+/*                     X r d C m s S e l B e n c h . c c                      */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+/* This utility simulates the cmsd node selection over a large cell using the
+   node mask type the cmsd is built with when CMS_MAXNODES is raised. It
+   compares the original scan of the whole node table against walking only
+   the bits set in the candidate mask, verifying that both pick the same node.
+   The syntax is:
+
+   xrdcmsselbench [-c <copies>] [-n <nodes>] [-s <selects>]
+
+   <copies>  the number of nodes that have each file (default 3).
+   <nodes>   the number of nodes in the cell (default STMax).
+   <selects> the number of selections to time (default 100000).
+*/
+
+/******************************************************************************/
+/*                         i n c l u d e   f i l e s                          */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "XrdCms/XrdCmsTypes.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+namespace
+{
+struct SimNode
+      {SMask_t NodeMask;
+       int     myLoad;
+       int     RefR;
+       bool    isOffline;
+      };
+
+SimNode  *NodeTab[STMax];
+int       STHi;
+
+int       numCopy = 3, numNode = STMax, numSel = 100000;
+}
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+// Pick the least loaded node the way SelbyLoad did, scanning every slot.
+//
+SimNode *SelScan(const SMask_t &mask)
+{
+   SimNode *np, *sp = 0;
+
+   for (int i = 0; i <= STHi; i++)
+       if ((np = NodeTab[i]) && (np->NodeMask & mask))
+          {if (np->isOffline) continue;
+           if (!sp || sp->myLoad > np->myLoad
+           ||  (sp->myLoad == np->myLoad && sp->RefR > np->RefR)) sp = np;
+          }
+   return sp;
+}
+
+/******************************************************************************/
+
+// Pick the least loaded node visiting only the slots whose bit is set.
+//
+SimNode *SelBits(const SMask_t &mask)
+{
+   SimNode *np, *sp = 0;
+
+   for (int i = SMaskNext(mask, 0); i >= 0 && i <= STHi;
+            i = SMaskNext(mask, i+1))
+       if ((np = NodeTab[i]))
+          {if (np->isOffline) continue;
+           if (!sp || sp->myLoad > np->myLoad
+           ||  (sp->myLoad == np->myLoad && sp->RefR > np->RefR)) sp = np;
+          }
+   return sp;
+}
+
+/******************************************************************************/
+
+// Run a selector over all the masks returning selections per second; the
+// chosen nodes are returned in picks.
+//
+double Run(SimNode *(*Sel)(const SMask_t &), SMask_t *masks, SimNode **picks)
+{
+   struct timeval tBeg, tEnd;
+   double secs;
+
+   gettimeofday(&tBeg, 0);
+   for (int i = 0; i < numSel; i++) picks[i] = Sel(masks[i]);
+   gettimeofday(&tEnd, 0);
+
+   secs = (tEnd.tv_sec - tBeg.tv_sec) + (tEnd.tv_usec - tBeg.tv_usec)/1.0e6;
+   return (secs > 0 ? numSel / secs : 0);
+}
+
+/******************************************************************************/
+
+void Usage()
+{
+   fprintf(stderr, "Usage: xrdcmsselbench [-c <copies>] [-n <nodes>] "
+                   "[-s <selects>]\n");
+   exit(1);
+}
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   SMask_t  *masks;
+   SimNode **scanPick, **bitsPick;
+   double    scanRate, bitsRate;
+   int       c, i, j, bad = 0, nBits = 0;
+
+// Process the options
+//
+   while ((c = getopt(argc, argv, "c:n:s:")) != -1)
+         {switch(c)
+                {case 'c': if ((numCopy = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 'n': numNode = atoi(optarg);
+                           if (numNode <= 0 || numNode > STMax) Usage();
+                           break;
+                 case 's': if ((numSel = atoi(optarg)) <= 0) Usage();
+                           break;
+                 default:  Usage();
+                }
+         }
+   if (optind < argc || numCopy > numNode) Usage();
+
+// Populate the node table with reproducible loads
+//
+   srand(17);
+   for (i = 0; i < numNode; i++)
+       {NodeTab[i] = new SimNode;
+        NodeTab[i]->NodeMask  = SMask_t(1) << i;
+        NodeTab[i]->myLoad    = rand() % 100;
+        NodeTab[i]->RefR      = rand() % 1000;
+        NodeTab[i]->isOffline = (rand() % 50) == 0;
+       }
+   STHi = numNode-1;
+
+// Generate the candidate masks, one per selection
+//
+   masks    = new SMask_t[numSel];
+   scanPick = new SimNode *[numSel];
+   bitsPick = new SimNode *[numSel];
+   for (i = 0; i < numSel; i++)
+       {for (j = 0; j < numCopy; j++) masks[i] |= SMask_t(1) << rand()%numNode;
+        nBits += SMaskCount(masks[i]);
+       }
+
+// Time both selectors and verify that they agree
+//
+   printf("%d selections over %d nodes (max %d), %.1f copies per file\n",
+          numSel, numNode, STMax, (double)nBits / numSel);
+   scanRate = Run(SelScan, masks, scanPick);
+   bitsRate = Run(SelBits, masks, bitsPick);
+   for (i = 0; i < numSel; i++) if (scanPick[i] != bitsPick[i]) bad++;
+
+   printf("scan %10.0f sel/s  bits %10.0f sel/s  speedup %6.1fx  %s\n",
+          scanRate, bitsRate, (scanRate > 0 ? bitsRate / scanRate : 0),
+          (bad ? "MISMATCH" : "ok"));
+
+// All done
+//
+   for (i = 0; i < numNode; i++) delete NodeTab[i];
+   delete [] masks; delete [] scanPick; delete [] bitsPick;
+   return (bad ? 1 : 0);
+}
@@ -863,7 +863,7 @@ void XrdCpConfig::Usage(int rc)
    static const char *Detail = "\n"
    "-C | --cksum <args> verifies the checksum at the destination as provided\n"
    "                    by the source server or locally computed. The args are\n"
-   "                    {adler32 | crc32 | md5}[:{<value>|print|source}]\n"
+   "                    {adler32 | crc32 | crc32c | md5}[:{<value>|print|source}]\n"
    "                    If the hex value of the checksum is given, it is used.\n"
    "                    Otherwise, the server's checksum is used for remote files\n"
    "                    and computed for local files. Specifying print merely\n"
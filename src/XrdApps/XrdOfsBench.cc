@@ -0,0 +1,215 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O f s B e n c h . c c                         */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+
+/* This utility measures the rate at which the ofs layer can open and close
+   file handles when many clients open the same set of files at the same time.
+   The files are opened through the default oss. The syntax is:
+
+   xrdofsbench [-f <files>] [-h <hold>] [-n <num>] [-t <threads>] <dir>
+
+   <files>   the number of distinct files to use (default 64). They are
+             created in <dir> if they do not exist.
+   <hold>    the number of files each thread keeps open at any one time; the
+             oldest is closed when a new one is opened (default 8).
+   <num>     the number of opens each thread performs (default 100000).
+   <threads> the number of threads opening files (default 16).
+*/
+
+/******************************************************************************/
+/*                         i n c l u d e   f i l e s                          */
+/******************************************************************************/
+  
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "XrdVersion.hh"
+#include "XrdOfs/XrdOfsHandle.hh"
+#include "XrdOss/XrdOss.hh"
+#include "XrdOss/XrdOssDefaultSS.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysHeaders.hh"
+#include "XrdSys/XrdSysLogger.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+extern XrdSysError OfsEroute;
+
+namespace
+{
+XrdOss  *ossP;
+char   **filePath;
+int      numFiles = 64, numHold = 8, numOpens = 100000;
+int      numDelay = 0, numError = 0;
+XrdSysMutex cntMutex;
+}
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+void Close(XrdOfsHandle *hP)
+{
+   int retc;
+
+   hP->Lock();
+   hP->Retire(retc);
+}
+
+double Elapsed(struct timeval &tBeg)
+{
+   struct timeval tEnd;
+
+   gettimeofday(&tEnd, 0);
+   return (tEnd.tv_sec - tBeg.tv_sec) + (tEnd.tv_usec - tBeg.tv_usec)/1.0e6;
+}
+
+void *Storm(void *carg)
+{
+   XrdOucEnv     myEnv;
+   XrdOfsHandle *hP, **held = new XrdOfsHandle *[numHold];
+   XrdOssDF     *fP;
+   unsigned int  seed = (unsigned int)(long)carg;
+   int           i, k, nHeld = 0, nDelay = 0, nError = 0;
+
+// Open random files while keeping the last numHold of them open
+//
+   for (i = 0; i < numOpens; i++)
+       {k = rand_r(&seed) % numFiles;
+        if (XrdOfsHandle::Alloc(filePath[k], 0, &hP)) {nDelay++; continue;}
+        if (hP->Inactive())
+           {fP = ossP->newFile("bench");
+            if (fP->Open(filePath[k], O_RDONLY, 0, myEnv))
+               {delete fP; nError++;}
+               else hP->Activate(fP);
+           }
+        hP->UnLock();
+        if (nHeld == numHold) Close(held[i % numHold]);
+           else nHeld++;
+        held[i % numHold] = hP;
+       }
+
+// Close whatever we have left
+//
+   for (i = 0; i < nHeld; i++) Close(held[i]);
+   delete [] held;
+
+// Add in our counts
+//
+   cntMutex.Lock(); numDelay += nDelay; numError += nError; cntMutex.UnLock();
+   return (void *)0;
+}
+
+void Usage()
+{
+   fprintf(stderr, "Usage: xrdofsbench [-f <files>] [-h <hold>] [-n <num>] "
+                   "[-t <threads>] <dir>\n");
+   exit(1);
+}
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+  
+int main(int argc, char *argv[])
+{
+   static XrdVERSIONINFODEF(myVer, xrdofsbench, XrdVNUMBER, XrdVERSION);
+   XrdSysLogger     myLogger;
+   XrdSysError      eDest(&myLogger, "bench");
+   pthread_t       *tid;
+   struct timeval   tBeg;
+   double           secs;
+   char             buff[1024];
+   int              c, i, fd, numThreads = 16;
+
+// Process the options
+//
+   while ((c = getopt(argc, argv, "f:h:n:t:")) != -1)
+         {switch(c)
+                {case 'f': if ((numFiles   = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 'h': if ((numHold    = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 'n': if ((numOpens   = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 't': if ((numThreads = atoi(optarg)) <= 0) Usage();
+                           break;
+                 default:  Usage();
+                }
+         }
+   if (optind >= argc) Usage();
+
+// Get the default storage system
+//
+   OfsEroute.logger(&myLogger);
+   if (!(ossP = XrdOssDefaultSS(&myLogger, 0, myVer)))
+      {eDest.Emsg("bench", "Unable to initialize the oss."); return 1;}
+
+// Create the files
+//
+   filePath = new char *[numFiles];
+   for (i = 0; i < numFiles; i++)
+       {snprintf(buff, sizeof(buff), "%s/ofsbench.%d", argv[optind], i);
+        filePath[i] = strdup(buff);
+        if ((fd = open(buff, O_RDONLY|O_CREAT, 0644)) < 0)
+           {eDest.Emsg("bench", errno, "create", buff); return 1;}
+        close(fd);
+       }
+
+// Run the threads
+//
+   tid = new pthread_t[numThreads];
+   gettimeofday(&tBeg, 0);
+   for (i = 0; i < numThreads; i++)
+       if ((c = XrdSysThread::Run(&tid[i], Storm, (void *)(long)(i+1),
+                                  XRDSYSTHREAD_HOLD, "storm")))
+          {eDest.Emsg("bench", c, "start thread"); return 1;}
+   for (i = 0; i < numThreads; i++) XrdSysThread::Join(tid[i], 0);
+   secs = Elapsed(tBeg);
+
+// Report the results
+//
+   printf("%d threads %d files %d held: %lld opens %8.3f s %10.0f opens/s; "
+          "%d delayed %d failed\n", numThreads, numFiles, numHold,
+          (long long)numThreads*numOpens, secs,
+          (secs > 0 ? (double)numThreads*numOpens/secs : 0.0),
+          numDelay, numError);
+   return 0;
+}
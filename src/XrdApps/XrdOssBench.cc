@@ -0,0 +1,172 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O s s B e n c h . c c                         */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+/* This utility compares vector read performance using ordinary pread() calls
+   with io_uring batched submission on a local file. The syntax is:
+
+   xrdossbench [-i <iter>] [-n <segs>] [-s <size>] <path>
+
+   <iter>   the number of vector reads to perform (default 1000).
+   <segs>   the number of segments in each vector read (default 64).
+   <size>   the size of each segment in bytes (default 4096).
+   <path>   the file to read. Segments are at random offsets in the file. The
+            page cache should be dropped between runs for cold cache results.
+*/
+
+/******************************************************************************/
+/*                         i n c l u d e   f i l e s                          */
+/******************************************************************************/
+  
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "XrdOss/XrdOssUring.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+double Elapsed(struct timeval &tBeg)
+{
+   struct timeval tEnd;
+
+   gettimeofday(&tEnd, 0);
+   return (tEnd.tv_sec - tBeg.tv_sec) + (tEnd.tv_usec - tBeg.tv_usec)/1.0e6;
+}
+
+ssize_t PreadV(int fd, XrdOucIOVec *readV, int n)
+{
+   ssize_t rdsz, totBytes = 0;
+   int i;
+
+   for (i = 0; i < n; i++)
+       {do {rdsz = pread(fd, readV[i].data, readV[i].size, readV[i].offset);}
+           while(rdsz < 0 && errno == EINTR);
+        if (rdsz < 0 || rdsz != readV[i].size) return -ESPIPE;
+        totBytes += rdsz;
+       }
+   return totBytes;
+}
+
+void Report(const char *what, int num, long long bytes, double secs)
+{
+   printf("%-16s %8d readv %8.3f s %9.1f us/readv %9.1f MB/s\n", what, num,
+          secs, (num ? secs*1.0e6/num : 0.0),
+          (secs > 0 ? bytes/secs/1048576.0 : 0.0));
+}
+
+void Usage()
+{
+   fprintf(stderr, "Usage: xrdossbench [-i <iter>] [-n <segs>] [-s <size>] "
+                   "<path>\n");
+   exit(1);
+}
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+  
+int main(int argc, char *argv[])
+{
+   XrdSysLogger     myLogger;
+   XrdSysError      eDest(&myLogger, "bench");
+   XrdOucIOVec     *readV;
+   struct timeval   tBeg;
+   struct stat      Stat;
+   long long        totBytes;
+   char            *buff;
+   int              c, i, j, fd, numIter = 1000, numSegs = 64, segSize = 4096;
+
+// Process the options
+//
+   while ((c = getopt(argc, argv, "i:n:s:")) != -1)
+         {switch(c)
+                {case 'i': if ((numIter = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 'n': if ((numSegs = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 's': if ((segSize = atoi(optarg)) <= 0) Usage();
+                           break;
+                 default:  Usage();
+                }
+         }
+   if (optind >= argc) Usage();
+
+// Open the file and make sure it is big enough
+//
+   if ((fd = open(argv[optind], O_RDONLY)) < 0 || fstat(fd, &Stat))
+      {eDest.Emsg("bench", errno, "open", argv[optind]); return 1;}
+   if (Stat.st_size < segSize)
+      {eDest.Emsg("bench", "File is smaller than the segment size."); return 1;}
+
+// Generate the vectors up front so only the reads are timed
+//
+   readV = new XrdOucIOVec[numSegs*numIter];
+   buff  = (char *)malloc((size_t)numSegs*segSize);
+   srand(1);
+   for (i = 0; i < numSegs*numIter; i++)
+       {readV[i].offset = (rand() % (Stat.st_size/segSize)) * (long long)segSize;
+        readV[i].size   = segSize;
+        readV[i].data   = buff + (i % numSegs)*segSize;
+       }
+   totBytes = (long long)numSegs*segSize*numIter;
+
+// Time the reads using pread()
+//
+   gettimeofday(&tBeg, 0);
+   for (j = 0; j < numIter; j++)
+       if (PreadV(fd, &readV[j*numSegs], numSegs) < 0)
+          {eDest.Emsg("bench", "pread vector read failed."); return 1;}
+   Report("pread", numIter, totBytes, Elapsed(tBeg));
+
+// Time the reads using io_uring
+//
+   if (!XrdOssUring::Init(&eDest, 1, (numSegs < 256 ? 256 : numSegs)))
+      return 1;
+   gettimeofday(&tBeg, 0);
+   for (j = 0; j < numIter; j++)
+       if (XrdOssUring::ReadV(fd, &readV[j*numSegs], numSegs) < 0)
+          {eDest.Emsg("bench", "io_uring vector read failed."); return 1;}
+   Report("io_uring", numIter, totBytes, Elapsed(tBeg));
+
+// All done
+//
+   return 0;
+}
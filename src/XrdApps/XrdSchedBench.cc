@@ -0,0 +1,159 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d S c h e d B e n c h . c c                       */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+/* This utility measures the cost of scheduling and cancelling timed jobs in
+   the XrdScheduler. The syntax is:
+
+   xrdschedbench [-n <num>] [-t <maxsec>]
+
+   <num>    the number of timed jobs to schedule and cancel (default 1000000).
+   <maxsec> jobs are scheduled at random times up to this many seconds in the
+            future (default 3600).
+*/
+
+/******************************************************************************/
+/*                         i n c l u d e   f i l e s                          */
+/******************************************************************************/
+  
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "Xrd/XrdJob.hh"
+#include "Xrd/XrdScheduler.hh"
+#include "XrdOuc/XrdOucTrace.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+class XrdSchedBenchJob : public XrdJob
+{
+public:
+
+void DoIt() {}
+
+     XrdSchedBenchJob() : XrdJob(".bench") {}
+    ~XrdSchedBenchJob() {}
+};
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+double Elapsed(struct timeval &tBeg)
+{
+   struct timeval tEnd;
+
+   gettimeofday(&tEnd, 0);
+   return (tEnd.tv_sec - tBeg.tv_sec) + (tEnd.tv_usec - tBeg.tv_usec)/1.0e6;
+}
+
+void Report(const char *what, int num, double secs)
+{
+   printf("%-22s %9d ops %8.3f s %8.1f ns/op\n", what, num, secs,
+          (num ? secs*1.0e9/num : 0.0));
+}
+
+void Usage()
+{
+   fprintf(stderr, "Usage: xrdschedbench [-n <num>] [-t <maxsec>]\n");
+   exit(1);
+}
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+  
+int main(int argc, char *argv[])
+{
+   XrdSysLogger     myLogger;
+   XrdSysError      eDest(&myLogger, "bench");
+   XrdOucTrace      myTrace(&eDest);
+   XrdScheduler     mySched(&eDest, &myTrace, 1, 8, 0);
+   XrdSchedBenchJob *jobs;
+   struct timeval   tBeg;
+   time_t           tNow = time(0);
+   int              c, i, *delay, numJobs = 1000000, maxSec = 3600;
+
+// Process the options
+//
+   while ((c = getopt(argc, argv, "n:t:")) != -1)
+         {switch(c)
+                {case 'n': if ((numJobs = atoi(optarg)) <= 0) Usage();
+                           break;
+                 case 't': if ((maxSec  = atoi(optarg)) <= 0) Usage();
+                           break;
+                 default:  Usage();
+                }
+         }
+
+// Precompute the jobs and their random delays so only the scheduler is timed
+//
+   jobs  = new XrdSchedBenchJob[numJobs];
+   delay = new int[numJobs];
+   srand(1);
+   for (i = 0; i < numJobs; i++) delay[i] = rand() % (maxSec*1000);
+
+// Schedule every job at a whole second
+//
+   gettimeofday(&tBeg, 0);
+   for (i = 0; i < numJobs; i++)
+       mySched.Schedule(&jobs[i], tNow + 1 + delay[i]/1000);
+   Report("schedule (sec)", numJobs, Elapsed(tBeg));
+
+// Move every job to a new time, as is done for idle link timers
+//
+   gettimeofday(&tBeg, 0);
+   for (i = 0; i < numJobs; i++) mySched.ScheduleMS(&jobs[i], 1000+delay[i]);
+   Report("reschedule (msec)", numJobs, Elapsed(tBeg));
+
+// Cancel every other job
+//
+   gettimeofday(&tBeg, 0);
+   for (i = 0; i < numJobs; i += 2) mySched.Cancel(&jobs[i]);
+   Report("cancel", (numJobs+1)/2, Elapsed(tBeg));
+
+// Cancel the remaining jobs in reverse order
+//
+   gettimeofday(&tBeg, 0);
+   for (i = numJobs-1; i >= 0; i--) mySched.Cancel(&jobs[i]);
+   Report("cancel (all)", numJobs, Elapsed(tBeg));
+
+// All done
+//
+   return 0;
+}
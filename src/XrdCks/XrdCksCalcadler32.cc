@@ -0,0 +1,163 @@
+/******************************************************************************/
+/*                                                                            */
+/*                  X r d C k s C a l c a d l e r 3 2 . c c                   */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/* Update() comes from XrdCksCalcadler32.hh, (c) 2011 by the Board of         */
+/* Trustees of the Leland Stanford, Jr., University                           */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdCks/XrdCksCalcadler32.hh"
+
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ > 4 \
+    || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define XRDCKS_AVX2 1
+#include <immintrin.h>
+#endif
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+#ifdef XRDCKS_AVX2
+namespace
+{
+__attribute__((target("avx2")))
+unsigned int HSum(__m256i v)
+{
+   __m128i x = _mm_add_epi32(_mm256_castsi256_si128(v),
+                             _mm256_extracti128_si256(v, 1));
+   x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1,0,3,2)));
+   x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2,3,0,1)));
+   return (unsigned int)_mm_cvtsi128_si32(x);
+}
+
+/******************************************************************************/
+
+/* Process 32 byte blocks, at most nMax bytes between reductions. For a block
+   starting with sums s1 and s2 the new s2 is s2 + 32*s1 + sum((32-i)*b[i])
+   and the new s1 is s1 + sum(b[i]). Across n blocks the s1 terms add up to
+   32*(n*s1 + the sum of the block sums preceding each block), which is kept
+   in vPS, while vS2 keeps the weighted byte sums and vS1 the byte sums.
+*/
+__attribute__((target("avx2")))
+void Adler32AVX2(unsigned int &s1, unsigned int &s2,
+                 const unsigned char *&buff, int &bLen,
+                 int nMax, unsigned int base)
+{
+   const __m256i tap  = _mm256_set_epi8( 1,  2,  3,  4,  5,  6,  7,  8,
+                                         9, 10, 11, 12, 13, 14, 15, 16,
+                                        17, 18, 19, 20, 21, 22, 23, 24,
+                                        25, 26, 27, 28, 29, 30, 31, 32);
+   const __m256i ones = _mm256_set1_epi16(1);
+   const __m256i zero = _mm256_setzero_si256();
+   int blocks = bLen / 32, n, i;
+
+   bLen -= blocks * 32;
+   while(blocks > 0)
+        {n = (blocks < nMax / 32 ? blocks : nMax / 32);
+         blocks -= n;
+         __m256i vPS = zero, vS1 = zero, vS2 = zero;
+         for (i = 0; i < n; i++)
+             {__m256i bytes = _mm256_loadu_si256((const __m256i *)buff);
+              vPS = _mm256_add_epi32(vPS, vS1);
+              vS1 = _mm256_add_epi32(vS1, _mm256_sad_epu8(bytes, zero));
+              vS2 = _mm256_add_epi32(vS2, _mm256_madd_epi16(
+                                     _mm256_maddubs_epi16(bytes, tap), ones));
+              buff += 32;
+             }
+         s2 = (unsigned int)((s2 + 32ULL * (s1 * (unsigned long long)n
+                             + HSum(vPS)) + HSum(vS2)) % base);
+         s1 = (s1 + HSum(vS1)) % base;
+        }
+}
+}
+#endif
+
+/******************************************************************************/
+/*                          S t a t i c   D a t a                             */
+/******************************************************************************/
+
+const bool XrdCksCalcadler32::doAVX2 = XrdCksCalcadler32::UseAVX2();
+
+/******************************************************************************/
+/*                               C o m b i n e                                */
+/******************************************************************************/
+
+/* The second sum of the concatenation is the second sum of the piece with each
+   of its bytes also weighted by the first sum of the leading part, hence the
+   Len*s1 term (the leading 1 of the second piece's s1 is taken out again).
+*/
+void XrdCksCalcadler32::Combine(const XrdCksCalcadler32 &csX, long long Len)
+{
+   unsigned int rem = static_cast<unsigned int>(Len % AdlerBase);
+   unsigned long long s2;
+
+   s2 = ((unsigned long long)rem * unSum1) % AdlerBase;
+   s2 += unSum2 + csX.unSum2 + AdlerBase - rem;
+   unSum1 += csX.unSum1 + AdlerBase - 1;
+
+   unSum1 %= AdlerBase;
+   unSum2  = static_cast<unsigned int>(s2 % AdlerBase);
+}
+
+/******************************************************************************/
+/*                               U s e A V X 2                                */
+/******************************************************************************/
+
+bool XrdCksCalcadler32::UseAVX2()
+{
+#ifdef XRDCKS_AVX2
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2");
+#else
+   return false;
+#endif
+}
+
+/******************************************************************************/
+/*                                U p d a t e                                 */
+/******************************************************************************/
+
+void XrdCksCalcadler32::Update(const char *Buff, int BLen)
+{
+   const unsigned char *buff = (const unsigned char *)Buff;
+   int k;
+
+// Use the vector unit for long enough buffers if the cpu has AVX2
+//
+#ifdef XRDCKS_AVX2
+   if (doAVX2 && BLen >= 64)
+      Adler32AVX2(unSum1, unSum2, buff, BLen, AdlerNMax, AdlerBase);
+#endif
+
+// Process whatever is left byte by byte
+//
+   while(BLen > 0)
+        {k = (BLen < AdlerNMax ? BLen : AdlerNMax);
+         BLen -= k;
+         while(k >= 16) {DO16(buff); k -= 16;}
+         if (k != 0) do {DO1(buff);} while (--k);
+         unSum1 %= AdlerBase; unSum2 %= AdlerBase;
+        }
+}
@@ -82,6 +82,12 @@ class XrdCksCalcadler32 : public XrdCksCalc
 {
 public:
 
+// Combine() folds in the checksum of the Len bytes that immediately follow
+// the bytes seen by this object, as computed by csX. This allows a file to
+// be checksummed in pieces and the pieces merged in order.
+//
+void        Combine(const XrdCksCalcadler32 &csX, long long Len);
+
 char *Final()
             {AdlerValue = (unSum2 << 16) | unSum1;
 #ifndef Xrd_Big_Endian
@@ -94,17 +100,7 @@ void        Init() {unSum1 = AdlerStart; unSum2 = 0;}
 
 XrdCksCalc *New() {return (XrdCksCalc *)new XrdCksCalcadler32;}
 
-void        Update(const char *Buff, int BLen)
-                  {int k;
-                   unsigned char *buff = (unsigned char *)Buff;
-                   while(BLen > 0)
-                        {k = (BLen < AdlerNMax ? BLen : AdlerNMax);
-                         BLen -= k;
-                         while(k >= 16) {DO16(buff); k -= 16;}
-                         if (k != 0) do {DO1(buff);} while (--k);
-                         unSum1 %= AdlerBase; unSum2 %= AdlerBase;
-                        }
-                  }
+void        Update(const char *Buff, int BLen);
 
 const char *Type(int &csSize) {csSize = sizeof(AdlerValue); return "adler32";}
 
@@ -113,6 +109,9 @@ virtual    ~XrdCksCalcadler32() {}
 
 private:
 
+static bool               UseAVX2();
+static const bool         doAVX2;
+
 static const unsigned int AdlerBase  = 0xFFF1;
 static const unsigned int AdlerStart = 0x0001;
 static const          int AdlerNMax  = 5552;
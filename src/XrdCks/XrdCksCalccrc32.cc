@@ -141,6 +141,57 @@ unsigned int XrdCksCalccrc32::crctable[256] =
 /*                   End of CRC Lookup Table                     */
 /*****************************************************************/
 
+/* The slice-by-8 method consumes 8 bytes per step using 8 tables, where entry
+   i of table k is the crc of byte i followed by k zero bytes. The tables are
+   derived from the one above when the library is loaded; until then Update()
+   falls back to the byte-at-a-time method.
+*/
+unsigned int XrdCksCalccrc32::crcslice[8][256];
+
+bool         XrdCksCalccrc32::sliceOK = XrdCksCalccrc32::InitSlice();
+
+bool XrdCksCalccrc32::InitSlice()
+{
+   int i, j;
+
+   for (i = 0; i < 256; i++) crcslice[0][i] = crctable[i];
+   for (i = 0; i < 256; i++)
+       for (j = 1; j < 8; j++)
+           crcslice[j][i] = (crcslice[j-1][i] << 8)
+                          ^ crcslice[0][crcslice[j-1][i] >> 24];
+   return true;
+}
+
+/* Since the crc register starts at zero it is linear in the data. Appending
+   Len bytes to a message multiplies its register by x**(8*Len) modulo the
+   polynomial, after which the register of the appended bytes is added in.
+   The power is built by squaring x**8, so the cost is logarithmic in Len.
+*/
+unsigned int XrdCksCalccrc32::MulMod(unsigned int a, unsigned int b)
+{
+   unsigned int prod = 0;
+   int i;
+
+   for (i = 31; i >= 0; i--)
+       {prod = (prod & 0x80000000 ? (prod << 1) ^ CRC32_POLY : prod << 1);
+        if (b & (1U << i)) prod ^= a;
+       }
+   return prod;
+}
+
+void XrdCksCalccrc32::Combine(const XrdCksCalccrc32 &csX, long long Len)
+{
+   unsigned int xPow = 1, xSqr = 0x100;
+
+   while(Len > 0)
+        {if (Len & 1) xPow = MulMod(xPow, xSqr);
+         xSqr = MulMod(xSqr, xSqr);
+         Len >>= 1;
+        }
+   C32Result = MulMod(C32Result, xPow) ^ csX.C32Result;
+   TotLen   += csX.TotLen;
+}
+
 /* Calculate CRC-32 Checksum for NAACCR Record,
    skipping area of record containing checksum field.
 
@@ -168,11 +219,30 @@ unsigned int XrdCksCalccrc32::crctable[256] =
 */
 void XrdCksCalccrc32::Update(const char *p, int reclen)
 {
+   const unsigned char *bP = (const unsigned char *)p;
+   unsigned int crc = C32Result, w1, w2;
 
-// Process each byte
+// Process 8 bytes at a time when the slice tables are ready. The crc is not
+// reflected, so the bytes are taken most significant first.
 //
+   if (reclen <= 0) return;
    TotLen += reclen;
+   if (sliceOK)
+      {const unsigned int (*T)[256] = crcslice;
+       while(reclen >= 8)
+            {w1 = (bP[0] << 24 | bP[1] << 16 | bP[2] << 8 | bP[3]) ^ crc;
+             w2 =  bP[4] << 24 | bP[5] << 16 | bP[6] << 8 | bP[7];
+             crc = T[7][ w1 >> 24        ] ^ T[6][(w1 >> 16) & 0xff]
+                 ^ T[5][(w1 >>  8) & 0xff] ^ T[4][ w1        & 0xff]
+                 ^ T[3][ w2 >> 24        ] ^ T[2][(w2 >> 16) & 0xff]
+                 ^ T[1][(w2 >>  8) & 0xff] ^ T[0][ w2        & 0xff];
+             bP += 8; reclen -= 8;
+            }
+      }
+
+// Process each remaining byte
+//
    while(reclen-- > 0)
-        C32Result = (C32Result<<8) 
-                  ^ crctable[(unsigned char)((C32Result>>24)^*p++)];
+        crc = (crc<<8) ^ crctable[(unsigned char)((crc>>24)^*bP++)];
+   C32Result = crc;
 }
@@ -42,6 +42,12 @@ class XrdCksCalccrc32 : public XrdCksCalc
 {
 public:
 
+// Combine() folds in the checksum of the Len bytes that immediately follow
+// the bytes seen by this object, as computed by csX. This allows a file to
+// be checksummed in pieces and the pieces merged in order.
+//
+void        Combine(const XrdCksCalccrc32 &csX, long long Len);
+
 char *Final() {char buff[sizeof(long long)];
                long long tLcs = TotLen;
                int i = 0;
@@ -68,9 +74,15 @@ const char *Type(int &csSz) {csSz = sizeof(TheResult); return "crc32";}
 virtual    ~XrdCksCalccrc32() {}
 
 private:
+static       unsigned int MulMod(unsigned int a, unsigned int b);
+static       bool         InitSlice();
+
 static const unsigned int CRC32_XINIT = 0;
 static const unsigned int CRC32_XOROT = 0xffffffff;
+static const unsigned int CRC32_POLY  = 0x04c11db7;
 static       unsigned int crctable[256];
+static       unsigned int crcslice[8][256];
+static       bool         sliceOK;
              unsigned int C32Result;
              unsigned int TheResult;
              long long    TotLen;
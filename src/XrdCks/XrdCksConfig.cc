@@ -54,7 +54,7 @@
 XrdCksConfig::XrdCksConfig(const char *cFN, XrdSysError *Eroute, int &aOK,
                            XrdVersionInfo &vInfo)
                           : eDest(Eroute), cfgFN(cFN), CksLib(0), CksParm(0),
-                            CksList(0), CksLast(0), myVersion(vInfo)
+                            CksCalc(0), CksList(0), CksLast(0), myVersion(vInfo)
 {
    static XrdVERSIONINFODEF(myVer, XrdCks, XrdVNUMBER, XrdVERSION);
 
@@ -65,6 +65,28 @@ XrdCksConfig::XrdCksConfig(const char *cFN, XrdSysError *Eroute, int &aOK,
       else aOK = 0;
 }
 
+/******************************************************************************/
+/*                                  C a l c                                   */
+/******************************************************************************/
+
+/* Function: Calc
+
+   Purpose:  Record the ckscalc parameters to be passed to the manager.
+
+             <parms>   the parameters as they appear after the directive.
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdCksConfig::Calc(const char *Parms)
+{
+   if (!Parms || !*Parms)
+      {eDest->Emsg("Config", "ckscalc parameters not specified"); return 1;}
+   if (CksCalc) free(CksCalc);
+   CksCalc = strdup(Parms);
+   return 0;
+}
+
 /******************************************************************************/
 /*                             C o n f i g u r e                              */
 /******************************************************************************/
@@ -82,6 +104,7 @@ XrdCks *XrdCksConfig::Configure(const char *dfltCalc, int rdsz, XrdOss *ossP)
 // Configure the object
 //
    while(tP) {NoGo |= myCks->Config("ckslib", tP->text); tP = tP->next;}
+   if (CksCalc) NoGo |= myCks->Config("ckscalc", CksCalc);
 
 // Configure if all went well
 //
@@ -43,6 +43,8 @@ class XrdCksConfig
 {
 public:
 
+int     Calc(const char *Parms);
+
 XrdCks *Configure(const char *dfltCalc=0, int rdsz=0, XrdOss *ossP=0);
 
 int     Manager() {return CksLib != 0;}
@@ -59,6 +61,7 @@ int     ParseLib(XrdOucStream &Config);
        ~XrdCksConfig() {XrdOucTList *tP;
                         if (CksLib)  free(CksLib);
                         if (CksParm) free(CksParm);
+                        if (CksCalc) free(CksCalc);
                         while((tP = CksList)) {CksList = tP->next; delete tP;}
                        }
 
@@ -69,6 +72,7 @@ XrdSysError    *eDest;
 const char     *cfgFN;
 char           *CksLib;
 char           *CksParm;
+char           *CksCalc;
 XrdOucTList    *CksList;
 XrdOucTList    *CksLast;
 XrdVersionInfo &myVersion;
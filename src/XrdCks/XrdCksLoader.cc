@@ -38,6 +38,7 @@
 #include "XrdCks/XrdCksCalc.hh"
 #include "XrdCks/XrdCksCalcadler32.hh"
 #include "XrdCks/XrdCksCalccrc32.hh"
+#include "XrdCks/XrdCksCalccrc32C.hh"
 #include "XrdCks/XrdCksCalcmd5.hh"
 #include "XrdCks/XrdCksLoader.hh"
 
@@ -76,7 +77,8 @@ XrdCksLoader::XrdCksLoader(XrdVersionInfo &vInfo, const char *libPath)
    csTab[0].Name = strdup("adler32");
    csTab[1].Name = strdup("crc32");
    csTab[2].Name = strdup("md5");
-   csLast = 2;
+   csTab[3].Name = strdup("crc32c");
+   csLast = 3;
 
 // Record the over-ride loader path
 //
@@ -137,6 +139,8 @@ XrdCksCalc *XrdCksLoader::Load(const char *csName, const char *csParms,
                    csIP->Obj = new XrdCksCalccrc32;
            else if (!strcmp("md5",     csIP->Name))
                    csIP->Obj = new XrdCksCalcmd5;
+           else if (!strcmp("crc32c",  csIP->Name))
+                   csIP->Obj = new XrdCksCalccrc32C;
            else {if (eBuff) snprintf(eBuff, eBlen, "Logic error configuring %s "
                                                    "checksum.", csName);
                  return 0;
@@ -30,22 +30,24 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <stdio.h>
 #include <unistd.h>
-#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
   
 #include "XrdCks/XrdCksCalc.hh"
 #include "XrdCks/XrdCksCalcadler32.hh"
 #include "XrdCks/XrdCksCalccrc32.hh"
+#include "XrdCks/XrdCksCalccrc32C.hh"
 #include "XrdCks/XrdCksCalcmd5.hh"
 #include "XrdCks/XrdCksLoader.hh"
 #include "XrdCks/XrdCksManager.hh"
 #include "XrdCks/XrdCksXAttr.hh"
 #include "XrdOuc/XrdOucPinLoader.hh"
+#include "XrdOuc/XrdOuca2x.hh"
 #include "XrdOuc/XrdOucTokenizer.hh"
 #include "XrdOuc/XrdOucXAttr.hh"
 #include "XrdSys/XrdSysError.hh"
@@ -53,6 +55,239 @@
 #include "XrdSys/XrdSysPlugin.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+// The calculation limits are kept here, not in the manager, so that the class
+// layout stays the same for plugins that derive from it. Read buffers are
+// charged against calcMem; a calculation waits for its first pipe and only
+// splits a file into as many pieces as there is memory left for.
+//
+XrdSysCondVar calcCV(0);
+int           calcMax     = 0;  // Calculations allowed at once, 0 = no limit
+int           calcNum     = 0;  // Calculations running
+int           calcThreads = 0;  // Threads per split file, 0 = not yet set
+long long     calcSplit   = 268435456LL; // Smallest file that is split
+long long     calcMem     = 268435456LL; // Read buffer memory limit
+long long     calcMemUsed = 0;  // Read buffer memory reserved
+
+// Reserve memory for up to want pipes of pipeMem bytes each, waiting for the
+// first one (which is always granted when nothing else is reserved). Returns
+// the number of pipes reserved.
+//
+int MemGet(long long pipeMem, int want)
+{
+   int n = 1;
+
+   calcCV.Lock();
+   while(calcMemUsed && calcMemUsed + pipeMem > calcMem) calcCV.Wait();
+   while(n < want && calcMemUsed + (n+1)*pipeMem <= calcMem) n++;
+   calcMemUsed += n*pipeMem;
+   calcCV.UnLock();
+   return n;
+}
+
+// Return reserved memory and let waiting calculations check again
+//
+void MemPut(long long mem)
+{
+   calcCV.Lock();
+   calcMemUsed -= mem;
+   calcCV.Broadcast();
+   calcCV.UnLock();
+}
+
+// The pipe reads a range of a file into two buffers using its own thread
+// while the caller calculates the checksum over the buffer read before.
+//
+class CksPipe
+{
+public:
+
+int          Run(XrdCksCalc *csP);
+
+static void *Reader(void *pP);
+
+             CksPipe(int fd, off_t offs, off_t blen, int bsz)
+                    : Empty(2), Full(0), FD(fd), Offset(offs), Length(blen),
+                      Bsize(blen < bsz ? blen : bsz)
+                    {Buff[0] = Buff[1] = 0; Bret[0] = Bret[1] = 0;}
+            ~CksPipe() {if (Buff[0]) free(Buff[0]);
+                        if (Buff[1]) free(Buff[1]);
+                       }
+private:
+
+ssize_t         Fill(char *bP, off_t offs, size_t blen);
+
+XrdSysSemaphore Empty;
+XrdSysSemaphore Full;
+char           *Buff[2];
+ssize_t         Bret[2];
+int             FD;
+off_t           Offset;
+off_t           Length;
+size_t          Bsize;
+};
+
+/******************************************************************************/
+
+// A piece of a file whose checksum is calculated by a separate thread
+//
+struct CksPiece
+{
+XrdCksManager *Mgr;
+XrdCksCalc    *csP;
+pthread_t      tid;
+off_t          Offset;
+off_t          Length;
+int            FD;
+int            rc;
+bool           Async;
+
+               CksPiece() : Mgr(0), csP(0), tid(0), Offset(0), Length(0),
+                            FD(-1), rc(0), Async(false) {}
+              ~CksPiece() {if (csP) csP->Recycle();}
+};
+}
+
+/******************************************************************************/
+/*                       C k s P i p e : : F i l l                            */
+/******************************************************************************/
+
+ssize_t CksPipe::Fill(char *bP, off_t offs, size_t blen)
+{
+   size_t left = blen;
+   ssize_t rlen;
+
+// Read until the buffer is full, the file should not have shrunk
+//
+   while(left)
+        {if ((rlen = pread(FD, bP, left, offs)) <= 0)
+            {if (rlen < 0 && errno == EINTR) continue;
+             return (rlen ? -errno : -EIO);
+            }
+         bP += rlen; offs += rlen; left -= rlen;
+        }
+   return static_cast<ssize_t>(blen);
+}
+  
+/******************************************************************************/
+/*                     C k s P i p e : : R e a d e r                          */
+/******************************************************************************/
+
+void *CksPipe::Reader(void *pP)
+{
+   CksPipe *pipe = (CksPipe *)pP;
+   off_t offs = pipe->Offset, left = pipe->Length;
+   size_t blen;
+   int i = 0;
+
+// Fill each buffer as soon as the calculation is done with it
+//
+   while(left > 0)
+        {pipe->Empty.Wait();
+         blen = (left < (off_t)pipe->Bsize ? left : pipe->Bsize);
+         pipe->Bret[i] = pipe->Fill(pipe->Buff[i], offs, blen);
+         pipe->Full.Post();
+         if (pipe->Bret[i] < 0) break;
+         offs += blen; left -= blen; i ^= 1;
+        }
+   return (void *)0;
+}
+  
+/******************************************************************************/
+/*                        C k s P i p e : : R u n                             */
+/******************************************************************************/
+
+int CksPipe::Run(XrdCksCalc *csP)
+{
+   pthread_t tid;
+   off_t offs = Offset, left = Length;
+   ssize_t rc;
+   int i = 0;
+
+// Tell the kernel how we will read the file
+//
+   if (Length <= 0) return 0;
+#ifdef POSIX_FADV_SEQUENTIAL
+   posix_fadvise(FD, Offset, Length, POSIX_FADV_SEQUENTIAL);
+#endif
+
+// Allocate the first buffer; that is all we need for a short range
+//
+   if (!(Buff[0] = (char *)malloc(Bsize))) return -ENOMEM;
+   if (Length > (off_t)Bsize && !(Buff[1] = (char *)malloc(Bsize)))
+      return -ENOMEM;
+
+// Run the reader in its own thread. If we can't, or there is only one buffer
+// full to read, we read and calculate in turn using the first buffer.
+//
+   if (!Buff[1]
+   ||  XrdSysThread::Run(&tid, Reader, (void *)this, XRDSYSTHREAD_HOLD,
+                         "cks reader"))
+      {while(left > 0)
+            {if ((rc = Fill(Buff[0], offs, (left < (off_t)Bsize
+                                           ? left : Bsize))) < 0) return rc;
+             csP->Update(Buff[0], rc);
+             offs += rc; left -= rc;
+            }
+       return 0;
+      }
+
+// Calculate the checksum as the buffers come in
+//
+   rc = 0;
+   while(left > 0)
+        {Full.Wait();
+         if ((rc = Bret[i]) < 0) break;
+         csP->Update(Buff[i], Bret[i]);
+         left -= Bret[i];
+         Empty.Post();
+         i ^= 1; rc = 0;
+        }
+
+// Wait for the reader to finish (it stops by itself upon an error)
+//
+   XrdSysThread::Join(tid, 0);
+   return static_cast<int>(rc);
+}
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+// Combine the checksum of the Len bytes following those seen by csP, held by
+// csX, into csP. Only native checksums of the same kind can be combined. When
+// csX is nil we only report whether csP can be combined at all.
+//
+bool Combine(XrdCksCalc *csP, XrdCksCalc *csX, long long Len)
+{
+   XrdCksCalcadler32 *adP, *adX;
+   XrdCksCalccrc32   *crP, *crX;
+
+   if ((adP = dynamic_cast<XrdCksCalcadler32 *>(csP)))
+      {if (!csX) return true;
+       if (!(adX = dynamic_cast<XrdCksCalcadler32 *>(csX))) return false;
+       adP->Combine(*adX, Len);
+       return true;
+      }
+
+   if ((crP = dynamic_cast<XrdCksCalccrc32 *>(csP)))
+      {if (!csX) return true;
+       if (!(crX = dynamic_cast<XrdCksCalccrc32 *>(csX))) return false;
+       crP->Combine(*crX, Len);
+       return true;
+      }
+
+   return false;
+}
+}
+
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -61,6 +296,7 @@ XrdCksManager::XrdCksManager(XrdSysError *erP, int rdsz, XrdVersionInfo &vInfo,
                              bool autoload)
               : XrdCks(erP), myVersion(vInfo)
 {
+   long nCPU = sysconf(_SC_NPROCESSORS_ONLN);
 
 // Get a dynamic loader if so wanted
 //
@@ -72,12 +308,24 @@ XrdCksManager::XrdCksManager(XrdSysError *erP, int rdsz, XrdVersionInfo &vInfo,
    strcpy(csTab[0].Name, "adler32");
    strcpy(csTab[1].Name, "crc32");
    strcpy(csTab[2].Name, "md5");
-   csLast = 2;
+   strcpy(csTab[3].Name, "crc32c");
+   csLast = 3;
 
-// Compute the i/o size
+// Compute the i/o size, which is the size of each of the two read buffers
 //
-   if (rdsz <= 65536) segSize = 67108864;
+   if (rdsz <= 65536) segSize = 4194304;
       else segSize = ((rdsz/65536) + (rdsz%65536 != 0)) * 65536;
+
+// Set the default number of concurrent calculations and the number of threads
+// that calculate pieces of one file unless an earlier manager did so.
+//
+   calcCV.Lock();
+   if (!calcThreads)
+      {if (nCPU < 1) nCPU = 1;
+       calcMax     = (nCPU > 4 ? nCPU : 4);
+       calcThreads = (nCPU/2 > 4 ? 4 : (nCPU/2 > 1 ? nCPU/2 : 1));
+      }
+   calcCV.UnLock();
 }
 
 /******************************************************************************/
@@ -120,9 +368,29 @@ int XrdCksManager::Calc(const char *Pfn, XrdCksData &Cks, int doSet)
 //
    if (!(csP = csIP->Obj->New())) return -ENOMEM;
 
-// Use the calculator to get and possibly set the checksum
+// Wait for our turn so that a burst of checksum requests does not take over
+// the disks and the cpus from everyone else.
+//
+   calcCV.Lock();
+   while(calcMax && calcNum >= calcMax) calcCV.Wait();
+   calcNum++;
+   calcCV.UnLock();
+
+// Use the calculator to get the checksum
+//
+   rc = Calc(Pfn, MTime, csP);
+
+// Let the next calculation in
+//
+   calcCV.Lock();
+   calcNum--;
+   calcCV.Broadcast();
+   calcCV.UnLock();
+
+// Set the checksum if so wanted
 //
-   if (!(rc = Calc(Pfn, MTime, csP)))
+   if (rc) csP->Recycle();
+      else
       {memcpy(Cks.Value, csP->Final(), csIP->Len);
        Cks.fmTime = static_cast<long long>(MTime);
        Cks.csTime = static_cast<int>(time(0) - MTime);
@@ -151,10 +419,10 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
             ~ioFD() {if (FD >= 0) close(FD);}
         } In;
    struct stat Stat;
-   char *inBuff;
-   off_t  Offset=0, fileSize;
-   size_t ioSize, calcSize;
-   int rc;
+   CksPiece *Piece;
+   off_t  fileSize, pieceSize;
+   long long pipeMem;
+   int i, nPiece, nThreads, rc;
 
 // Open the input file
 //
@@ -164,28 +432,89 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
 //
    if (fstat(In.FD, &Stat)) return -errno;
    if (!(Stat.st_mode & S_IFREG)) return -EPERM;
-   calcSize = fileSize = Stat.st_size;
+   fileSize = Stat.st_size;
    MTime = Stat.st_mtime;
 
-// We now compute checksum 64MB at a time using mmap I/O
-//
-   ioSize = (fileSize < (off_t)segSize ? fileSize : segSize); rc = 0;
-   while(calcSize)
-        {if ((inBuff = (char *)mmap(0, ioSize, PROT_READ, 
-                       MAP_NORESERVE|MAP_PRIVATE, In.FD, Offset)) == MAP_FAILED)
-            {rc = errno; eDest->Emsg("Cks", rc, "memory map", Pfn); break;}
-         madvise(inBuff, ioSize, MADV_SEQUENTIAL);
-         csP->Update(inBuff, ioSize);
-         calcSize -= ioSize; Offset += ioSize;
-         if (munmap(inBuff, ioSize) < 0)
-            {rc = errno; eDest->Emsg("Cks",rc,"unmap memory for",Pfn); break;}
-         if (calcSize < (size_t)segSize) ioSize = calcSize;
-        }
+// Small files and checksums whose pieces can't be combined are calculated
+// in one piece while the next buffer is being read.
+//
+   pipeMem  = 2LL * (fileSize < segSize ? fileSize : segSize);
+   nThreads = (fileSize < calcSplit || !Combine(csP, 0, 0) ? 1 : calcThreads);
+   nThreads = MemGet(pipeMem, nThreads);
+   if (nThreads < 2)
+      {if ((rc = CalcPart(In.FD, 0, fileSize, csP)))
+          eDest->Emsg("Cks", -rc, "read", Pfn);
+       MemPut(pipeMem * nThreads);
+       return rc;
+      }
 
-// Return if we failed
+// Split the file into pieces of whole segments, one per thread. The first
+// piece is ours and is calculated into the caller's object.
 //
-   if (calcSize) return (rc ? -rc : -EIO);
-   return 0;
+   pieceSize = (fileSize + nThreads - 1) / nThreads;
+   pieceSize = ((pieceSize + segSize - 1) / segSize) * segSize;
+   nPiece    = static_cast<int>((fileSize + pieceSize - 1) / pieceSize);
+   Piece     = new CksPiece[nPiece];
+   for (i = 0; i < nPiece; i++)
+       {Piece[i].Mgr    = this;
+        Piece[i].FD     = In.FD;
+        Piece[i].Offset = pieceSize * i;
+        Piece[i].Length = (i == nPiece-1 ? fileSize - Piece[i].Offset
+                                         : pieceSize);
+       }
+
+// Start a thread for every other piece. A piece whose thread can't be
+// started is calculated here once we are done with our own.
+//
+   for (i = 1; i < nPiece; i++)
+       {if (!(Piece[i].csP = csP->New())) {Piece[i].rc = -ENOMEM; continue;}
+        Piece[i].Async = !XrdSysThread::Run(&Piece[i].tid, CalcPiece,
+                                            (void *)&Piece[i],
+                                            XRDSYSTHREAD_HOLD, "cks piece");
+       }
+   rc = CalcPart(In.FD, 0, Piece[0].Length, csP);
+   for (i = 1; i < nPiece; i++)
+       if (!Piece[i].Async && Piece[i].csP) CalcPiece((void *)&Piece[i]);
+
+// Wait for all the pieces and combine them in file order
+//
+   for (i = 1; i < nPiece; i++)
+       {if (Piece[i].Async) XrdSysThread::Join(Piece[i].tid, 0);
+        if (!rc && !(rc = Piece[i].rc)
+        &&  !Combine(csP, Piece[i].csP, Piece[i].Length)) rc = -ENOTSUP;
+       }
+   delete [] Piece;
+   MemPut(pipeMem * nThreads);
+
+// All done
+//
+   if (rc) eDest->Emsg("Cks", -rc, "read", Pfn);
+   return rc;
+}
+
+/******************************************************************************/
+/*                              C a l c P a r t                               */
+/******************************************************************************/
+  
+int XrdCksManager::CalcPart(int fd, off_t Offset, off_t Length,
+                            XrdCksCalc *csP)
+{
+   CksPipe Pipe(fd, Offset, Length, segSize);
+
+   return Pipe.Run(csP);
+}
+
+/******************************************************************************/
+/*                             C a l c P i e c e                              */
+/******************************************************************************/
+
+void *XrdCksManager::CalcPiece(void *pP)
+{
+   CksPiece *Piece = (CksPiece *)pP;
+
+   Piece->rc = Piece->Mgr->CalcPart(Piece->FD, Piece->Offset, Piece->Length,
+                                    Piece->csP);
+   return (void *)0;
 }
 
 /******************************************************************************/
@@ -198,6 +527,8 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
              <path>    the path of the checksum library to be used.
              <parms>   optional parms to be passed
 
+             The ckscalc directive is handed off to ConfigCalc().
+
   Output: 0 upon success or !0 upon failure.
 */
 int XrdCksManager::Config(const char *Token, char *Line)
@@ -206,6 +537,10 @@ int XrdCksManager::Config(const char *Token, char *Line)
    char *val, *path = 0, name[XrdCksData::NameSize], *parms;
    int i;
 
+// Check if this is the calculation directive
+//
+   if (Token && !strcmp(Token, "ckscalc")) return ConfigCalc(Line);
+
 // Get the the checksum name
 //
    Cfg.GetLine();
@@ -249,6 +584,82 @@ int XrdCksManager::Config(const char *Token, char *Line)
    return 0;
 }
 
+/******************************************************************************/
+/*                            C o n f i g C a l c                             */
+/******************************************************************************/
+/*
+   Purpose:  To parse the directive: ckscalc [limit <n>] [threads <n>]
+                                             [split <size>] [memory <size>]
+
+             limit     the maximum number of checksums calculated at the same
+                       time; others wait their turn. Zero means no limit.
+             threads   the number of threads that calculate pieces of one file
+                       when the checksum can combine them (adler32 and crc32).
+                       One turns off splitting.
+             split     the smallest file that is split into pieces.
+             memory    the read buffer memory all calculations may use. Each
+                       piece takes two cksrdsz buffers; files are split into
+                       fewer pieces, and calculations wait, to stay within it.
+
+  Output: 0 upon success or !0 upon failure.
+*/
+int XrdCksManager::ConfigCalc(char *Line)
+{
+   XrdOucTokenizer Cfg(Line);
+   char *val;
+   long long split;
+   int num;
+
+// Process each option
+//
+   Cfg.GetLine();
+   if (!(val = Cfg.GetToken()) || !val[0])
+      {eDest->Emsg("Config", "ckscalc option not specified"); return 1;}
+
+   do {     if (!strcmp(val, "limit"))
+               {if (!(val = Cfg.GetToken()) || !val[0])
+                   {eDest->Emsg("Config","ckscalc limit not specified");
+                    return 1;
+                   }
+                if (XrdOuca2x::a2i(*eDest,"ckscalc limit",val,&num,0,4096))
+                   return 1;
+                calcMax = num;
+               }
+       else if (!strcmp(val, "threads"))
+               {if (!(val = Cfg.GetToken()) || !val[0])
+                   {eDest->Emsg("Config","ckscalc threads not specified");
+                    return 1;
+                   }
+                if (XrdOuca2x::a2i(*eDest,"ckscalc threads",val,&num,1,64))
+                   return 1;
+                calcThreads = num;
+               }
+       else if (!strcmp(val, "split"))
+               {if (!(val = Cfg.GetToken()) || !val[0])
+                   {eDest->Emsg("Config","ckscalc split not specified");
+                    return 1;
+                   }
+                if (XrdOuca2x::a2sz(*eDest,"ckscalc split",val,&split,1))
+                   return 1;
+                calcSplit = split;
+               }
+       else if (!strcmp(val, "memory"))
+               {if (!(val = Cfg.GetToken()) || !val[0])
+                   {eDest->Emsg("Config","ckscalc memory not specified");
+                    return 1;
+                   }
+                if (XrdOuca2x::a2sz(*eDest,"ckscalc memory",val,&split,1))
+                   return 1;
+                calcMem = split;
+               }
+       else {eDest->Emsg("Config", "invalid ckscalc option -", val); return 1;}
+      } while((val = Cfg.GetToken()) && val[0]);
+
+// All done
+//
+   return 0;
+}
+
 /******************************************************************************/
 /*                                  I n i t                                   */
 /******************************************************************************/
@@ -286,6 +697,8 @@ int XrdCksManager::Init(const char *ConfigFN, const char *DfltCalc)
                          csTab[i].Obj = new XrdCksCalccrc32;
                  else if (!strcmp("md5",     csTab[i].Name))
                          csTab[i].Obj = new XrdCksCalcmd5;
+                 else if (!strcmp("crc32c",  csTab[i].Name))
+                         csTab[i].Obj = new XrdCksCalccrc32C;
                  else {eDest->Emsg("Config", "Invalid native checksum -",
                                              csTab[i].Name);
                        return 0;
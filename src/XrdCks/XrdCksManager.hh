@@ -79,7 +79,9 @@ protected:
 /* Calc()     returns 0 if the checksum was successfully calculated using the
               supplied CksObj and places the file's modification time in MTime.
               Otherwise, it returns -errno. The default implementation uses
-              open(), fstat(), mmap(), and unmap() to calculate the results.
+              open(), fstat(), and pread() into two buffers so that reading
+              overlaps the calculation. Large files are split into pieces
+              calculated in parallel when the checksum can combine them.
 */
 virtual int         Calc(const char *Pfn, time_t &MTime, XrdCksCalc *CksObj);
 
@@ -103,9 +105,13 @@ struct csInfo
                                 {memset(Name, 0, sizeof(Name));}
       };
 
+int     CalcPart(int fd, off_t Offset, off_t Length, XrdCksCalc *csP);
 int     Config(const char *cFN, csInfo &Info);
+int     ConfigCalc(char *Line);
 csInfo *Find(const char *Name);
 
+static void *CalcPiece(void *pP);
+
 static const int csMax = 8;
 csInfo           csTab[csMax];
 int              csLast;
@@ -27,6 +27,7 @@
 #include "XrdCks/XrdCksCalc.hh"
 #include "XrdCks/XrdCksCalcmd5.hh"
 #include "XrdCks/XrdCksCalccrc32.hh"
+#include "XrdCks/XrdCksCalccrc32C.hh"
 #include "XrdCks/XrdCksCalcadler32.hh"
 #include "XrdVersion.hh"
 
@@ -48,6 +49,7 @@ namespace XrdCl
     pCalculators["md5"]     = new XrdCksCalcmd5();
     pCalculators["crc32"]   = new XrdCksCalccrc32;
     pCalculators["adler32"] = new XrdCksCalcadler32;
+    pCalculators["crc32c"]  = new XrdCksCalccrc32C;
   }
 
   //----------------------------------------------------------------------------
@@ -66,6 +66,9 @@ namespace XrdCl
   const int DefaultParallelEvtLoop      = 1;
   const int DefaultMetalinkProcessing   = 1;
   const int DefaultLocalMetalinkFile    = 1;
+  const int DefaultReadSplitSize        = 4194304;
+  const int DefaultReadCoalesceWindow   = 0;
+  const int DefaultReadCoalesceSize     = 1048576;
 
   const char * const DefaultPollerPreference   = "built-in";
   const char * const DefaultNetworkStack       = "IPAuto";
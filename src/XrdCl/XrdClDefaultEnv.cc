@@ -285,6 +285,9 @@ namespace XrdCl
     REGISTER_VAR_INT( varsInt, "ParallelEvtLoop",      DefaultParallelEvtLoop      );
     REGISTER_VAR_INT( varsInt, "MetalinkProcessing",   DefaultMetalinkProcessing   );
     REGISTER_VAR_INT( varsInt, "LocalMetalinkFile",    DefaultLocalMetalinkFile    );
+    REGISTER_VAR_INT( varsInt, "ReadSplitSize",        DefaultReadSplitSize        );
+    REGISTER_VAR_INT( varsInt, "ReadCoalesceWindow",   DefaultReadCoalesceWindow   );
+    REGISTER_VAR_INT( varsInt, "ReadCoalesceSize",     DefaultReadCoalesceSize     );
 
     REGISTER_VAR_STR( varsStr, "PollerPreference",     DefaultPollerPreference     );
     REGISTER_VAR_STR( varsStr, "ClientMonitor",        DefaultClientMonitor        );
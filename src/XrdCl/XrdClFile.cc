@@ -204,7 +204,17 @@ namespace XrdCl
                            uint16_t  timeout )
   {
     SyncResponseHandler handler;
-    Status st = Read( offset, size, buffer, &handler, timeout );
+    Status st;
+
+    //--------------------------------------------------------------------------
+    // The caller is waiting for the data, so holding the read back to be
+    // coalesced would only add the coalescing window to its latency
+    //--------------------------------------------------------------------------
+    if( pPlugIn )
+      st = pPlugIn->Read( offset, size, buffer, &handler, timeout );
+    else
+      st = pStateHandler->Read( offset, size, buffer, &handler, timeout,
+                                false );
     if( !st.IsOK() )
       return st;
 
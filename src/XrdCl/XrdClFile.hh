@@ -407,6 +407,8 @@ namespace XrdCl
       //! Read-only properties:
       //! DataServer [string] - the data server the file is accessed at
       //! LastURL    [string] - final file URL with all the cgi information
+      //! ReadMergeRatio [string] - average number of reads merged into one
+      //!                           request by the read coalescing
       //------------------------------------------------------------------------
       bool GetProperty( const std::string &name, std::string &value ) const;
 
@@ -41,6 +41,10 @@
 
 #include <sstream>
 #include <memory>
+#include <algorithm>
+#include <map>
+#include <cstring>
+#include <unistd.h>
 #include <sys/time.h>
 
 namespace
@@ -223,6 +227,565 @@ namespace
       XrdCl::Message           *pMessage;
       XrdCl::MessageSendParams  pSendParams;
   };
+
+  //----------------------------------------------------------------------------
+  // Collects the responses to the pieces of a read or a vector read that
+  // has been split across substreams and calls the user handler when all
+  // of them have arrived
+  //----------------------------------------------------------------------------
+  class SplitReadHandler
+  {
+    public:
+      //------------------------------------------------------------------------
+      // Handler of one piece
+      //------------------------------------------------------------------------
+      class PieceHandler: public XrdCl::ResponseHandler
+      {
+        public:
+          PieceHandler( SplitReadHandler *parent, size_t piece ):
+            pParent( parent ), pPiece( piece ) {}
+
+          virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
+                                                XrdCl::AnyObject    *response,
+                                                XrdCl::HostList     *hostList )
+          {
+            pParent->PieceDone( pPiece, status, response, hostList );
+            delete this;
+          }
+
+        private:
+          SplitReadHandler *pParent;
+          size_t            pPiece;
+      };
+
+      //------------------------------------------------------------------------
+      // Constructor, the sender holds one extra reference until all the
+      // pieces have been sent
+      //------------------------------------------------------------------------
+      SplitReadHandler( XrdCl::ResponseHandler *userHandler,
+                        bool                    vectorRead,
+                        uint64_t                offset,
+                        void                   *buffer,
+                        size_t                  pieces ):
+        pUserHandler( userHandler ),
+        pVectorRead( vectorRead ),
+        pOffset( offset ),
+        pBuffer( buffer ),
+        pRequested( pieces, 0 ),
+        pRead( pieces, 0 ),
+        pChunks( pieces ),
+        pHostList( 0 ),
+        pPending( pieces + 1 )
+      {
+      }
+
+      //------------------------------------------------------------------------
+      // Get the handler of a piece requesting the given number of bytes
+      //------------------------------------------------------------------------
+      XrdCl::ResponseHandler *GetPieceHandler( size_t piece, uint32_t size )
+      {
+        pRequested[piece] = size;
+        return new PieceHandler( this, piece );
+      }
+
+      //------------------------------------------------------------------------
+      // Pieces from the given one onwards could not be sent
+      //------------------------------------------------------------------------
+      void SendFailed( size_t piece, const XrdCl::XRootDStatus &status )
+      {
+        XrdSysMutexHelper scopedLock( pMutex );
+        if( pStatus.IsOK() )
+          pStatus = status;
+        pPending -= pRequested.size() - piece;
+      }
+
+      //------------------------------------------------------------------------
+      // Drop the sender reference
+      //------------------------------------------------------------------------
+      void SendDone()
+      {
+        Release();
+      }
+
+      //------------------------------------------------------------------------
+      // Record the response to a piece
+      //------------------------------------------------------------------------
+      void PieceDone( size_t               piece,
+                      XrdCl::XRootDStatus *status,
+                      XrdCl::AnyObject    *response,
+                      XrdCl::HostList     *hostList )
+      {
+        using namespace XrdCl;
+        {
+          XrdSysMutexHelper scopedLock( pMutex );
+          if( !status->IsOK() )
+          {
+            if( pStatus.IsOK() )
+              pStatus = *status;
+          }
+          else if( pVectorRead )
+          {
+            VectorReadInfo *info = 0;
+            response->Get( info );
+            pRead[piece] = info->GetSize();
+            pChunks[piece].swap( info->GetChunks() );
+          }
+          else
+          {
+            ChunkInfo *info = 0;
+            response->Get( info );
+            pRead[piece] = info->length;
+          }
+
+          if( !pHostList )
+          {
+            pHostList = hostList;
+            hostList  = 0;
+          }
+        }
+        delete status;
+        delete response;
+        delete hostList;
+        Release();
+      }
+
+    private:
+      //------------------------------------------------------------------------
+      // Drop a reference and respond to the user when it was the last one
+      //------------------------------------------------------------------------
+      void Release()
+      {
+        {
+          XrdSysMutexHelper scopedLock( pMutex );
+          if( --pPending )
+            return;
+        }
+        Respond();
+        delete this;
+      }
+
+      //------------------------------------------------------------------------
+      // Put the pieces together
+      //------------------------------------------------------------------------
+      void Respond()
+      {
+        using namespace XrdCl;
+        if( !pStatus.IsOK() )
+        {
+          pUserHandler->HandleResponseWithHosts( new XRootDStatus( pStatus ),
+                                                 0, pHostList );
+          return;
+        }
+
+        AnyObject *response = new AnyObject();
+        if( pVectorRead )
+        {
+          VectorReadInfo *info = new VectorReadInfo();
+          uint32_t        size = 0;
+          for( size_t i = 0; i < pChunks.size(); ++i )
+          {
+            info->GetChunks().insert( info->GetChunks().end(),
+                                      pChunks[i].begin(), pChunks[i].end() );
+            size += pRead[i];
+          }
+          info->SetSize( size );
+          response->Set( info );
+        }
+        else
+        {
+          //--------------------------------------------------------------------
+          // The data is contiguous up to the first short piece
+          //--------------------------------------------------------------------
+          uint32_t size = 0;
+          for( size_t i = 0; i < pRead.size(); ++i )
+          {
+            size += pRead[i];
+            if( pRead[i] < pRequested[i] )
+              break;
+          }
+          response->Set( new ChunkInfo( pOffset, size, pBuffer ) );
+        }
+        pUserHandler->HandleResponseWithHosts( new XRootDStatus(), response,
+                                               pHostList );
+      }
+
+      XrdCl::ResponseHandler          *pUserHandler;
+      bool                             pVectorRead;
+      uint64_t                         pOffset;
+      void                            *pBuffer;
+      std::vector<uint32_t>            pRequested;
+      std::vector<uint32_t>            pRead;
+      std::vector<XrdCl::ChunkList>    pChunks;
+      XrdCl::XRootDStatus              pStatus;
+      XrdCl::HostList                 *pHostList;
+      size_t                           pPending;
+      XrdSysMutex                      pMutex;
+  };
+
+  //----------------------------------------------------------------------------
+  // Current time in milliseconds
+  //----------------------------------------------------------------------------
+  uint64_t NowMS()
+  {
+    timeval now;
+    gettimeofday( &now, 0 );
+    return (uint64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+  }
+
+  //----------------------------------------------------------------------------
+  // Flushes the coalesced reads of the files whose window has expired
+  //----------------------------------------------------------------------------
+  class ReadCoalesceTimer
+  {
+    public:
+      //------------------------------------------------------------------------
+      // Constructor
+      //------------------------------------------------------------------------
+      ReadCoalesceTimer(): pCond( 0 ), pRunning( 0 ), pPid( 0 ) {}
+
+      //------------------------------------------------------------------------
+      // Get the timer, start it if needed
+      //------------------------------------------------------------------------
+      static ReadCoalesceTimer *Instance();
+
+      //------------------------------------------------------------------------
+      // Remove the file from the timer, wait if it is being flushed, the
+      // file must not be locked
+      //------------------------------------------------------------------------
+      static void Cancel( XrdCl::FileStateHandler *file );
+
+      //------------------------------------------------------------------------
+      // Flush the file at the given time, the file may be locked
+      //------------------------------------------------------------------------
+      void Schedule( XrdCl::FileStateHandler *file, uint64_t deadline )
+      {
+        XrdSysCondVarHelper scopedLock( pCond );
+        pFiles[file] = deadline;
+        pCond.Signal();
+      }
+
+      //------------------------------------------------------------------------
+      // Run the timer
+      //------------------------------------------------------------------------
+      void Run()
+      {
+        pCond.Lock();
+        while( 1 )
+        {
+          uint64_t                 now  = NowMS();
+          uint64_t                 next = 0;
+          XrdCl::FileStateHandler *due  = 0;
+          FileMap::iterator        it;
+          for( it = pFiles.begin(); it != pFiles.end(); ++it )
+          {
+            if( it->second <= now )
+            {
+              due = it->first;
+              pFiles.erase( it );
+              break;
+            }
+            if( !next || it->second < next )
+              next = it->second;
+          }
+
+          if( due )
+          {
+            pRunning = due;
+            pCond.UnLock();
+            due->FlushCoalescedReads();
+            pCond.Lock();
+            pRunning = 0;
+            pCond.Broadcast();
+          }
+          else if( next )
+            pCond.WaitMS( next - now );
+          else
+            pCond.Wait();
+        }
+      }
+
+    private:
+      typedef std::map<XrdCl::FileStateHandler*, uint64_t> FileMap;
+
+      bool Start();
+
+      XrdSysCondVar            pCond;
+      FileMap                  pFiles;
+      XrdCl::FileStateHandler *pRunning;
+      pid_t                    pPid;
+
+      static XrdSysMutex        sMutex;
+      static ReadCoalesceTimer *sTimer;
+  };
+
+  XrdSysMutex        ReadCoalesceTimer::sMutex;
+  ReadCoalesceTimer *ReadCoalesceTimer::sTimer = 0;
+}
+
+extern "C"
+{
+  static void *RunReadCoalesceTimer( void *arg )
+  {
+    ((ReadCoalesceTimer*)arg)->Run();
+    return 0;
+  }
+}
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Get the timer, (re)start the thread if this is a new process
+  //----------------------------------------------------------------------------
+  ReadCoalesceTimer *ReadCoalesceTimer::Instance()
+  {
+    XrdSysMutexHelper scopedLock( sMutex );
+    if( !sTimer )
+      sTimer = new ReadCoalesceTimer();
+    if( sTimer->pPid != getpid() && sTimer->Start() )
+      sTimer->pPid = getpid();
+    return sTimer;
+  }
+
+  //----------------------------------------------------------------------------
+  // Start the timer thread
+  //----------------------------------------------------------------------------
+  bool ReadCoalesceTimer::Start()
+  {
+    pthread_t thread;
+    pRunning = 0;
+    int ret = ::pthread_create( &thread, 0, ::RunReadCoalesceTimer, this );
+    if( ret != 0 )
+    {
+      XrdCl::Log *log = XrdCl::DefaultEnv::GetLog();
+      log->Error( XrdCl::FileMsg, "Unable to spawn the read coalescing "
+                  "thread: %s", strerror( ret ) );
+      return false;
+    }
+    pthread_detach( thread );
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Remove a file from the timer
+  //----------------------------------------------------------------------------
+  void ReadCoalesceTimer::Cancel( XrdCl::FileStateHandler *file )
+  {
+    ReadCoalesceTimer *timer;
+    {
+      XrdSysMutexHelper scopedLock( sMutex );
+      timer = sTimer;
+    }
+    if( !timer )
+      return;
+
+    XrdSysCondVarHelper scopedLock( timer->pCond );
+    timer->pFiles.erase( file );
+    while( timer->pRunning == file )
+      timer->pCond.Wait();
+  }
+
+  //----------------------------------------------------------------------------
+  // Sends the reads of a failed coalesced vector read one by one
+  //----------------------------------------------------------------------------
+  class ResendJob: public XrdCl::Job
+  {
+    public:
+      ResendJob( XrdCl::FileStateHandler                    *stateHandler,
+                 const XrdCl::FileStateHandler::CoalescedReadList &reads,
+                 uint16_t                                    timeout ):
+        pStateHandler( stateHandler ), pReads( reads ), pTimeout( timeout ) {}
+
+      virtual void Run( void* )
+      {
+        pStateHandler->ResendCoalescedReads( pReads, pTimeout );
+        delete this;
+      }
+
+    private:
+      XrdCl::FileStateHandler                    *pStateHandler;
+      XrdCl::FileStateHandler::CoalescedReadList  pReads;
+      uint16_t                                    pTimeout;
+  };
+
+  //----------------------------------------------------------------------------
+  // Splits the response to a coalesced read or vector read among the reads
+  // that were merged into it
+  //----------------------------------------------------------------------------
+  class CoalescedReadHandler: public XrdCl::ResponseHandler
+  {
+    public:
+      //------------------------------------------------------------------------
+      // A contiguous range covering one or more of the reads
+      //------------------------------------------------------------------------
+      struct Range
+      {
+        Range( uint64_t o, uint32_t l ): offset( o ), length( l ), buffer( 0 ),
+          own( false ) {}
+        uint64_t                                  offset;
+        uint32_t                                  length;
+        char                                     *buffer;
+        bool                                      own;
+        XrdCl::FileStateHandler::CoalescedReadList reads;
+      };
+
+      //------------------------------------------------------------------------
+      // Constructor
+      //------------------------------------------------------------------------
+      CoalescedReadHandler( XrdCl::FileStateHandler *stateHandler,
+                            bool                     vectorRead,
+                            uint16_t                 timeout ):
+        pStateHandler( stateHandler ),
+        pVectorRead( vectorRead ),
+        pTimeout( timeout )
+      {
+      }
+
+      //------------------------------------------------------------------------
+      // Destructor
+      //------------------------------------------------------------------------
+      virtual ~CoalescedReadHandler()
+      {
+        for( size_t i = 0; i < pRanges.size(); ++i )
+          if( pRanges[i].own )
+            delete [] pRanges[i].buffer;
+      }
+
+      //------------------------------------------------------------------------
+      // Add a range, a single read is read into its own buffer, otherwise
+      // the range is read into a temporary buffer
+      //------------------------------------------------------------------------
+      void AddRange( const Range &range )
+      {
+        pRanges.push_back( range );
+        Range &r = pRanges.back();
+        if( r.reads.size() == 1 )
+          r.buffer = (char*)r.reads[0].buffer;
+        else
+        {
+          r.buffer = new char[r.length];
+          r.own    = true;
+        }
+      }
+
+      //------------------------------------------------------------------------
+      // Get the ranges
+      //------------------------------------------------------------------------
+      const std::vector<Range> &GetRanges() const
+      {
+        return pRanges;
+      }
+
+      //------------------------------------------------------------------------
+      // Fail all the reads
+      //------------------------------------------------------------------------
+      void Fail( const XrdCl::XRootDStatus &status,
+                 XrdCl::HostList           *hostList,
+                 bool                       async )
+      {
+        using namespace XrdCl;
+        JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+        for( size_t i = 0; i < pRanges.size(); ++i )
+          for( size_t j = 0; j < pRanges[i].reads.size(); ++j )
+          {
+            ResponseHandler *handler = pRanges[i].reads[j].handler;
+            XRootDStatus    *st      = new XRootDStatus( status );
+            HostList        *hosts   = hostList ? new HostList( *hostList ) : 0;
+            if( async )
+              jobMan->QueueJob( new ResponseJob( handler, st, 0, hosts ) );
+            else
+              handler->HandleResponseWithHosts( st, 0, hosts );
+          }
+      }
+
+      //------------------------------------------------------------------------
+      // Handle the response
+      //------------------------------------------------------------------------
+      virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
+                                            XrdCl::AnyObject    *response,
+                                            XrdCl::HostList     *hostList )
+      {
+        using namespace XrdCl;
+
+        //----------------------------------------------------------------------
+        // A vector read fails as a whole if any range is past the end of
+        // the file, so give the reads another chance one by one. Errors
+        // may be reported with the file locked, so resend from a job.
+        //----------------------------------------------------------------------
+        if( !status->IsOK() )
+        {
+          if( pVectorRead )
+          {
+            FileStateHandler::CoalescedReadList reads;
+            for( size_t i = 0; i < pRanges.size(); ++i )
+              reads.insert( reads.end(), pRanges[i].reads.begin(),
+                            pRanges[i].reads.end() );
+            JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+            jobMan->QueueJob( new ResendJob( pStateHandler, reads, pTimeout ) );
+          }
+          else
+            Fail( *status, hostList, false );
+        }
+        else if( pVectorRead )
+        {
+          pStateHandler->CoalescedVReadDone();
+          VectorReadInfo *info = 0;
+          response->Get( info );
+          ChunkList &chunks = info->GetChunks();
+          for( size_t i = 0; i < pRanges.size(); ++i )
+            Respond( pRanges[i], i < chunks.size() ? chunks[i].length : 0,
+                     hostList );
+        }
+        else
+        {
+          ChunkInfo *info = 0;
+          response->Get( info );
+          Respond( pRanges[0], info->length, hostList );
+        }
+
+        delete status;
+        delete response;
+        delete hostList;
+        delete this;
+      }
+
+    private:
+      //------------------------------------------------------------------------
+      // Hand out the data of a range to its reads, the range may be short
+      // at the end of the file
+      //------------------------------------------------------------------------
+      void Respond( const Range &range, uint32_t length,
+                    XrdCl::HostList *hostList )
+      {
+        using namespace XrdCl;
+        for( size_t i = 0; i < range.reads.size(); ++i )
+        {
+          const FileStateHandler::CoalescedRead &rd = range.reads[i];
+          uint32_t skip = rd.offset - range.offset;
+          uint32_t size = length > skip ? std::min( rd.size, length - skip ) : 0;
+          if( range.own && size )
+            memcpy( rd.buffer, range.buffer + skip, size );
+
+          AnyObject *obj = new AnyObject();
+          obj->Set( new ChunkInfo( rd.offset, size, rd.buffer ) );
+          rd.handler->HandleResponseWithHosts( new XRootDStatus(), obj,
+                                 hostList ? new HostList( *hostList ) : 0 );
+        }
+      }
+
+      XrdCl::FileStateHandler *pStateHandler;
+      bool                     pVectorRead;
+      uint16_t                 pTimeout;
+      std::vector<Range>       pRanges;
+  };
+
+  //----------------------------------------------------------------------------
+  // Orders coalesced reads by offset
+  //----------------------------------------------------------------------------
+  bool CoalescedReadLess( const XrdCl::FileStateHandler::CoalescedRead &a,
+                          const XrdCl::FileStateHandler::CoalescedRead &b )
+  {
+    return a.offset < b.offset;
+  }
 }
 
 namespace XrdCl
@@ -332,6 +895,16 @@ namespace XrdCl
     pDoRecoverWrite( true ),
     pFollowRedirects( true ),
     pUseVirtRedirector( true ),
+    pReadSplitPieces( 1 ),
+    pReadSplitSize( DefaultReadSplitSize ),
+    pCoalesceWindow( 0 ),
+    pCoalesceSize( DefaultReadCoalesceSize ),
+    pCoalescedBytes( 0 ),
+    pCoalescedTimeout( 0 ),
+    pCoalesceDeadline( 0 ),
+    pCoalescedReads( 0 ),
+    pCoalescedRequests( 0 ),
+    pCoalescedVReads( 0 ),
     pReOpenHandler( 0 )
   {
     pFileHandle = new uint8_t[4];
@@ -361,6 +934,16 @@ namespace XrdCl
     pDoRecoverWrite( true ),
     pFollowRedirects( true ),
     pUseVirtRedirector( useVirtRedirector ),
+    pReadSplitPieces( 1 ),
+    pReadSplitSize( DefaultReadSplitSize ),
+    pCoalesceWindow( 0 ),
+    pCoalesceSize( DefaultReadCoalesceSize ),
+    pCoalescedBytes( 0 ),
+    pCoalescedTimeout( 0 ),
+    pCoalesceDeadline( 0 ),
+    pCoalescedReads( 0 ),
+    pCoalescedRequests( 0 ),
+    pCoalescedVReads( 0 ),
     pReOpenHandler( 0 )
   {
     pFileHandle = new uint8_t[4];
@@ -377,6 +960,18 @@ namespace XrdCl
     if( pReOpenHandler )
       pReOpenHandler->Destroy();
 
+    //--------------------------------------------------------------------------
+    // Nobody is going to send the reads that are still waiting for the
+    // coalescing window
+    //--------------------------------------------------------------------------
+    if( pCoalesceWindow > 0 )
+    {
+      ReadCoalesceTimer::Cancel( this );
+      for( size_t i = 0; i < pCoalesced.size(); ++i )
+        pCoalesced[i].handler->HandleResponseWithHosts(
+                             new XRootDStatus( stError, errInvalidOp ), 0, 0 );
+    }
+
     if( DefaultEnv::GetFileTimer() )
       DefaultEnv::GetFileTimer()->UnRegisterFileObject( this );
 
@@ -473,6 +1068,30 @@ namespace XrdCl
                   this, pFileUrl->GetURL().c_str() );
     }
 
+    //--------------------------------------------------------------------------
+    // Check whether large reads should be split across the substreams
+    //--------------------------------------------------------------------------
+    Env *env = DefaultEnv::GetEnv();
+    int  subStreams = DefaultSubStreamsPerChannel;
+    int  splitSize  = DefaultReadSplitSize;
+    env->GetInt( "SubStreamsPerChannel", subStreams );
+    env->GetInt( "ReadSplitSize",        splitSize );
+    pReadSplitPieces = subStreams > 1 && splitSize > 0 ? subStreams : 1;
+    pReadSplitSize   = splitSize;
+
+    //--------------------------------------------------------------------------
+    // Check whether small reads should be coalesced
+    //--------------------------------------------------------------------------
+    int coalesceWindow = DefaultReadCoalesceWindow;
+    int coalesceSize   = DefaultReadCoalesceSize;
+    env->GetInt( "ReadCoalesceWindow", coalesceWindow );
+    env->GetInt( "ReadCoalesceSize",   coalesceSize );
+    if( coalesceSize > 0 && coalesceWindow > 0 )
+    {
+      pCoalesceWindow = coalesceWindow;
+      pCoalesceSize   = coalesceSize;
+    }
+
     //--------------------------------------------------------------------------
     // Open the file
     //--------------------------------------------------------------------------
@@ -546,13 +1165,25 @@ namespace XrdCl
     if( pFileState == CloseInProgress )
       return XRootDStatus( stError, errInProgress );
 
+    //--------------------------------------------------------------------------
+    // Reads held back for coalescing are in flight as far as the user is
+    // concerned, they go out when their window expires as usual. So are
+    // the reads of a coalesced vector read until they are answered or, if
+    // the vector read failed, resent one by one.
+    //--------------------------------------------------------------------------
     if( pFileState == OpenInProgress || pFileState == Closed ||
-        pFileState == Recovering || !pInTheFly.empty() )
+        pFileState == Recovering || !pInTheFly.empty() ||
+        !pCoalesced.empty() || pCoalescedVReads )
       return XRootDStatus( stError, errInvalidOp );
 
     pStatus = CloseInProgress;
 
     Log *log = DefaultEnv::GetLog();
+    if( pCoalescedRequests )
+      log->Debug( FileMsg, "[0x%x@%s] Coalesced %llu reads into %llu "
+                  "requests", this, pFileUrl->GetURL().c_str(),
+                  (unsigned long long)pCoalescedReads,
+                  (unsigned long long)pCoalescedRequests );
     log->Debug( FileMsg, "[0x%x@%s] Sending a close command for handle 0x%x to "
                 "%s", this, pFileUrl->GetURL().c_str(),
                 *((uint32_t*)pFileHandle), pDataServer->GetHostId().c_str() );
@@ -654,13 +1285,65 @@ namespace XrdCl
                                        uint32_t         size,
                                        void            *buffer,
                                        ResponseHandler *handler,
-                                       uint16_t         timeout )
+                                       uint16_t         timeout,
+                                       bool             coalesce )
   {
     XrdSysMutexHelper scopedLock( pMutex );
 
     if( pFileState != Opened && pFileState != Recovering )
       return XRootDStatus( stError, errInvalidOp );
 
+    if( coalesce && pCoalesceWindow > 0 && buffer && size &&
+        size < (uint32_t)pCoalesceSize )
+      return CoalesceRead( offset, size, buffer, handler, timeout );
+
+    //--------------------------------------------------------------------------
+    // Split a large read into pieces that the transport can spread over
+    // the substreams, each piece is a multiple of 4k
+    //--------------------------------------------------------------------------
+    size_t pieces = GetSplitPieces( size );
+    if( pieces < 2 || !buffer )
+      return SendRead( offset, size, buffer, handler, timeout );
+
+    uint32_t pieceSize = ((size / pieces) + 4095) & ~4095;
+    pieces = (size + pieceSize - 1) / pieceSize;
+    SplitReadHandler *splitHandler = new SplitReadHandler( handler, false,
+                                                           offset, buffer,
+                                                           pieces );
+    for( size_t i = 0; i < pieces; ++i )
+    {
+      uint32_t pieceOff = i * pieceSize;
+      uint32_t pieceLen = std::min( pieceSize, size - pieceOff );
+      ResponseHandler *pieceHandler = splitHandler->GetPieceHandler( i, pieceLen );
+      XRootDStatus st = SendRead( offset + pieceOff, pieceLen,
+                                  (char*)buffer + pieceOff, pieceHandler,
+                                  timeout );
+      if( !st.IsOK() )
+      {
+        delete pieceHandler;
+        if( i == 0 )
+        {
+          delete splitHandler;
+          return st;
+        }
+        splitHandler->SendFailed( i, st );
+        break;
+      }
+    }
+    scopedLock.UnLock();
+    splitHandler->SendDone();
+    return XRootDStatus();
+  }
+
+  //----------------------------------------------------------------------------
+  // Send a read request
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::SendRead( uint64_t         offset,
+                                           uint32_t         size,
+                                           void            *buffer,
+                                           ResponseHandler *handler,
+                                           uint16_t         timeout )
+  {
     Log *log = DefaultEnv::GetLog();
     log->Debug( FileMsg, "[0x%x@%s] Sending a read command for handle 0x%x to "
                 "%s", this, pFileUrl->GetURL().c_str(),
@@ -690,6 +1373,205 @@ namespace XrdCl
     return SendOrQueue( *pDataServer, msg, stHandler, params );
   }
 
+  //----------------------------------------------------------------------------
+  // Queue a read to be coalesced
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::CoalesceRead( uint64_t         offset,
+                                               uint32_t         size,
+                                               void            *buffer,
+                                               ResponseHandler *handler,
+                                               uint16_t         timeout )
+  {
+    //--------------------------------------------------------------------------
+    // The reads in one batch share a timeout and have to fit in one
+    // request, a vector read can't have more than 1024 chunks
+    //--------------------------------------------------------------------------
+    if( !pCoalesced.empty() &&
+        ( timeout != pCoalescedTimeout || pCoalesced.size() >= 1024 ||
+          pCoalescedBytes + size > (uint32_t)pCoalesceSize ) )
+      SendCoalescedReads();
+
+    if( pCoalesced.empty() )
+    {
+      pCoalescedTimeout = timeout;
+      pCoalesceDeadline = NowMS() + pCoalesceWindow;
+      ReadCoalesceTimer::Instance()->Schedule( this, pCoalesceDeadline );
+    }
+
+    pCoalesced.push_back( CoalescedRead( offset, size, buffer, handler ) );
+    pCoalescedBytes += size;
+    if( pCoalescedBytes >= (uint32_t)pCoalesceSize )
+      SendCoalescedReads();
+    return XRootDStatus();
+  }
+
+  //----------------------------------------------------------------------------
+  // Send the coalesced reads
+  //----------------------------------------------------------------------------
+  void FileStateHandler::SendCoalescedReads()
+  {
+    if( pCoalesced.empty() )
+      return;
+
+    CoalescedReadList reads;
+    reads.swap( pCoalesced );
+    pCoalescedBytes = 0;
+    pCoalescedReads += reads.size();
+
+    //--------------------------------------------------------------------------
+    // Group the reads into contiguous ranges
+    //--------------------------------------------------------------------------
+    typedef CoalescedReadHandler::Range Range;
+    std::vector<Range> ranges;
+    std::stable_sort( reads.begin(), reads.end(), CoalescedReadLess );
+    for( size_t i = 0; i < reads.size(); ++i )
+    {
+      if( ranges.empty() ||
+          reads[i].offset > ranges.back().offset + ranges.back().length )
+        ranges.push_back( Range( reads[i].offset, 0 ) );
+      Range    &r   = ranges.back();
+      uint64_t  end = std::max( r.offset + r.length,
+                                reads[i].offset + reads[i].size );
+      r.length = end - r.offset;
+      r.reads.push_back( reads[i] );
+    }
+
+    //--------------------------------------------------------------------------
+    // Sparse ranges go in one vector read, unless some of them may be past
+    // the end of the file, which would fail the whole vector read
+    //--------------------------------------------------------------------------
+    bool vectorRead = ranges.size() > 1 && pStatInfo;
+    for( size_t i = 0; vectorRead && i < ranges.size(); ++i )
+      if( ranges[i].offset + ranges[i].length > pStatInfo->GetSize() )
+        vectorRead = false;
+
+    if( vectorRead )
+    {
+      CoalescedReadHandler *rdHandler = new CoalescedReadHandler( this, true,
+                                                          pCoalescedTimeout );
+      ChunkList chunks;
+      for( size_t i = 0; i < ranges.size(); ++i )
+      {
+        rdHandler->AddRange( ranges[i] );
+        const Range &r = rdHandler->GetRanges().back();
+        chunks.push_back( ChunkInfo( r.offset, r.length, r.buffer ) );
+      }
+
+      ++pCoalescedRequests;
+      ++pCoalescedVReads;
+      XRootDStatus st = SendVectorRead( chunks, 0, rdHandler,
+                                        pCoalescedTimeout );
+      if( !st.IsOK() )
+      {
+        --pCoalescedVReads;
+        rdHandler->Fail( st, 0, true );
+        delete rdHandler;
+      }
+      return;
+    }
+
+    //--------------------------------------------------------------------------
+    // Otherwise send one read per range
+    //--------------------------------------------------------------------------
+    for( size_t i = 0; i < ranges.size(); ++i )
+    {
+      ++pCoalescedRequests;
+      if( ranges[i].reads.size() == 1 )
+      {
+        const CoalescedRead &rd = ranges[i].reads[0];
+        XRootDStatus st = SendRead( rd.offset, rd.size, rd.buffer, rd.handler,
+                                    pCoalescedTimeout );
+        if( !st.IsOK() )
+        {
+          JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+          jobMan->QueueJob( new ResponseJob( rd.handler,
+                                             new XRootDStatus( st ), 0, 0 ) );
+        }
+        continue;
+      }
+
+      CoalescedReadHandler *rdHandler = new CoalescedReadHandler( this, false,
+                                                          pCoalescedTimeout );
+      rdHandler->AddRange( ranges[i] );
+      const Range &r = rdHandler->GetRanges().back();
+      XRootDStatus st = SendRead( r.offset, r.length, r.buffer, rdHandler,
+                                  pCoalescedTimeout );
+      if( !st.IsOK() )
+      {
+        rdHandler->Fail( st, 0, true );
+        delete rdHandler;
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Send the coalesced reads if their window has expired
+  //----------------------------------------------------------------------------
+  void FileStateHandler::FlushCoalescedReads()
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+    if( pCoalesced.empty() )
+      return;
+
+    //--------------------------------------------------------------------------
+    // The batch has been sent already and a new one has been started since
+    // the timer was set
+    //--------------------------------------------------------------------------
+    if( pCoalesceDeadline > NowMS() )
+    {
+      ReadCoalesceTimer::Instance()->Schedule( this, pCoalesceDeadline );
+      return;
+    }
+
+    if( pFileState == Opened || pFileState == Recovering )
+    {
+      SendCoalescedReads();
+      return;
+    }
+
+    CoalescedReadList reads;
+    reads.swap( pCoalesced );
+    pCoalescedBytes = 0;
+    JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+    for( size_t i = 0; i < reads.size(); ++i )
+      jobMan->QueueJob( new ResponseJob( reads[i].handler,
+                                   new XRootDStatus( stError, errInvalidOp ),
+                                   0, 0 ) );
+  }
+
+  //----------------------------------------------------------------------------
+  // Send coalesced reads one by one
+  //----------------------------------------------------------------------------
+  void FileStateHandler::ResendCoalescedReads( const CoalescedReadList &reads,
+                                               uint16_t                 timeout )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+    JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+    --pCoalescedVReads;
+    for( size_t i = 0; i < reads.size(); ++i )
+    {
+      XRootDStatus st( stError, errInvalidOp );
+      if( pFileState == Opened || pFileState == Recovering )
+      {
+        ++pCoalescedRequests;
+        st = SendRead( reads[i].offset, reads[i].size, reads[i].buffer,
+                       reads[i].handler, timeout );
+      }
+      if( !st.IsOK() )
+        jobMan->QueueJob( new ResponseJob( reads[i].handler,
+                                           new XRootDStatus( st ), 0, 0 ) );
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Called when a coalesced vector read succeeded
+  //----------------------------------------------------------------------------
+  void FileStateHandler::CoalescedVReadDone()
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+    --pCoalescedVReads;
+  }
+
   //----------------------------------------------------------------------------
   // Write a data chunk at a given offset - async
   //----------------------------------------------------------------------------
@@ -820,6 +1702,74 @@ namespace XrdCl
     if( pFileState != Opened && pFileState != Recovering )
       return XRootDStatus( stError, errInvalidOp );
 
+    //--------------------------------------------------------------------------
+    // Split a large vector read into pieces of about the same number of
+    // bytes that the transport can spread over the substreams
+    //--------------------------------------------------------------------------
+    uint64_t total = 0;
+    for( size_t i = 0; i < chunks.size(); ++i )
+      total += chunks[i].length;
+
+    size_t pieces = std::min( GetSplitPieces( total ), chunks.size() );
+    if( pieces < 2 )
+      return SendVectorRead( chunks, buffer, handler, timeout );
+
+    SplitReadHandler *splitHandler = new SplitReadHandler( handler, true, 0, 0,
+                                                           pieces );
+    char     *cursor = (char*)buffer;
+    uint64_t  sent   = 0;
+    size_t    next   = 0;
+    for( size_t i = 0; i < pieces; ++i )
+    {
+      //------------------------------------------------------------------------
+      // Take chunks until the piece reaches its share of the total, leaving
+      // at least one chunk for every following piece
+      //------------------------------------------------------------------------
+      ChunkList piece;
+      uint64_t  target = total * (i + 1) / pieces;
+      uint32_t  size   = 0;
+      while( next < chunks.size() &&
+             ( piece.empty() ||
+               ( sent < target && chunks.size() - next > pieces - i - 1 ) ) )
+      {
+        ChunkInfo chunk = chunks[next++];
+        if( cursor )
+        {
+          chunk.buffer  = cursor;
+          cursor       += chunk.length;
+        }
+        piece.push_back( chunk );
+        sent += chunk.length;
+        size += chunk.length;
+      }
+
+      ResponseHandler *pieceHandler = splitHandler->GetPieceHandler( i, size );
+      XRootDStatus st = SendVectorRead( piece, 0, pieceHandler, timeout );
+      if( !st.IsOK() )
+      {
+        delete pieceHandler;
+        if( i == 0 )
+        {
+          delete splitHandler;
+          return st;
+        }
+        splitHandler->SendFailed( i, st );
+        break;
+      }
+    }
+    scopedLock.UnLock();
+    splitHandler->SendDone();
+    return XRootDStatus();
+  }
+
+  //----------------------------------------------------------------------------
+  // Send a vector read request
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::SendVectorRead( const ChunkList &chunks,
+                                                 void            *buffer,
+                                                 ResponseHandler *handler,
+                                                 uint16_t         timeout )
+  {
     Log *log = DefaultEnv::GetLog();
     log->Debug( FileMsg, "[0x%x@%s] Sending a vector read command for handle "
                 "0x%x to %s", this, pFileUrl->GetURL().c_str(),
@@ -1020,6 +1970,14 @@ namespace XrdCl
       { value = pDataServer->GetHostId(); return true; }
     else if( name == "LastURL" && pDataServer )
       { value =  pDataServer->GetURL(); return true; }
+    else if( name == "ReadMergeRatio" )
+    {
+      std::ostringstream o;
+      o << ( pCoalescedRequests ? (double)pCoalescedReads / pCoalescedRequests
+                                : 1.0 );
+      value = o.str();
+      return true;
+    }
     value = "";
     return false;
   }
@@ -1407,6 +2365,16 @@ namespace XrdCl
       pFileState = Error;
   }
 
+  //----------------------------------------------------------------------------
+  // Number of pieces a read of the given size should be split into
+  //----------------------------------------------------------------------------
+  size_t FileStateHandler::GetSplitPieces( uint64_t size ) const
+  {
+    if( pReadSplitPieces < 2 || size < 2 * (uint64_t)pReadSplitSize )
+      return 1;
+    return std::min( (uint64_t)pReadSplitPieces, size / pReadSplitSize );
+  }
+
   //----------------------------------------------------------------------------
   // Send a message to a host or put it in the recovery queue
   //----------------------------------------------------------------------------
@@ -32,6 +32,7 @@
 #include "XrdSys/XrdSysPthread.hh"
 #include <list>
 #include <set>
+#include <vector>
 
 namespace XrdCl
 {
@@ -133,13 +134,16 @@ namespace XrdCl
       //!                "wrap" this buffer
       //! @param timeout timeout value, if 0 the environment default will be
       //!                used
+      //! @param coalesce false if the read should be sent right away rather
+      //!                than wait to be merged with the reads following it
       //! @return        status of the operation
       //------------------------------------------------------------------------
       XRootDStatus Read( uint64_t         offset,
                          uint32_t         size,
                          void            *buffer,
                          ResponseHandler *handler,
-                         uint16_t         timeout = 0 );
+                         uint16_t         timeout = 0,
+                         bool             coalesce = true );
 
       //------------------------------------------------------------------------
       //! Write a data chunk at a given offset - async
@@ -313,6 +317,38 @@ namespace XrdCl
       //------------------------------------------------------------------------
       void AfterForkChild();
 
+      //------------------------------------------------------------------------
+      //! A read waiting to be coalesced with its neighbours
+      //------------------------------------------------------------------------
+      struct CoalescedRead
+      {
+        CoalescedRead( uint64_t o, uint32_t s, void *b, ResponseHandler *h ):
+          offset( o ), size( s ), buffer( b ), handler( h ) {}
+        uint64_t         offset;
+        uint32_t         size;
+        void            *buffer;
+        ResponseHandler *handler;
+      };
+      typedef std::vector<CoalescedRead> CoalescedReadList;
+
+      //------------------------------------------------------------------------
+      //! Send the coalesced reads if their window has expired, called by
+      //! the coalescing timer
+      //------------------------------------------------------------------------
+      void FlushCoalescedReads();
+
+      //------------------------------------------------------------------------
+      //! Send coalesced reads one by one after the merged request failed
+      //------------------------------------------------------------------------
+      void ResendCoalescedReads( const CoalescedReadList &reads,
+                                 uint16_t                 timeout );
+
+      //------------------------------------------------------------------------
+      //! Called when a coalesced vector read succeeded, before its reads
+      //! are answered
+      //------------------------------------------------------------------------
+      void CoalescedVReadDone();
+
     private:
       //------------------------------------------------------------------------
       // Helper for queuing messages
@@ -329,6 +365,45 @@ namespace XrdCl
       };
       typedef std::list<RequestData> RequestList;
 
+      //------------------------------------------------------------------------
+      //! Send a read request, the file must be locked
+      //------------------------------------------------------------------------
+      XRootDStatus SendRead( uint64_t         offset,
+                             uint32_t         size,
+                             void            *buffer,
+                             ResponseHandler *handler,
+                             uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Send a vector read request, the file must be locked
+      //------------------------------------------------------------------------
+      XRootDStatus SendVectorRead( const ChunkList &chunks,
+                                   void            *buffer,
+                                   ResponseHandler *handler,
+                                   uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Queue a small read to be merged with the reads following it within
+      //! the coalescing window, the file must be locked
+      //------------------------------------------------------------------------
+      XRootDStatus CoalesceRead( uint64_t         offset,
+                                 uint32_t         size,
+                                 void            *buffer,
+                                 ResponseHandler *handler,
+                                 uint16_t         timeout );
+
+      //------------------------------------------------------------------------
+      //! Send the queued reads as one read per contiguous range, or as one
+      //! vector read for sparse ranges, the file must be locked
+      //------------------------------------------------------------------------
+      void SendCoalescedReads();
+
+      //------------------------------------------------------------------------
+      //! Number of pieces a read of the given size should be split into so
+      //! that the pieces can be spread over the substreams
+      //------------------------------------------------------------------------
+      size_t GetSplitPieces( uint64_t size ) const;
+
       //------------------------------------------------------------------------
       //! Send a message to a host or put it in the recovery queue
       //------------------------------------------------------------------------
@@ -431,6 +506,21 @@ namespace XrdCl
       bool                    pFollowRedirects;
       bool                    pDoneInitOpen;
       bool                    pUseVirtRedirector;
+      int                     pReadSplitPieces;
+      int                     pReadSplitSize;
+
+      //------------------------------------------------------------------------
+      // Read coalescing
+      //------------------------------------------------------------------------
+      int                     pCoalesceWindow;
+      int                     pCoalesceSize;
+      CoalescedReadList       pCoalesced;
+      uint32_t                pCoalescedBytes;
+      uint16_t                pCoalescedTimeout;
+      uint64_t                pCoalesceDeadline;
+      uint64_t                pCoalescedReads;
+      uint64_t                pCoalescedRequests;
+      uint32_t                pCoalescedVReads;
 
       //------------------------------------------------------------------------
       // Monitoring variables
@@ -20,11 +20,93 @@
 #include "XrdCl/XrdClInQueue.hh"
 #include "XrdCl/XrdClPostMasterInterfaces.hh"
 #include "XrdCl/XrdClMessage.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 
 #include <arpa/inet.h>              // for network unmarshalling stuff
+#include <string.h>
 
 namespace XrdCl
 {
+  //----------------------------------------------------------------------------
+  // Constructor
+  //----------------------------------------------------------------------------
+  InQueue::InQueue()
+  {
+    memset( pPages, 0, sizeof(pPages) );
+    memset( pUsed, 0, sizeof(pUsed) );
+  }
+
+  //----------------------------------------------------------------------------
+  // Destructor
+  //----------------------------------------------------------------------------
+  InQueue::~InQueue()
+  {
+    for( uint32_t i = 0; i < NumPages; ++i )
+      delete [] pPages[i];
+  }
+
+  //----------------------------------------------------------------------------
+  // Get the slot of a SID
+  //----------------------------------------------------------------------------
+  InQueue::Slot *InQueue::GetSlot( uint16_t sid, bool create )
+  {
+    Slot *page = pPages[sid / PageSize];
+    if( !page )
+    {
+      if( !create )
+        return 0;
+
+      //------------------------------------------------------------------------
+      // Pages are only released with all the stripes locked, so once
+      // published they may be read by the holder of any stripe lock
+      //------------------------------------------------------------------------
+      XrdSysMutexHelper scopedLock( pPageMutex );
+      page = pPages[sid / PageSize];
+      if( !page )
+      {
+        page = new Slot[PageSize];
+        memset( page, 0, sizeof(Slot) * PageSize );
+        AtomicCAS( pPages[sid / PageSize], (Slot*)0, page );
+      }
+    }
+    return &page[sid % PageSize];
+  }
+
+  //----------------------------------------------------------------------------
+  // Update the used slot count of a page
+  //----------------------------------------------------------------------------
+  void InQueue::SlotChanged( uint16_t sid, bool wasUsed, const Slot *slot )
+  {
+    bool used = InUse( slot );
+    if( used == wasUsed )
+      return;
+
+    AtomicBeg( pPageMutex );
+    if( used )
+      AtomicInc( pUsed[sid / PageSize] );
+    else
+      AtomicDec( pUsed[sid / PageSize] );
+    AtomicEnd( pPageMutex );
+  }
+
+  //----------------------------------------------------------------------------
+  // Lock all the stripes
+  //----------------------------------------------------------------------------
+  void InQueue::LockAll()
+  {
+    for( uint32_t stripe = 0; stripe < NumStripes; ++stripe )
+      pLocks[stripe].Lock();
+  }
+
+  //----------------------------------------------------------------------------
+  // Unlock all the stripes
+  //----------------------------------------------------------------------------
+  void InQueue::UnLockAll()
+  {
+    for( uint32_t stripe = NumStripes; stripe > 0; --stripe )
+      pLocks[stripe-1].UnLock();
+  }
+
   //----------------------------------------------------------------------------
   // Filter messages
   //----------------------------------------------------------------------------
@@ -73,23 +155,26 @@ namespace XrdCl
       return true;
     }
 
-    // Lookup the sid in the map of handlers
-    pMutex.Lock();
-    HandlerMap::iterator it = pHandlers.find(msgSid);
+    // Lookup the sid in the slots of handlers
+    XrdSysMutex &mutex = GetLock( msgSid );
+    mutex.Lock();
+    Slot *slot = GetSlot( msgSid, true );
+    bool  used = InUse( slot );
 
-    if (it != pHandlers.end())
+    if( slot->handler )
     {
-      handler = it->second.first;
+      handler = slot->handler;
       action  = handler->Examine( msg );
 
       if( action & IncomingMsgHandler::RemoveHandler )
-	pHandlers.erase( it );
+	slot->handler = 0;
     }
 
     if( !(action & IncomingMsgHandler::Take) )
-      pMessages[msgSid] = msg;
+      slot->message = msg;
 
-    pMutex.UnLock();
+    SlotChanged( msgSid, used, slot );
+    mutex.UnLock();
 
     if( handler && !(action & IncomingMsgHandler::NoProcess) )
       handler->Process( msg );
@@ -104,24 +189,30 @@ namespace XrdCl
   {
     uint16_t action = 0;
     uint16_t handlerSid = handler->GetSid();
-    XrdSysMutexHelper scopedLock( pMutex );
-    MessageMap::iterator it = pMessages.find(handlerSid);
+    XrdSysMutexHelper scopedLock( GetLock( handlerSid ) );
+    Slot *slot = GetSlot( handlerSid, true );
+    bool  used = InUse( slot );
 
-    if (it != pMessages.end())
+    if( slot->message )
     {
-      action = handler->Examine( it->second );
+      action = handler->Examine( slot->message );
 
       if( action & IncomingMsgHandler::Take )
       {
 	if( !(action & IncomingMsgHandler::NoProcess ) )
-	  handler->Process( it->second );
+	  handler->Process( slot->message );
 
-	pMessages.erase( it );
+	slot->message = 0;
       }
     }
 
     if( !(action & IncomingMsgHandler::RemoveHandler) )
-      pHandlers[handlerSid] = HandlerAndExpire( handler, expires );
+    {
+      slot->handler = handler;
+      slot->expires = expires;
+    }
+
+    SlotChanged( handlerSid, used, slot );
   }
 
   //----------------------------------------------------------------------------
@@ -142,17 +233,20 @@ namespace XrdCl
       return handler;
     }
 
-    XrdSysMutexHelper scopedLock( pMutex );
-    HandlerMap::iterator it = pHandlers.find(msgSid);
+    XrdSysMutexHelper scopedLock( GetLock( msgSid ) );
+    Slot *slot = GetSlot( msgSid, false );
 
-    if (it != pHandlers.end())
+    if( slot && slot->handler )
     {
-      handler = it->second.first;
+      handler = slot->handler;
       act     = handler->Examine( msg );
-      exp     = it->second.second;
+      exp     = slot->expires;
 
       if( act & IncomingMsgHandler::Take )
-	pHandlers.erase( it );
+      {
+	slot->handler = 0;
+	SlotChanged( msgSid, true, slot );
+      }
     }
 
     if( handler )
@@ -171,8 +265,12 @@ namespace XrdCl
 				     time_t              expires )
   {
     uint16_t handlerSid = handler->GetSid();
-    XrdSysMutexHelper scopedLock( pMutex );
-    pHandlers[handlerSid] = HandlerAndExpire( handler, expires );
+    XrdSysMutexHelper scopedLock( GetLock( handlerSid ) );
+    Slot *slot = GetSlot( handlerSid, true );
+    bool  used = InUse( slot );
+    slot->handler = handler;
+    slot->expires = expires;
+    SlotChanged( handlerSid, used, slot );
   }
 
   //----------------------------------------------------------------------------
@@ -181,8 +279,13 @@ namespace XrdCl
   void InQueue::RemoveMessageHandler( IncomingMsgHandler *handler )
   {
     uint16_t handlerSid = handler->GetSid();
-    XrdSysMutexHelper scopedLock( pMutex );
-    pHandlers.erase(handlerSid);
+    XrdSysMutexHelper scopedLock( GetLock( handlerSid ) );
+    Slot *slot = GetSlot( handlerSid, false );
+    if( slot && slot->handler == handler )
+    {
+      slot->handler = 0;
+      SlotChanged( handlerSid, true, slot );
+    }
   }
 
   //----------------------------------------------------------------------------
@@ -193,16 +296,28 @@ namespace XrdCl
 				   Status                          status )
   {
     uint8_t action = 0;
-    XrdSysMutexHelper scopedLock( pMutex );
-    for( HandlerMap::iterator it = pHandlers.begin(); it != pHandlers.end(); )
+    LockAll();
+    for( uint32_t p = 0; p < NumPages; ++p )
     {
-      action = it->second.first->OnStreamEvent( event, streamNum, status );
+      Slot *page = pPages[p];
+      if( !page || !pUsed[p] )
+        continue;
 
-      if( action & IncomingMsgHandler::RemoveHandler )
-	pHandlers.erase( it++ );
-      else
-	++it;
+      for( uint32_t i = 0; i < PageSize; ++i )
+      {
+        if( !page[i].handler )
+          continue;
+
+        action = page[i].handler->OnStreamEvent( event, streamNum, status );
+
+        if( action & IncomingMsgHandler::RemoveHandler )
+        {
+          page[i].handler = 0;
+          SlotChanged( p * PageSize + i, true, &page[i] );
+        }
+      }
     }
+    UnLockAll();
   }
 
   //----------------------------------------------------------------------------
@@ -213,18 +328,36 @@ namespace XrdCl
     if( !now )
       now = ::time(0);
 
-    XrdSysMutexHelper scopedLock( pMutex );
-    HandlerMap::iterator it = pHandlers.begin();
-    while( it != pHandlers.end() )
+    //--------------------------------------------------------------------------
+    // SIDs are handed out round robin, so over time a channel touches every
+    // page; release the ones that emptied out as nobody can be using them
+    // while we hold all the stripes
+    //--------------------------------------------------------------------------
+    LockAll();
+    for( uint32_t p = 0; p < NumPages; ++p )
     {
-      if( it->second.second <= now )
+      Slot *page = pPages[p];
+      if( !page )
+        continue;
+
+      if( !pUsed[p] )
+      {
+        pPages[p] = 0;
+        delete [] page;
+        continue;
+      }
+
+      for( uint32_t i = 0; i < PageSize; ++i )
       {
-	it->second.first->OnStreamEvent( IncomingMsgHandler::Timeout, 0,
-				  Status( stError, errOperationExpired ) );
-	pHandlers.erase( it++ );
+        if( !page[i].handler || page[i].expires > now )
+          continue;
+
+        page[i].handler->OnStreamEvent( IncomingMsgHandler::Timeout, 0,
+                                Status( stError, errOperationExpired ) );
+        page[i].handler = 0;
+        SlotChanged( p * PageSize + i, true, &page[i] );
       }
-      else
-	++it;
     }
+    UnLockAll();
   }
 }
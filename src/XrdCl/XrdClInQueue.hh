@@ -20,8 +20,7 @@
 #define __XRD_CL_IN_QUEUE_HH__
 
 #include <XrdSys/XrdSysPthread.hh>
-#include <map>
-#include <utility>
+#include <time.h>
 #include "XrdCl/XrdClStatus.hh"
 #include "XrdCl/XrdClPostMasterInterfaces.hh"
 
@@ -31,10 +30,26 @@ namespace XrdCl
 
   //----------------------------------------------------------------------------
   //! A synchronize queue for incoming data
+  //!
+  //! Handlers and cached messages are kept in slots indexed directly by the
+  //! SID. The slots are allocated in pages on first use and protected by
+  //! striped locks, so that responses to different requests don't contend.
+  //! Each page counts its used slots so that the periodic scans skip empty
+  //! pages and release them.
   //----------------------------------------------------------------------------
   class InQueue
   {
     public:
+      //------------------------------------------------------------------------
+      //! Constructor
+      //------------------------------------------------------------------------
+      InQueue();
+
+      //------------------------------------------------------------------------
+      //! Destructor
+      //------------------------------------------------------------------------
+      ~InQueue();
+
       //------------------------------------------------------------------------
       //! Add a fully reconstructed message to the queue
       //------------------------------------------------------------------------
@@ -98,12 +113,58 @@ namespace XrdCl
       //------------------------------------------------------------------------
       bool DiscardMessage(Message* msg, uint16_t& sid) const;
 
-      typedef std::pair<IncomingMsgHandler *, time_t> HandlerAndExpire;
-      typedef std::map<uint16_t, HandlerAndExpire> HandlerMap;
-      typedef std::map<uint16_t, Message*> MessageMap;
-      MessageMap pMessages;
-      HandlerMap pHandlers;
-      XrdSysMutex pMutex;
+      //------------------------------------------------------------------------
+      //! Handler and cached message of a SID
+      //------------------------------------------------------------------------
+      struct Slot
+      {
+        IncomingMsgHandler *handler;
+        time_t              expires;
+        Message            *message;
+      };
+
+      static const uint32_t PageSize   = 256;
+      static const uint32_t NumPages   = 65536 / PageSize;
+      static const uint32_t NumStripes = 64;
+
+      //------------------------------------------------------------------------
+      //! Get the slot of a SID, allocate its page if asked to
+      //------------------------------------------------------------------------
+      Slot *GetSlot( uint16_t sid, bool create );
+
+      //------------------------------------------------------------------------
+      //! Get the lock protecting the slot of a SID
+      //------------------------------------------------------------------------
+      XrdSysMutex &GetLock( uint16_t sid )
+      {
+        return pLocks[sid % NumStripes];
+      }
+
+      //------------------------------------------------------------------------
+      //! Check if a slot holds a handler or a message
+      //------------------------------------------------------------------------
+      static bool InUse( const Slot *slot )
+      {
+        return slot->handler || slot->message;
+      }
+
+      //------------------------------------------------------------------------
+      //! Update the used slot count of the page of a SID after its slot
+      //! changed, the lock of the slot must be held
+      //------------------------------------------------------------------------
+      void SlotChanged( uint16_t sid, bool wasUsed, const Slot *slot );
+
+      //------------------------------------------------------------------------
+      //! Lock or unlock all the stripes, this excludes any other access to
+      //! the pages
+      //------------------------------------------------------------------------
+      void LockAll();
+      void UnLockAll();
+
+      Slot        *pPages[NumPages];
+      uint32_t     pUsed[NumPages];
+      XrdSysMutex  pLocks[NumStripes];
+      XrdSysMutex  pPageMutex;
   };
 }
 
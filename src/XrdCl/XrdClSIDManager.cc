@@ -17,38 +17,74 @@
 //------------------------------------------------------------------------------
 
 #include "XrdCl/XrdClSIDManager.hh"
+#include "XrdSys/XrdSysAtomics.hh"
+
+#include <string.h>
 
 namespace XrdCl
 {
+  //----------------------------------------------------------------------------
+  // Constructor - SID 0 and 0xffff are never handed out
+  //----------------------------------------------------------------------------
+  SIDManager::SIDManager(): pNextSID( 1 ), pAllocated( 0 ), pNumTimedOut( 0 )
+  {
+    memset( pTaken, 0, sizeof(pTaken) );
+    memset( pTimedOut, 0, sizeof(pTimedOut) );
+    pTaken[0]          |= 1ULL;
+    pTaken[NumWords-1] |= 1ULL << 63;
+  }
+
   //----------------------------------------------------------------------------
   // Allocate a SID
   //---------------------------------------------------------------------------
   Status SIDManager::AllocateSID( uint8_t sid[2] )
   {
-    XrdSysMutexHelper scopedLock( pMutex );
-
-    uint16_t allocSID = 1;
+    AtomicBeg( pMutex );
 
     //--------------------------------------------------------------------------
-    // Get a SID from the list of free SIDs if it's not empty
+    // Take the first clear bit at or after the cursor, wrapping around, so
+    // that a released SID is only handed out again once all the others have
+    // been; the bits of the first word below the cursor are looked at last
     //--------------------------------------------------------------------------
-    if( !pFreeSIDs.empty() )
+    uint32_t next  = AtomicGet( pNextSID );
+    uint32_t first = next / 64;
+    for( uint32_t i = 0; i <= NumWords; ++i )
     {
-      allocSID = pFreeSIDs.front();
-      pFreeSIDs.pop_front();
-    }
-    //--------------------------------------------------------------------------
-    // Allocate a new SID if possible
-    //--------------------------------------------------------------------------
-    else
-    {
-      if( pSIDCeiling == 0xffff )
-        return Status( stError, errNoMoreFreeSIDs );
-      allocSID = pSIDCeiling++;
+      uint32_t w    = (first + i) % NumWords;
+      uint64_t skip = i == 0 ? (1ULL << (next % 64)) - 1 : 0;
+      uint64_t word = AtomicGet( pTaken[w] );
+      while( (word | skip) != ~0ULL )
+      {
+        int      bit   = __builtin_ctzll( ~(word | skip) );
+        uint64_t taken = word | (1ULL << bit);
+#ifdef HAVE_ATOMICS
+        if( !AtomicCAS( pTaken[w], word, taken ) )
+        {
+          word = AtomicGet( pTaken[w] );
+          continue;
+        }
+#else
+        pTaken[w] = taken;
+#endif
+        uint16_t allocSID = w * 64 + bit;
+        AtomicCAS( pNextSID, next, (allocSID + 1U) % 65536 );
+        AtomicInc( pAllocated );
+        AtomicEnd( pMutex );
+
+        memcpy( sid, &allocSID, 2 );
+        return Status();
+      }
     }
+    AtomicEnd( pMutex );
+    return Status( stError, errNoMoreFreeSIDs );
+  }
 
-    memcpy( sid, &allocSID, 2 );
-    return Status();
+  //----------------------------------------------------------------------------
+  // Clear a SID in the taken bitmap
+  //----------------------------------------------------------------------------
+  void SIDManager::FreeSID( uint16_t sid )
+  {
+    AtomicAnd( pTaken[sid / 64], ~(1ULL << (sid % 64)) );
   }
 
   //----------------------------------------------------------------------------
@@ -56,10 +92,13 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   void SIDManager::ReleaseSID( uint8_t sid[2] )
   {
-    XrdSysMutexHelper scopedLock( pMutex );
     uint16_t relSID = 0;
     memcpy( &relSID, sid, 2 );
-    pFreeSIDs.push_back( relSID );
+
+    AtomicBeg( pMutex );
+    FreeSID( relSID );
+    AtomicDec( pAllocated );
+    AtomicEnd( pMutex );
   }
 
   //----------------------------------------------------------------------------
@@ -67,10 +106,14 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   void SIDManager::TimeOutSID( uint8_t sid[2] )
   {
-    XrdSysMutexHelper scopedLock( pMutex );
     uint16_t tiSID = 0;
     memcpy( &tiSID, sid, 2 );
-    pTimeOutSIDs.insert( tiSID );
+
+    AtomicBeg( pMutex );
+    AtomicOr( pTimedOut[tiSID / 64], 1ULL << (tiSID % 64) );
+    AtomicInc( pNumTimedOut );
+    AtomicDec( pAllocated );
+    AtomicEnd( pMutex );
   }
 
   //----------------------------------------------------------------------------
@@ -78,13 +121,15 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   bool SIDManager::IsTimedOut( uint8_t sid[2] )
   {
-    XrdSysMutexHelper scopedLock( pMutex );
     uint16_t tiSID = 0;
     memcpy( &tiSID, sid, 2 );
-    std::set<uint16_t>::iterator it = pTimeOutSIDs.find( tiSID );
-    if( it != pTimeOutSIDs.end() )
-      return true;
-    return false;
+
+    AtomicBeg( pMutex );
+    bool timedOut = AtomicGet( pNumTimedOut ) &&
+                    ( AtomicGet( pTimedOut[tiSID / 64] ) &
+                      (1ULL << (tiSID % 64)) );
+    AtomicEnd( pMutex );
+    return timedOut;
   }
 
   //----------------------------------------------------------------------------
@@ -92,11 +137,19 @@ namespace XrdCl
   //-----------------------------------------------------------------------------
   void SIDManager::ReleaseTimedOut( uint8_t sid[2] )
   {
-    XrdSysMutexHelper scopedLock( pMutex );
     uint16_t tiSID = 0;
     memcpy( &tiSID, sid, 2 );
-    pTimeOutSIDs.erase( tiSID );
-    pFreeSIDs.push_back( tiSID );
+    uint64_t mask = 1ULL << (tiSID % 64);
+
+    AtomicBeg( pMutex );
+    uint64_t old;
+    AtomicFAnd( old, pTimedOut[tiSID / 64], ~mask );
+    if( old & mask )
+    {
+      AtomicDec( pNumTimedOut );
+      FreeSID( tiSID );
+    }
+    AtomicEnd( pMutex );
   }
 
   //------------------------------------------------------------------------
@@ -104,11 +157,32 @@ namespace XrdCl
   //------------------------------------------------------------------------
   void SIDManager::ReleaseAllTimedOut()
   {
-    XrdSysMutexHelper scopedLock( pMutex );
-    std::set<uint16_t>::iterator it;
-    for( it = pTimeOutSIDs.begin(); it != pTimeOutSIDs.end(); ++it )
-      pFreeSIDs.push_back( *it );
-    pTimeOutSIDs.clear();
+    AtomicBeg( pMutex );
+    if( AtomicGet( pNumTimedOut ) )
+    {
+      for( uint32_t w = 0; w < NumWords; ++w )
+      {
+        uint64_t old;
+        AtomicFZAP( old, pTimedOut[w] );
+        for( ; old; old &= old - 1 )
+        {
+          AtomicDec( pNumTimedOut );
+          FreeSID( w * 64 + __builtin_ctzll( old ) );
+        }
+      }
+    }
+    AtomicEnd( pMutex );
+  }
+
+  //----------------------------------------------------------------------------
+  // Number of timed out SIDs
+  //----------------------------------------------------------------------------
+  uint32_t SIDManager::NumberOfTimedOutSIDs() const
+  {
+    AtomicBeg( pMutex );
+    uint32_t n = AtomicGet( const_cast<uint32_t&>( pNumTimedOut ) );
+    AtomicEnd( pMutex );
+    return n;
   }
 
   //----------------------------------------------------------------------------
@@ -116,7 +190,9 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   uint16_t SIDManager::GetNumberOfAllocatedSIDs() const
   {
-    XrdSysMutexHelper scopedLock( pMutex );
-    return pSIDCeiling - pFreeSIDs.size() - pTimeOutSIDs.size() - 1;
+    AtomicBeg( pMutex );
+    uint16_t n = AtomicGet( const_cast<uint32_t&>( pAllocated ) );
+    AtomicEnd( pMutex );
+    return n;
   }
 }
@@ -19,8 +19,6 @@
 #ifndef __XRD_CL_SID_MANAGER_HH__
 #define __XRD_CL_SID_MANAGER_HH__
 
-#include <list>
-#include <set>
 #include <stdint.h>
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdCl/XrdClStatus.hh"
@@ -29,6 +27,13 @@ namespace XrdCl
 {
   //----------------------------------------------------------------------------
   //! Handle XRootD stream IDs
+  //!
+  //! The state of all the 65536 SIDs is kept in two bitmaps, one for the
+  //! SIDs that are taken and one for those that timed out, so that SIDs are
+  //! allocated and released with atomic operations and no lock. The SIDs
+  //! are handed out in a round robin fashion, so that a released SID is not
+  //! reused before all the other free ones, as a late response to it may
+  //! still be on the way.
   //----------------------------------------------------------------------------
   class SIDManager
   {
@@ -37,7 +42,7 @@ namespace XrdCl
       //------------------------------------------------------------------------
       //! Constructor
       //------------------------------------------------------------------------
-      SIDManager(): pSIDCeiling(1) {}
+      SIDManager();
 
       //------------------------------------------------------------------------
       //! Allocate a SID
@@ -75,11 +80,7 @@ namespace XrdCl
       //------------------------------------------------------------------------
       //! Number of timeout sids
       //------------------------------------------------------------------------
-      uint32_t NumberOfTimedOutSIDs() const
-      {
-        XrdSysMutexHelper scopedLock( pMutex );
-        return pTimeOutSIDs.size();
-      }
+      uint32_t NumberOfTimedOutSIDs() const;
 
       //------------------------------------------------------------------------
       //! Number of allocated streams
@@ -87,10 +88,19 @@ namespace XrdCl
       uint16_t GetNumberOfAllocatedSIDs() const;
 
     private:
-      std::list<uint16_t>  pFreeSIDs;
-      std::set<uint16_t>   pTimeOutSIDs;
-      uint16_t             pSIDCeiling;
-      mutable XrdSysMutex  pMutex;
+      static const uint32_t NumWords = 65536 / 64;
+
+      //------------------------------------------------------------------------
+      //! Clear a SID in the taken bitmap
+      //------------------------------------------------------------------------
+      void FreeSID( uint16_t sid );
+
+      uint64_t             pTaken[NumWords];    //!< SID in use or timed out
+      uint64_t             pTimedOut[NumWords]; //!< SID timed out
+      uint32_t             pNextSID;            //!< where to look for a free SID
+      uint32_t             pAllocated;          //!< SIDs in use
+      uint32_t             pNumTimedOut;        //!< SIDs timed out
+      mutable XrdSysMutex  pMutex;              //!< used without atomics only
   };
 }
 
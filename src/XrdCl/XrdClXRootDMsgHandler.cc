@@ -37,11 +37,41 @@
 
 #include <arpa/inet.h>              // for network unmarshalling stuff
 #include "XrdSys/XrdSysPlatform.hh" // same as above
+#include <algorithm>
 #include <memory>
 #include <sstream>
 
 namespace
 {
+  //----------------------------------------------------------------------------
+  // Order chunk list indices by offset and length
+  //----------------------------------------------------------------------------
+  class ChunkIndexLess
+  {
+    public:
+      ChunkIndexLess( const XrdCl::ChunkList &chunks ): pChunks( chunks ) {}
+
+      bool operator()( uint32_t a, uint32_t b ) const
+      {
+        return Less( pChunks[a], pChunks[b] );
+      }
+
+      bool operator()( uint32_t a, const XrdCl::ChunkInfo &b ) const
+      {
+        return Less( pChunks[a], b );
+      }
+
+    private:
+      static bool Less( const XrdCl::ChunkInfo &a, const XrdCl::ChunkInfo &b )
+      {
+        if( a.offset != b.offset )
+          return a.offset < b.offset;
+        return a.length < b.length;
+      }
+
+      const XrdCl::ChunkList &pChunks;
+  };
+
   //----------------------------------------------------------------------------
   // We need an extra task what will run the handler in the future, because
   // tasks get deleted and we need the handler
@@ -828,15 +858,12 @@ namespace XrdCl
         // Find the buffer corresponding to the chunk
         //----------------------------------------------------------------------
         bool chunkFound = false;
-        for( int i = pReadVRawChunkIndex; i < (int)pChunkList->size(); ++i )
+        int  chunkIndex = FindReadVChunk( pReadVRawChunkHeader.offset,
+                                          pReadVRawChunkHeader.rlen );
+        if( chunkIndex >= 0 )
         {
-          if( (*pChunkList)[i].offset == (uint64_t)pReadVRawChunkHeader.offset &&
-              (*pChunkList)[i].length == (uint32_t)pReadVRawChunkHeader.rlen )
-          {
-            chunkFound = true;
-            pReadVRawChunkIndex = i;
-            break;
-          }
+          chunkFound = true;
+          pReadVRawChunkIndex = chunkIndex;
         }
 
         //----------------------------------------------------------------------
@@ -928,6 +955,66 @@ namespace XrdCl
     return st;
   }
 
+  //----------------------------------------------------------------------------
+  // Sort the chunk list indices by offset and length
+  //----------------------------------------------------------------------------
+  void XRootDMsgHandler::IndexChunkList()
+  {
+    if( !pChunkList || pChunkList->size() < 2 )
+      return;
+
+    pChunkIndex.resize( pChunkList->size() );
+    for( uint32_t i = 0; i < pChunkIndex.size(); ++i )
+      pChunkIndex[i] = i;
+    std::stable_sort( pChunkIndex.begin(), pChunkIndex.end(),
+                      ChunkIndexLess( *pChunkList ) );
+  }
+
+  //----------------------------------------------------------------------------
+  // Find the requested chunk matching a readv chunk header
+  //----------------------------------------------------------------------------
+  int XRootDMsgHandler::FindReadVChunk( uint64_t offset, uint32_t length )
+  {
+    const ChunkList &chunks = *pChunkList;
+    int              size   = chunks.size();
+
+    //--------------------------------------------------------------------------
+    // The chunks normally come in the requested order, so try the current
+    // one and the one after it first
+    //--------------------------------------------------------------------------
+    for( int i = pReadVRawChunkIndex; i < size && i <= pReadVRawChunkIndex + 1;
+         ++i )
+    {
+      if( chunks[i].offset == offset && chunks[i].length == length &&
+          !pChunkStatus[i].done )
+        return i;
+    }
+
+    if( pChunkIndex.empty() )
+    {
+      IndexChunkList();
+      if( pChunkIndex.empty() )
+        return -1;
+    }
+
+    //--------------------------------------------------------------------------
+    // Look the chunk up in the index, the same chunk may have been requested
+    // more than once so we take the first one not read yet
+    //--------------------------------------------------------------------------
+    ChunkInfo key( offset, length );
+    std::vector<uint32_t>::const_iterator it;
+    it = std::lower_bound( pChunkIndex.begin(), pChunkIndex.end(), key,
+                           ChunkIndexLess( chunks ) );
+    for( ; it != pChunkIndex.end(); ++it )
+    {
+      if( chunks[*it].offset != offset || chunks[*it].length != length )
+        break;
+      if( !pChunkStatus[*it].done )
+        return *it;
+    }
+    return -1;
+  }
+
   //----------------------------------------------------------------------------
   // Handle anything other than kXR_read and kXR_readv in raw mode
   //----------------------------------------------------------------------------
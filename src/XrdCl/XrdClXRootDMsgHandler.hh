@@ -242,6 +242,7 @@ namespace XrdCl
           pChunkStatus.resize( chunkList->size() );
         else
           pChunkStatus.clear();
+        pChunkIndex.clear();
       }
 
       //------------------------------------------------------------------------
@@ -274,6 +275,21 @@ namespace XrdCl
                            int       socket,
                            uint32_t &bytesRead );
 
+      //------------------------------------------------------------------------
+      //! Sort the chunk list indices by offset and length, so that readv
+      //! chunk headers can be matched by a binary search; done on the first
+      //! chunk that does not arrive in the requested order
+      //------------------------------------------------------------------------
+      void IndexChunkList();
+
+      //------------------------------------------------------------------------
+      //! Find the requested chunk, not yet read, that matches a readv chunk
+      //! header
+      //!
+      //! @return chunk list index or -1 if not found
+      //------------------------------------------------------------------------
+      int FindReadVChunk( uint64_t offset, uint32_t length );
+
       //------------------------------------------------------------------------
       //! Read a buffer asynchronously - depends on pAsyncBuffer, pAsyncSize
       //! and pAsyncOffset
@@ -365,6 +381,7 @@ namespace XrdCl
       std::string                pRedirectUrl;
       ChunkList                 *pChunkList;
       std::vector<ChunkStatus>   pChunkStatus;
+      std::vector<uint32_t>      pChunkIndex;
       uint16_t                   pRedirectCounter;
 
       uint32_t                   pAsyncOffset;
@@ -42,11 +42,14 @@
 
 #include <arpa/inet.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <dlfcn.h>
 #include <sstream>
 #include <iomanip>
 #include <set>
+#include <algorithm>
+#include <map>
 
 XrdVERSIONINFOREF( XrdCl );
 
@@ -76,12 +79,30 @@ namespace XrdCl
     //--------------------------------------------------------------------------
     // Constructor
     //--------------------------------------------------------------------------
-    XRootDStreamInfo(): status( Disconnected ), pathId( 0 )
+    XRootDStreamInfo(): status( Disconnected ), pathId( 0 ), bytesInFlight( 0 ),
+      bytesReceived( 0 ), requests( 0 ), windowBytes( 0 ), windowStart( 0 ),
+      throughput( 0 )
     {
     }
 
     StreamStatus status;
     uint8_t      pathId;
+    uint64_t     bytesInFlight; // response bytes expected for the reads sent
+    uint64_t     bytesReceived; // response bytes received
+    uint64_t     requests;      // number of reads sent
+    uint64_t     windowBytes;   // bytes received in the current rate window
+    double       windowStart;   // start of the current rate window
+    double       throughput;    // smoothed download rate in bytes per second
+  };
+
+  //----------------------------------------------------------------------------
+  //! Read waiting for its response on a substream
+  //----------------------------------------------------------------------------
+  struct XRootDInFlightRead
+  {
+    XRootDInFlightRead(): subStream( 0 ), bytes( 0 ) {}
+    uint16_t subStream;
+    uint64_t bytes;
   };
 
   //----------------------------------------------------------------------------
@@ -102,7 +123,8 @@ namespace XrdCl
       authParams(0),
       authEnv(0),
       openFiles(0),
-      waitBarrier(0)
+      waitBarrier(0),
+      readsChecked(0)
     {
       sidManager = new SIDManager();
       memset( sessionId, 0, 16 );
@@ -138,11 +160,209 @@ namespace XrdCl
     std::string       authProtocolName;
     std::set<uint16_t> sentOpens;
     std::set<uint16_t> sentCloses;
+    std::map<uint16_t, XRootDInFlightRead> inFlightReads;
     uint32_t          openFiles;
     time_t            waitBarrier;
+    time_t            readsChecked;
     XrdSysMutex       mutex;
   };
 
+  //----------------------------------------------------------------------------
+  // Helpers for the substream load accounting
+  //----------------------------------------------------------------------------
+  namespace
+  {
+    //--------------------------------------------------------------------------
+    // Length of the rate window and weight of a new rate sample
+    //--------------------------------------------------------------------------
+    const double RateWindow = 0.05;
+    const double RateWeight = 0.25;
+
+    //--------------------------------------------------------------------------
+    // Current time in seconds
+    //--------------------------------------------------------------------------
+    double Now()
+    {
+      timeval tv;
+      gettimeofday( &tv, 0 );
+      return tv.tv_sec + tv.tv_usec / 1000000.0;
+    }
+
+    //--------------------------------------------------------------------------
+    // Number of bytes the server is going to send in response to an
+    // unmarshalled read or vector read request
+    //--------------------------------------------------------------------------
+    uint64_t ResponseSize( Message *msg )
+    {
+      ClientRequest *req = (ClientRequest*)msg->GetBuffer();
+      if( req->header.requestid == kXR_read )
+        return req->read.rlen;
+
+      if( req->header.requestid == kXR_readv )
+      {
+        uint64_t        size      = 0;
+        uint32_t        numChunks = req->readv.dlen/sizeof(readahead_list);
+        readahead_list *dataChunk = (readahead_list*)msg->GetBuffer( 24 );
+        for( uint32_t i = 0; i < numChunks; ++i )
+          size += dataChunk[i].rlen + sizeof(readahead_list);
+        return size;
+      }
+      return 0;
+    }
+
+    //--------------------------------------------------------------------------
+    // Pick the connected substream expected to deliver the response first.
+    // The finish time is estimated from the bytes already expected on the
+    // substream and its recent download rate; substreams with no rate
+    // measured yet are assumed as fast as the fastest known one.
+    //--------------------------------------------------------------------------
+    uint16_t SelectDownStream( XRootDChannelInfo *info, uint64_t size )
+    {
+      double   maxRate = 0;
+      uint16_t best    = 0;
+      double   bestEta = 0;
+
+      for( size_t i = 1; i < info->stream.size(); ++i )
+        if( info->stream[i].throughput > maxRate )
+          maxRate = info->stream[i].throughput;
+      if( maxRate == 0 )
+        maxRate = 1;
+
+      //------------------------------------------------------------------------
+      // Start at a random substream so that ties are spread out
+      //------------------------------------------------------------------------
+      size_t n     = info->stream.size() - 1;
+      size_t first = n ? random() % n : 0;
+      for( size_t j = 0; j < n; ++j )
+      {
+        size_t i = 1 + (first + j) % n;
+        XRootDStreamInfo &sInfo = info->stream[i];
+        if( sInfo.status != XRootDStreamInfo::Connected )
+          continue;
+
+        double rate = sInfo.throughput > 0 ? sInfo.throughput : maxRate;
+        double eta  = (sInfo.bytesInFlight + size) / rate;
+        if( !best || eta < bestEta )
+        {
+          best    = i;
+          bestEta = eta;
+        }
+      }
+      return best;
+    }
+
+    //--------------------------------------------------------------------------
+    // Forget the reads that timed out, their responses may never come and
+    // they would keep counting as load of their substreams; this is done at
+    // most once a second and only if there are timed out requests
+    //--------------------------------------------------------------------------
+    void DropTimedOutReads( XRootDChannelInfo *info )
+    {
+      time_t now = time(0);
+      if( info->inFlightReads.empty() || info->readsChecked == now ||
+          !info->sidManager->NumberOfTimedOutSIDs() )
+        return;
+      info->readsChecked = now;
+
+      std::map<uint16_t, XRootDInFlightRead>::iterator it;
+      for( it = info->inFlightReads.begin(); it != info->inFlightReads.end(); )
+      {
+        uint8_t sid[2]; memcpy( sid, &it->first, 2 );
+        if( !info->sidManager->IsTimedOut( sid ) )
+        {
+          ++it;
+          continue;
+        }
+        if( it->second.subStream < info->stream.size() )
+        {
+          XRootDStreamInfo &sInfo = info->stream[it->second.subStream];
+          sInfo.bytesInFlight -= std::min( sInfo.bytesInFlight,
+                                           it->second.bytes );
+        }
+        info->inFlightReads.erase( it++ );
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    // Account for a read sent to be answered at the given substream
+    //--------------------------------------------------------------------------
+    void ReadSent( XRootDChannelInfo *info, Message *msg, uint16_t subStream,
+                   uint64_t size )
+    {
+      ClientRequestHdr *hdr = (ClientRequestHdr*)msg->GetBuffer();
+      uint16_t sid; memcpy( &sid, hdr->streamid, 2 );
+
+      //------------------------------------------------------------------------
+      // The request may be resent, eg. after kXR_wait, so forget whatever
+      // has been accounted for it before
+      //------------------------------------------------------------------------
+      XRootDInFlightRead &rd = info->inFlightReads[sid];
+      if( rd.subStream < info->stream.size() )
+      {
+        XRootDStreamInfo &old = info->stream[rd.subStream];
+        old.bytesInFlight -= std::min( old.bytesInFlight, rd.bytes );
+      }
+
+      XRootDStreamInfo &sInfo = info->stream[subStream];
+      if( sInfo.bytesInFlight == 0 )
+      {
+        sInfo.windowStart = Now();
+        sInfo.windowBytes = 0;
+      }
+      sInfo.bytesInFlight += size;
+      ++sInfo.requests;
+      rd.subStream = subStream;
+      rd.bytes     = size;
+    }
+
+    //--------------------------------------------------------------------------
+    // Account for a response to a read, update the download rate of the
+    // substream it came through
+    //--------------------------------------------------------------------------
+    void ReadReceived( XRootDChannelInfo *info, ServerResponse *rsp,
+                       uint16_t subStream )
+    {
+      uint16_t sid; memcpy( &sid, rsp->hdr.streamid, 2 );
+      std::map<uint16_t, XRootDInFlightRead>::iterator it;
+      it = info->inFlightReads.find( sid );
+      if( it == info->inFlightReads.end() )
+        return;
+
+      uint64_t bytes = rsp->hdr.dlen;
+      bool     final = rsp->hdr.status != kXR_oksofar &&
+                       rsp->hdr.status != kXR_waitresp;
+      uint64_t done  = final ? it->second.bytes :
+                               std::min( it->second.bytes, bytes );
+      if( it->second.subStream < info->stream.size() )
+      {
+        XRootDStreamInfo &sInfo = info->stream[it->second.subStream];
+        sInfo.bytesInFlight -= std::min( sInfo.bytesInFlight, done );
+      }
+      it->second.bytes -= done;
+      if( final )
+        info->inFlightReads.erase( it );
+
+      if( subStream >= info->stream.size() )
+        return;
+
+      XRootDStreamInfo &sInfo = info->stream[subStream];
+      sInfo.bytesReceived += bytes;
+      sInfo.windowBytes   += bytes;
+      double now     = Now();
+      double elapsed = now - sInfo.windowStart;
+      if( elapsed >= RateWindow || (sInfo.bytesInFlight == 0 && elapsed > 0) )
+      {
+        double rate = sInfo.windowBytes / elapsed;
+        if( sInfo.throughput > 0 )
+          sInfo.throughput += RateWeight * (rate - sInfo.throughput);
+        else
+          sInfo.throughput = rate;
+        sInfo.windowStart = now;
+        sInfo.windowBytes = 0;
+      }
+    }
+  }
+
   //----------------------------------------------------------------------------
   // Constructor
   //----------------------------------------------------------------------------
@@ -599,12 +819,18 @@ namespace XrdCl
       return PathID( 0, 0 );
 
     //--------------------------------------------------------------------------
-    // Select the streams
+    // Select the streams, the answer is expected at the substream likely
+    // to deliver it first
     //--------------------------------------------------------------------------
     Log *log = DefaultEnv::GetLog();
     uint16_t upStream   = 0;
     uint16_t downStream = 0;
 
+    UnMarshallRequest( msg );
+    uint64_t size = ResponseSize( msg );
+    if( size )
+      DropTimedOutReads( info );
+
     if( hint )
     {
       upStream   = hint->up;
@@ -612,16 +838,8 @@ namespace XrdCl
     }
     else
     {
-      upStream = 0;
-      std::vector<uint16_t> connected;
-      for( size_t i = 1; i < info->stream.size(); ++i )
-        if( info->stream[i].status == XRootDStreamInfo::Connected )
-          connected.push_back( i );
-
-      if( connected.empty() )
-        downStream = 0;
-      else
-        downStream = connected[random()%connected.size()];
+      upStream   = 0;
+      downStream = SelectDownStream( info, size );
     }
 
     if( upStream >= info->stream.size() )
@@ -640,10 +858,15 @@ namespace XrdCl
       downStream = 0;
     }
 
+    //--------------------------------------------------------------------------
+    // The hinted path is the final one, so account for the read
+    //--------------------------------------------------------------------------
+    if( hint && size )
+      ReadSent( info, msg, downStream, size );
+
     //--------------------------------------------------------------------------
     // Modify the message
     //--------------------------------------------------------------------------
-    UnMarshallRequest( msg );
     ClientRequestHdr *hdr = (ClientRequestHdr*)msg->GetBuffer();
     switch( hdr->requestid )
     {
@@ -957,8 +1180,26 @@ namespace XrdCl
     if( !info->stream.empty() )
     {
       XRootDStreamInfo &sInfo = info->stream[subStreamId];
-      sInfo.status = XRootDStreamInfo::Disconnected;
+      sInfo.status        = XRootDStreamInfo::Disconnected;
+      sInfo.bytesInFlight = 0;
+      sInfo.throughput    = 0;
+    }
+
+    //--------------------------------------------------------------------------
+    // The reads waiting at this substream won't be answered there anymore,
+    // and if the main stream is gone none of them will be
+    //--------------------------------------------------------------------------
+    std::map<uint16_t, XRootDInFlightRead>::iterator it;
+    for( it = info->inFlightReads.begin(); it != info->inFlightReads.end(); )
+    {
+      if( subStreamId == 0 || it->second.subStream == subStreamId )
+        info->inFlightReads.erase( it++ );
+      else
+        ++it;
     }
+    if( subStreamId == 0 )
+      for( size_t i = 0; i < info->stream.size(); ++i )
+        info->stream[i].bytesInFlight = 0;
 
     if( subStreamId == 0 )
     {
@@ -1017,6 +1258,26 @@ namespace XrdCl
       case XRootDQuery::ProtocolVersion:
         result.Set( new int( info->protocolVersion ), false );
         return Status();
+
+      //------------------------------------------------------------------------
+      // Substream load
+      //------------------------------------------------------------------------
+      case XRootDQuery::SubStreamLoad:
+      {
+        std::vector<SubStreamLoad> *load = new std::vector<SubStreamLoad>();
+        for( size_t i = 0; i < info->stream.size(); ++i )
+        {
+          SubStreamLoad l;
+          l.connected     = info->stream[i].status == XRootDStreamInfo::Connected;
+          l.bytesInFlight = info->stream[i].bytesInFlight;
+          l.bytesReceived = info->stream[i].bytesReceived;
+          l.requests      = info->stream[i].requests;
+          l.throughput    = info->stream[i].throughput;
+          load->push_back( l );
+        }
+        result.Set( load, false );
+        return Status();
+      }
     };
     return Status( stError, errQueryNotSupported );
   }
@@ -1046,6 +1307,9 @@ namespace XrdCl
       rsp = (ServerResponse*)msg->GetBuffer(16);
     }
 
+    if( !info->inFlightReads.empty() )
+      ReadReceived( info, rsp, subStream );
+
     if( info->sidManager->IsTimedOut( rsp->hdr.streamid ) )
     {
       log->Error( XRootDTransportMsg, "Message 0x%x, stream [%d, %d] is a "
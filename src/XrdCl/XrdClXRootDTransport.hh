@@ -44,6 +44,20 @@ namespace XrdCl
     static const uint16_t SIDManager      = 1001; //!< returns the SIDManager object
     static const uint16_t ServerFlags     = 1002; //!< returns server flags
     static const uint16_t ProtocolVersion = 1003; //!< returns the protocol version
+    static const uint16_t SubStreamLoad   = 1004; //!< returns the substream load
+  };
+
+  //----------------------------------------------------------------------------
+  //! Load of a substream, XRootDQuery::SubStreamLoad returns a vector of
+  //! these indexed by the substream number
+  //----------------------------------------------------------------------------
+  struct SubStreamLoad
+  {
+    bool     connected;     //!< substream is usable
+    uint64_t bytesInFlight; //!< response bytes expected for the reads sent
+    uint64_t bytesReceived; //!< response bytes received
+    uint64_t requests;      //!< number of reads sent to be answered there
+    double   throughput;    //!< smoothed download rate in bytes per second
   };
 
   //----------------------------------------------------------------------------
@@ -29,6 +29,7 @@
 /******************************************************************************/
   
 #include <stdio.h>
+#include <time.h>
 #include <sys/types.h>
 
 #include "XrdCms/XrdCmsCache.hh"
@@ -61,17 +62,47 @@ class XrdCmsCacheJob : XrdJob
 {
 public:
 
-void   DoIt() {Cache.Recycle(myList); delete this;}
+void   DoIt() {Cache.Recycle(myPart, myList); delete this;}
 
-       XrdCmsCacheJob(XrdCmsKeyItem *List)
-                     : XrdJob("cache scrubber"), myList(List) {}
+       XrdCmsCacheJob(XrdCmsCache::CachePart *Part, XrdCmsKeyItem *List)
+                     : XrdJob("cache scrubber"), myPart(Part), myList(List) {}
       ~XrdCmsCacheJob() {}
 
 private:
 
-XrdCmsKeyItem *myList;
+XrdCmsCache::CachePart *myPart;
+XrdCmsKeyItem          *myList;
 };
 
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+// Return a monotonic time stamp in nanoseconds.
+//
+inline long long Clock()
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+// Return the latency histogram slot for an elapsed time in nanoseconds.
+//
+inline int LatSlot(long long nsec)
+{
+   long long usec = nsec / 1000;
+   int n;
+
+   if (usec <= 0) return 0;
+   n = 64 - __builtin_clzll(usec);
+   return (n < XrdCmsCache::LatSlots ? n : XrdCmsCache::LatSlots-1);
+}
+}
+
 /******************************************************************************/
 /*            E x t e r n a l   T h r e a d   I n t e r f a c e s             */
 /******************************************************************************/
@@ -116,18 +147,20 @@ void *XrdCmsStartTickTock(void *carg)
   
 int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
 {
+   CachePart &cP = Part(Sel.Path);
    XrdCmsKeyItem *iP;
    SMask_t xmask;
+   long long tBeg = Clock();
    int isrw = (Sel.Opts & XrdCmsSelect::Write), isnew = 0;
 
 // Serialize processing
 //
-   myMutex.Lock();
+   cP.myMutex.Lock();
 
 // Check for fast path processing
 //
    if (  !(iP = Sel.Path.TODRef) || !(iP->Key.Equiv(Sel.Path)))
-      if ((iP = Sel.Path.TODRef = CTable.Find(Sel.Path)))
+      if ((iP = Sel.Path.TODRef = cP.CTable.Find(Sel.Path)))
          Sel.Path.Ref = iP->Key.Ref;
 
 // Add/Modify the entry
@@ -136,8 +169,8 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
       {if (!mask)
           {iP->Loc.deadline = QDelay + time(0);
            iP->Loc.hfvec = 0; iP->Loc.pfvec = 0; iP->Loc.qfvec = 0;
-           iP->Loc.TOD_B = BClock;
-           iP->Key.TOD = Tock;
+           iP->Loc.TOD_B = cP.BClock;
+           iP->Key.TOD = cP.Tock;
           } else {
            xmask = iP->Loc.pfvec;
            if (Sel.Opts & XrdCmsSelect::Pending) iP->Loc.pfvec |= mask;
@@ -154,21 +187,24 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
                      }
           }
       } else if (!(Sel.Opts & XrdCmsSelect::Advisory))
-                {Sel.Path.TOD = Tock;
-                 if ((iP = CTable.Add(Sel.Path)))
+                {Sel.Path.TOD = cP.Tock;
+                 if ((iP = cP.CTable.Add(Sel.Path)))
                     {iP->Loc.pfvec    = (Sel.Opts&XrdCmsSelect::Pending?mask:0);
                      iP->Loc.hfvec    = mask;
-                     iP->Loc.TOD_B    = BClock;
+                     iP->Loc.TOD_B    = cP.BClock;
                      iP->Loc.qfvec    = 0;
                      iP->Loc.deadline = QDelay + time(0);
                      Sel.Path.Ref     = iP->Key.Ref;
                      Sel.Path.TODRef  = iP; isnew = 1;
+                     cP.Stats.adNew++;
                     }
                 }
 
 // All done
 //
-   myMutex.UnLock();
+   cP.Stats.adCount++;
+   cP.Stats.adLat[LatSlot(Clock() - tBeg)]++;
+   cP.myMutex.UnLock();
    return isnew;
 }
   
@@ -188,27 +224,28 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
   
 int XrdCmsCache::DelFile(XrdCmsSelect &Sel, SMask_t mask)
 {
+   CachePart &cP = Part(Sel.Path);
    XrdCmsKeyItem *iP;
    int gone4good;
 
 // Lock the hash table
 //
-   myMutex.Lock();
+   cP.myMutex.Lock();
 
 // Look up the entry and remove server
 //
-   if ((iP = CTable.Find(Sel.Path)))
+   if ((iP = cP.CTable.Find(Sel.Path)))
       {iP->Loc.hfvec &= ~mask;
        iP->Loc.pfvec &= ~mask;
        if ((gone4good = (iP->Loc.hfvec == 0))
        && (!(Sel.Opts & XrdCmsSelect::Advisory))
-       && (XrdCmsKeyItem::Unload(iP) && !CTable.Recycle(iP)))
+       && (cP.CTable.Keys.Unload(iP) && !cP.CTable.Recycle(iP)))
           Say.Emsg("DelFile", "Delete failed for", iP->Key.Val);
       } else gone4good = 0;
 
 // All done
 //
-   myMutex.UnLock();
+   cP.myMutex.UnLock();
    return gone4good;
 }
   
@@ -227,19 +264,21 @@ int XrdCmsCache::DelFile(XrdCmsSelect &Sel, SMask_t mask)
   
 int  XrdCmsCache::GetFile(XrdCmsSelect &Sel, SMask_t mask)
 {
+   CachePart &cP = Part(Sel.Path);
    XrdCmsKeyItem *iP;
    SMask_t bVec;
+   long long tBeg = Clock();
    int retc;
 
 // Lock the hash table
 //
-   myMutex.Lock();
+   cP.myMutex.Lock();
 
 // Look up the entry and return location information
 //
-   if ((iP = CTable.Find(Sel.Path)))
-      {if ((bVec = (iP->Loc.TOD_B < BClock 
-                 ? getBVec(iP->Key.TOD, iP->Loc.TOD_B) & mask : 0)))
+   if ((iP = cP.CTable.Find(Sel.Path)))
+      {if ((bVec = (iP->Loc.TOD_B < cP.BClock
+                 ? getBVec(cP, iP->Key.TOD, iP->Loc.TOD_B) & mask : 0)))
           {iP->Loc.hfvec &= ~bVec; 
            iP->Loc.pfvec &= ~bVec;
            iP->Loc.qfvec &= ~mask;
@@ -249,15 +288,18 @@ int  XrdCmsCache::GetFile(XrdCmsSelect &Sel, SMask_t mask)
                     if (iP->Loc.deadline > time(0)) retc = -1;
                        else {iP->Loc.deadline = 0;  retc =  1;}
                     else retc = 1;
-       Sel.Vec.hf      = okVec & iP->Loc.hfvec;
-       Sel.Vec.pf      = okVec & iP->Loc.pfvec;
-       Sel.Vec.bf      = okVec & (bVec | iP->Loc.qfvec); iP->Loc.qfvec = 0;
+       Sel.Vec.hf      = cP.okVec & iP->Loc.hfvec;
+       Sel.Vec.pf      = cP.okVec & iP->Loc.pfvec;
+       Sel.Vec.bf      = cP.okVec & (bVec | iP->Loc.qfvec); iP->Loc.qfvec = 0;
        Sel.Path.Ref    = iP->Key.Ref;
+       cP.Stats.luHits++;
       } else retc = 0;
 
 // All done
 //
-   myMutex.UnLock();
+   cP.Stats.luCount++;
+   cP.Stats.luLat[LatSlot(Clock() - tBeg)]++;
+   cP.myMutex.UnLock();
    Sel.Path.TODRef = iP;
    return retc;
 }
@@ -269,11 +311,12 @@ int  XrdCmsCache::GetFile(XrdCmsSelect &Sel, SMask_t mask)
 int XrdCmsCache::UnkFile(XrdCmsSelect &Sel, SMask_t mask)
 {
    EPNAME("UnkFile");
+   CachePart &cP = Part(Sel.Path);
    XrdCmsKeyItem *iP;
 
 // Make sure we have the proper information. If so, lock the hash table
 //
-   myMutex.Lock();
+   cP.myMutex.Lock();
 
 // Look up the entry and if valid update the unqueried vector. Note that
 // this method may only be called after GetFile() or AddFile() for a new entry
@@ -285,7 +328,7 @@ int XrdCmsCache::UnkFile(XrdCmsSelect &Sel, SMask_t mask)
 
 // Return result
 //
-   myMutex.UnLock();
+   cP.myMutex.UnLock();
    DEBUG("rc=" <<(iP ? 1 : 0) <<" path=" <<Sel.Path.Val);
    return (iP ? 1 : 0);
 }
@@ -304,7 +347,8 @@ int XrdCmsCache::WT4File(XrdCmsSelect &Sel, SMask_t mask)
 // Make sure we have the proper information. If so, lock the hash table
 //
    if (!Sel.InfoP) return DLTime;
-   myMutex.Lock();
+   CachePart &cP = Part(Sel.Path);
+   cP.myMutex.Lock();
 
 // Look up the entry and if valid add it to the callback queue. Note that
 // this method may only be called after GetFile() or AddFile() for a new entry
@@ -319,7 +363,7 @@ int XrdCmsCache::WT4File(XrdCmsSelect &Sel, SMask_t mask)
 
 // Return result
 //
-   myMutex.UnLock();
+   cP.myMutex.UnLock();
    DEBUG("rc=" <<retc <<" path=" <<Sel.Path.Val);
    return retc;
 }
@@ -334,13 +378,16 @@ int XrdCmsCache::WT4File(XrdCmsSelect &Sel, SMask_t mask)
 void XrdCmsCache::Bounce(SMask_t smask, int SNum)
 {
 
-// Simply indicate that this server bounced
+// Simply indicate that this server bounced in each partition
 //
-   myMutex.Lock();
-   Bounced[SNum] = ++BClock;
-   okVec |= smask;
-   if (SNum > vecHi) vecHi = SNum;
-   myMutex.UnLock();
+   for (int i = 0; i < PartNum; i++)
+       {CachePart &cP = Parts[i];
+        cP.myMutex.Lock();
+        cP.Bounced[SNum] = ++cP.BClock;
+        cP.okVec |= smask;
+        if (SNum > cP.vecHi) cP.vecHi = SNum;
+        cP.myMutex.UnLock();
+       }
 }
 
 /******************************************************************************/
@@ -355,13 +402,16 @@ void XrdCmsCache::Drop(SMask_t smask, int SNum, int xHi)
 //
    Paths.Remove(smask);
 
-// Remove the node from the list of valid nodes
+// Remove the node from the list of valid nodes in each partition
 //
-   myMutex.Lock();
-   Bounced[SNum] = 0;
-   okVec &= nmask;
-   vecHi = xHi;
-   myMutex.UnLock();
+   for (int i = 0; i < PartNum; i++)
+       {CachePart &cP = Parts[i];
+        cP.myMutex.Lock();
+        cP.Bounced[SNum] = 0;
+        cP.okVec &= nmask;
+        cP.vecHi = xHi;
+        cP.myMutex.UnLock();
+       }
 }
 
 /******************************************************************************/
@@ -370,7 +420,6 @@ void XrdCmsCache::Drop(SMask_t smask, int SNum, int xHi)
   
 int XrdCmsCache::Init(int fxHold, int fxDelay, int fxQuery, int seFS)
 {
-   XrdCmsKeyItem *iP;
    pthread_t tid;
 
 // Indicate whether we are a shared-everything setup as this changes how we
@@ -391,17 +440,45 @@ int XrdCmsCache::Init(int fxHold, int fxDelay, int fxQuery, int seFS)
        return 0;
       }
 
-// Get the first reserve of cache items
+// Get the first reserve of cache items for each partition
 //
-   iP = XrdCmsKeyItem::Alloc(0);
-   XrdCmsKeyItem::Unload((unsigned int)0);
-   iP->Recycle();
+   for (int i = 0; i < PartNum; i++)
+       {Parts[i].myMutex.Lock();
+        Parts[i].CTable.Keys.Replenish();
+        Parts[i].myMutex.UnLock();
+       }
 
 // All done
 //
    return 1;
 }
 
+/******************************************************************************/
+/* public                     S t a t i s t i c s                             */
+/******************************************************************************/
+
+void XrdCmsCache::Statistics(Info &Data)
+{
+   int i, j;
+
+// Sum up the statistics of each partition
+//
+   Data = Info();
+   for (i = 0; i < PartNum; i++)
+       {CachePart &cP = Parts[i];
+        cP.myMutex.Lock();
+        Data.luCount += cP.Stats.luCount;
+        Data.luHits  += cP.Stats.luHits;
+        Data.adCount += cP.Stats.adCount;
+        Data.adNew   += cP.Stats.adNew;
+        for (j = 0; j < LatSlots; j++)
+            {Data.luLat[j] += cP.Stats.luLat[j];
+             Data.adLat[j] += cP.Stats.adLat[j];
+            }
+        cP.myMutex.UnLock();
+       }
+}
+
 /******************************************************************************/
 /* public                       T i c k T o c k                               */
 /******************************************************************************/
@@ -409,16 +486,24 @@ int XrdCmsCache::Init(int fxHold, int fxDelay, int fxQuery, int seFS)
 void *XrdCmsCache::TickTock()
 {
    XrdCmsKeyItem *iP;
+   int n = 0, wTime = Tick*1000/PartNum;
+
+// Each partition is advanced once a tick. We stagger the partitions across
+// the tick so that only one of them is aged at a time.
+//
+   if (wTime <= 0) wTime = 1;
 
 // Simply adjust the clock and trim old entries
 //
-   do {XrdSysTimer::Snooze(Tick);
-       myMutex.Lock();
-       Tock = (Tock+1) & XrdCmsKeyItem::TickMask;
-       Bhistory[Tock].Start = Bhistory[Tock].End = 0;
-       iP = XrdCmsKeyItem::Unload(Tock);
-       myMutex.UnLock();
-       if (iP) Sched->Schedule((XrdJob *)new XrdCmsCacheJob(iP));
+   do {XrdSysTimer::Wait(wTime);
+       CachePart &cP = Parts[n];
+       cP.myMutex.Lock();
+       cP.Tock = (cP.Tock+1) & XrdCmsKeyItem::TickMask;
+       cP.Bhistory[cP.Tock].Start = cP.Bhistory[cP.Tock].End = 0;
+       iP = cP.CTable.Keys.Unload(cP.Tock);
+       cP.myMutex.UnLock();
+       if (iP) Sched->Schedule((XrdJob *)new XrdCmsCacheJob(&cP, iP));
+       n = (n+1) % PartNum;
       } while(1);
 
 // Keep compiler happy
@@ -484,7 +569,8 @@ void XrdCmsCache::Dispatch(XrdCmsSelect &Sel, XrdCmsKeyItem *iP,
 /*                               g e t B V e c                                */
 /******************************************************************************/
   
-SMask_t XrdCmsCache::getBVec(unsigned int TODa, unsigned int &TODb)
+SMask_t XrdCmsCache::getBVec(CachePart &cP, unsigned int TODa,
+                                            unsigned int &TODb)
 {
    EPNAME("getBVec");
    SMask_t BVec(0);
@@ -492,20 +578,20 @@ SMask_t XrdCmsCache::getBVec(unsigned int TODa, unsigned int &TODb)
 
 // See if we can use a previously calculated bVec
 //
-   if (Bhistory[TODa].End == BClock && Bhistory[TODa].Start <= TODb)
-      {Bhits++; TODb = BClock; return Bhistory[TODa].Vec;}
+   if (cP.Bhistory[TODa].End == cP.BClock && cP.Bhistory[TODa].Start <= TODb)
+      {cP.Bhits++; TODb = cP.BClock; return cP.Bhistory[TODa].Vec;}
 
 // Calculate the new vector
 //
-   for (i = 0; i <= vecHi; i++)
-       if (TODb < Bounced[i]) BVec |= 1ULL << i;
+   for (i = 0; i <= cP.vecHi; i++)
+       if (TODb < cP.Bounced[i]) BVec |= SMask_t(1) << i;
 
-   Bhistory[TODa].Vec   = BVec;
-   Bhistory[TODa].Start = TODb;
-   Bhistory[TODa].End   = BClock;
-   TODb                 = BClock;
-   Bmiss++;
-   if (!(Bmiss & 0xff)) DEBUG("hits=" <<Bhits <<" miss=" <<Bmiss);
+   cP.Bhistory[TODa].Vec   = BVec;
+   cP.Bhistory[TODa].Start = TODb;
+   cP.Bhistory[TODa].End   = cP.BClock;
+   TODb                    = cP.BClock;
+   cP.Bmiss++;
+   if (!(cP.Bmiss & 0xff)) DEBUG("hits=" <<cP.Bhits <<" miss=" <<cP.Bmiss);
    return BVec;
 }
 
@@ -513,7 +599,7 @@ SMask_t XrdCmsCache::getBVec(unsigned int TODa, unsigned int &TODb)
 /*                               R e c y c l e                                */
 /******************************************************************************/
   
-void XrdCmsCache::Recycle(XrdCmsKeyItem *theList)
+void XrdCmsCache::Recycle(CachePart *cP, XrdCmsKeyItem *theList)
 {
    XrdCmsKeyItem *iP;
    char msgBuff[100];
@@ -525,28 +611,28 @@ void XrdCmsCache::Recycle(XrdCmsKeyItem *theList)
         {theList = iP->Key.TODRef;
          if (iP->Loc.roPend) RRQ.Del(iP->Loc.roPend, iP);
          if (iP->Loc.rwPend) RRQ.Del(iP->Loc.rwPend, iP);
-         myMutex.Lock(); CTable.Recycle(iP); myMutex.UnLock();
+         cP->myMutex.Lock(); cP->CTable.Recycle(iP); cP->myMutex.UnLock();
          numRecycled++;
         }
 
 // See if we have enough items in reserve
 //
-   myMutex.Lock();
-   XrdCmsKeyItem::Stats(numHave, numFree, numNull);
-   if (numFree < XrdCmsKeyItem::minFree)
-      {myMutex.UnLock();
+   cP->myMutex.Lock();
+   cP->CTable.Keys.Stats(numHave, numFree, numNull);
+   if (numFree < XrdCmsKeyPool::minFree)
+      {cP->myMutex.UnLock();
        if (!(numNull /= 4)) numNull = 1;
-       numHave += XrdCmsKeyItem::minAlloc * numNull;
+       numHave += XrdCmsKeyPool::minAlloc * numNull;
        while(numNull--)
-            {myMutex.Lock();
-             numFree = XrdCmsKeyItem::Replenish();
-             myMutex.UnLock();
+            {cP->myMutex.Lock();
+             numFree = cP->CTable.Keys.Replenish();
+             cP->myMutex.UnLock();
             }
-      } else myMutex.UnLock();
+      } else cP->myMutex.UnLock();
 
 // Log the stats
 //
-   sprintf(msgBuff, "%d cache items; %d allocated %d free",
-           numRecycled, numHave, numFree);
+   sprintf(msgBuff, "%d cache items; %d allocated %d free in partition %d",
+           numRecycled, numHave, numFree, static_cast<int>(cP - Parts));
    Say.Emsg("Recycle", msgBuff);
 }
@@ -76,41 +76,78 @@ void        Drop(SMask_t mask, int SNum, int xHi);
 
 int         Init(int fxHold, int fxDelay, int fxQuery, int seFS);
 
+// Statistics() returns lookup (GetFile) and update (AddFile) counts along with
+//              their latency, including lock waits, summed over all
+//              partitions. Latency slot 0 counts calls under 1us, slot n
+//              calls under 2**n us, and the last slot all longer ones.
+//
+static const int LatSlots = 12;
+
+struct Info
+      {long long luCount;            // Lookups
+       long long luHits;             // Lookups that found the path
+       long long adCount;            // Additions and updates
+       long long adNew;              // Additions of a new path
+       long long luLat[LatSlots];    // Lookup latency histogram
+       long long adLat[LatSlots];    // Update latency histogram
+
+                 Info() {memset(this, 0, sizeof(Info));}
+      };
+
+void        Statistics(Info &Data);
+
 void       *TickTock();
 
-            XrdCmsCache() : okVec(0), Tick(8*60*60), Tock(0), BClock(0), 
-                            DLTime(5), QDelay(5), Bhits(0), Bmiss(0), vecHi(-1),
-                            isDFS(0)
-                          {memset(Bounced,  0, sizeof(Bounced));
-                           memset(Bhistory, 0, sizeof(Bhistory));
-                          }
+            XrdCmsCache() : Tick(8*60*60), DLTime(5), QDelay(5), isDFS(0) {}
            ~XrdCmsCache() {}   // Never gets deleted
 
 private:
 
+// The cache is split into independently locked partitions selected by the
+// high order bits of the path hash. Each partition has its own hash table,
+// key items, aging clock and copy of the node bounce state; the latter is
+// only changed by the rare Bounce() and Drop() calls which update them all.
+//
+static const int PartBits = 4;
+static const int PartNum  = 1 << PartBits;
+
+struct CachePart
+      {XrdSysMutex   myMutex;
+       XrdCmsNash    CTable;
+       struct {SMask_t      Vec;
+               unsigned int Start;
+               unsigned int End;
+              }      Bhistory[XrdCmsKeyItem::TickRate];
+       unsigned int  Bounced[STMax];
+       SMask_t       okVec;
+       unsigned int  Tock;
+       unsigned int  BClock;
+                int  Bhits;
+                int  Bmiss;
+                int  vecHi;
+       Info          Stats;
+
+                     CachePart() : CTable(1597, 2584), okVec(0), Tock(0),
+                                   BClock(0), Bhits(0), Bmiss(0), vecHi(-1)
+                                 {memset(Bounced,  0, sizeof(Bounced));
+                                  memset(Bhistory, 0, sizeof(Bhistory));
+                                 }
+      };
+
 void          Add2Q(XrdCmsRRQInfo *Info, XrdCmsKeyItem *cp, int selOpts);
 void          Dispatch(XrdCmsSelect &Sel, XrdCmsKeyItem *cinfo,
                        short roQ, short rwQ);
-SMask_t       getBVec(unsigned int todA, unsigned int &todB);
-void          Recycle(XrdCmsKeyItem *theList);
-
-struct  {SMask_t      Vec;
-         unsigned int Start;
-         unsigned int End;
-        }             Bhistory[XrdCmsKeyItem::TickRate];
-
-XrdSysMutex   myMutex;
-XrdCmsNash    CTable;
-unsigned int  Bounced[STMax];
-SMask_t       okVec;
+SMask_t       getBVec(CachePart &cP, unsigned int todA, unsigned int &todB);
+CachePart    &Part(XrdCmsKey &Key)
+                  {if (!Key.Hash) Key.setHash();
+                   return Parts[Key.Hash >> (32 - PartBits)];
+                  }
+void          Recycle(CachePart *cP, XrdCmsKeyItem *theList);
+
+CachePart     Parts[PartNum];
 unsigned int  Tick;
-unsigned int  Tock;
-unsigned int  BClock;
          int  DLTime;
          int  QDelay;
-         int  Bhits;
-         int  Bmiss;
-         int  vecHi;
          int  isDFS;
 };
 
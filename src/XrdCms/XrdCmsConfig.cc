@@ -2312,6 +2312,7 @@ int XrdCmsConfig::xreps(XrdSysError *eDest, XrdOucStream &CFile)
     static struct repsopts {const char *opname; int opval;} rsopts[] =
        {
         {"all",      RepStat_All},
+        {"cache",    RepStat_cache},
         {"frq",      RepStat_frq},
         {"shr",      RepStat_shr}
        };
@@ -181,6 +181,7 @@ XrdNetSecurity    *Police;
 //
 static const int RepStat_frq    = 0x0001; // Fast Response Queue
 static const int RepStat_shr    = 0x0002; // Share
+static const int RepStat_cache  = 0x0004; // Location cache
 static const int RepStat_All    = 0xffff; // All
 
 private:
@@ -129,34 +129,53 @@ public:
        XrdCmsKey      Key;
        XrdCmsKeyItem *Next;
 
-static XrdCmsKeyItem *Alloc(unsigned int theTock);
+       XrdCmsKeyItem() {}  // Warning see XrdCmsKeyPool::Replenish()!
+      ~XrdCmsKeyItem() {}  // These are usually never deleted
+
+static const unsigned int TickRate =   64;
+static const unsigned int TickMask =   63;
+};
+
+/******************************************************************************/
+/*                   C l a s s   X r d C m s K e y P o o l                    */
+/******************************************************************************/
 
-       void           Recycle();
+// The XrdCmsKeyPool object holds the free key items and the lists of items by
+// time of day (tock) used to age them out. There is one per cache partition
+// and an item never leaves the pool it was allocated from. All methods must
+// be called with the owning partition locked.
+//
+class XrdCmsKeyPool
+{
+public:
 
-       void           Reload();
+XrdCmsKeyItem *Alloc(unsigned int theTock);
 
-static int            Replenish();
+void           Recycle(XrdCmsKeyItem *theItem);
 
-static void           Stats(int &isAlloc, int &isFree, int &wasEmpty);
+void           Reload(XrdCmsKeyItem *theItem);
 
-static XrdCmsKeyItem *Unload(unsigned int   theTock);
+int            Replenish();
 
-static XrdCmsKeyItem *Unload(XrdCmsKeyItem *theItem);
+void           Stats(int &isAlloc, int &isFree, int &wasEmpty);
 
-       XrdCmsKeyItem() {}  // Warning see the constructor!
-      ~XrdCmsKeyItem() {}  // These are usually never deleted
+XrdCmsKeyItem *Unload(unsigned int   theTock);
 
-static const unsigned int TickRate =   64;
-static const unsigned int TickMask =   63;
-static const          int minAlloc = 4096;
-static const          int minFree  = 1024;
+XrdCmsKeyItem *Unload(XrdCmsKeyItem *theItem);
+
+               XrdCmsKeyPool() : Free(0), numFree(0), numHave(0), numNull(0)
+                               {memset(TockTable, 0, sizeof(TockTable));}
+              ~XrdCmsKeyPool() {}  // Never gets deleted
+
+static const int minAlloc =  256;
+static const int minFree  =   64;
 
 private:
 
-static XrdCmsKeyItem *TockTable[TickRate];
-static XrdCmsKeyItem *Free;
-static int            numFree;
-static int            numHave;
-static int            numNull;
+XrdCmsKeyItem *TockTable[XrdCmsKeyItem::TickRate];
+XrdCmsKeyItem *Free;
+int            numFree;
+int            numHave;
+int            numNull;
 };
 #endif
@@ -35,6 +35,9 @@
 class XrdCmsNash
 {
 public:
+
+XrdCmsKeyPool  Keys;     // Items that may be added to this table
+
 XrdCmsKeyItem *Add(XrdCmsKey &Key);
 
 XrdCmsKeyItem *Find(XrdCmsKey &Key);
@@ -575,7 +575,7 @@ const char *XrdCmsNode::do_Locate(XrdCmsRRData &Arg)
    XrdCmsSelect    Sel(0, Arg.Path, Arg.PathLen-1);
    XrdCmsSelected *sP = 0;
    struct {kXR_unt32 Val; 
-           char outbuff[CmsLocateRequest::RHLen*STMax];} Resp;
+           char outbuff[CmsLocateRequest::RHLen*STLocMax];} Resp;
    struct iovec ioV[2] = {{(char *)&Arg.Request, sizeof(Arg.Request)},
                           {(char *)&Resp,        0}};
    const char *Why;
@@ -702,6 +702,7 @@ int XrdCmsNode::do_LocFmt(char *buff, XrdCmsSelected *sP,
                          |  XrdCmsSelected::Suspend);
    XrdCmsSelected *pP;
    char *oP = buff;
+   int   nLeft = STLocMax;
 
 // If only unique entries are wanted then we need to only let through
 // all non-servers and one server (prefereably a r/w one)
@@ -726,9 +727,12 @@ if (!lsall && lsuniq)
 // 01234567810123456789212345678
 // xy[::123.123.123.123]:123456
 //
+// The buffer only has room for STLocMax entries, any excess is dropped.
+//
 if (lsall)
    while(sP)
-        {*oP = (sP->Status & XrdCmsSelected::isMangr ? 'M' : 'S');
+        {if (nLeft-- <= 0) {pP = sP; sP = sP->next; delete pP; continue;}
+         *oP = (sP->Status & XrdCmsSelected::isMangr ? 'M' : 'S');
          if (sP->Status & Hung) *oP = tolower(*oP);
          *(oP+1) = (sP->Mask   & wfVec               ? 'w' : 'r');
          strcpy(oP+2, sP->Ident); oP += sP->IdentLen + 2;
@@ -737,7 +741,7 @@ if (lsall)
         }
    else
    while(sP)
-        {if (!(sP->Status & Skip))
+        {if (!(sP->Status & Skip) && nLeft-- > 0)
             {*oP     = (sP->Status & XrdCmsSelected::isMangr ? 'M' : 'S');
              if (sP->Mask & pfVec) *oP = tolower(*oP);
              *(oP+1) = (sP->Mask   & wfVec                   ? 'w' : 'r');
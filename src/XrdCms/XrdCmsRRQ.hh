@@ -159,7 +159,7 @@ static   const int                     iov_cnt = 2;
          XrdCms::CmsResponse           waitResp;
 union   {char                          hostbuff[288];
          char                          databuff[XrdCms::CmsLocateRequest::RHLen
-                                               *STMax];
+                                               *STLocMax];
         };
          Info                          Stats;
          int                           luFast;
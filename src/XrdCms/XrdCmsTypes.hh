@@ -30,13 +30,202 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
   
+// The following defines our cell size (maximum subscribers). It may be raised
+// at build time (cmake -DCMS_MAXNODES=n) in which case it should be a multiple
+// of 64. The default keeps node masks a single 64-bit word.
+//
+#ifndef XRDCMS_STMAX
+#define XRDCMS_STMAX 64
+#endif
+
+#define STMax XRDCMS_STMAX
+
+#if STMax <= 64
+
 typedef unsigned long long SMask_t;
 
 #define FULLMASK 0xFFFFFFFFFFFFFFFFULL
 
-// The following defines our cell size (maximum subscribers)
+/******************************************************************************/
+/*                     S M a s k   B i t   O p e r a t i o n s                */
+/******************************************************************************/
+
+// Return the number of the lowest bit set at or above bit n or -1 if none.
+//
+inline int     SMaskNext(SMask_t mask, int n)
+                        {if (n >= 64 || !(mask >>= n)) return -1;
+                         return n + __builtin_ctzll(mask);
+                        }
+
+// Return the number of bits set in the mask.
+//
+inline int     SMaskCount(SMask_t mask) {return __builtin_popcountll(mask);}
+
+#else
+
+#include <ostream>
+
+#if STMax % 64
+#error XRDCMS_STMAX must be a multiple of 64
+#endif
+
+/******************************************************************************/
+/*                       C l a s s   X r d C m s M a s k                      */
+/******************************************************************************/
+
+// When more than 64 nodes are allowed a node mask is a fixed array of 64-bit
+// words that behaves like an unsigned integer of STMax bits. Only the integer
+// operations used on node masks are provided. Constructing a mask from a
+// signed value sign-extends it so that SMask_t(~0) still means all nodes.
+//
+class XrdCmsMask
+{
+public:
+
+static const int Words = STMax/64;
+
+typedef unsigned long long Word_t;
+
+inline XrdCmsMask() {Fill(0);}
+
+inline XrdCmsMask(int                v) {Fill(v < 0 ? ~0ULL : 0); mVec[0]=v;}
+inline XrdCmsMask(long               v) {Fill(v < 0 ? ~0ULL : 0); mVec[0]=v;}
+inline XrdCmsMask(long long          v) {Fill(v < 0 ? ~0ULL : 0); mVec[0]=v;}
+inline XrdCmsMask(unsigned int       v) {Fill(0); mVec[0] = v;}
+inline XrdCmsMask(unsigned long      v) {Fill(0); mVec[0] = v;}
+inline XrdCmsMask(unsigned long long v) {Fill(0); mVec[0] = v;}
+
+// Bit manipulation
+//
+XrdCmsMask  operator~() const
+               {XrdCmsMask r;
+                for (int i = 0; i < Words; i++) r.mVec[i] = ~mVec[i];
+                return r;
+               }
+
+XrdCmsMask &operator&=(const XrdCmsMask &m)
+               {for (int i = 0; i < Words; i++) mVec[i] &= m.mVec[i];
+                return *this;
+               }
+
+XrdCmsMask &operator|=(const XrdCmsMask &m)
+               {for (int i = 0; i < Words; i++) mVec[i] |= m.mVec[i];
+                return *this;
+               }
+
+XrdCmsMask &operator^=(const XrdCmsMask &m)
+               {for (int i = 0; i < Words; i++) mVec[i] ^= m.mVec[i];
+                return *this;
+               }
+
+XrdCmsMask &operator<<=(int n)
+               {int w = n / 64, b = n % 64;
+                for (int i = Words-1; i >= 0; i--)
+                    {Word_t v = (i-w >= 0 ? mVec[i-w] << b : 0);
+                     if (b && i-w-1 >= 0) v |= mVec[i-w-1] >> (64-b);
+                     mVec[i] = v;
+                    }
+                return *this;
+               }
+
+XrdCmsMask &operator>>=(int n)
+               {int w = n / 64, b = n % 64;
+                for (int i = 0; i < Words; i++)
+                    {Word_t v = (i+w < Words ? mVec[i+w] >> b : 0);
+                     if (b && i+w+1 < Words) v |= mVec[i+w+1] << (64-b);
+                     mVec[i] = v;
+                    }
+                return *this;
+               }
+
+XrdCmsMask  operator<<(int n) const {XrdCmsMask r(*this); return r <<= n;}
+XrdCmsMask  operator>>(int n) const {XrdCmsMask r(*this); return r >>= n;}
+
+// Comparisons and truth tests
+//
+bool        operator==(const XrdCmsMask &m) const
+               {for (int i = 0; i < Words; i++)
+                    if (mVec[i] != m.mVec[i]) return false;
+                return true;
+               }
+bool        operator!=(const XrdCmsMask &m) const {return !(*this == m);}
+bool        operator==(int v) const {return *this == XrdCmsMask(v);}
+bool        operator!=(int v) const {return !(*this == XrdCmsMask(v));}
+
+bool        operator!() const {return !Any();}
+
+typedef bool (XrdCmsMask::*isSet_t)() const;
+
+            operator isSet_t() const {return (Any() ? &XrdCmsMask::Any : 0);}
+
+// Bit scanning
+//
+int         Count() const
+               {int n = 0;
+                for (int i = 0; i < Words; i++)
+                    n += __builtin_popcountll(mVec[i]);
+                return n;
+               }
+
+int         Next(int n) const
+               {int w = n / 64;
+                if (n < 0 || w >= Words) return -1;
+                Word_t v = mVec[w] & (~0ULL << (n % 64));
+                while(!v) {if (++w >= Words) return -1; v = mVec[w];}
+                return w*64 + __builtin_ctzll(v);
+               }
+
+Word_t      mVec[Words];
+
+private:
+
+bool        Any() const
+               {for (int i = 0; i < Words; i++) if (mVec[i]) return true;
+                return false;
+               }
+void        Fill(Word_t v) {for (int i = 0; i < Words; i++) mVec[i] = v;}
+};
+
+inline XrdCmsMask operator&(const XrdCmsMask &a, const XrdCmsMask &b)
+                           {XrdCmsMask r(a); return r &= b;}
+inline XrdCmsMask operator|(const XrdCmsMask &a, const XrdCmsMask &b)
+                           {XrdCmsMask r(a); return r |= b;}
+inline XrdCmsMask operator^(const XrdCmsMask &a, const XrdCmsMask &b)
+                           {XrdCmsMask r(a); return r ^= b;}
+
+// Masks are displayed in hex, most significant word first, as the stream's
+// base flags would do for an integer.
+//
+inline std::ostream &operator<<(std::ostream &os, const XrdCmsMask &m)
+{
+   int i = XrdCmsMask::Words-1;
+   while(i > 0 && !m.mVec[i]) i--;
+   std::ios_base::fmtflags oflags = os.flags();
+   os <<std::hex <<m.mVec[i--];
+   char ofill = os.fill('0');
+   while(i >= 0) {os.width(16); os <<m.mVec[i--];}
+   os.fill(ofill); os.flags(oflags);
+   return os;
+}
+
+typedef XrdCmsMask SMask_t;
+
+#define FULLMASK (~XrdCmsMask(0))
+
+/******************************************************************************/
+/*                     S M a s k   B i t   O p e r a t i o n s                */
+/******************************************************************************/
+
+inline int     SMaskNext(const SMask_t &mask, int n) {return mask.Next(n);}
+
+inline int     SMaskCount(const SMask_t &mask) {return mask.Count();}
+
+#endif
+
+// The following defines the maximum number of servers listed in a locate
+// response. Responses have a 16-bit length so more than this will not fit.
 //
-#define STMax 64
+#define STLocMax (STMax > 240 ? 240 : STMax)
 
 // The following defines the maximum number of redirectors. It is one greater
 // than the actual maximum as the zeroth is never used.
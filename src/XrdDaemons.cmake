@@ -53,6 +53,14 @@ add_executable(
   XrdCms/XrdCmsState.cc           XrdCms/XrdCmsState.hh
   XrdCms/XrdCmsSupervisor.cc      XrdCms/XrdCmsSupervisor.hh
                                   XrdCms/XrdCmsTrace.hh )
+#-------------------------------------------------------------------------------
+# The maximum number of nodes a cmsd may subscribe at each level
+#-------------------------------------------------------------------------------
+set_target_properties(
+  cmsd
+  PROPERTIES
+  COMPILE_DEFINITIONS "XRDCMS_STMAX=${CMS_MAXNODES}" )
+
 target_link_libraries(
   cmsd
   XrdServer
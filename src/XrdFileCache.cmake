@@ -21,6 +21,8 @@ add_library(
   XrdFileCache/XrdFileCachePrefetch.cc      XrdFileCache/XrdFileCachePrefetch.hh
   XrdFileCache/XrdFileCacheStats.hh
   XrdFileCache/XrdFileCacheInfo.cc          XrdFileCache/XrdFileCacheInfo.hh
+  XrdFileCache/XrdFileCachePurge.cc         XrdFileCache/XrdFileCachePurge.hh
+  XrdFileCache/XrdFileCacheRamPool.cc       XrdFileCache/XrdFileCacheRamPool.hh
   XrdFileCache/XrdFileCacheIOEntireFile.cc  XrdFileCache/XrdFileCacheIOEntireFile.hh
   XrdFileCache/XrdFileCacheIOFileBlock.cc   XrdFileCache/XrdFileCacheIOFileBlock.hh
   XrdFileCache/XrdFileCacheDecision.hh)
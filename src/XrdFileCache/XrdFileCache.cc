@@ -19,6 +19,7 @@
 #include <fcntl.h>
 #include <sstream>
 #include <sys/statvfs.h>
+#include <sys/time.h>
 
 #include "XrdCl/XrdClConstants.hh"
 #include "XrdCl/XrdClURL.hh"
@@ -34,13 +35,29 @@
 #include "XrdFileCachePrefetch.hh"
 
 
-XrdFileCache::Cache::WriteQ XrdFileCache::Cache::s_writeQ;
+XrdFileCache::Cache::WriteQ      *XrdFileCache::Cache::s_writeQ  = 0;
+int                               XrdFileCache::Cache::s_nWriteQ  = 0;
+XrdSysMutex                       XrdFileCache::Cache::s_writeQMutex;
+XrdFileCache::Cache::WriteQStats  XrdFileCache::Cache::s_writeQStats;
 
 using namespace XrdFileCache;
+
+namespace
+{
+   //! Maximum number of adjacent blocks written with one call.
+   const size_t s_maxCoalesce = 16;
+
+   long long NowUs()
+   {
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      return tv.tv_sec * 1000000LL + tv.tv_usec;
+   }
+}
+
 void *ProcessWriteTaskThread(void* c)
 {
-   Cache *cache = static_cast<Cache*>(c);
-   cache->ProcessWriteTasks();
+   Cache::ProcessWriteTasks((int)(long) c);
    return NULL;
 }
 
@@ -48,8 +65,19 @@ Cache::Cache(XrdOucCacheStats & stats)
    : m_attached(0),
      m_stats(stats)
 {
-   pthread_t tid;
-   XrdSysThread::Run(&tid, ProcessWriteTaskThread, (void*)this, 0, "XrdFileCache WriteTasks ");
+   // The write queues and their threads are shared by all cache objects.
+   XrdSysMutexHelper lock(&s_writeQMutex);
+   if (!s_writeQ)
+   {
+      int nq = Factory::GetInstance().RefConfiguration().m_wqueueThreads;
+      s_writeQ  = new WriteQ[nq];
+      s_nWriteQ = nq;
+      for (int i = 0; i < nq; ++i)
+      {
+         pthread_t tid;
+         XrdSysThread::Run(&tid, ProcessWriteTaskThread, (void*)(long)i, 0, "XrdFileCache WriteTasks ");
+      }
+   }
 }
 //______________________________________________________________________________
 
@@ -106,69 +134,191 @@ void Cache::getFilePathFromURL(const char* iUrl, std::string &result) const
    result = Factory::GetInstance().RefConfiguration().m_cache_dir + url.GetPath();
 }
 
+//______________________________________________________________________________
+Cache::WriteQ&
+Cache::GetWriteQ(Prefetch* p)
+{
+   // Blocks of a file, or of all files on a device, go to the same queue so
+   // that adjacent blocks can be coalesced and each device gets its own writer.
+   // Prefetch objects are 16 byte aligned, so the low pointer bits are dropped
+   // and the key is mixed with a multiplicative hash to use all queues.
+   unsigned long long key;
+   if (Factory::GetInstance().RefConfiguration().m_wqueueByDevice)
+      key = (unsigned long long) p->GetOutputDevice();
+   else
+      key = (unsigned long long) (unsigned long) p >> 4;
+   key = (key * 0x9E3779B97F4A7C15ULL) >> 32;
+   return s_writeQ[key % s_nWriteQ];
+}
+
 //______________________________________________________________________________
 bool
 Cache::HaveFreeWritingSlots()
 {
-   const static size_t maxWriteWaits=500;
-   return s_writeQ.size < maxWriteWaits;
+   XrdSysMutexHelper lock(&s_writeQMutex);
+   return s_writeQStats.nBytesQueued < Factory::GetInstance().RefConfiguration().m_wqueueMaxBytes;
 }
 
 
 //______________________________________________________________________________
 void
-Cache::AddWriteTask(Prefetch* p, int ri, size_t s, bool fromRead)
+Cache::AddWriteTask(Prefetch* p, int ri, int fi, size_t s, bool fromRead)
 {
-   XrdCl::DefaultEnv::GetLog()->Dump(XrdCl::AppMsg, "Cache::AddWriteTask() wqsize = %d, bi=%d", s_writeQ.size, ri);
-   s_writeQ.condVar.Lock();
+   WriteQ &q = GetWriteQ(p);
+   XrdCl::DefaultEnv::GetLog()->Dump(XrdCl::AppMsg, "Cache::AddWriteTask() wqsize = %d, bi=%d", q.size, ri);
+   {
+      XrdSysMutexHelper lock(&s_writeQMutex);
+      s_writeQStats.nBytesQueued += s;
+      if (++s_writeQStats.nTasks > s_writeQStats.maxTasks)
+         s_writeQStats.maxTasks = s_writeQStats.nTasks;
+   }
+   q.condVar.Lock();
    if (fromRead)
-      s_writeQ.queue.push_back(WriteTask(p, ri, s));
+      q.queue.push_back(WriteTask(p, ri, fi, s, NowUs()));
    else
-      s_writeQ.queue.push_front(WriteTask(p, ri, s));
-   s_writeQ.size++;
-   s_writeQ.condVar.Signal();
-   s_writeQ.condVar.UnLock();
+      q.queue.push_front(WriteTask(p, ri, fi, s, NowUs()));
+   q.size++;
+   q.condVar.Signal();
+   q.condVar.UnLock();
 }
 
 //______________________________________________________________________________
 void Cache::RemoveWriteQEntriesFor(Prefetch *p)
 {
-   s_writeQ.condVar.Lock();
-   std::list<WriteTask>::iterator i = s_writeQ.queue.begin();
-   while (i != s_writeQ.queue.end())
+   WriteQ &q = GetWriteQ(p);
+   int       nRemoved = 0;
+   long long nBytes   = 0;
+
+   q.condVar.Lock();
+   std::list<WriteTask>::iterator i = q.queue.begin();
+   while (i != q.queue.end())
    {
       if (i->prefetch == p)
       {
          std::list<WriteTask>::iterator j = i++;
          j->prefetch->DecRamBlockRefCount(j->ramBlockIdx);
-         s_writeQ.queue.erase(j);
-         --s_writeQ.size;
+         nBytes += j->size;
+         nRemoved++;
+         q.queue.erase(j);
+         --q.size;
       }
       else
       {
          ++i;
       }
    }
-   s_writeQ.condVar.UnLock();
+   q.condVar.UnLock();
+
+   XrdSysMutexHelper lock(&s_writeQMutex);
+   s_writeQStats.nTasks       -= nRemoved;
+   s_writeQStats.nBytesQueued -= nBytes;
 }
 
 //______________________________________________________________________________
 void
-Cache::ProcessWriteTasks()
+Cache::TakeAdjacent(WriteQ& q, std::vector<WriteTask>& tasks, size_t maxTasks)
 {
+   // Extend the run of blocks in either direction until nothing is found.
+   // tasks[0] is the block taken from the front of the queue.
+   Prefetch* p     = tasks[0].prefetch;
+   int       first = tasks[0].fileBlockIdx;
+   int       last  = first;
+   bool      found = true;
+
+   while (found && tasks.size() < maxTasks)
+   {
+      found = false;
+      std::list<WriteTask>::iterator i = q.queue.begin();
+      while (i != q.queue.end() && tasks.size() < maxTasks)
+      {
+         if (i->prefetch == p && (i->fileBlockIdx == last + 1 || i->fileBlockIdx == first - 1))
+         {
+            if (i->fileBlockIdx == last + 1) last++;
+            else first--;
+            tasks.push_back(*i);
+            i = q.queue.erase(i);
+            q.size--;
+            found = true;
+         }
+         else
+         {
+            ++i;
+         }
+      }
+   }
+}
+
+//______________________________________________________________________________
+void
+Cache::ProcessWriteTasks(int qIdx)
+{
+   WriteQ &q = s_writeQ[qIdx];
+   std::vector<WriteTask> tasks;
+   std::vector<int>       ramIdx;
+   std::vector<size_t>    sizes;
+
    while (true)
    {
-      s_writeQ.condVar.Lock();
-      while (s_writeQ.queue.empty())
+      q.condVar.Lock();
+      while (q.queue.empty())
+      {
+         q.condVar.Wait();
+      }
+      tasks.clear();
+      tasks.push_back(q.queue.front());
+      q.queue.pop_front();
+      q.size--;
+      TakeAdjacent(q, tasks, s_maxCoalesce);
+      q.condVar.UnLock();
+
+      // write the blocks in file order
+      size_t    n      = tasks.size();
+      int       first  = tasks[0].fileBlockIdx;
+      long long nBytes = 0;
+      for (size_t i = 1; i < n; ++i)
+      {
+         if (tasks[i].fileBlockIdx < first) first = tasks[i].fileBlockIdx;
+      }
+      ramIdx.resize(n);
+      sizes.resize(n);
+      for (size_t i = 0; i < n; ++i)
       {
-         s_writeQ.condVar.Wait();
+         ramIdx[tasks[i].fileBlockIdx - first] = tasks[i].ramBlockIdx;
+         sizes [tasks[i].fileBlockIdx - first] = tasks[i].size;
+         nBytes += tasks[i].size;
       }
-      WriteTask t = s_writeQ.queue.front();
-      s_writeQ.queue.pop_front();
-      s_writeQ.size--;
-      s_writeQ.condVar.UnLock();
 
-      t.prefetch->WriteBlockToDisk(t.ramBlockIdx, t.size);
-      t.prefetch->DecRamBlockRefCount(t.ramBlockIdx);
+      tasks[0].prefetch->WriteBlocksToDisk(&ramIdx[0], &sizes[0], n);
+
+      long long now = NowUs();
+      {
+         XrdSysMutexHelper lock(&s_writeQMutex);
+         s_writeQStats.nTasks       -= n;
+         s_writeQStats.nBytesQueued -= nBytes;
+         s_writeQStats.nBlocks      += n;
+         s_writeQStats.nWrites++;
+         for (size_t i = 0; i < n; ++i)
+         {
+            long long lat = now - tasks[i].queueTime;
+            s_writeQStats.latencyUs += lat;
+            if (lat > s_writeQStats.maxLatencyUs) s_writeQStats.maxLatencyUs = lat;
+         }
+      }
+
+      for (size_t i = 0; i < n; ++i)
+         tasks[i].prefetch->DecRamBlockRefCount(tasks[i].ramBlockIdx);
+   }
+}
+
+//______________________________________________________________________________
+void
+Cache::GetWriteQStats(WriteQStats& stats, bool resetMax)
+{
+   XrdSysMutexHelper lock(&s_writeQMutex);
+   stats = s_writeQStats;
+   if (resetMax)
+   {
+      s_writeQStats.maxTasks     = s_writeQStats.nTasks;
+      s_writeQStats.maxLatencyUs = 0;
    }
 }
@@ -19,6 +19,7 @@
 //----------------------------------------------------------------------------------
 #include <string>
 #include <list>
+#include <vector>
 
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdOuc/XrdOucCache.hh"
@@ -42,6 +43,23 @@ namespace XrdFileCache
       friend class IOFileBlock;
 
       public:
+         //---------------------------------------------------------------------
+         //! Write queue statistics.
+         //---------------------------------------------------------------------
+         struct WriteQStats
+         {
+            int       nTasks;       //!< blocks currently queued
+            int       maxTasks;     //!< max blocks queued since last reset
+            long long nBytesQueued; //!< bytes currently queued
+            long long nBlocks;      //!< blocks written
+            long long nWrites;      //!< write calls, adjacent blocks are coalesced
+            long long latencyUs;    //!< total time from queueing to written
+            long long maxLatencyUs; //!< max latency since last reset
+
+            WriteQStats() : nTasks(0), maxTasks(0), nBytesQueued(0), nBlocks(0),
+                            nWrites(0), latencyUs(0), maxLatencyUs(0) {}
+         };
+
          //---------------------------------------------------------------------
          //! Constructor
          //---------------------------------------------------------------------
@@ -67,13 +85,18 @@ namespace XrdFileCache
          //---------------------------------------------------------------------
          //! Add downloaded block in write queue.
          //---------------------------------------------------------------------
-         static void AddWriteTask(Prefetch* p, int ramBlockidx, size_t size, bool fromRead);
+         static void AddWriteTask(Prefetch* p, int ramBlockidx, int fileBlockIdx, size_t size, bool fromRead);
 
          //---------------------------------------------------------------------
-         //! Check write queue size is not over limit.
+         //! Check queued bytes are within the write queue memory budget.
          //---------------------------------------------------------------------
          static bool HaveFreeWritingSlots();
 
+         //---------------------------------------------------------------------
+         //! Get write queue statistics and optionally reset the maxima.
+         //---------------------------------------------------------------------
+         static void GetWriteQStats(WriteQStats& stats, bool resetMax);
+
          //---------------------------------------------------------------------
          //!  \brief Remove blocks from write queue which belong to given prefetch.
          //! This method is used at the time of Prefetch destruction.
@@ -82,8 +105,10 @@ namespace XrdFileCache
 
          //---------------------------------------------------------------------
          //! Separate task which writes blocks from ram to disk.
+         //!
+         //! @param qIdx index of the write queue served by the calling thread
          //---------------------------------------------------------------------
-         static void ProcessWriteTasks();
+         static void ProcessWriteTasks(int qIdx);
 
       private:
          //! Decrease attached count. Called from IO::Detach().
@@ -101,10 +126,13 @@ namespace XrdFileCache
 
          struct WriteTask
          {
-            Prefetch* prefetch;    //!< object queued for writing
-            int       ramBlockIdx; //!< in memory cache index
-            size_t    size;        //!< write size -- block size except in case this is the end file block
-            WriteTask(Prefetch* p, int ri, size_t s):prefetch(p), ramBlockIdx(ri), size(s){}
+            Prefetch* prefetch;     //!< object queued for writing
+            int       ramBlockIdx;  //!< in memory cache index
+            int       fileBlockIdx; //!< block index in file, used to find adjacent blocks
+            size_t    size;         //!< write size -- block size except in case this is the end file block
+            long long queueTime;    //!< time queued in microseconds
+            WriteTask(Prefetch* p, int ri, int fi, size_t s, long long t):
+               prefetch(p), ramBlockIdx(ri), fileBlockIdx(fi), size(s), queueTime(t) {}
          };
 
          struct WriteQ
@@ -115,7 +143,16 @@ namespace XrdFileCache
             std::list<WriteTask>  queue;    //!< container
          };
 
-         static WriteQ s_writeQ;
+         //! Queue for blocks of the given prefetch object.
+         static WriteQ& GetWriteQ(Prefetch* p);
+
+         //! Take blocks adjacent to the first one off the queue, the queue must be locked.
+         static void TakeAdjacent(WriteQ& q, std::vector<WriteTask>& tasks, size_t maxTasks);
+
+         static WriteQ        *s_writeQ;      //!< write queues, one per writer thread
+         static int            s_nWriteQ;     //!< number of write queues
+         static XrdSysMutex    s_writeQMutex; //!< protects s_writeQStats
+         static WriteQStats    s_writeQStats; //!< write queue statistics
 
    };
 
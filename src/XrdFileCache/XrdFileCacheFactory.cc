@@ -262,6 +262,12 @@ bool Factory::Config(XrdSysLogger *logger, const char *config_filename, const ch
       }
    }
 
+   if (m_configuration.m_wqueueMaxBytes < 0)
+      m_configuration.m_wqueueMaxBytes = 500 * m_configuration.m_bufferSize;
+   if (m_configuration.m_ramMaxBytes < 0)
+      m_configuration.m_ramMaxBytes = 256 * m_configuration.m_bufferSize;
+   m_ramPool.Configure(m_configuration.m_bufferSize, m_configuration.m_ramMaxBytes);
+
    if (retval)
    {
       int loff = 0;
@@ -269,10 +275,20 @@ bool Factory::Config(XrdSysLogger *logger, const char *config_filename, const ch
       loff = snprintf(buff, sizeof(buff), "result\n"
                "\tpfc.cachedir %s\n"
                "\tpfc.blocksize %lld\n"
-               "\tpfc.nramread %d\n\tpfc.nramprefetch %d\n",
+               "\tpfc.nramread %d\n\tpfc.nramprefetch %d\n"
+               "\tpfc.ram %lld\n"
+               "\tpfc.prefetch %s maxblocks %d\n"
+               "\tpfc.writequeue threads %d maxsize %lld %s\n"
+               "\tpfc.purgepolicy %s\n",
                m_configuration.m_cache_dir.c_str() , 
                m_configuration.m_bufferSize, 
-               m_configuration.m_NRamBuffersRead, m_configuration.m_NRamBuffersPrefetch );
+               m_configuration.m_NRamBuffersRead, m_configuration.m_NRamBuffersPrefetch,
+               m_configuration.m_ramMaxBytes,
+               m_configuration.m_prefetchAdaptive ? "adaptive" : "full",
+               m_configuration.m_prefetchMaxBlocks,
+               m_configuration.m_wqueueThreads, m_configuration.m_wqueueMaxBytes,
+               m_configuration.m_wqueueByDevice ? "bydevice" : "byfile",
+               m_purgeIndex.RefPolicy().Name() );
 
       if (m_configuration.m_hdfsmode)
       {
@@ -368,6 +384,81 @@ bool Factory::ConfigParameters(std::string part, XrdOucStream& config )
    {
       m_configuration.m_NRamBuffersPrefetch = ::atoi(config.GetWord());
    }
+   else if (part == "ram")
+   {
+      if (XrdOuca2x::a2sz(m_log, "Error getting ram size", config.GetWord(), &m_configuration.m_ramMaxBytes, 1))
+         return false;
+   }
+   else if (part == "prefetch")
+   {
+      const char* val;
+      while ((val = config.GetWord()))
+      {
+         if (!strcmp(val, "adaptive"))
+         {
+            m_configuration.m_prefetchAdaptive = true;
+         }
+         else if (!strcmp(val, "full"))
+         {
+            m_configuration.m_prefetchAdaptive = false;
+         }
+         else if (!strcmp(val, "maxblocks"))
+         {
+            if (XrdOuca2x::a2i(m_log, "Error getting prefetch max blocks", config.GetWord(), &m_configuration.m_prefetchMaxBlocks, 1, 64))
+               return false;
+         }
+         else
+         {
+            m_log.Emsg("Config", "Error unknown prefetch option", val);
+            return false;
+         }
+      }
+      // the options took the whole line, another GetWord() would read the next one
+      return true;
+   }
+   else if (part == "writequeue")
+   {
+      const char* val;
+      while ((val = config.GetWord()))
+      {
+         if (!strcmp(val, "threads"))
+         {
+            if (XrdOuca2x::a2i(m_log, "Error getting write queue threads", config.GetWord(), &m_configuration.m_wqueueThreads, 1, 64))
+               return false;
+         }
+         else if (!strcmp(val, "maxsize"))
+         {
+            if (XrdOuca2x::a2sz(m_log, "Error getting write queue size", config.GetWord(), &m_configuration.m_wqueueMaxBytes, 1))
+               return false;
+         }
+         else if (!strcmp(val, "byfile"))
+         {
+            m_configuration.m_wqueueByDevice = false;
+         }
+         else if (!strcmp(val, "bydevice"))
+         {
+            m_configuration.m_wqueueByDevice = true;
+         }
+         else
+         {
+            m_log.Emsg("Config", "Error unknown writequeue option", val);
+            return false;
+         }
+      }
+      // the options took the whole line, another GetWord() would read the next one
+      return true;
+   }
+   else if (part == "purgepolicy")
+   {
+      const char* name = config.GetWord();
+      PurgePolicy* policy = PurgePolicy::Create(name);
+      if (!policy)
+      {
+         m_log.Emsg("Config", "Error unknown purge policy", name ? name : "");
+         return false;
+      }
+      m_purgeIndex.SetPolicy(policy);
+   }
    else if ( part == "hdfsmode" )
    {
       m_configuration.m_hdfsmode = true;
@@ -401,54 +492,8 @@ bool Factory::ConfigParameters(std::string part, XrdOucStream& config )
 }
 
 //______________________________________________________________________________
-//namespace {
 
-class FPurgeState
-{
-public:
-   struct FS
-   {
-      std::string path;
-      long long   nByte;
-
-      FS(const char* p, long long n) : path(p), nByte(n) {}
-   };
-
-   typedef std::multimap<time_t, FS> map_t;
-   typedef map_t::iterator map_i;
-
-   FPurgeState(long long iNByteReq) : nByteReq(iNByteReq), nByteAccum(0) {}
-
-   map_t fmap;
-
-   void checkFile (time_t iTime, const char* iPath,  long long iNByte)
-   {
-      if (nByteAccum < nByteReq || iTime < fmap.rbegin()->first)
-      {
-         fmap.insert(std::pair<const time_t, FS> (iTime, FS(iPath, iNByte)));
-         nByteAccum += iNByte;
-
-         // remove newest files from map if necessary
-         while (nByteAccum > nByteReq)
-         {
-            time_t nt = fmap.begin()->first;
-            std::pair<map_i, map_i> ret = fmap.equal_range(nt); 
-            for (map_i it2 = ret.first; it2 != ret.second; ++it2)
-               nByteAccum -= it2->second.nByte;
-	    fmap.erase(ret.first, ret.second);
-         }
-      }
-   }
-
-private:
-   long long nByteReq;
-   long long nByteAccum;
-};
-
-
-//}
-
-void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState& purgeState)
+void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, PurgeIndex& purgeIndex)
 {
    char buff[256];
    XrdOucEnv env;
@@ -475,8 +520,6 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
 
          if (fname_len > InfoExtLen && strncmp(&buff[fname_len - InfoExtLen ], XrdFileCache::Info::m_infoExtension, InfoExtLen) == 0)
          {
-            // XXXX MT - shouldn't we also check if it is currently opened?
-
             fh->Open(np.c_str(), O_RDONLY, 0600, env);
             Info cinfo(factory.RefConfiguration().m_bufferSize);
             time_t accessTime;
@@ -484,7 +527,7 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
             if (cinfo.GetLatestDetachTime(accessTime, fh))
             {
                log->Debug(XrdCl::AppMsg, "FillFileMapRecurse() checking %s accessTime %d ", buff, (int)accessTime);
-               purgeState.checkFile(accessTime, np.c_str(), cinfo.GetNDownloadedBytes());
+               purgeIndex.Add(np, accessTime, cinfo.GetNDownloadedBytes(), cinfo.GetAccessCnt());
             }
             else
             {
@@ -501,7 +544,7 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
                   log->Info(XrdCl::AppMsg, "FillFileMapRecurse() determined access time for %s via stat: %lld\n",
                                                 np.c_str(), accessTime);
 
-                  purgeState.checkFile(accessTime, np.c_str(), cinfo.GetNDownloadedBytes());
+                  purgeIndex.Add(np, accessTime, cinfo.GetNDownloadedBytes(), cinfo.GetAccessCnt());
                }
                else
                {
@@ -518,7 +561,7 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
          }
          else if (dh->Opendir(np.c_str(), env) >= 0)
          {
-            FillFileMapRecurse(dh, np, purgeState);
+            FillFileMapRecurse(dh, np, purgeIndex);
          }
 
          delete dh; dh = 0;
@@ -528,16 +571,40 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
 }
 
 
+void Factory::ScanCacheDir()
+{
+   XrdOucEnv env;
+   XrdOssDF* dh = m_output_fs->newDir(m_configuration.m_username.c_str());
+   if (dh->Opendir(m_configuration.m_cache_dir.c_str(), env) >= 0)
+   {
+      m_purgeIndex.BeginScan();
+      FillFileMapRecurse(dh, m_configuration.m_cache_dir, m_purgeIndex);
+      m_purgeIndex.EndScan();
+      clLog()->Info(XrdCl::AppMsg, "Factory::ScanCacheDir() indexed %d files", m_purgeIndex.Size());
+   }
+   dh->Close();
+   delete dh; dh = 0;
+}
+
+//______________________________________________________________________________
+
 void Factory::CacheDirCleanup()
 {
    // check state every sleep seconds
    const static int sleept = 300;
    struct stat fstat;
-   XrdOucEnv env;
 
    XrdOss* oss = Factory::GetInstance().GetOss();
    XrdOssVSInfo sP;
 
+   // The purge works from the index of cached files which is kept current by
+   // the prefetch objects. The directory tree is only walked when there is no
+   // checkpoint of the index or when the index can not free enough space.
+   const std::string cpPath = m_configuration.m_cache_dir + "/.pfc-purge-index";
+   const std::string &user  = m_configuration.m_username;
+   if (!m_purgeIndex.Load(oss, user, cpPath))
+      ScanCacheDir();
+
    while (1)
    {
       // get amount of space to erase
@@ -558,50 +625,60 @@ void Factory::CacheDirCleanup()
          }
       }
 
-      if (bytesToRemove > 0)
+      for (int pass = 0; pass < 2 && bytesToRemove > 0; ++pass)
       {
-         // make a sorted map of file patch by access time
-         XrdOssDF* dh = oss->newDir(m_configuration.m_username.c_str());
-         if (dh->Opendir(m_configuration.m_cache_dir.c_str(), env) >= 0)
-         {
-            FPurgeState purgeState(bytesToRemove * 5 / 4); // prepare 20% more volume than required
+         // index does not cover enough files, rebuild it from disk
+         if (pass) ScanCacheDir();
 
-            FillFileMapRecurse(dh, m_configuration.m_cache_dir, purgeState);
+         // files by purge order, prepare 20% more volume than required
+         std::vector<PurgeIndex::Candidate> cands;
+         m_purgeIndex.Select(bytesToRemove * 5 / 4, cands);
 
-            // loop over map and remove files with highest value of access time
-            for (FPurgeState::map_i it = purgeState.fmap.begin(); it != purgeState.fmap.end(); ++it)
-            {
-               // XXXX MT - shouldn't we re-check if the file is currently opened?
-
-               std::string path = it->second.path;
-               // remove info file
-               if (oss->Stat(path.c_str(), &fstat) == XrdOssOK)
-               {
-                  bytesToRemove -= fstat.st_size;
-                  oss->Unlink(path.c_str());
-                  clLog()->Info(XrdCl::AppMsg, "Factory::CacheDirCleanup() removed %s size %lld",
-                                                path.c_str(), fstat.st_size);
-               }
+         for (std::vector<PurgeIndex::Candidate>::iterator it = cands.begin(); it != cands.end(); ++it)
+         {
+            // skip files that have been attached since the selection
+            std::string path = it->path;
+            if (!m_purgeIndex.Remove(path))
+               continue;
 
-               // remove data file
-               path = path.substr(0, path.size() - strlen(XrdFileCache::Info::m_infoExtension));
-               if (oss->Stat(path.c_str(), &fstat) == XrdOssOK)
-               {
-                  bytesToRemove -= it->second.nByte;
-                  oss->Unlink(path.c_str());
-                  clLog()->Info(XrdCl::AppMsg, "Factory::CacheDirCleanup() removed %s bytes %lld, stat_size %lld",
-                                                path.c_str(), it->second.nByte, fstat.st_size);
-               }
+            // remove info file
+            if (oss->Stat(path.c_str(), &fstat) == XrdOssOK)
+            {
+               bytesToRemove -= fstat.st_size;
+               oss->Unlink(path.c_str());
+               clLog()->Info(XrdCl::AppMsg, "Factory::CacheDirCleanup() removed %s size %lld",
+                                             path.c_str(), fstat.st_size);
+            }
 
-               if (bytesToRemove <= 0)
-                  break;
+            // remove data file
+            path = path.substr(0, path.size() - strlen(XrdFileCache::Info::m_infoExtension));
+            if (oss->Stat(path.c_str(), &fstat) == XrdOssOK)
+            {
+               bytesToRemove -= it->nBytes;
+               oss->Unlink(path.c_str());
+               clLog()->Info(XrdCl::AppMsg, "Factory::CacheDirCleanup() removed %s bytes %lld, stat_size %lld",
+                                             path.c_str(), it->nBytes, fstat.st_size);
             }
+
+            if (bytesToRemove <= 0)
+               break;
          }
-	 dh->Close();
-	 delete dh; dh =0;
       }
 
+      m_purgeIndex.Checkpoint(oss, user, cpPath);
+
+      Cache::WriteQStats wqs;
+      Cache::GetWriteQStats(wqs, true);
+      clLog()->Info(XrdCl::AppMsg, "Factory::CacheDirCleanup() write queue depth %d max %d bytes %lld; "
+                    "%lld blocks in %lld writes, latency avg %lld us max %lld us",
+                    wqs.nTasks, wqs.maxTasks, wqs.nBytesQueued, wqs.nBlocks, wqs.nWrites,
+                    wqs.nBlocks ? wqs.latencyUs / wqs.nBlocks : 0, wqs.maxLatencyUs);
+
+      int ramUsed, ramTotal, ramActive;
+      m_ramPool.GetUsage(ramUsed, ramTotal, ramActive);
+      clLog()->Info(XrdCl::AppMsg, "Factory::CacheDirCleanup() ram blocks used %d of %d by %d active files",
+                    ramUsed, ramTotal, ramActive);
+
       sleep(sleept);
    }
 }
-
@@ -28,6 +28,8 @@
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdVersion.hh"
 #include "XrdFileCacheDecision.hh"
+#include "XrdFileCachePurge.hh"
+#include "XrdFileCacheRamPool.hh"
 
 class XrdOucStream;
 class XrdSysError;
@@ -51,6 +53,12 @@ namespace XrdFileCache
          m_bufferSize(1024*1024),
 	 m_NRamBuffersRead(8),
 	 m_NRamBuffersPrefetch(1),
+         m_ramMaxBytes(-1),
+         m_prefetchAdaptive(true),
+         m_prefetchMaxBlocks(4),
+         m_wqueueThreads(4),
+         m_wqueueMaxBytes(-1),
+         m_wqueueByDevice(false),
          m_hdfsbsize(128*1024*1024) {}
 
       bool m_hdfsmode;      //!< flag for enabling block-level operation
@@ -63,6 +71,12 @@ namespace XrdFileCache
       long long m_bufferSize;         //!< prefetch buffer size, default 1MB
       int  m_NRamBuffersRead;         //!< number of read in-memory cache blocks
       int  m_NRamBuffersPrefetch;     //!< number of prefetch in-memory cache blocks
+      long long m_ramMaxBytes;        //!< memory shared by all in-memory cache blocks
+      bool m_prefetchAdaptive;        //!< follow the access pattern instead of prefetching whole files
+      int  m_prefetchMaxBlocks;       //!< max blocks fetched with one request for sequential access
+      int  m_wqueueThreads;           //!< number of disk writer threads and queues
+      long long m_wqueueMaxBytes;     //!< write queue memory budget, default 500 blocks
+      bool m_wqueueByDevice;          //!< queue writes by device instead of by file
       long long m_hdfsbsize;          //!< used with m_hdfsmode, default 128MB
    };
 
@@ -143,10 +157,21 @@ namespace XrdFileCache
          //---------------------------------------------------------------------
          void CacheDirCleanup();
 
+         //---------------------------------------------------------------------
+         //! Reference index of cached files used by the purge.
+         //---------------------------------------------------------------------
+         PurgeIndex& RefPurgeIndex() { return m_purgeIndex; }
+
+         //---------------------------------------------------------------------
+         //! Reference in-memory block pool shared by all prefetch objects.
+         //---------------------------------------------------------------------
+         RamPool& RefRamPool() { return m_ramPool; }
+
       private:
          bool ConfigParameters(std::string, XrdOucStream&);
          bool ConfigXeq(char *, XrdOucStream &);
          bool xdlib(XrdOucStream &);
+         void ScanCacheDir();
 
          XrdCl::Log* clLog() const { return XrdCl::DefaultEnv::GetLog(); }
 
@@ -160,6 +185,9 @@ namespace XrdFileCache
 
          std::map<std::string, long long> m_filesInQueue;
 
+         PurgeIndex        m_purgeIndex; //!< cached files by purge order
+         RamPool           m_ramPool;    //!< in-memory cache blocks
+
          Configuration     m_configuration; //!< configurable parameters
    };
 }
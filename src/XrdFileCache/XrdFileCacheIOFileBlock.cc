@@ -21,6 +21,8 @@
 #include <stdio.h>
 #include <iostream>
 #include <assert.h>
+#include <algorithm>
+#include <vector>
 
 #include "XrdFileCacheIOFileBlock.hh"
 #include "XrdFileCache.hh"
@@ -123,6 +125,34 @@ bool IOFileBlock::ioActive()
    return res;
 }
 
+//______________________________________________________________________________
+Prefetch* IOFileBlock::GetBlockPrefetcher(int blockIdx)
+{
+   Prefetch* fb;
+   m_mutex.Lock();
+   std::map<int, Prefetch*>::iterator it = m_blocks.find(blockIdx);
+   if ( it != m_blocks.end() )
+   {
+      fb = it->second;
+   }
+   else
+   {
+      size_t pbs = m_blocksize;
+      // check if this is last block
+      int lastIOFileBlock = (m_io.FSize()-1)/m_blocksize;
+      if (blockIdx == lastIOFileBlock )
+      {
+         pbs =  m_io.FSize() - blockIdx*m_blocksize;
+         clLog()->Debug(XrdCl::AppMsg, "IOFileBlock::Read() last block, change output file size to %lld \n %s", pbs, m_io.Path());
+      }
+
+      fb = newBlockPrefetcher(blockIdx*m_blocksize, pbs, &m_io);
+      m_blocks.insert(std::pair<int,Prefetch*>(blockIdx, (Prefetch*) fb));
+   }
+   m_mutex.UnLock();
+   return fb;
+}
+
 //______________________________________________________________________________
 int IOFileBlock::Read (char *buff, long long off, int size)
 {
@@ -146,28 +176,7 @@ int IOFileBlock::Read (char *buff, long long off, int size)
    for (int blockIdx = idx_first; blockIdx <= idx_last; ++blockIdx )
    {
       // locate block
-      Prefetch* fb;
-      m_mutex.Lock();
-      std::map<int, Prefetch*>::iterator it = m_blocks.find(blockIdx);
-      if ( it != m_blocks.end() )
-      {
-         fb = it->second;
-      }
-      else
-      {
-         size_t pbs = m_blocksize;
-         // check if this is last block
-         int lastIOFileBlock = (m_io.FSize()-1)/m_blocksize;
-         if (blockIdx == lastIOFileBlock )
-         {
-            pbs =  m_io.FSize() - blockIdx*m_blocksize;
-            clLog()->Debug(XrdCl::AppMsg, "IOFileBlock::Read() last block, change output file size to %lld \n %s", pbs, m_io.Path());
-         }
-
-         fb = newBlockPrefetcher(blockIdx*m_blocksize, pbs, &m_io);
-         m_blocks.insert(std::pair<int,Prefetch*>(blockIdx, (Prefetch*) fb));
-      }
-      m_mutex.UnLock();
+      Prefetch* fb = GetBlockPrefetcher(blockIdx);
 
       // edit size if read request is reaching more than a block
       int readBlockSize = size;
@@ -218,4 +227,52 @@ int IOFileBlock::Read (char *buff, long long off, int size)
    return bytes_read;
 }
 
+//______________________________________________________________________________
+int IOFileBlock::ReadV (const XrdOucIOVec *readV, int n)
+{
+   // requests crossing a file-block boundary are split, so that each
+   // Prefetch object gets one vector read for all its parts
+   std::map<int, std::vector<XrdOucIOVec> > parts;
+   int nbytes = 0;
+   for (int i = 0; i < n; ++i)
+   {
+      long long off  = readV[i].offset;
+      long long end  = off + readV[i].size;
+      char     *data = readV[i].data;
+      if (off < 0 || end > m_io.FSize())
+      {
+         errno = EINVAL;
+         return -1;
+      }
+      nbytes += readV[i].size;
 
+      while (off < end)
+      {
+         int blockIdx = off/m_blocksize;
+         long long blockEnd = std::min(end, (blockIdx + 1) * m_blocksize);
+         XrdOucIOVec v;
+         v.offset = off;
+         v.size   = blockEnd - off;
+         v.info   = 0;
+         v.data   = data;
+         parts[blockIdx].push_back(v);
+         data += v.size;
+         off   = blockEnd;
+      }
+   }
+
+   clLog()->Debug(XrdCl::AppMsg, "IOFileBlock::ReadV() %d requests in %d blocks %s", n, (int) parts.size(), m_io.Path());
+
+   for (std::map<int, std::vector<XrdOucIOVec> >::iterator it = parts.begin(); it != parts.end(); ++it)
+   {
+      Prefetch* fb = GetBlockPrefetcher(it->first);
+      int retval = fb->ReadV(&it->second[0], it->second.size());
+      if (retval < 0)
+      {
+         clLog()->Error(XrdCl::AppMsg, "IOFileBlock::ReadV() read error, retval %d %s", retval, m_io.Path());
+         return retval;
+      }
+   }
+
+   return nbytes;
+}
@@ -61,6 +61,12 @@ namespace XrdFileCache
          //---------------------------------------------------------------------
          virtual int Read(char *Buffer, long long Offset, int Length);
 
+         //---------------------------------------------------------------------
+         //! Split ReadV request by file-block and pass the parts to the
+         //! corresponding Prefetch objects.
+         //---------------------------------------------------------------------
+         virtual int ReadV(const XrdOucIOVec *readV, int n);
+
          //! \brief Virtual method of XrdOucCacheIO. 
          //! Called to check if destruction needs to be done in a separate task.
          virtual bool ioActive();
@@ -71,6 +77,7 @@ namespace XrdFileCache
          XrdSysMutex                m_mutex;     //!< map mutex
 
          void GetBlockSizeFromPath();
+         Prefetch* GetBlockPrefetcher(int blockIdx);
          Prefetch* newBlockPrefetcher(long long off, int blocksize, XrdOucCacheIO* io);
    };
 }
@@ -17,10 +17,12 @@
 //----------------------------------------------------------------------------------
 
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <assert.h>
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <sys/stat.h>
 
 #include "XrdOss/XrdOss.hh"
@@ -37,9 +39,10 @@ using namespace XrdFileCache;
 
 
 Info::Info(long long iBufferSize) :
-   m_version(0),
+   m_version(1),
    m_bufferSize(iBufferSize),
    m_sizeInBits(0), m_buff_fetched(0), m_buff_write_called(0),
+   m_map(0), m_mapSize(0),
    m_accessCnt(0),
    m_complete(false)
 {
@@ -48,7 +51,8 @@ Info::Info(long long iBufferSize) :
 Info::~Info()
 {
    if (m_buff_fetched) free(m_buff_fetched);
-   if (m_buff_write_called) free(m_buff_write_called);
+   if (m_map) munmap(m_map, m_mapSize);
+   else if (m_buff_write_called) free(m_buff_write_called);
 }
 
 //______________________________________________________________________________
@@ -71,17 +75,34 @@ int Info::Read(XrdOssDF* fp)
    // does not need lock, called only in Prefetch::Open
    // before Prefetch::Run() starts
 
+   int       version    = m_version;
+   long long bufferSize = m_bufferSize;
+
    int off = 0;
    off += fp->Read(&m_version, off, sizeof(int));
    off += fp->Read(&m_bufferSize, off, sizeof(long long));
    if (off <= 0) return off;
 
-   int sb;
+   int sb = 0;
    off += fp->Read(&sb, off, sizeof(int));
-   ResizeBits(sb);
+   if (off == (int)(sizeof(int) + sizeof(long long) + sizeof(int)) && sb > 0)
+   {
+      ResizeBits(sb);
+      off += fp->Read(m_buff_fetched, off, GetSizeInBytes());
+   }
 
-   off += fp->Read(m_buff_fetched, off, GetSizeInBytes());
-   assert (off == GetHeaderSize());
+   if (off != GetHeaderSize())
+   {
+      // short (e.g. truncated) file, let the caller write a fresh header
+      clLog()->Warning(XrdCl::AppMsg, "Info::Read() header incomplete, ignoring it");
+      if (m_buff_fetched)      free(m_buff_fetched);
+      if (m_buff_write_called) free(m_buff_write_called);
+      m_buff_fetched = m_buff_write_called = 0;
+      m_sizeInBits = 0;
+      m_version    = version;
+      m_bufferSize = bufferSize;
+      return 0;
+   }
 
    memcpy(m_buff_write_called, m_buff_fetched, GetSizeInBytes());
    m_complete = IsAnythingEmptyInRng(0, sb-1) ? false : true;
@@ -101,9 +122,56 @@ int Info::GetHeaderSize() const
    return sizeof(int) + sizeof(long long) + sizeof(int) + GetSizeInBytes();
 }
 
+//______________________________________________________________________________
+int Info::GetAStatSize() const
+{
+   // version 0 records end before the prefetch statistics
+   return m_version < 1 ? offsetof(AStat, BytesPrefetched) : sizeof(AStat);
+}
+
+//______________________________________________________________________________
+bool Info::MapHeader(XrdOssDF* fp)
+{
+   int fd = fp->getFD();
+   if (fd < 0 || m_map) return m_map != 0;
+
+   // touching a mapped page beyond the end of the file raises SIGBUS, a short
+   // (e.g. truncated) file is left to the unmapped path
+   struct stat st;
+   if (fstat(fd, &st) || st.st_size < GetHeaderSize())
+   {
+      clLog()->Warning(XrdCl::AppMsg, "Info::MapHeader() file shorter than header, not mapped");
+      return false;
+   }
+
+   void *map = mmap(0, GetHeaderSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (map == MAP_FAILED)
+   {
+      clLog()->Warning(XrdCl::AppMsg, "Info::MapHeader() mmap failed %s", strerror(errno));
+      return false;
+   }
+
+   // the mapped vector matches the file, keep bits set since the last write
+   m_map     = (char*) map;
+   m_mapSize = GetHeaderSize();
+   unsigned char* wc = (unsigned char*) (m_map + GetHeaderSize() - GetSizeInBytes());
+   for (int i = 0; i < GetSizeInBytes(); ++i) wc[i] |= m_buff_write_called[i];
+   free(m_buff_write_called);
+   m_buff_write_called = wc;
+   return true;
+}
+
 //______________________________________________________________________________
 void Info::WriteHeader(XrdOssDF* fp)
 {
+   if (m_map)
+   {
+      // header fields don't change, only the vector needs flushing
+      if (msync(m_map, m_mapSize, MS_SYNC))
+         clLog()->Error(XrdCl::AppMsg, "WriteHeader() msync failed %s", strerror(errno));
+      return;
+   }
+
    int flr = XrdOucSxeq::Serialize(fp->getFD(), XrdOucSxeq::noWait);
    if (flr) clLog()->Error(XrdCl::AppMsg, "WriteHeader() lock failed %s \n", strerror(errno));
 
@@ -132,13 +200,13 @@ void Info::AppendIOStat(AStat& as, XrdOssDF* fp)
    m_accessCnt++;
    long long off = GetHeaderSize();
    off += fp->Write(&m_accessCnt, off, sizeof(int));
-   off += (m_accessCnt-1)*sizeof(AStat);
+   off += (m_accessCnt-1)*GetAStatSize();
  
-   long long ws = fp->Write(&as, off, sizeof(AStat));
+   long long ws = fp->Write(&as, off, GetAStatSize());
    flr = XrdOucSxeq::Release(fp->getFD());
    if (flr) clLog()->Error(XrdCl::AppMsg, "AppenIOStat() un-lock failed \n");
 
-   if ( ws != sizeof(AStat)) { assert(0); }
+   if ( ws != GetAStatSize()) { assert(0); }
 }
 
 //______________________________________________________________________________
@@ -151,9 +219,9 @@ bool Info::GetLatestDetachTime(time_t& t, XrdOssDF* fp) const
    if (m_accessCnt)
    {
       AStat     stat;
-      long long off      = GetHeaderSize() + sizeof(int) + (m_accessCnt-1)*sizeof(AStat);
-      ssize_t   read_res = fp->Read(&stat, off, sizeof(AStat));
-      if (read_res == sizeof(AStat))
+      long long off      = GetHeaderSize() + sizeof(int) + (m_accessCnt-1)*GetAStatSize();
+      ssize_t   read_res = fp->Read(&stat, off, GetAStatSize());
+      if (read_res == GetAStatSize())
       {
          t = stat.DetachTime;
          res = true;
@@ -22,6 +22,7 @@
 #include <time.h>
 #include <assert.h>
 
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdCl/XrdClLog.hh"
 #include "XrdCl/XrdClConstants.hh"
@@ -54,6 +55,8 @@ namespace XrdFileCache
             long long BytesDisk;   //! read from disk
             long long BytesRam;    //! read from ram
             long long BytesMissed; //! read remote client
+            long long BytesPrefetched;   //! downloaded by prefetching, since version 1
+            long long BytesPrefetchUsed; //! part of the prefetched blocks later read
          };
 
          //------------------------------------------------------------------------
@@ -67,13 +70,15 @@ namespace XrdFileCache
          ~Info();
 
          //---------------------------------------------------------------------
-         //! \brief Mark block as downloaded
+         //! \brief Mark block as downloaded. Atomic where atomics are
+         //! available, else callers must serialize.
          //!
          //! @param i block index
          //---------------------------------------------------------------------
          void SetBitFetched(int i);
 
-         //! \brief Mark block as disk written
+         //! \brief Mark block as disk written. Call only once the block data
+         //! has been synced, the bit may reach the disk at any time after.
          //!
          //! @param i block index
          //---------------------------------------------------------------------
@@ -95,6 +100,16 @@ namespace XrdFileCache
          //---------------------------------------------------------------------
          int Read(XrdOssDF* fp);
 
+         //---------------------------------------------------------------------
+         //! \brief Map the header of the info file into memory.
+         //!
+         //! The disk written state vector then lives in the mapping and
+         //! WriteHeader() only flushes it. The header must have been read or
+         //! written before. Returns false, keeping the state in memory, if
+         //! the file can't be mapped.
+         //---------------------------------------------------------------------
+         bool MapHeader(XrdOssDF* fp);
+
          //---------------------------------------------------------------------
          //! Write number of blocks and prefetch buffer size
          //---------------------------------------------------------------------
@@ -125,6 +140,11 @@ namespace XrdFileCache
          //----------------------------------------------------------------------
          int GetHeaderSize() const;
 
+         //---------------------------------------------------------------------
+         //! Size of the AStat records in the file, shorter for version 0.
+         //---------------------------------------------------------------------
+         int GetAStatSize() const;
+
          //---------------------------------------------------------------------
          //! Get latest detach time
          //---------------------------------------------------------------------
@@ -186,6 +206,8 @@ namespace XrdFileCache
          int            m_sizeInBits; //!< number of file blocks
          unsigned char *m_buff_fetched;       //!< download state vector
          unsigned char *m_buff_write_called;  //!< disk written state vector
+         char          *m_map;        //!< mapped header, 0 if not mapped
+         int            m_mapSize;    //!< size of mapped header
          int            m_accessCnt;  //!< number of written AStat structs
          bool           m_complete;   //!< cached
    };
@@ -195,8 +217,9 @@ namespace XrdFileCache
       int cn = i/8;
       assert(cn < GetSizeInBytes());
 
+      // lock free, a byte is only ever changed by setting bits
       int off = i - cn*8;
-      return (m_buff_fetched[cn] & cfiBIT(off)) == cfiBIT(off);
+      return (((volatile unsigned char*) m_buff_fetched)[cn] & cfiBIT(off)) == cfiBIT(off);
    }
 
 
@@ -257,7 +280,7 @@ namespace XrdFileCache
       assert(cn < GetSizeInBytes());
 
       int off = i - cn*8;
-      m_buff_fetched[cn] |= cfiBIT(off);
+      AtomicOr(m_buff_fetched[cn], cfiBIT(off));
    }
 
    inline long long Info::GetBufferSize() const
@@ -19,10 +19,14 @@
 #include <stdio.h>
 #include <sstream>
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
 
 #include "XrdCl/XrdClLog.hh"
 #include "XrdCl/XrdClConstants.hh"
 #include "XrdCl/XrdClFile.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdOss/XrdOss.hh"
@@ -47,6 +51,30 @@ namespace
 {
    const int PREFETCH_MAX_ATTEMPTS = 10;
 
+   // vector read elements are kept well below the server transfer size
+   const int PREFETCH_READV_PIECE = 128 * 1024;
+
+   // client vector reads fetch and cache whole blocks up to this size
+   const long long PREFETCH_READV_WHOLE_BLOCK = 1024 * 1024;
+
+   // the server refuses vector reads with more elements than this (maxRvecsz)
+   const int PREFETCH_READV_MAXCHUNKS = 1024;
+
+   // issue a vector read in batches the server accepts, returns the total
+   // number of bytes read or the first negative result
+   long long ReadVBatched(XrdOucCacheIO &io, XrdOucIOVec *iov, int n)
+   {
+      long long total = 0;
+      for (int i = 0; i < n; i += PREFETCH_READV_MAXCHUNKS)
+      {
+         int cnt    = std::min(n - i, PREFETCH_READV_MAXCHUNKS);
+         int retval = io.ReadV(&iov[i], cnt);
+         if (retval < 0) return retval;
+         total += retval;
+      }
+      return total;
+   }
+
    class DiskSyncer : public XrdJob
    {
    private:
@@ -66,21 +94,67 @@ namespace
 }
 
 
-Prefetch::RAM::RAM():m_numBlocks(0),m_buffer(0), m_blockStates(0), m_writeMutex(0)
+Prefetch::RAM::RAM():m_numBlocks(0), m_blockStates(0), m_writeMutex(0)
 {
-   m_numBlocks = Factory::GetInstance().RefConfiguration().m_NRamBuffersRead + Factory::GetInstance().RefConfiguration().m_NRamBuffersPrefetch;
-   m_buffer = (char*)malloc(m_numBlocks * Factory::GetInstance().RefConfiguration().m_bufferSize);
+   // memory for the blocks comes from the shared pool as they are used
+   const Configuration &conf = Factory::GetInstance().RefConfiguration();
+   m_numBlocks = conf.m_NRamBuffersRead + std::max(conf.m_NRamBuffersPrefetch, conf.m_prefetchMaxBlocks);
    m_blockStates = new RAMBlock[m_numBlocks];
 }
 
 Prefetch::RAM::~RAM()
 {
-   free(m_buffer);
    delete [] m_blockStates;
 }
 
+//______________________________________________________________________________
+Prefetch::AccessPattern::AccessPattern() :
+   firstBlock(-1), lastBlock(-1), delta(0), stride(0), nSeqRun(0), nKinds(0)
+{
+   count[kSequential] = count[kStrided] = count[kSparse] = 0;
+}
+
+void Prefetch::AccessPattern::Record(int first, int last)
+{
+   if (firstBlock >= 0)
+   {
+      // continuing or re-reading the last blocks is sequential, repeating
+      // the last jump forward is strided, anything else is sparse
+      int    jump = first - firstBlock;
+      Kind_e kind;
+      if (first >= firstBlock && first <= lastBlock + 1)
+         kind = kSequential;
+      else if (jump > 0 && jump == delta)
+         kind = kStrided;
+      else
+         kind = kSparse;
+
+      nSeqRun = (kind == kSequential) ? nSeqRun + 1 : 0;
+      delta   = jump;
+      if (kind == kStrided) stride = jump;
+
+      int slot = nKinds % s_window;
+      if (nKinds >= s_window) count[kinds[slot]]--;
+      kinds[slot] = kind;
+      count[kind]++;
+      nKinds++;
+   }
+   firstBlock = first;
+   lastBlock  = last;
+}
+
+Prefetch::AccessPattern::Kind_e Prefetch::AccessPattern::Classify() const
+{
+   int n = nKinds < s_window ? nKinds : s_window;
+   if (n < 4) return kSequential;
+   if (2 * count[kSequential] >= n) return kSequential;
+   if (2 * count[kStrided]    >= n) return kStrided;
+   return kSparse;
+}
+
 Prefetch::Prefetch(XrdOucCacheIO &inputIO, std::string& disk_file_path, long long iOffset, long long iFileSize) :
    m_output(NULL),
+   m_outputDevice(0),
    m_infoFile(NULL),
    m_cfi(Factory::GetInstance().RefConfiguration().m_bufferSize),
    m_input(inputIO),
@@ -202,6 +276,7 @@ Prefetch::~Prefetch()
 
       // write statistics in *cinfo file
       AppendIOStatToFileInfo();
+      Factory::GetInstance().RefPurgeIndex().Detach(m_temp_filename + Info::m_infoExtension);
 
       m_infoFile->Close();
       delete m_infoFile;
@@ -212,6 +287,8 @@ Prefetch::~Prefetch()
       clLog()->Info(XrdCl::AppMsg, "Prefetch::~Prefetch close info file -- not opened %p",(void*)this , lPath());
    }
 
+   Factory::GetInstance().RefRamPool().Deactivate(m_ramUser);
+
    delete m_syncer;
 }
 
@@ -241,6 +318,9 @@ bool Prefetch::Open()
          m_output = NULL;
          return false;
       }
+      struct stat st;
+      if (m_output->Fstat(&st) == XrdOssOK)
+         m_outputDevice = st.st_dev;
    }
    else
    {
@@ -285,6 +365,14 @@ bool Prefetch::Open()
       // m_cfi.Print();
    }
 
+   if ( ! m_cfi.MapHeader(m_infoFile))
+      clLog()->Debug(XrdCl::AppMsg, "Prefetch::Open() info file not mapped %s", lPath());
+
+   m_prefetched.resize(m_cfi.GetSizeInBits(), false);
+
+   // keep the file from being purged while attached
+   Factory::GetInstance().RefPurgeIndex().Attach(ifn, m_cfi.GetNDownloadedBytes(), m_cfi.GetAccessCnt());
+
    return true;
 }
 
@@ -323,6 +411,7 @@ Prefetch::Run()
       }
    }
    assert(m_infoFile);
+   Factory::GetInstance().RefRamPool().Activate(m_ramUser);
    clLog()->Debug(XrdCl::AppMsg, "Prefetch::Run() Starting loop over tasks for %s", lPath());
 
    Task* task;
@@ -350,12 +439,151 @@ Prefetch::Run()
 
    m_cfi.CheckComplete();
 
+   // blocks still queued for writing go back to the pool when written
+   Factory::GetInstance().RefRamPool().Deactivate(m_ramUser);
+
    m_stateCond.Lock();
    m_stopped = true;
    m_stateCond.UnLock();
 } // end Run()
 
 
+//______________________________________________________________________________
+void
+Prefetch::GetPrefetchPlan(PrefetchPlan& plan)
+{
+   const Configuration &conf = Factory::GetInstance().RefConfiguration();
+   int nBlocks = m_cfi.GetSizeInBits();
+
+   plan.start  = 0;
+   plan.stride = 1;
+   plan.span   = 0;
+   plan.count  = nBlocks;
+   plan.wrap   = false;
+   plan.depth  = conf.m_NRamBuffersPrefetch;
+   plan.run    = 1;
+   if ( ! conf.m_prefetchAdaptive) return;
+
+   XrdSysMutexHelper _lck(&m_patternMutex);
+
+   switch (m_pattern.Classify())
+   {
+      case AccessPattern::kSequential:
+      {
+         // continue after the reader, fetch more blocks per request while the
+         // reads stay sequential, then the rest of the file
+         plan.start = (m_pattern.lastBlock + 1) % nBlocks;
+         plan.wrap  = true;
+         plan.run   = std::min(conf.m_prefetchMaxBlocks, 1 << std::min(m_pattern.nSeqRun / 4, 6));
+         plan.depth = std::max(plan.depth, plan.run);
+         break;
+      }
+      case AccessPattern::kStrided:
+      {
+         // the next few reads at the same stride, no whole file prefetch;
+         // the reads since the last repeated jump may have gone backwards
+         if (m_pattern.stride <= 0 || m_pattern.firstBlock + m_pattern.stride >= nBlocks)
+         {
+            plan.depth = 0;
+            break;
+         }
+         plan.stride = m_pattern.stride;
+         plan.span   = m_pattern.lastBlock - m_pattern.firstBlock;
+         plan.start  = m_pattern.firstBlock + plan.stride;
+         plan.count  = std::max(plan.depth, 4) * (plan.span + 1);
+         break;
+      }
+      case AccessPattern::kSparse:
+      {
+         plan.depth = 0;
+         break;
+      }
+   }
+}
+
+//______________________________________________________________________________
+void
+Prefetch::RecordAccess(long long off, long long size)
+{
+   if (size <= 0) return;
+
+   int first = (off - m_offset) / m_cfi.GetBufferSize();
+   int last  = (off - m_offset + size - 1) / m_cfi.GetBufferSize();
+
+   XrdSysMutexHelper _lck(&m_patternMutex);
+   AccessPattern::Kind_e prev = m_pattern.Classify();
+   m_pattern.Record(first, last);
+   AccessPattern::Kind_e kind = m_pattern.Classify();
+   if (kind != prev)
+   {
+      static const char* const names[] = { "sequential", "strided", "sparse" };
+      clLog()->Debug(XrdCl::AppMsg, "Prefetch::RecordAccess() access pattern changed to %s %s", names[kind], lPath());
+   }
+}
+
+//______________________________________________________________________________
+void
+Prefetch::PrefetchUsed(int firstBlockIdx, int lastBlockIdx)
+{
+   int blockOff = m_offset / m_cfi.GetBufferSize();
+
+   XrdSysMutexHelper _lck(&m_patternMutex);
+   for (int f = firstBlockIdx - blockOff; f <= lastBlockIdx - blockOff; ++f)
+   {
+      if (f >= 0 && f < (int) m_prefetched.size() && m_prefetched[f])
+      {
+         m_prefetched[f] = false;
+         m_stats.m_BytesPrefetchUsed += GetBlockBytes(f + blockOff);
+      }
+   }
+}
+
+//______________________________________________________________________________
+long long
+Prefetch::GetBlockBytes(int fileBlockIdx) const
+{
+   long long offset = fileBlockIdx * m_cfi.GetBufferSize();
+   long long size   = m_cfi.GetBufferSize();
+   // fix size if this is the last file block
+   if ( offset + size - m_offset > m_fileSize )
+      size = m_fileSize + m_offset - offset;
+   return size;
+}
+
+//______________________________________________________________________________
+bool
+Prefetch::IsInRam(int fileBlockIdx) const
+{
+   for (int r = 0; r < m_ram.m_numBlocks; ++r)
+   {
+      if (m_ram.m_blockStates[r].fileBlockIdx == fileBlockIdx) return true;
+   }
+   return false;
+}
+
+//______________________________________________________________________________
+int
+Prefetch::AllocRamBlock(int fileBlockIdx, bool fromRead)
+{
+   for (int r = 0; r < m_ram.m_numBlocks; ++r)
+   {
+      if (m_ram.m_blockStates[r].refCount == 0 )
+      {
+         assert(m_ram.m_blockStates[r].fileBlockIdx == -1);
+         char* buffer = Factory::GetInstance().RefRamPool().Alloc(m_ramUser, m_cfi.GetBufferSize(), fromRead);
+         if (!buffer) return -1;
+
+         m_ram.m_blockStates[r].refCount = 1;
+         m_ram.m_blockStates[r].fileBlockIdx = fileBlockIdx;
+         m_ram.m_blockStates[r].fromRead = fromRead;
+         m_ram.m_blockStates[r].status = kReadWait;
+         m_ram.m_blockStates[r].buffer = buffer;
+         return r;
+      }
+   }
+   return -1;
+}
+
 //______________________________________________________________________________
 Prefetch::Task*
 Prefetch::CreateTaskForFirstUndownloadedBlock()
@@ -363,65 +591,71 @@ Prefetch::CreateTaskForFirstUndownloadedBlock()
    // first check if there are enough write and ram resources
    if (Cache::HaveFreeWritingSlots() == false) return 0;
 
+   PrefetchPlan plan;
+   GetPrefetchPlan(plan);
+   if (plan.depth == 0) return 0;
+
    int nRP = 0;
    for (int i =0 ; i < m_ram.m_numBlocks; ++i) {
       if (m_ram.m_blockStates[i].fromRead == false && m_ram.m_blockStates[i].refCount > 0) nRP++;
    }
-   if ( nRP >= Factory::GetInstance().RefConfiguration().m_NRamBuffersPrefetch ) {
-      clLog()->Dump(XrdCl::AppMsg, "Prefetch::CreateTaskForFirstUndownloadedBlock no resources %d %d, %s ",  nRP, Factory::GetInstance().RefConfiguration().m_NRamBuffersPrefetch, lPath());
+   if ( nRP >= plan.depth ) {
+      clLog()->Dump(XrdCl::AppMsg, "Prefetch::CreateTaskForFirstUndownloadedBlock no resources %d %d, %s ",  nRP, plan.depth, lPath());
       return 0;
    }
 
-   Task *task = new Task;
-   Task &t = * task;
-   t.ramBlockIdx = -1;
-   int fileBlockIdx = -1;
-   for (int f = 0; f < m_cfi.GetSizeInBits(); ++f)
+   const int nBlocks  = m_cfi.GetSizeInBits();
+   const int blockOff = m_offset/m_cfi.GetBufferSize();
+   int  first   = -1;
+   bool pending = false;
+   std::vector<int> ramIdx;
+
+   m_ram.m_writeMutex.Lock();
+   for (int c = 0; c < plan.count; ++c)
    {
-      m_downloadStatusMutex.Lock();
+      int f = plan.start + (c / (plan.span + 1)) * plan.stride + c % (plan.span + 1);
+      if (plan.wrap) f %= nBlocks;
+      else if (f >= nBlocks) break;
+      if (f < 0) continue;
+
       bool isdn = m_cfi.TestBit(f);
-      m_downloadStatusMutex.UnLock();
+      if (isdn) continue;
 
-      if (!isdn)
+      // skip blocks which are already being downloaded
+      if (IsInRam(f + blockOff))
       {
-         fileBlockIdx = f + m_offset/m_cfi.GetBufferSize();
-         // get ram for the file block
-         m_ram.m_writeMutex.Lock();
-         for (int r =0 ; r < m_ram.m_numBlocks; ++r)
-         {
-
-            if (m_ram.m_blockStates[r].fileBlockIdx == fileBlockIdx)
-            {
-               // skip this task, the file block f is already downloaded
-               break;
-            }
-
-            if (m_ram.m_blockStates[r].refCount == 0 )
-            {
-               t.ramBlockIdx = r;
-
-               assert(m_ram.m_blockStates[r].fileBlockIdx == -1);
-               m_ram.m_blockStates[r].refCount = 1;
-               m_ram.m_blockStates[r].fileBlockIdx = fileBlockIdx;
-               m_ram.m_blockStates[r].status = kReadWait;
-               break;
-            }
-         }
-         m_ram.m_writeMutex.UnLock();
+         pending = true;
+         continue;
+      }
+      first = f;
+      break;
+   }
 
-         break;
+   // extend to a run of adjacent missing blocks fetched with one request
+   int maxRun = std::min(plan.run, plan.depth - nRP);
+   for (int f = first; f >= 0 && f < nBlocks && (int) ramIdx.size() < maxRun; ++f)
+   {
+      if (f != first)
+      {
+         bool isdn = m_cfi.TestBit(f);
+         if (isdn || IsInRam(f + blockOff)) break;
       }
+      int r = AllocRamBlock(f + blockOff, false);
+      if (r < 0) break;
+      ramIdx.push_back(r);
    }
+   m_ram.m_writeMutex.UnLock();
 
-   if (t.ramBlockIdx >= 0) {
-      clLog()->Dump(XrdCl::AppMsg, "Prefetch::CreateTaskForFirstUndownloadedBlock success block %d %s ",  fileBlockIdx, lPath());
+   if ( ! ramIdx.empty()) {
+      Task *task = new Task(ramIdx[0], 0);
+      task->run.assign(ramIdx.begin() + 1, ramIdx.end());
+      clLog()->Dump(XrdCl::AppMsg, "Prefetch::CreateTaskForFirstUndownloadedBlock success block %d run %d %s ",  first + blockOff, (int) ramIdx.size(), lPath());
       return task;
    }
-   else if (fileBlockIdx == -1) {
+   else if (first == -1 && ! pending && (plan.wrap || plan.start == 0)) {
       m_cfi.CheckComplete();
    }
 
-   delete task;
    return 0;
 }
 
@@ -482,93 +716,178 @@ Prefetch::GetNextTask()
 void
 Prefetch::DoTask(Task* task)
 {
-   // read block from client  into buffer
-   int fileBlockIdx = m_ram.m_blockStates[task->ramBlockIdx].fileBlockIdx;
+   std::vector<int> ramIdx(1, task->ramBlockIdx);
+   ramIdx.insert(ramIdx.end(), task->run.begin(), task->run.end());
+   const int n = ramIdx.size();
+
+   int  fileBlockIdx = m_ram.m_blockStates[task->ramBlockIdx].fileBlockIdx;
    long long offset  = fileBlockIdx * m_cfi.GetBufferSize();
+   long long missing = 0;
+   for (int i = 0; i < n; ++i)
+      missing += GetBlockBytes(fileBlockIdx + i);
 
-   long long  rw_size = m_cfi.GetBufferSize();
-   // fix size if this is the last file block
-   if ( offset + rw_size - m_offset > m_fileSize ) {
-      rw_size = m_fileSize + m_offset - offset;
-      assert (rw_size < m_cfi.GetBufferSize());
-   }
-   int   missing = rw_size;
-   int   cnt  = 0;
-   char* buff = m_ram.m_buffer;
-   buff += task->ramBlockIdx * m_cfi.GetBufferSize();
-   while (missing)
+   if (n == 1)
    {
-      clLog()->Dump(XrdCl::AppMsg, "Prefetch::DoTask() for block f = %d r = %dsingal = %p  %s", fileBlockIdx, task->ramBlockIdx, task->condVar,  lPath());
-      int retval = m_input.Read(buff, offset, missing);
-      if (retval < 0)
+      // read block from client  into buffer
+      int   cnt  = 0;
+      char* buff = m_ram.m_blockStates[task->ramBlockIdx].buffer;
+      while (missing)
       {
-         clLog()->Warning(XrdCl::AppMsg, "Prefetch::DoTask() failed for negative ret %d block %d %s", retval, fileBlockIdx , lPath());
-         break;
-      }
+         clLog()->Dump(XrdCl::AppMsg, "Prefetch::DoTask() for block f = %d r = %dsingal = %p  %s", fileBlockIdx, task->ramBlockIdx, task->condVar,  lPath());
+         int retval = m_input.Read(buff, offset, missing);
+         if (retval < 0)
+         {
+            clLog()->Warning(XrdCl::AppMsg, "Prefetch::DoTask() failed for negative ret %d block %d %s", retval, fileBlockIdx , lPath());
+            break;
+         }
 
-      missing -= retval;
-      offset  += retval;
-      buff    += retval;
-      ++cnt;
-      if (cnt > PREFETCH_MAX_ATTEMPTS)
+         missing -= retval;
+         offset  += retval;
+         buff    += retval;
+         ++cnt;
+         if (cnt > PREFETCH_MAX_ATTEMPTS)
+         {
+            break;
+         }
+      }
+   }
+   else
+   {
+      // adjacent blocks are read with one vector read, one round trip
+      std::vector<XrdOucIOVec> iov;
+      for (int i = 0; i < n; ++i)
       {
-         break;
+         long long bsize = GetBlockBytes(fileBlockIdx + i);
+         for (long long pos = 0; pos < bsize; pos += PREFETCH_READV_PIECE)
+         {
+            XrdOucIOVec v;
+            v.offset = (fileBlockIdx + i) * m_cfi.GetBufferSize() + pos;
+            v.size   = std::min(bsize - pos, (long long) PREFETCH_READV_PIECE);
+            v.info   = 0;
+            v.data   = m_ram.m_blockStates[ramIdx[i]].buffer + pos;
+            iov.push_back(v);
+         }
       }
+      clLog()->Dump(XrdCl::AppMsg, "Prefetch::DoTask() for blocks f = %d-%d %s", fileBlockIdx, fileBlockIdx + n - 1, lPath());
+      long long retval = ReadVBatched(m_input, &iov[0], iov.size());
+      if (retval == missing)
+         missing = 0;
+      else
+         clLog()->Warning(XrdCl::AppMsg, "Prefetch::DoTask() vector read failed ret %lld blocks %d-%d %s", retval, fileBlockIdx, fileBlockIdx + n - 1, lPath());
    }
 
    m_ram.m_writeMutex.Lock();
-   if (missing) {
-       m_ram.m_blockStates[task->ramBlockIdx].status = kReadFailed;
-       m_ram.m_blockStates[task->ramBlockIdx].readErrno = errno;
-   }
-   else {
-       m_ram.m_blockStates[task->ramBlockIdx].status = kReadSuccess;
-       m_ram.m_blockStates[task->ramBlockIdx].readErrno = 0;
+   for (int i = 0; i < n; ++i)
+   {
+      if (missing) {
+          m_ram.m_blockStates[ramIdx[i]].status = kReadFailed;
+          m_ram.m_blockStates[ramIdx[i]].readErrno = errno;
+      }
+      else {
+          m_ram.m_blockStates[ramIdx[i]].status = kReadSuccess;
+          m_ram.m_blockStates[ramIdx[i]].readErrno = 0;
+      }
    }
    m_ram.m_writeMutex.Broadcast();
    m_ram.m_writeMutex.UnLock();
 
    if (missing == 0)
    {
-      // queue for ram to disk write
-      XrdSysCondVarHelper monitor(m_stateCond);
-      if (!m_stopping) { Cache::AddWriteTask(this, task->ramBlockIdx, rw_size, task->condVar ? true : false );
-      }
-      else {
-         m_ram.m_blockStates[task->ramBlockIdx].refCount--;
+      if ( ! task->condVar)
+      {
+         XrdSysMutexHelper _lck(&m_patternMutex);
+         int blockOff = m_offset/m_cfi.GetBufferSize();
+         for (int i = 0; i < n; ++i)
+         {
+            m_prefetched[fileBlockIdx + i - blockOff] = true;
+            m_stats.m_BytesPrefetched += GetBlockBytes(fileBlockIdx + i);
+         }
       }
 
+      // queue for ram to disk write
+      for (int i = 0; i < n; ++i)
+      {
+         bool queued = false;
+         {
+            XrdSysCondVarHelper monitor(m_stateCond);
+            if (!m_stopping) {
+               Cache::AddWriteTask(this, ramIdx[i], fileBlockIdx + i, GetBlockBytes(fileBlockIdx + i), task->condVar ? true : false );
+               queued = true;
+            }
+         }
+         if (!queued)
+            DecRamBlockRefCount(ramIdx[i]);
+      }
    }
    else
    {
-      DecRamBlockRefCount(task->ramBlockIdx);
-      clLog()->Dump(XrdCl::AppMsg, "Prefetch::DoTask() incomplete read missing %d for block %d %s", missing, fileBlockIdx, lPath());
+      for (int i = 0; i < n; ++i)
+         DecRamBlockRefCount(ramIdx[i]);
+      clLog()->Dump(XrdCl::AppMsg, "Prefetch::DoTask() incomplete read missing %lld for block %d %s", missing, fileBlockIdx, lPath());
    }
 }
 
 //_________________________________________________________________________________________________
 void
-Prefetch::WriteBlockToDisk(int ramIdx, size_t size)
+Prefetch::WriteBlocksToDisk(const int* ramIdx, const size_t* size, int n)
 {
    // called from XrdFileCache::Cache when process queue
 
+   if (n > 1)
+   {
+      // blocks are adjacent in the file, write them with one call
+      std::vector<XrdOucIOVec> iov(n);
+      long long total = 0;
+      for (int i = 0; i < n; ++i)
+      {
+         assert(ramIdx[i] >=0 && ramIdx[i] < m_ram.m_numBlocks);
+         iov[i].offset = m_ram.m_blockStates[ramIdx[i]].fileBlockIdx * m_cfi.GetBufferSize() - m_offset;
+         iov[i].size   = size[i];
+         iov[i].info   = 0;
+         iov[i].data   = m_ram.m_blockStates[ramIdx[i]].buffer;
+         total += size[i];
+      }
+      if (m_output->WriteV(&iov[0], n) == total)
+      {
+         for (int i = 0; i < n; ++i) BlockWritten(ramIdx[i], size[i]);
+         return;
+      }
+      clLog()->Warning(XrdCl::AppMsg, "Prefetch::WriteToDisk() vector write of %d blocks failed, writing one by one %s", n, lPath());
+   }
+
+   for (int i = 0; i < n; ++i)
+   {
+      if (WriteBlock(ramIdx[i], size[i])) BlockWritten(ramIdx[i], size[i]);
+   }
+}
+
+//_________________________________________________________________________________________________
+bool
+Prefetch::WriteBlock(int ramIdx, size_t size)
+{
    int fileIdx = m_ram.m_blockStates[ramIdx].fileBlockIdx;
-   char* buff = m_ram.m_buffer;
-   buff += ramIdx*m_cfi.GetBufferSize();
    assert(ramIdx >=0 && ramIdx < m_ram.m_numBlocks);
-   int retval = 0;
+   char* buff = m_ram.m_blockStates[ramIdx].buffer;
+   ssize_t retval = 0;
 
    // write block buffer into disk file
    long long offset = fileIdx * m_cfi.GetBufferSize() - m_offset;
    int buffer_remaining = size;
    int buffer_offset = 0;
    int cnt = 0;
-   while ((buffer_remaining > 0) && // There is more to be written
-          (((retval = m_output->Write(buff, offset + buffer_offset, buffer_remaining)) != -1)
-           || (errno == EINTR))) // Write occurs without an error
+   while (buffer_remaining > 0) // There is more to be written
    {
-      buffer_remaining -= retval;
-      buff += retval;
+      retval = m_output->Write(buff + buffer_offset, offset + buffer_offset, buffer_remaining);
+      if (retval < 0 && retval != -EINTR)
+      {
+         clLog()->Error(XrdCl::AppMsg, "Prefetch::WriteToDisk() write failed %s", lPath());
+         return false;
+      }
+      if (retval > 0)
+      {
+         buffer_remaining -= retval;
+         buffer_offset    += retval;
+      }
       cnt++;
 
       if (buffer_remaining)
@@ -579,38 +898,37 @@ Prefetch::WriteBlockToDisk(int ramIdx, size_t size)
       if (cnt > PREFETCH_MAX_ATTEMPTS)
       {
          clLog()->Error(XrdCl::AppMsg, "Prefetch::WriteToDisk() write failes too manny attempts %s", lPath());
-         return;
+         return false;
       }
    }
+   return true;
+}
+
+//_________________________________________________________________________________________________
+void
+Prefetch::BlockWritten(int ramIdx, size_t size)
+{
+   int fileIdx = m_ram.m_blockStates[ramIdx].fileBlockIdx;
 
    // set bit fetched
    clLog()->Dump(XrdCl::AppMsg, "Prefetch::WriteToDisk() success set bit for block [%d] size [%d] %s", fileIdx, size, lPath());
    int pfIdx =  fileIdx - m_offset/m_cfi.GetBufferSize();
-   m_downloadStatusMutex.Lock();
+   AtomicBeg(m_downloadStatusMutex);
    m_cfi.SetBitFetched(pfIdx);
-   m_downloadStatusMutex.UnLock();
-
+   AtomicEnd(m_downloadStatusMutex);
 
-   // set bit synced
+   // the bit synced is set by Sync() after the data is flushed
    bool schedule_sync = false;
    {
       XrdSysMutexHelper _lck(&m_syncStatusMutex);
 
-      if (m_in_sync)
-      {
-         m_writes_during_sync.push_back(pfIdx);
-      }
-      else
-      {
-         m_cfi.SetBitWriteCalled(pfIdx);
-         ++m_non_flushed_cnt;
-      }
+      m_writes_pending.push_back(pfIdx);
+      ++m_non_flushed_cnt;
 
-      if (m_non_flushed_cnt >= 100)
+      if (!m_in_sync && m_non_flushed_cnt >= 100)
       {
          schedule_sync     = true;
          m_in_sync         = true;
-         m_non_flushed_cnt = 0;
       }
    }
 
@@ -625,27 +943,31 @@ void Prefetch::Sync()
 { 
    clLog()->Dump(XrdCl::AppMsg, "Prefetch::Sync %s", lPath());
 
+   std::vector<int> written;
+   {
+      XrdSysMutexHelper _lck(&m_syncStatusMutex);
+      written.swap(m_writes_pending);
+      m_non_flushed_cnt = 0;
+   }
+
+   // data first, so that a synced bit never refers to data lost in a crash
    m_output->Fsync();
 
+   for (std::vector<int>::iterator i = written.begin(); i != written.end(); ++i)
+   {
+      m_cfi.SetBitWriteCalled(*i);
+   }
    m_cfi.WriteHeader(m_infoFile);
+   m_infoFile->Fsync();
 
    int written_while_in_sync;
    {
       XrdSysMutexHelper _lck(&m_syncStatusMutex);
-
-      for (std::vector<int>::iterator i = m_writes_during_sync.begin(); i != m_writes_during_sync.end(); ++i)
-      {
-         m_cfi.SetBitWriteCalled(*i);
-      }
-      written_while_in_sync = m_non_flushed_cnt = (int) m_writes_during_sync.size();
-      m_writes_during_sync.clear();
-
+      written_while_in_sync = m_non_flushed_cnt;
       m_in_sync = false;
    }
 
    clLog()->Dump(XrdCl::AppMsg, "Prefetch::Sync %d blocks written during sync.", written_while_in_sync);
-
-   m_infoFile->Fsync();
 }
 
 //______________________________________________________________________________
@@ -661,6 +983,8 @@ void Prefetch::DecRamBlockRefCount(int ramIdx)
    m_ram.m_blockStates[ramIdx].refCount --;
    if (m_ram.m_blockStates[ramIdx].refCount == 0) {
        m_ram.m_blockStates[ramIdx].fileBlockIdx = -1;
+       Factory::GetInstance().RefRamPool().Free(m_ramUser, m_ram.m_blockStates[ramIdx].buffer);
+       m_ram.m_blockStates[ramIdx].buffer = 0;
    }
    m_ram.m_writeMutex.UnLock();
 }
@@ -692,11 +1016,16 @@ bool Prefetch::ReadFromTask(int iFileBlockIdx, char* iBuff, long long iOff, size
             if (m_ram.m_blockStates[i].refCount == 0)
             {
                assert(m_ram.m_blockStates[i].fileBlockIdx == -1);
+               char* buffer = Factory::GetInstance().RefRamPool().Alloc(m_ramUser, m_cfi.GetBufferSize(), true);
+               if (!buffer) break;
+
+               // one reference for the task and one for this read
                ramIdx = i;
-               m_ram.m_blockStates[i].refCount = 1;
+               m_ram.m_blockStates[i].refCount = 2;
                m_ram.m_blockStates[i].fileBlockIdx = iFileBlockIdx;
                m_ram.m_blockStates[i].fromRead = true;
                m_ram.m_blockStates[i].status = kReadWait;
+               m_ram.m_blockStates[i].buffer = buffer;
                break;
             }
          }
@@ -721,19 +1050,21 @@ bool Prefetch::ReadFromTask(int iFileBlockIdx, char* iBuff, long long iOff, size
 
             newTaskCond.Wait();
          }
-         if (m_ram.m_blockStates[ramIdx].status == kReadSuccess)
+         bool success = m_ram.m_blockStates[ramIdx].status == kReadSuccess;
+         if (success)
          {
             clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadFromTask memcpy from RAM to IO::buffer fileIdx=%d ", iFileBlockIdx);
             long long inBlockOff = iOff - iFileBlockIdx * m_cfi.GetBufferSize();
-            char* srcBuff = m_ram.m_buffer + ramIdx*m_cfi.GetBufferSize();
+            char* srcBuff = m_ram.m_blockStates[ramIdx].buffer;
             memcpy(iBuff, srcBuff + inBlockOff, iSize);
          }
          else
          {
             clLog()->Error(XrdCl::AppMsg, "Prefetch::ReadFromTask client fileIdx=%d failed", iFileBlockIdx);
          }
+         DecRamBlockRefCount(ramIdx);
 
-         return m_ram.m_blockStates[ramIdx].status == kReadSuccess;
+         return success;
       }
       else {
          clLog()->Debug(XrdCl::AppMsg, "Prefetch::ReadFromTask can't get free ram, not enough resources");
@@ -784,14 +1115,13 @@ ssize_t Prefetch::ReadInBlocks(char *buff, off_t off, size_t size)
       int retvalBlock = -1;
       // now do per block read at Read(buff, off, readBlockSize)
 
-      m_downloadStatusMutex.Lock();
       bool dsl = m_cfi.TestBit(blockIdx - m_offset/m_cfi.GetBufferSize());
-      m_downloadStatusMutex.UnLock();
 
       if (dsl)
       {
          retvalBlock = m_output->Read(buff, off - m_offset, readBlockSize);
          m_stats.m_BytesDisk += retvalBlock;
+         PrefetchUsed(blockIdx, blockIdx);
          clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadInBlocks [%d] disk = %d",blockIdx, retvalBlock);
       }
       else
@@ -819,10 +1149,11 @@ ssize_t Prefetch::ReadInBlocks(char *buff, off_t off, size_t size)
              if ( m_ram.m_blockStates[RamIdx].status == kReadSuccess) {
                  clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadInBlocks  ram = %d file block = %d", RamIdx, blockIdx);
                  int in_block_off = off - m_ram.m_blockStates[RamIdx].fileBlockIdx *m_cfi.GetBufferSize();
-                 char *rbuff = m_ram.m_buffer + RamIdx*m_cfi.GetBufferSize() + in_block_off;
+                 char *rbuff = m_ram.m_blockStates[RamIdx].buffer + in_block_off;
                  memcpy(buff, rbuff, readBlockSize);
                  DecRamBlockRefCount(RamIdx);
                  retvalBlock = readBlockSize;
+                 PrefetchUsed(blockIdx, blockIdx);
              }
              else  {
                  errno = m_ram.m_blockStates[RamIdx].readErrno;
@@ -884,14 +1215,12 @@ int Prefetch::ReadV (const XrdOucIOVec *readV, int n)
       }
    }
 
-   // check if read sizes are big enough to cache
-
-   XrdCl::XRootDStatus Status;
-   XrdCl::ChunkList chunkVec;
-   XrdCl::VectorReadInfo *vrInfo = 0;
-
-   std::vector<int> cachedReads;
+   const long long bs       = m_cfi.GetBufferSize();
+   const int       blockOff = m_offset / bs;
 
+   // split requests in those that can be served from disk or RAM and those
+   // that need some blocks from the remote file
+   std::vector<int> missing;
    int nbytes = 0;
    for (int i=0; i<n; i++)
    {
@@ -900,25 +1229,16 @@ int Prefetch::ReadV (const XrdOucIOVec *readV, int n)
       XrdSfsXferSize size = readV[i].size;
       XrdSfsFileOffset off = readV[i].offset;
       bool cached = true;
-      const int idx_first = off / m_cfi.GetBufferSize();
-      const int idx_last = (off + size - 1) / m_cfi.GetBufferSize();
+      const int idx_first = off / bs;
+      const int idx_last = (off + size - 1) / bs;
       for (int blockIdx = idx_first; blockIdx <= idx_last; ++blockIdx)
       {
          bool onDisk = false;
          bool inRam = false;
-         m_downloadStatusMutex.Lock();
-         onDisk = m_cfi.TestBit(blockIdx);
-         m_downloadStatusMutex.UnLock();
+         onDisk = m_cfi.TestBit(blockIdx - blockOff);
          if (!onDisk) {
             m_ram.m_writeMutex.Lock();
-            for (int ri = 0; ri < m_ram.m_numBlocks; ++ri )
-            {
-               if (m_ram.m_blockStates[ri].fileBlockIdx == blockIdx)
-               {
-                  inRam = true;
-                  break;
-               }
-            }
+            inRam = IsInRam(blockIdx);
             m_ram.m_writeMutex.UnLock();
          }
 
@@ -935,61 +1255,171 @@ int Prefetch::ReadV (const XrdOucIOVec *readV, int n)
       }
       else
       {
-         clLog()->Debug(XrdCl::AppMsg, "Prefetch::ReadV %d add back to client vector read ", i);
-         chunkVec.push_back(XrdCl::ChunkInfo((uint64_t)readV[i].offset,
-                                             (uint32_t)readV[i].size,
-                                             (void *)readV[i].data
-                                             ));
+         RecordAccess(readV[i].offset, readV[i].size);
+         missing.push_back(i);
       }
+   }
+   if (missing.empty()) return nbytes;
 
+   // Missing blocks are fetched whole into RAM, and then cached, if they are
+   // small or mostly needed. Requests touching blocks that are not fetched
+   // are read directly. Both go to the remote file in one vector read.
+   std::vector<int>  fetched;   // ram blocks filled by this read
+   std::vector<int>  fromRam;   // requests served from the cache afterwards
+   std::vector<XrdOucIOVec> iov;
+
+   m_ram.m_writeMutex.Lock();
+   int nRR = 0;
+   for (int i = 0; i < m_ram.m_numBlocks; ++i) {
+      if (m_ram.m_blockStates[i].fromRead && m_ram.m_blockStates[i].refCount > 0) nRR++;
    }
-   if (!chunkVec.empty()) {
-      XrdCl::File& clFile = ((XrdPosixFile&)m_input).clFile;
-      Status = clFile.VectorRead(chunkVec, (void *)0, vrInfo);
-      delete vrInfo;
+   bool canCache = Cache::HaveFreeWritingSlots();
 
-      if (!Status.IsOK())
+   for (std::vector<int>::iterator mi = missing.begin(); mi != missing.end(); ++mi)
+   {
+      const XrdOucIOVec &req = readV[*mi];
+      const int idx_first = req.offset / bs;
+      const int idx_last  = (req.offset + req.size - 1) / bs;
+      bool inCache = true;
+      for (int blockIdx = idx_first; blockIdx <= idx_last && inCache; ++blockIdx)
+      {
+         bool onDisk = m_cfi.TestBit(blockIdx - blockOff);
+         if (onDisk || IsInRam(blockIdx)) continue;
+
+         long long needed = std::min(req.offset + req.size, (blockIdx + 1) * bs) - std::max(req.offset, blockIdx * bs);
+         bool whole = bs <= PREFETCH_READV_WHOLE_BLOCK || 2 * needed >= bs;
+         int  r = -1;
+         if (canCache && whole && nRR < Factory::GetInstance().RefConfiguration().m_NRamBuffersRead)
+            r = AllocRamBlock(blockIdx, true);
+         if (r < 0)
+         {
+            inCache = false;
+            break;
+         }
+
+         // one reference for the disk write and one for this read
+         m_ram.m_blockStates[r].refCount = 2;
+         fetched.push_back(r);
+         nRR++;
+
+         long long bsize = GetBlockBytes(blockIdx);
+         for (long long pos = 0; pos < bsize; pos += PREFETCH_READV_PIECE)
+         {
+            XrdOucIOVec v;
+            v.offset = blockIdx * bs + pos;
+            v.size   = std::min(bsize - pos, (long long) PREFETCH_READV_PIECE);
+            v.info   = 0;
+            v.data   = m_ram.m_blockStates[r].buffer + pos;
+            iov.push_back(v);
+         }
+      }
+
+      if (inCache)
+      {
+         fromRam.push_back(*mi);
+      }
+      else
       {
-         XrdPosixMap::Result(Status);
-         return -1;
+         iov.push_back(req);
+         m_stats.m_BytesMissed += req.size;
       }
    }
-   return nbytes;
+   m_ram.m_writeMutex.UnLock();
+
+   long long expected = 0;
+   for (std::vector<XrdOucIOVec>::iterator vi = iov.begin(); vi != iov.end(); ++vi)
+      expected += vi->size;
+
+   clLog()->Debug(XrdCl::AppMsg, "Prefetch::ReadV %d requests, %d missing, %d blocks fetched, %d chunks to remote %s",
+                  n, (int) missing.size(), (int) fetched.size(), (int) iov.size(), lPath());
+
+   bool success = true;
+   if (!iov.empty())
+   {
+      // whole blocks are cut into pieces, so the count can exceed what the
+      // client sent and what the server accepts in one request
+      long long retval = ReadVBatched(m_input, &iov[0], iov.size());
+      success = (retval == expected);
+      if (!success)
+         clLog()->Warning(XrdCl::AppMsg, "Prefetch::ReadV remote vector read failed ret %lld %s", retval, lPath());
+   }
+
+   // release waiting readers of the fetched blocks and queue them for writing
+   m_ram.m_writeMutex.Lock();
+   for (std::vector<int>::iterator ri = fetched.begin(); ri != fetched.end(); ++ri)
+   {
+      m_ram.m_blockStates[*ri].status    = success ? kReadSuccess : kReadFailed;
+      m_ram.m_blockStates[*ri].readErrno = success ? 0 : errno;
+   }
+   m_ram.m_writeMutex.Broadcast();
+   m_ram.m_writeMutex.UnLock();
+
+   for (std::vector<int>::iterator ri = fetched.begin(); ri != fetched.end(); ++ri)
+   {
+      bool queued = false;
+      if (success)
+      {
+         XrdSysCondVarHelper monitor(m_stateCond);
+         if (!m_stopping) {
+            int fileBlockIdx = m_ram.m_blockStates[*ri].fileBlockIdx;
+            Cache::AddWriteTask(this, *ri, fileBlockIdx, GetBlockBytes(fileBlockIdx), true);
+            queued = true;
+         }
+      }
+      if (!queued)
+         DecRamBlockRefCount(*ri);
+   }
+
+   if (success)
+   {
+      for (std::vector<int>::iterator mi = fromRam.begin(); mi != fromRam.end(); ++mi)
+      {
+         if (ReadInBlocks(readV[*mi].data, readV[*mi].offset, readV[*mi].size) != readV[*mi].size)
+         {
+            success = false;
+            break;
+         }
+      }
+   }
+
+   for (std::vector<int>::iterator ri = fetched.begin(); ri != fetched.end(); ++ri)
+      DecRamBlockRefCount(*ri);
+
+   return success ? nbytes : -1;
 }
 //______________________________________________________________________________
 ssize_t
 Prefetch::Read(char *buff, off_t off, size_t size)
 {
+   // Reads of a fully cached file take no lock. The complete flag is only
+   // set once the data file is open.
+   if ( ! m_cfi.IsComplete())
    {
-      XrdSysCondVarHelper monitor(m_stateCond);
+      {
+         XrdSysCondVarHelper monitor(m_stateCond);
 
-      // AMT check if this can be done once during initalization
-      if (m_failed) return m_input.Read(buff, off, size);
+         // AMT check if this can be done once during initalization
+         if (m_failed) return m_input.Read(buff, off, size);
 
-      if ( ! m_started)
-      {
-         m_stateCond.Wait();
-         if (m_failed) return 0;
+         if ( ! m_started)
+         {
+            m_stateCond.Wait();
+            if (m_failed) return 0;
+         }
       }
-   }
 
-   clLog()->Dump(XrdCl::AppMsg, "Prefetch::Read()  off = %lld size = %lld. %s", off, size, lPath());
-
-   bool fileComplete;
-   m_downloadStatusMutex.Lock();
-   fileComplete = m_cfi.IsComplete();
-   m_downloadStatusMutex.UnLock();
+      clLog()->Dump(XrdCl::AppMsg, "Prefetch::Read()  off = %lld size = %lld. %s", off, size, lPath());
+      RecordAccess(off, size);
 
-   if (fileComplete)
-   {
-      int res = m_output->Read(buff, off - m_offset, size);
-      m_stats.m_BytesDisk += res;
-      return res;
-   }
-   else
-   {
-      return ReadInBlocks(buff, off, size);
+      if ( ! m_cfi.IsComplete())
+         return ReadInBlocks(buff, off, size);
    }
+
+   int res = m_output->Read(buff, off - m_offset, size);
+   m_stats.m_BytesDisk += res;
+   if (res > 0 && m_stats.m_BytesPrefetched > m_stats.m_BytesPrefetchUsed)
+      PrefetchUsed(off / m_cfi.GetBufferSize(), (off + res - 1) / m_cfi.GetBufferSize());
+   return res;
 }
 
 
@@ -1005,7 +1435,14 @@ void Prefetch::AppendIOStatToFileInfo()
       as.BytesDisk   = m_stats.m_BytesDisk;
       as.BytesRam    = m_stats.m_BytesRam;
       as.BytesMissed = m_stats.m_BytesMissed;
+      {
+         XrdSysMutexHelper _lck(&m_patternMutex);
+         as.BytesPrefetched   = m_stats.m_BytesPrefetched;
+         as.BytesPrefetchUsed = m_stats.m_BytesPrefetchUsed;
+      }
       m_cfi.AppendIOStat(as, (XrdOssDF*)m_infoFile);
+      Factory::GetInstance().RefPurgeIndex().Update(m_temp_filename + Info::m_infoExtension, as.DetachTime,
+                                                    m_cfi.GetNDownloadedBytes(), m_cfi.GetAccessCnt());
    }
    else
    {
@@ -20,10 +20,12 @@
 
 #include <string>
 #include <queue>
+#include <vector>
 
 #include "XrdCl/XrdClDefaultEnv.hh"
 
 #include "XrdFileCacheInfo.hh"
+#include "XrdFileCacheRamPool.hh"
 #include "XrdFileCacheStats.hh"
 
 class XrdJob;
@@ -69,9 +71,18 @@ namespace XrdFileCache
          Stats& GetStats() { return m_stats; }
 
          //----------------------------------------------------------------------
-         //! Write block to file on disk. Called from Cache.
+         //! \brief Write adjacent blocks to file on disk. Called from Cache.
+         //!
+         //! @param ramIdx in memory cache indices, in file block order
+         //! @param size   write size of each block
+         //! @param n      number of blocks
          //----------------------------------------------------------------------
-         void WriteBlockToDisk(int ramIdx, size_t size);
+         void WriteBlocksToDisk(const int* ramIdx, const size_t* size, int n);
+
+         //----------------------------------------------------------------------
+         //! Device of the data file on disk, used to select a write queue.
+         //----------------------------------------------------------------------
+         long long GetOutputDevice() const { return m_outputDevice; }
 
          //----------------------------------------------------------------------
          //! Decrease block reference count.
@@ -94,7 +105,7 @@ namespace XrdFileCache
          //! Read from disk, RAM, task, or client.
          ssize_t Read(char * buff, off_t offset, size_t size);
 
-         //! Vector read from disk if block is already downloaded, else ReadV from client.
+         //! Vector read from disk or RAM, missing blocks fetched with one ReadV from client.
          int ReadV (const XrdOucIOVec *readV, int n);
 
          //! Write cache statistics in *cinfo file.
@@ -108,6 +119,7 @@ namespace XrdFileCache
          {
             int            ramBlockIdx;  //!< idx in the in-memory buffer
             XrdSysCondVar *condVar;      //!< signal when complete
+            std::vector<int> run;        //!< following file blocks read with the same request
 
             Task(): ramBlockIdx(-1),  condVar(0) {}
             Task(int r, XrdSysCondVar *cv):
@@ -121,14 +133,14 @@ namespace XrdFileCache
              bool fromRead;     //!< is ram requested from prefetch or read
              ReadRamState_t status;       //!< read from client status
              int readErrno; //!< posix error on read fail
+             char* buffer;      //!< block from the shared pool while refCount > 0
 
-             RAMBlock():fileBlockIdx(-1), refCount(0), fromRead(false), status(kReadWait) {}
+             RAMBlock():fileBlockIdx(-1), refCount(0), fromRead(false), status(kReadWait), buffer(0) {}
          };
 
          struct RAM
          {
-           int         m_numBlocks;    //!< number of in memory blocks
-           char*       m_buffer;       //!< buffer m_numBlocks x size_of_block
+           int         m_numBlocks;    //!< max number of in memory blocks
            RAMBlock*   m_blockStates;  //!< referenced structure
            XrdSysCondVar m_writeMutex;   //!< write mutex
 
@@ -136,6 +148,48 @@ namespace XrdFileCache
            ~RAM();
          };
 
+         //----------------------------------------------------------------------
+         //! Recent client reads, used to steer prefetching.
+         //----------------------------------------------------------------------
+         struct AccessPattern
+         {
+            enum Kind_e { kSequential, kStrided, kSparse };
+
+            static const int s_window = 16; //!< number of reads classified
+
+            int  firstBlock;        //!< first block of the last read, -1 before any read
+            int  lastBlock;         //!< last block of the last read
+            int  delta;             //!< distance between the last two read starts
+            int  stride;            //!< last forward jump that repeated, 0 if none
+            int  nSeqRun;           //!< consecutive sequential reads
+            int  nKinds;            //!< reads in the window
+            int  kinds[s_window];   //!< ring buffer of read kinds
+            int  count[3];          //!< reads of each kind in the window
+
+            AccessPattern();
+
+            //! Classify read of blocks [first, last].
+            void   Record(int first, int last);
+
+            //! Dominant kind in the window, sequential until enough reads are seen.
+            Kind_e Classify() const;
+         };
+
+         //----------------------------------------------------------------------
+         //! Blocks to prefetch next, candidate c is block
+         //! start + (c / (span+1)) * stride + c % (span+1).
+         //----------------------------------------------------------------------
+         struct PrefetchPlan
+         {
+            int  start;   //!< first candidate block
+            int  stride;  //!< distance between candidate groups
+            int  span;    //!< extra blocks in each candidate group
+            int  count;   //!< number of candidates
+            bool wrap;    //!< wrap around the end of file, whole file prefetch
+            int  depth;   //!< max blocks prefetched at a time, 0 stops prefetching
+            int  run;     //!< max adjacent blocks fetched with one request
+         };
+
          //! Stop Run thread.
          void CloseCleanly();
 
@@ -151,21 +205,47 @@ namespace XrdFileCache
          //! Split read in blocks.
          ssize_t ReadInBlocks( char* buff, off_t offset, size_t size);
 
-         //! Prefetch block.
+         //! Prefetch block, or a run of adjacent blocks.
          Task*   CreateTaskForFirstUndownloadedBlock();
 
+         //! Decide where and how much to prefetch from the access pattern.
+         void    GetPrefetchPlan(PrefetchPlan& plan);
+
+         //! Record client read for the access pattern.
+         void    RecordAccess(long long off, long long size);
+
+         //! Count first client read of prefetched blocks in range.
+         void    PrefetchUsed(int firstBlockIdx, int lastBlockIdx);
+
+         //! Take a free in memory block for the file block, m_writeMutex must be held.
+         int     AllocRamBlock(int fileBlockIdx, bool fromRead);
+
+         //! Check if file block is in memory, m_writeMutex must be held.
+         bool    IsInRam(int fileBlockIdx) const;
+
+         //! Number of bytes in file block.
+         long long GetBlockBytes(int fileBlockIdx) const;
+
          //! Create task from read request and wait its completed.
          bool    ReadFromTask(int bIdx, char* buff, long long off, size_t size);
 
          //! Read from client into in memory cache, queue ram buffer for disk write.
          void    DoTask(Task* task);
 
+         //! Write one block, retrying partial writes.
+         bool    WriteBlock(int ramIdx, size_t size);
+
+         //! Mark block as written and schedule sync as needed.
+         void    BlockWritten(int ramIdx, size_t size);
+
          //! Log path
          const char* lPath() const;
           
          RAM             m_ram;            //!< in memory cache
+         RamPool::User   m_ramUser;        //!< usage of the shared block pool
 
          XrdOssDF       *m_output;         //!< file handle for data file on disk
+         long long       m_outputDevice;   //!< device of data file on disk
          XrdOssDF       *m_infoFile;       //!< file handle for data-info file on disk
          Info            m_cfi;            //!< download status of file blocks and access statistics
          XrdOucCacheIO  &m_input;          //!< original data source
@@ -181,17 +261,22 @@ namespace XrdFileCache
          bool            m_stopped;   //!< prefetch is stopped
          XrdSysCondVar   m_stateCond; //!< state condition variable
 
-         XrdSysMutex       m_downloadStatusMutex; //!< mutex locking access to m_cfi object
+         XrdSysMutex       m_downloadStatusMutex; //!< mutex locking m_cfi updates, bits are tested lock free
 
          std::deque<Task*> m_tasks_queue;  //!< download queue
          XrdSysCondVar     m_queueCond;    //!< m_tasks_queue condition variable
 
          Stats             m_stats;      //!< cache statistics, used in IO detach
 
+         // access pattern
+         XrdSysMutex       m_patternMutex; //!< mutex locking access pattern and prefetch statistics
+         AccessPattern     m_pattern;      //!< recent client reads
+         std::vector<bool> m_prefetched;   //!< blocks prefetched and not yet read
+
          // fsync
          XrdSysMutex       m_syncStatusMutex; //!< mutex locking fsync status
          XrdJob           *m_syncer;
-         std::vector<int>  m_writes_during_sync;
+         std::vector<int>  m_writes_pending;
          int               m_non_flushed_cnt;
          bool              m_in_sync;
    };
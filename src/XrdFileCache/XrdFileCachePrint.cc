@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <fcntl.h>
+#include <string.h>
 #include <vector>
 #include "XrdFileCachePrint.hh"
 #include "XrdOuc/XrdOucEnv.hh"
@@ -64,7 +65,8 @@ void Print::printFile(const std::string& path)
 
    for (int i = 0; i <cfi.GetAccessCnt(); ++i ) {
       Info::AStat a;
-      off += fh->Read(&a, off , sizeof(Info::AStat));
+      memset(&a, 0, sizeof(a));
+      off += fh->Read(&a, off , cfi.GetAStatSize());
       statv.push_back(a);
    }
 
@@ -88,7 +90,10 @@ void Print::printFile(const std::string& path)
       char s[1000];
       struct tm * p = localtime(&a.DetachTime);
       strftime(s, 1000, "%c", p);
-      printf("[%s], bytesDisk=%lld, bytesRAM=%lld, bytesMissed=%lld\n", s, a.BytesDisk, a.BytesRam, a.BytesMissed);
+      printf("[%s], bytesDisk=%lld, bytesRAM=%lld, bytesMissed=%lld", s, a.BytesDisk, a.BytesRam, a.BytesMissed);
+      if (cfi.GetVersion() >= 1)
+         printf(", bytesPrefetched=%lld, bytesPrefetchUsed=%lld", a.BytesPrefetched, a.BytesPrefetchUsed);
+      printf("\n");
    }
 
    delete fh;
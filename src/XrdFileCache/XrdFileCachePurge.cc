@@ -0,0 +1,339 @@
+//----------------------------------------------------------------------------------
+// Copyright (c) 2026 by the XRootD contributors
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include "XrdCl/XrdClLog.hh"
+#include "XrdCl/XrdClConstants.hh"
+#include "XrdOss/XrdOss.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+
+#include "XrdFileCachePurge.hh"
+
+using namespace XrdFileCache;
+
+namespace
+{
+   const char* const s_cpHeader = "pfc-purge-index 1\n";
+
+   //! Orders entries with the policy, used to sort purge candidates.
+   class PolicyLess
+   {
+      public:
+         PolicyLess(const PurgePolicy& p) : m_policy(p) {}
+
+         bool operator()(const std::pair<const std::string*, const PurgeEntry*>& a,
+                         const std::pair<const std::string*, const PurgeEntry*>& b) const
+         { return m_policy.Before(*a.second, *b.second); }
+
+      private:
+         const PurgePolicy& m_policy;
+   };
+}
+
+//______________________________________________________________________________
+
+
+PurgePolicy* PurgePolicy::Create(const char* name)
+{
+   if (!name) return NULL;
+   if (!strcmp(name, "lru")) return new PurgePolicyLRU;
+   if (!strcmp(name, "lfu")) return new PurgePolicyLFU;
+   return NULL;
+}
+
+//______________________________________________________________________________
+
+
+PurgeIndex::PurgeIndex() :
+   m_policy(new PurgePolicyLRU),
+   m_scanGen(0),
+   m_dirty(false)
+{}
+
+PurgeIndex::~PurgeIndex()
+{
+   delete m_policy;
+}
+
+//______________________________________________________________________________
+
+
+void PurgeIndex::SetPolicy(PurgePolicy* policy)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   delete m_policy;
+   m_policy = policy;
+}
+
+//______________________________________________________________________________
+
+
+void PurgeIndex::Attach(const std::string& path, long long nBytes, int nAccess)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   PurgeEntry &e = m_map[path];
+   if (!e.nAttached && !e.accessTime) e.accessTime = time(0);
+   e.nBytes  = nBytes;
+   e.nAccess = nAccess;
+   e.scanGen = m_scanGen;
+   e.nAttached++;
+   m_dirty = true;
+}
+
+//______________________________________________________________________________
+
+
+void PurgeIndex::Update(const std::string& path, time_t accessTime, long long nBytes, int nAccess)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   PurgeEntry &e = m_map[path];
+   e.accessTime = accessTime;
+   e.nBytes     = nBytes;
+   e.nAccess    = nAccess;
+   m_dirty = true;
+}
+
+//______________________________________________________________________________
+
+
+void PurgeIndex::Detach(const std::string& path)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   map_i it = m_map.find(path);
+   if (it != m_map.end() && it->second.nAttached > 0)
+      it->second.nAttached--;
+}
+
+//______________________________________________________________________________
+
+
+void PurgeIndex::BeginScan()
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   m_scanGen++;
+}
+
+void PurgeIndex::Add(const std::string& path, time_t accessTime, long long nBytes, int nAccess)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   PurgeEntry &e = m_map[path];
+   if (!e.nAttached)
+   {
+      e.accessTime = accessTime;
+      e.nBytes     = nBytes;
+      e.nAccess    = nAccess;
+   }
+   e.scanGen = m_scanGen;
+   m_dirty = true;
+}
+
+void PurgeIndex::EndScan()
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   map_i it = m_map.begin();
+   while (it != m_map.end())
+   {
+      if (it->second.scanGen != m_scanGen && !it->second.nAttached)
+         m_map.erase(it++);
+      else
+         ++it;
+   }
+   m_dirty = true;
+}
+
+//______________________________________________________________________________
+
+
+long long PurgeIndex::Select(long long nBytesReq, std::vector<Candidate>& cands) const
+{
+   typedef std::pair<const std::string*, const PurgeEntry*> ref_t;
+   std::vector<ref_t> refs;
+   long long nBytes = 0;
+
+   XrdSysMutexHelper lock(&m_mutex);
+
+   refs.reserve(m_map.size());
+   for (map_ci it = m_map.begin(); it != m_map.end(); ++it)
+   {
+      if (!it->second.nAttached)
+         refs.push_back(ref_t(&it->first, &it->second));
+   }
+   std::sort(refs.begin(), refs.end(), PolicyLess(*m_policy));
+
+   for (std::vector<ref_t>::iterator it = refs.begin(); it != refs.end() && nBytes < nBytesReq; ++it)
+   {
+      cands.push_back(Candidate(*it->first, it->second->nBytes));
+      nBytes += it->second->nBytes;
+   }
+   return nBytes;
+}
+
+//______________________________________________________________________________
+
+
+bool PurgeIndex::Remove(const std::string& path)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   map_i it = m_map.find(path);
+   if (it != m_map.end())
+   {
+      if (it->second.nAttached) return false;
+      m_map.erase(it);
+      m_dirty = true;
+   }
+   return true;
+}
+
+//______________________________________________________________________________
+
+
+int PurgeIndex::Size() const
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   return m_map.size();
+}
+
+//______________________________________________________________________________
+
+
+bool PurgeIndex::Load(XrdOss* oss, const std::string& user, const std::string& path)
+{
+   XrdOucEnv   env;
+   struct stat st;
+   XrdOssDF   *fh = oss->newFile(user.c_str());
+   if (!fh) return false;
+
+   if (fh->Open(path.c_str(), O_RDONLY, 0600, env) < 0 || fh->Fstat(&st) < 0)
+   {
+      delete fh;
+      return false;
+   }
+
+   std::vector<char> buff(st.st_size + 1);
+   long long off = 0;
+   while (off < st.st_size)
+   {
+      ssize_t rc = fh->Read(&buff[off], off, st.st_size - off);
+      if (rc <= 0) break;
+      off += rc;
+   }
+   fh->Close();
+   delete fh;
+   buff[off] = 0;
+
+   size_t hlen = strlen(s_cpHeader);
+   if (off < (long long)hlen || strncmp(&buff[0], s_cpHeader, hlen))
+   {
+      clLog()->Warning(XrdCl::AppMsg, "PurgeIndex::Load() invalid checkpoint %s", path.c_str());
+      return false;
+   }
+
+   // Each line is: <access time> <bytes> <accesses> <info file path>
+   int   nLoaded = 0;
+   char *lp = &buff[hlen], *np;
+   XrdSysMutexHelper lock(&m_mutex);
+   for ( ; *lp; lp = np)
+   {
+      long long atm, nb;
+      int       nacc, pos = 0;
+
+      if ((np = index(lp, '\n'))) *np++ = 0;
+      else np = lp + strlen(lp);
+
+      if (sscanf(lp, "%lld %lld %d %n", &atm, &nb, &nacc, &pos) != 3 || !lp[pos])
+         continue;
+
+      std::pair<map_i, bool> ret = m_map.insert(std::make_pair(std::string(lp + pos), PurgeEntry()));
+      if (ret.second)
+      {
+         ret.first->second.accessTime = (time_t) atm;
+         ret.first->second.nBytes     = nb;
+         ret.first->second.nAccess    = nacc;
+         ret.first->second.scanGen    = m_scanGen;
+         nLoaded++;
+      }
+   }
+   clLog()->Info(XrdCl::AppMsg, "PurgeIndex::Load() loaded %d entries from %s", nLoaded, path.c_str());
+   return true;
+}
+
+//______________________________________________________________________________
+
+
+bool PurgeIndex::Checkpoint(XrdOss* oss, const std::string& user, const std::string& path)
+{
+   std::string data(s_cpHeader);
+   char        line[64];
+
+   {
+      XrdSysMutexHelper lock(&m_mutex);
+      if (!m_dirty) return true;
+      for (map_ci it = m_map.begin(); it != m_map.end(); ++it)
+      {
+         snprintf(line, sizeof(line), "%lld %lld %d ", (long long) it->second.accessTime,
+                  it->second.nBytes, it->second.nAccess);
+         data += line;
+         data += it->first;
+         data += '\n';
+      }
+      m_dirty = false;
+   }
+
+   // Write to a temporary file and rename it so a crash never leaves a
+   // truncated checkpoint behind.
+   XrdOucEnv   env;
+   std::string tmp = path + ".tmp";
+   oss->Unlink(tmp.c_str());
+   XrdOssDF *fh = oss->newFile(user.c_str());
+   bool      ok = fh && oss->Create(user.c_str(), tmp.c_str(), 0600, env, XRDOSS_mkpath) >= 0
+                     && fh->Open(tmp.c_str(), O_RDWR, 0600, env) >= 0;
+   if (ok)
+   {
+      long long off = 0, len = data.size();
+      while (off < len)
+      {
+         ssize_t rc = fh->Write(data.data() + off, off, len - off);
+         if (rc <= 0) { ok = false; break; }
+         off += rc;
+      }
+      // The data must be on disk before the rename makes it the checkpoint.
+      if (ok && fh->Fsync() < 0) ok = false;
+      fh->Close();
+   }
+   delete fh;
+
+   // XrdOss::Rename() refuses an existing target, replace the previous
+   // checkpoint with rename(2) on the physical paths instead.
+   char tmpPfn[MAXPATHLEN+1], pfn[MAXPATHLEN+1];
+   if (ok && !oss->Lfn2Pfn(tmp.c_str(),  tmpPfn, sizeof(tmpPfn))
+          && !oss->Lfn2Pfn(path.c_str(), pfn,    sizeof(pfn))
+          && !rename(tmpPfn, pfn))
+      return true;
+
+   clLog()->Error(XrdCl::AppMsg, "PurgeIndex::Checkpoint() can't write %s", path.c_str());
+   oss->Unlink(tmp.c_str());
+   XrdSysMutexHelper lock(&m_mutex);
+   m_dirty = true;
+   return false;
+}
@@ -0,0 +1,220 @@
+#ifndef __XRDFILECACHE_PURGE_HH__
+#define __XRDFILECACHE_PURGE_HH__
+//----------------------------------------------------------------------------------
+// Copyright (c) 2026 by the XRootD contributors
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <time.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "XrdSys/XrdSysPthread.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+
+class XrdOss;
+
+namespace XrdCl
+{
+   class Log;
+}
+
+namespace XrdFileCache
+{
+   //----------------------------------------------------------------------------
+   //! Usage of a cached file as known to the purge index.
+   //----------------------------------------------------------------------------
+   struct PurgeEntry
+   {
+      time_t    accessTime; //!< latest detach (or attach) time
+      long long nBytes;     //!< downloaded bytes
+      int       nAccess;    //!< number of recorded accesses
+      int       nAttached;  //!< number of prefetch objects using the file
+      int       scanGen;    //!< generation of the last scan or attach
+
+      PurgeEntry() : accessTime(0), nBytes(0), nAccess(0), nAttached(0), scanGen(0) {}
+   };
+
+   //----------------------------------------------------------------------------
+   //! Eviction policy used to order purge candidates.
+   //----------------------------------------------------------------------------
+   class PurgePolicy
+   {
+      public:
+         virtual ~PurgePolicy() {}
+
+         //---------------------------------------------------------------------
+         //! Policy name as used in the pfc.purgepolicy directive.
+         //---------------------------------------------------------------------
+         virtual const char* Name() const = 0;
+
+         //---------------------------------------------------------------------
+         //! Return true if file a should be purged before file b.
+         //---------------------------------------------------------------------
+         virtual bool Before(const PurgeEntry& a, const PurgeEntry& b) const = 0;
+
+         //---------------------------------------------------------------------
+         //! Create one of the built-in policies (lru or lfu), NULL if unknown.
+         //---------------------------------------------------------------------
+         static PurgePolicy* Create(const char* name);
+   };
+
+   //----------------------------------------------------------------------------
+   //! Least recently used files are purged first.
+   //----------------------------------------------------------------------------
+   class PurgePolicyLRU : public PurgePolicy
+   {
+      public:
+         virtual const char* Name() const { return "lru"; }
+
+         virtual bool Before(const PurgeEntry& a, const PurgeEntry& b) const
+         { return a.accessTime < b.accessTime; }
+   };
+
+   //----------------------------------------------------------------------------
+   //! Least frequently used files are purged first, ties broken by age.
+   //----------------------------------------------------------------------------
+   class PurgePolicyLFU : public PurgePolicy
+   {
+      public:
+         virtual const char* Name() const { return "lfu"; }
+
+         virtual bool Before(const PurgeEntry& a, const PurgeEntry& b) const
+         {
+            if (a.nAccess != b.nAccess) return a.nAccess < b.nAccess;
+            return a.accessTime < b.accessTime;
+         }
+   };
+
+   //----------------------------------------------------------------------------
+   //! \brief In-memory index of cached files used by the disk cache purge.
+   //!
+   //! The index is keyed by the path of the info file. It is kept current by
+   //! the prefetch objects on attach and detach, so that a purge pass does
+   //! not need to walk the cache directory. The index is checkpointed to a
+   //! file in the cache directory and reloaded on restart. A full scan is
+   //! only needed when there is no checkpoint or when the index turns out
+   //! to be out of step with the disk.
+   //----------------------------------------------------------------------------
+   class PurgeIndex
+   {
+      public:
+         struct Candidate
+         {
+            std::string path;   //!< info file path
+            long long   nBytes; //!< downloaded bytes
+
+            Candidate(const std::string& p, long long n) : path(p), nBytes(n) {}
+         };
+
+         //---------------------------------------------------------------------
+         //! Constructor.
+         //---------------------------------------------------------------------
+         PurgeIndex();
+
+         //---------------------------------------------------------------------
+         //! Destructor.
+         //---------------------------------------------------------------------
+         ~PurgeIndex();
+
+         //---------------------------------------------------------------------
+         //! Set eviction policy. The index takes ownership.
+         //---------------------------------------------------------------------
+         void SetPolicy(PurgePolicy* policy);
+
+         //---------------------------------------------------------------------
+         //! Get eviction policy.
+         //---------------------------------------------------------------------
+         const PurgePolicy& RefPolicy() const { return *m_policy; }
+
+         //---------------------------------------------------------------------
+         //! Mark file as in use. Called when a prefetch object opens it.
+         //---------------------------------------------------------------------
+         void Attach(const std::string& path, long long nBytes, int nAccess);
+
+         //---------------------------------------------------------------------
+         //! Record access statistics. Called when they are written to the
+         //! info file.
+         //---------------------------------------------------------------------
+         void Update(const std::string& path, time_t accessTime, long long nBytes, int nAccess);
+
+         //---------------------------------------------------------------------
+         //! Mark file as no longer used by the calling prefetch object.
+         //---------------------------------------------------------------------
+         void Detach(const std::string& path);
+
+         //---------------------------------------------------------------------
+         //! Start a full scan. Files not added before EndScan() are dropped.
+         //---------------------------------------------------------------------
+         void BeginScan();
+
+         //---------------------------------------------------------------------
+         //! Add or refresh a file found by a full scan.
+         //---------------------------------------------------------------------
+         void Add(const std::string& path, time_t accessTime, long long nBytes, int nAccess);
+
+         //---------------------------------------------------------------------
+         //! Finish a full scan.
+         //---------------------------------------------------------------------
+         void EndScan();
+
+         //---------------------------------------------------------------------
+         //! \brief Select files to purge in policy order.
+         //!
+         //! @param nBytesReq  number of bytes the candidates should add up to
+         //! @param cands      selected candidates, files in use are skipped
+         //!
+         //! @return number of bytes selected
+         //---------------------------------------------------------------------
+         long long Select(long long nBytesReq, std::vector<Candidate>& cands) const;
+
+         //---------------------------------------------------------------------
+         //! Remove file from the index. Returns false, and keeps the entry,
+         //! if the file has been attached since it was selected.
+         //---------------------------------------------------------------------
+         bool Remove(const std::string& path);
+
+         //---------------------------------------------------------------------
+         //! Load checkpoint. Existing entries are kept.
+         //---------------------------------------------------------------------
+         bool Load(XrdOss* oss, const std::string& user, const std::string& path);
+
+         //---------------------------------------------------------------------
+         //! Write checkpoint if the index changed since the last one.
+         //---------------------------------------------------------------------
+         bool Checkpoint(XrdOss* oss, const std::string& user, const std::string& path);
+
+         //---------------------------------------------------------------------
+         //! Number of indexed files.
+         //---------------------------------------------------------------------
+         int Size() const;
+
+      private:
+         typedef std::map<std::string, PurgeEntry> map_t;
+         typedef map_t::iterator                   map_i;
+         typedef map_t::const_iterator             map_ci;
+
+         XrdCl::Log* clLog() const { return XrdCl::DefaultEnv::GetLog(); }
+
+         mutable XrdSysMutex m_mutex;   //!< protects all members
+         map_t               m_map;     //!< entries by info file path
+         PurgePolicy        *m_policy;  //!< eviction order
+         int                 m_scanGen; //!< current scan generation
+         bool                m_dirty;   //!< changed since last checkpoint
+   };
+}
+
+#endif
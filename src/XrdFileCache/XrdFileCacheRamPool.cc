@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------------
+// Copyright (c) 2026 by the XRootD contributors
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <stdlib.h>
+
+#include "XrdFileCacheRamPool.hh"
+
+using namespace XrdFileCache;
+
+RamPool::RamPool() :
+   m_blockSize(0),
+   m_nTotal(0),
+   m_nAllocated(0),
+   m_nUsed(0),
+   m_nActive(0),
+   m_nReserve(0)
+{}
+
+RamPool::~RamPool()
+{
+   for (std::vector<char*>::iterator i = m_free.begin(); i != m_free.end(); ++i)
+      free(*i);
+}
+
+//______________________________________________________________________________
+
+
+void RamPool::Configure(long long blockSize, long long maxBytes)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   m_blockSize = blockSize;
+   m_nTotal    = maxBytes / blockSize;
+   if (m_nTotal < 1) m_nTotal = 1;
+   // keep 1/8 of the pool for demand reads
+   m_nReserve  = m_nTotal / 8;
+   m_free.reserve(m_nTotal);
+}
+
+//______________________________________________________________________________
+
+
+void RamPool::Activate(User& u)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   if (!u.active)
+   {
+      u.active = true;
+      m_nActive++;
+   }
+}
+
+void RamPool::Deactivate(User& u)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   if (u.active)
+   {
+      u.active = false;
+      m_nActive--;
+   }
+}
+
+//______________________________________________________________________________
+
+
+char* RamPool::Alloc(User& u, long long size, bool demand)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+
+   if (size > m_blockSize) return NULL;
+
+   int nFree  = m_nTotal - m_nUsed;
+   int nFair  = m_nTotal / (m_nActive > 0 ? m_nActive : 1);
+   if (nFair < 1) nFair = 1;
+
+   // Prefetching stays within the fair share and leaves the reserve alone.
+   // Demand reads may go over the fair share while there is spare memory.
+   bool grant;
+   if (demand)
+      grant = nFree > 0 && (u.nUsed < nFair || nFree > m_nReserve);
+   else
+      grant = nFree > m_nReserve && u.nUsed < nFair;
+   if (!grant) return NULL;
+
+   char* block;
+   if (!m_free.empty())
+   {
+      block = m_free.back();
+      m_free.pop_back();
+   }
+   else
+   {
+      if (!(block = (char*) malloc(m_blockSize))) return NULL;
+      m_nAllocated++;
+   }
+   m_nUsed++;
+   u.nUsed++;
+   return block;
+}
+
+//______________________________________________________________________________
+
+
+void RamPool::Free(User& u, char* block)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   m_free.push_back(block);
+   m_nUsed--;
+   u.nUsed--;
+}
+
+//______________________________________________________________________________
+
+
+void RamPool::GetUsage(int& nUsed, int& nTotal, int& nActive) const
+{
+   XrdSysMutexHelper lock(&m_mutex);
+   nUsed   = m_nUsed;
+   nTotal  = m_nTotal;
+   nActive = m_nActive;
+}
@@ -0,0 +1,109 @@
+#ifndef __XRDFILECACHE_RAMPOOL_HH__
+#define __XRDFILECACHE_RAMPOOL_HH__
+//----------------------------------------------------------------------------------
+// Copyright (c) 2026 by the XRootD contributors
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <vector>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+namespace XrdFileCache
+{
+   //----------------------------------------------------------------------------
+   //! \brief Pool of in-memory cache blocks shared by all prefetch objects.
+   //!
+   //! The pool holds at most a configured number of blocks. Blocks are
+   //! allocated on first use and kept on a free list afterwards. A fair share
+   //! of the pool is computed from the number of active files. Prefetching
+   //! is limited to the fair share and may not use the last blocks, which are
+   //! kept for demand reads. Demand reads may exceed the fair share while the
+   //! pool has spare blocks, so a hot file can hold more blocks than a cold
+   //! one. Blocks return to the pool as soon as they are written to disk.
+   //----------------------------------------------------------------------------
+   class RamPool
+   {
+      public:
+         //---------------------------------------------------------------------
+         //! Per-file pool usage, owned by the prefetch object.
+         //---------------------------------------------------------------------
+         struct User
+         {
+            int  nUsed;   //!< blocks held
+            bool active;  //!< counted for the fair share
+
+            User() : nUsed(0), active(false) {}
+         };
+
+         //---------------------------------------------------------------------
+         //! Constructor.
+         //---------------------------------------------------------------------
+         RamPool();
+
+         //---------------------------------------------------------------------
+         //! Destructor.
+         //---------------------------------------------------------------------
+         ~RamPool();
+
+         //---------------------------------------------------------------------
+         //! Set block size and total size. Called once at configuration.
+         //---------------------------------------------------------------------
+         void Configure(long long blockSize, long long maxBytes);
+
+         //---------------------------------------------------------------------
+         //! Include file in the fair share computation.
+         //---------------------------------------------------------------------
+         void Activate(User& u);
+
+         //---------------------------------------------------------------------
+         //! Exclude file from the fair share computation.
+         //---------------------------------------------------------------------
+         void Deactivate(User& u);
+
+         //---------------------------------------------------------------------
+         //! \brief Get a block.
+         //!
+         //! @param u       file requesting the block
+         //! @param size    required block size
+         //! @param demand  true for a client read, false for prefetching
+         //!
+         //! @return block or NULL if the request can not be granted now
+         //---------------------------------------------------------------------
+         char* Alloc(User& u, long long size, bool demand);
+
+         //---------------------------------------------------------------------
+         //! Return a block.
+         //---------------------------------------------------------------------
+         void Free(User& u, char* block);
+
+         //---------------------------------------------------------------------
+         //! Get number of blocks in use and the pool size.
+         //---------------------------------------------------------------------
+         void GetUsage(int& nUsed, int& nTotal, int& nActive) const;
+
+      private:
+         mutable XrdSysMutex m_mutex;
+         std::vector<char*>  m_free;       //!< allocated blocks not in use
+         long long           m_blockSize;  //!< size of each block
+         int                 m_nTotal;     //!< max number of blocks
+         int                 m_nAllocated; //!< blocks allocated so far
+         int                 m_nUsed;      //!< blocks in use
+         int                 m_nActive;    //!< active files
+         int                 m_nReserve;   //!< blocks kept for demand reads
+   };
+}
+
+#endif
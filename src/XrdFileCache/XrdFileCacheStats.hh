@@ -35,11 +35,14 @@ namespace XrdFileCache
          //----------------------------------------------------------------------
          Stats() {
             m_BytesDisk = m_BytesRam = m_BytesMissed = 0;
+            m_BytesPrefetched = m_BytesPrefetchUsed = 0;
          }
 
          long long m_BytesDisk;   //!< number of bytes served from disk cache
          long long m_BytesRam;    //!< number of bytes served from RAM cache
          long long m_BytesMissed; //!< number of bytes served directly from XrdCl
+         long long m_BytesPrefetched;   //!< number of bytes downloaded by prefetching
+         long long m_BytesPrefetchUsed; //!< number of prefetched bytes later read
 
          inline void AddStat(Stats &Src)
          {
@@ -49,6 +52,8 @@ namespace XrdFileCache
             m_BytesDisk += Src.m_BytesDisk;
             m_BytesRam += Src.m_BytesRam;
             m_BytesMissed += Src.m_BytesMissed;
+            m_BytesPrefetched += Src.m_BytesPrefetched;
+            m_BytesPrefetchUsed += Src.m_BytesPrefetchUsed;
 
             m_MutexXfc.UnLock();
          }
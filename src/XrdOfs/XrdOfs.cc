@@ -106,6 +106,8 @@ XrdOfsStats      OfsStats;
   
 XrdOfsHandle     *XrdOfs::dummyHandle;
 
+XrdCksCalc       *XrdOfs::CksWObj = 0;
+
 int               XrdOfs::MaxDelay = 60;
 int               XrdOfs::OSSDelay = 30;
 
@@ -635,6 +637,13 @@ int XrdOfsFile::open(const char          *path,      // In
        dorawio = (open_mode & SFS_O_RAWIO ? 1 : 0);
       }
    oP.hP->Activate(oP.fP);
+
+// If the file starts out empty, calculate its checksum as it is written
+//
+   if (isRW && XrdOfsFS->CksWObj && (open_flag & (O_TRUNC | O_EXCL)))
+      {XrdCksCalc *csP = XrdOfsFS->CksWObj->New();
+       if (csP) oP.hP->Wcks = new XrdOfsHanCks(csP);
+      }
    oP.hP->UnLock();
 
 // Send an open event if we must
@@ -680,6 +689,8 @@ int XrdOfsFile::close()  // In
    static XrdOfsHanCB *hCB = static_cast<XrdOfsHanCB *>(new CloseFH);
 
    XrdOfsHandle *hP;
+   XrdOfsHanCks *wcP = 0;
+   char pathbuff[MAXPATHLEN+8];
    int   poscNum, retc, cRetc = 0;
    short theMode;
 
@@ -743,15 +754,23 @@ int XrdOfsFile::close()  // In
    &&  XrdOfsFS->evsObject->Enabled(hP->isRW ? XrdOfsEvs::Closew
                                              : XrdOfsEvs::Closer))
       {long long FSize, *retsz;
-       char pathbuff[MAXPATHLEN+8];
        XrdOfsEvs::Event theEvent;
        if (hP->isRW) {theEvent = XrdOfsEvs::Closew; retsz = &FSize;}
           else {      theEvent = XrdOfsEvs::Closer; retsz = 0; FSize=0;}
-       if (!(hP->Retire(cRetc, retsz, pathbuff, sizeof(pathbuff))))
+       if (!(hP->Retire(cRetc, retsz, pathbuff, sizeof(pathbuff), &wcP)))
           {XrdOfsEvsInfo evInfo(tident, pathbuff, "" , 0, 0, FSize);
            XrdOfsFS->evsObject->Notify(theEvent, evInfo);
           }
-      } else hP->Retire(cRetc);
+      } else hP->Retire(cRetc, 0, pathbuff, sizeof(pathbuff), &wcP);
+
+// If this was the final close of a file whose checksum was calculated while
+// it was written, record the checksum. Otherwise, it will be calculated by
+// reading the file when someone asks for it.
+//
+   if (wcP)
+      {if (!cRetc) SetCks(pathbuff, wcP);
+       delete wcP;
+      }
 
 // All done
 //
@@ -1024,6 +1043,10 @@ XrdSfsXferSize XrdOfsFile::write(XrdSfsFileOffset  offset,    // In
    if (nbytes < 0)
       return XrdOfsFS->Emsg(epname, error, (int)nbytes, "write", oh);
 
+// Add the data to the checksum being calculated
+//
+   if (oh->Wcks) oh->Wcks->Update(buff, offset, nbytes);
+
 // Return number of bytes written
 //
    return nbytes;
@@ -1046,8 +1069,9 @@ int XrdOfsFile::write(XrdSfsAio *aiop)
 
 // If this is a POSC file, we must convert the async call to a sync call as we
 // must trap any errors that unpersist the file. We can't do that via aio i/f.
+// The same applies if we calculate the checksum as the file is written.
 //
-   if (oh->isRW == XrdOfsHandle::opPC)
+   if (oh->isRW == XrdOfsHandle::opPC || oh->Wcks)
       {aiop->Result = this->write(aiop->sfsAio.aio_offset,
                                   (const char *)aiop->sfsAio.aio_buf,
                                   aiop->sfsAio.aio_nbytes);
@@ -1230,6 +1254,10 @@ int XrdOfsFile::truncate(XrdSfsFileOffset  flen)  // In
    if ((retc = oh->Select().Ftruncate(flen)))
       return XrdOfsFS->Emsg(epname, error, retc, "truncate", oh);
 
+// Unless nothing changed, the checksum can't be calculated while writing
+//
+   if (oh->Wcks) oh->Wcks->Trunc(flen);
+
 // Indicate Success
 //
    return SFS_OK;
@@ -1281,6 +1309,35 @@ void XrdOfsFile::GenFWEvent()
       }
 }
 
+/******************************************************************************/
+/* private                        S e t C k s                                 */
+/******************************************************************************/
+
+void XrdOfsFile::SetCks(const char *path, XrdOfsHanCks *wcP)
+{
+   XrdCksData  cksData;
+   XrdCksCalc *csP;
+   char pfnbuff[MAXPATHLEN+8];
+   long long csLen;
+   int csSize, rc;
+
+// Get the checksum, which is only there if the whole file was written in order
+//
+   if (!(csP = wcP->Calc(csLen))) return;
+   cksData.Set(csP->Type(csSize));
+   memcpy(cksData.Value, csP->Final(), csSize);
+   cksData.Length = csSize;
+   csP->Recycle();
+
+// Record the checksum so that it need not be calculated by reading the file
+//
+   if (XrdOfsFS->CksPfn
+   &&  !(path = XrdOfsOss->Lfn2Pfn(path, pfnbuff, MAXPATHLEN, rc)))
+      {OfsEroute.Emsg("Close", rc, "set checksum for", path); return;}
+   if ((rc = XrdOfsFS->Cks->Set(path, cksData)))
+      OfsEroute.Emsg("Close", rc, "set checksum for", path);
+}
+
 /******************************************************************************/
 /*                                                                            */
 /*         F i l e   S y s t e m   O b j e c t   I n t e r f a c e s          */
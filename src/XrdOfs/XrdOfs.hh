@@ -97,6 +97,7 @@ char           dname[MAXNAMLEN];
 /*                            X r d O f s F i l e                             */
 /******************************************************************************/
 
+class XrdOfsHanCks;
 class XrdOfsTPC;
   
 class XrdOfsFile : public XrdSfsFile
@@ -164,6 +165,7 @@ protected:
 private:
 
 void           GenFWEvent();
+void           SetCks(const char *path, XrdOfsHanCks *wcP);
 
 XrdOfsHandle  *oh;
 XrdOfsTPC     *myTPC;
@@ -177,6 +179,7 @@ char           viaDel;
 
 class XrdAccAuthorize;
 class XrdCks;
+class XrdCksCalc;
 class XrdCmsClient;
 class XrdOfsConfigPI;
 class XrdOfsPoscq;
@@ -302,7 +305,8 @@ enum {Authorize = 0x0001,    // Authorization wanted
       haveRole  = 0x01F0,    // A role is present
       Forwarding= 0x1000,    // Fowarding wanted
       ThirdPC   = 0x2000,    // This party copy wanted
-      SubCluster= 0x4000     // all.subcluster directive encountered
+      SubCluster= 0x4000,    // all.subcluster directive encountered
+      CksWrite  = 0x8000     // ofs.ckswrite  directive encountered
      };                      // These are set in Options below
 
 int   Options;               // Various options
@@ -385,6 +389,7 @@ char              myRType[4];     // Role type for consistency with the cms
 XrdVersionInfo   *myVersion;      // Version number compiled against
 
 static XrdOfsHandle     *dummyHandle;
+static XrdCksCalc       *CksWObj; // Checksum calculated while writing
 XrdSysMutex              ocMutex; // Global mutex for open/close
 
 /******************************************************************************/
@@ -399,6 +404,7 @@ XrdSysMutex              ocMutex; // Global mutex for open/close
 
 // Function used during Configuration
 //
+void          ConfigCksW(XrdSysError &Eroute);
 int           ConfigDispFwd(char *buff, struct fwdOpt &Fwd);
 int           ConfigPosc(XrdSysError &Eroute);
 int           ConfigRedir(XrdSysError &Eroute, XrdOucEnv *EnvInfo);
@@ -408,6 +414,7 @@ int           Forward(int &Result, XrdOucErrInfo &Resp, struct fwdOpt &Fwd,
                       XrdOucEnv  *Env1=0, XrdOucEnv  *Env2=0);
 int           Reformat(XrdOucErrInfo &);
 const char   *theRole(int opts);
+int           xccalc(XrdOucStream &, XrdSysError &);
 int           xcrds(XrdOucStream &, XrdSysError &);
 int           xexp(XrdOucStream &, XrdSysError &, bool);
 int           xforward(XrdOucStream &, XrdSysError &);
@@ -250,6 +250,7 @@ int XrdOfs::Configure(XrdSysError &Eroute, XrdOucEnv *EnvInfo) {
       else {ofsConfig->Plugin(XrdOfsOss);
             ofsConfig->Plugin(Cks);
             CksPfn = !ofsConfig->OssCks();
+            if (Options & CksWrite) ConfigCksW(Eroute);
             if (Options & Authorize)
                {ofsConfig->Plugin(Authorization);
                 XrdOfsTPC::Init(Authorization);
@@ -330,12 +331,13 @@ void XrdOfs::Config_Display(XrdSysError &Eroute)
 
      snprintf(buff, sizeof(buff), "Config effective %s ofs configuration:\n"
                                   "       all.role %s\n"
-                                  "%s"
+                                  "%s%s"
                                   "       ofs.maxdelay   %d\n"
                                   "       ofs.persist    %s hold %d%s%s\n"
                                   "       ofs.trace      %x",
               cloc, myRole,
               (Options & Authorize ? "       ofs.authorize\n" : ""),
+              (CksWObj             ? "       ofs.ckswrite\n"  : ""),
                MaxDelay,
                pval, poscHold, (poscLog ? " logdir " : ""),
                (poscLog ? poscLog    : ""), OfsTrace.What);
@@ -389,6 +391,26 @@ void XrdOfs::Config_Display(XrdSysError &Eroute)
 /******************************************************************************/
 /*                     p r i v a t e   f u n c t i o n s                      */
 /******************************************************************************/
+/******************************************************************************/
+/*                            C o n f i g C k s W                             */
+/******************************************************************************/
+  
+void XrdOfs::ConfigCksW(XrdSysError &Eroute)
+{
+   const char *csName;
+
+// We need a checksum manager that can give us a calculator for the default
+// checksum. Otherwise, checksums are only calculated by reading the file.
+//
+   if (!Cks || !(csName = Cks->Name()) || !(CksWObj = Cks->Object(csName)))
+      {Eroute.Say("Config warning: ckswrite ignored; default checksum "
+                  "object not available.");
+       Options &= ~CksWrite;
+       return;
+      }
+   Eroute.Say("Config ", csName, " checksums calculated as files are written.");
+}
+
 /******************************************************************************/
 /*                         C o n f i g D i s p F w d                          */
 /******************************************************************************/
@@ -577,7 +599,9 @@ int XrdOfs::ConfigXeq(char *var, XrdOucStream &Config,
     TS_Bit("authorize",     Options, Authorize);
     TS_XPI("authlib",       theAutLib);
     TS_XPI("ckslib",        theCksLib);
+    TS_Xeq("ckscalc",       xccalc);
     TS_Xeq("cksrdsz",       xcrds);
+    TS_Bit("ckswrite",      Options, CksWrite);
     TS_XPI("cmslib",        theCmsLib);
     TS_Xeq("forward",       xforward);
     TS_Xeq("maxdelay",      xmaxd);
@@ -607,6 +631,41 @@ int XrdOfs::ConfigXeq(char *var, XrdOucStream &Config,
     return 0;
 }
 
+/******************************************************************************/
+/*                                x c c a l c                                 */
+/******************************************************************************/
+  
+/* Function: xccalc
+
+   Purpose:  To parse the directive: ckscalc [limit <n>] [threads <n>]
+                                             [split <size>] [memory <size>]
+
+             limit   maximum number of checksums calculated at the same time.
+             threads number of threads calculating pieces of a large file
+                     when the checksum allows it (adler32 and crc32).
+             split   minimum file size for it to be calculated in pieces.
+             memory  read buffer memory all calculations may use.
+
+             The options are checked by the checksum manager.
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOfs::xccalc(XrdOucStream &Config, XrdSysError &Eroute)
+{
+   char parms[1024];
+
+// Get the parameters
+//
+   *parms = 0;
+   if (!Config.GetRest(parms, sizeof(parms)))
+      {Eroute.Emsg("Config", "ckscalc parameters too long"); return 1;}
+
+// Record them for the checksum manager
+//
+   return !ofsConfig->SetCksCalc(parms);
+}
+
 /******************************************************************************/
 /*                                 x c r d s                                  */
 /******************************************************************************/
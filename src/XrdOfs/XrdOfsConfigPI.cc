@@ -435,6 +435,17 @@ bool XrdOfsConfigPI::RepLib(XrdOfsConfigPI::TheLib what,
    return true;
 }
 
+/******************************************************************************/
+/*                           S e t C k s C a l c                              */
+/******************************************************************************/
+
+bool   XrdOfsConfigPI::SetCksCalc(const char *parms)
+{
+   if (!CksConfig)
+      {Eroute->Emsg("Config", "Checksum version error!"); return false;}
+   return CksConfig->Calc(parms) == 0;
+}
+
 /******************************************************************************/
 /*                            S e t C k s R d S z                             */
 /******************************************************************************/
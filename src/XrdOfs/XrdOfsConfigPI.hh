@@ -171,6 +171,17 @@ bool   Plugin(XrdCks          *&pip);    //!< Get Checksum manager plugin
 bool   Plugin(XrdCmsClient_t   &piP);    //!< Get Cms client object generator
 bool   Plugin(XrdOss          *&piP);    //!< Get Oss plugin
 
+//-----------------------------------------------------------------------------
+//! Set the checksum calculation parameters (i.e. the ckscalc directive)
+//!
+//! @param   parms   The parameters following the directive.
+//!
+//! @return true     The parameters were recorded.
+//! @return false    The parameters could not be recorded.
+//-----------------------------------------------------------------------------
+
+bool   SetCksCalc(const char *parms);
+
 //-----------------------------------------------------------------------------
 //! Set the checksum read size
 //!
@@ -36,6 +36,7 @@
 #include "XrdOfs/XrdOfsHandle.hh"
 #include "XrdOfs/XrdOfsStats.hh"
 #include "XrdOss/XrdOss.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysTimer.hh"
@@ -150,6 +151,55 @@ static XrdOfsHanPsc  *Free;
 XrdSysMutex    XrdOfsHanPsc::pscMutex;
 XrdOfsHanPsc  *XrdOfsHanPsc::Free = 0;
 
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+// Link counts of handles in the table are changed under a shard read lock
+// using atomics. Without atomics the shard lock must be held exclusively.
+//
+#ifdef HAVE_ATOMICS
+#define HanReadLock(x)   x.ReadLock()
+#else
+#define HanReadLock(x)   x.WriteLock()
+#endif
+
+namespace
+{
+// Add a link unless the count is at its maximum. Returns true if added.
+//
+bool LinkAdd(unsigned short &Links)
+{
+#ifdef HAVE_ATOMICS
+   unsigned short curLinks;
+
+   do {if ((curLinks = Links) == 0xffff) return false;}
+      while(!AtomicCAS(Links, curLinks, curLinks+1));
+#else
+   if (Links == 0xffff) return false;
+   Links++;
+#endif
+   return true;
+}
+
+// Drop a link unless it is the last one. Returns the number of links left or
+// zero if the caller must retire the last link under the shard write lock.
+//
+int LinkDrop(unsigned short &Links)
+{
+#ifdef HAVE_ATOMICS
+   unsigned short curLinks;
+
+   do {if ((curLinks = Links) <= 1) return 0;}
+      while(!AtomicCAS(Links, curLinks, curLinks-1));
+   return curLinks-1;
+#else
+   if (Links <= 1) return 0;
+   return --Links;
+#endif
+}
+}
+
 /******************************************************************************/
 /*                     E x t e r n a l   L i n k a g e s                      */
 /******************************************************************************/
@@ -169,8 +219,9 @@ extern XrdOfsStats OfsStats;
 /******************************************************************************/
   
 XrdSysMutex   XrdOfsHandle::myMutex;
-XrdOfsHanTab  XrdOfsHandle::roTable;
-XrdOfsHanTab  XrdOfsHandle::rwTable;
+XrdSysRWLock  XrdOfsHandle::hanLock[XrdOfsHandle::hanShards];
+XrdOfsHanTab  XrdOfsHandle::roTable[XrdOfsHandle::hanShards];
+XrdOfsHanTab  XrdOfsHandle::rwTable[XrdOfsHandle::hanShards];
 XrdOssDF     *XrdOfsHandle::ossDF = (XrdOssDF *)new XrdOfsHanOss;
 XrdOfsHandle *XrdOfsHandle::Free = 0;
 
@@ -184,22 +235,36 @@ XrdOfsHandle *XrdOfsHandle::Free = 0;
 int XrdOfsHandle::Alloc(const char *thePath, int Opts, XrdOfsHandle **Handle)
 {
    XrdOfsHandle *hP;
-   XrdOfsHanTab *theTable = (Opts & opRW ? &rwTable : &roTable);
-   XrdOfsHanKey theKey(thePath, (int)strlen(thePath));
-   int          retc;
-
-// Lock the search table and try to find the key. If found, increment the
-// the link count (can only be done with the global lock) then release the
-// lock and try to lock the handle. It can't escape between lock calls because
-// the link count is positive. If we can't lock the handle then it must be the
+   XrdOfsHanKey  theKey(thePath, (int)strlen(thePath));
+   int           hX = Shard(theKey);
+   XrdOfsHanTab *theTable = (Opts & opRW ? &rwTable[hX] : &roTable[hX]);
+   XrdSysRWLock &theLock  = hanLock[hX];
+   int           retc;
+
+// Read lock the shard and try to find the key. If found, increment the link
+// count (atomically as other readers may do the same) then release the lock
+// and try to lock the handle. It can't escape between lock calls because the
+// link count is positive. If we can't lock the handle then it must be the
 // that a long running operation is occuring. Return the handle to its former
 // state and return a delay. Otherwise, return the handle.
 //
-   myMutex.Lock();
-   if ((hP = theTable->Find(theKey)) && hP->Path.Links != 0xffff)
-      {hP->Path.Links++; myMutex.UnLock();
+   HanReadLock(theLock);
+   if ((hP = theTable->Find(theKey)) && LinkAdd(hP->Path.Links))
+      {theLock.UnLock();
        if (hP->WaitLock()) {*Handle = hP; return 0;}
-       myMutex.Lock(); hP->Path.Links--; myMutex.UnLock();
+       HanReadLock(theLock); AtomicDec(hP->Path.Links); theLock.UnLock();
+       return nolokDelay;
+      }
+   theLock.UnLock();
+
+// Write lock the shard and check again as someone may have added the handle
+// while we were unlocked.
+//
+   theLock.WriteLock();
+   if ((hP = theTable->Find(theKey)) && LinkAdd(hP->Path.Links))
+      {theLock.UnLock();
+       if (hP->WaitLock()) {*Handle = hP; return 0;}
+       HanReadLock(theLock); AtomicDec(hP->Path.Links); theLock.UnLock();
        return nolokDelay;
       }
 
@@ -210,7 +275,7 @@ int XrdOfsHandle::Alloc(const char *thePath, int Opts, XrdOfsHandle **Handle)
 
 // All done
 //
-   myMutex.UnLock();
+   theLock.UnLock();
    return retc;
 }
 
@@ -223,10 +288,8 @@ int XrdOfsHandle::Alloc(XrdOfsHandle **Handle)
     XrdOfsHanKey myKey("dummy", 5);
     int retc;
 
-    myMutex.Lock();
     if (!(retc = Alloc(myKey, 0, Handle))) 
        {(*Handle)->Path.Links = 0; (*Handle)->UnLock();}
-    myMutex.UnLock();
     return retc;
 }
 
@@ -241,9 +304,11 @@ int XrdOfsHandle::Alloc(XrdOfsHanKey theKey, int Opts, XrdOfsHandle **Handle)
 
 // No handle currently in the table. Get a new one off the free list
 //
+   myMutex.Lock();
    if (!Free && (hP = new XrdOfsHandle[minAlloc]))
       {int i = minAlloc; while(i--) {hP->Next = Free; Free = hP; hP++;}}
    if ((hP = Free)) Free = hP->Next;
+   myMutex.UnLock();
 
 // Initialize the new handle, if we have one, and add it to the table
 //
@@ -256,6 +321,7 @@ int XrdOfsHandle::Alloc(XrdOfsHanKey theKey, int Opts, XrdOfsHandle **Handle)
        hP->isRW         = (Opts & opPC);           // File mode
        hP->ssi          = ossDF;                   // No storage system yet
        hP->Posc         = 0;                       // No creator
+       hP->Wcks         = 0;                       // No write checksum
        hP->Lock();                                 // Wait is not possible
        *Handle = hP;
        return 0;
@@ -271,14 +337,15 @@ void XrdOfsHandle::Hide(const char *thePath)
 {
    XrdOfsHandle *hP;
    XrdOfsHanKey theKey(thePath, (int)strlen(thePath));
+   int hX = Shard(theKey);
 
-// Lock the search table and try to find the key in each table. If found,
-// clear the length field to effectively hide the item.
+// Lock the shard and try to find the key in each table. If found, clear the
+// length field to effectively hide the item.
 //
-   myMutex.Lock();
-   if ((hP = roTable.Find(theKey))) hP->Path.Len = 0;
-   if ((hP = rwTable.Find(theKey))) hP->Path.Len = 0;
-   myMutex.UnLock();
+   hanLock[hX].WriteLock();
+   if ((hP = roTable[hX].Find(theKey))) hP->Path.Len = 0;
+   if ((hP = rwTable[hX].Find(theKey))) hP->Path.Len = 0;
+   hanLock[hX].UnLock();
 }
 
 /******************************************************************************/
@@ -297,7 +364,12 @@ int XrdOfsHandle::PoscGet(short &Mode, int Done)
        Mode = Posc->Mode;
        if (Done)
           {pP = Posc; Posc = 0;
-           if (pP->xprP) {myMutex.Lock(); Path.Links--; myMutex.UnLock();}
+           if (pP->xprP)
+              {int hX = Shard(Path);
+               HanReadLock(hanLock[hX]);
+               AtomicDec(Path.Links);
+               hanLock[hX].UnLock();
+              }
            pP->Recycle();
           }
        return pnum;
@@ -378,32 +450,52 @@ const char *XrdOfsHandle::PoscUsr()
 
 int XrdOfsHandle::Retire(int &retc, long long *retsz, char *buff, int blen)
 {
-   XrdOssDF *mySSI;
-   int numLeft;
+   return Retire(retc, retsz, buff, blen, 0);
+}
 
-// Get the global lock as the links field can only be manipulated with it.
-// Decrement the links count and if zero, remove it from the table and
-// place it on the free list. Otherwise, it is still in use.
+/******************************************************************************/
+
+int XrdOfsHandle::Retire(int &retc, long long *retsz, char *buff, int blen,
+                         XrdOfsHanCks **wcks)
+{
+   XrdOssDF *mySSI = 0;
+   int hX = Shard(Path), numLeft;
+
+// If this is not the last link, simply decrement the link count. This only
+// needs the shard read lock as the handle cannot leave the table.
 //
    retc = 0;
-   myMutex.Lock();
+   HanReadLock(hanLock[hX]);
+   numLeft = LinkDrop(Path.Links);
+   hanLock[hX].UnLock();
+   if (numLeft) {UnLock(); return numLeft;}
+
+// Get the shard write lock as the handle may need to be removed. Since the
+// lock was dropped, someone may have added a link in the meantime. If the
+// links count is one, remove it from the table and place it on the free list.
+// Otherwise, it is still in use.
+//
+   hanLock[hX].WriteLock();
    if (Path.Links == 1)
       {if (buff) strlcpy(buff, Path.Val, blen);
-       numLeft = 0; OfsStats.Dec(OfsStats.Data.numHandles);
-       if ( (isRW ? rwTable.Remove(this) : roTable.Remove(this)) )
-         {Next = Free; Free = this;
-          if (Posc) {Posc->Recycle(); Posc = 0;}
+       OfsStats.Dec(OfsStats.Data.numHandles);
+       if ( (isRW ? rwTable[hX].Remove(this) : roTable[hX].Remove(this)) )
+         {if (Posc) {Posc->Recycle(); Posc = 0;}
+          if (wcks) *wcks = Wcks;
+             else if (Wcks) delete Wcks;
+          Wcks = 0;
           if (Path.Val) {free((void *)Path.Val); Path.Val = (char *)"";}
           Path.Len = 0;
-          if ((mySSI = ssi) && ssi != ossDF)
-             {ssi = ossDF; myMutex.UnLock();
-              retc = mySSI->Close(retsz); delete mySSI;
-             } else myMutex.UnLock();
+          if ((mySSI = ssi) && ssi != ossDF) ssi = ossDF;
+             else mySSI = 0;
+          myMutex.Lock(); Next = Free; Free = this; myMutex.UnLock();
+          hanLock[hX].UnLock();
+          if (mySSI) {retc = mySSI->Close(retsz); delete mySSI;}
          } else {
-          myMutex.UnLock();
+          hanLock[hX].UnLock();
           OfsEroute.Emsg("Retire", "Lost handle to", Path.Val);
         }
-      } else {numLeft = --Path.Links; myMutex.UnLock();}
+      } else {numLeft = --Path.Links; hanLock[hX].UnLock();}
    UnLock();
    return numLeft;
 }
@@ -414,19 +506,19 @@ int XrdOfsHandle::Retire(XrdOfsHanCB *cbP, int hTime)
 {
    static int allOK = StartXpr(1);
    XrdOfsHanXpr *xP;
-   int retc;
+   int hX = Shard(Path), retc;
 
 // The handle can only be held by one reference and only if it's a POSC and
 // defered handling was properly set up.
 //
-   myMutex.Lock();
+   hanLock[hX].WriteLock();
    if (!Posc || !allOK)
       {OfsEroute.Emsg("Retire", "ignoring deferred retire of", Path.Val);
-       if (Path.Links != 1 || !Posc || !cbP) myMutex.UnLock();
-          else {myMutex.UnLock(); cbP->Retired(this);}
+       if (Path.Links != 1 || !Posc || !cbP) hanLock[hX].UnLock();
+          else {hanLock[hX].UnLock(); cbP->Retired(this);}
        return Retire(retc);
       }
-   myMutex.UnLock();
+   hanLock[hX].UnLock();
 
 // If this object already has an xpr object (happens for bouncing connections)
 // then reuse that object. Otherwise create a new one and put it on the queue.
@@ -448,7 +540,7 @@ int XrdOfsHandle::StartXpr(int Init)
    static int InitDone = 0;
    XrdOfsHanXpr *xP;
    XrdOfsHandle *hP;
-   int retc;
+   int hX, retc;
 
 // If this is the initial all and we have not been initialized do so
 //
@@ -478,14 +570,15 @@ do{xP = XrdOfsHanXpr::Get(); hP = xP->Handle;
             hP->UnLock(); delete xP; continue;
            }
 
-// As the handle is locked we can get the global handle lock to prevent
-// additions and removals of handles as we need a stable reference count to
+// As the handle is locked we can get the shard write lock to prevent
+// additions and removals of links as we need a stable reference count to
 // effect the callout, if any. Do so only if the reference count is one (for us)
-// and the handle is active. In all cases, drop the global lock.
+// and the handle is active. In all cases, drop the shard lock.
 //
-   myMutex.Lock();
-   if (hP->Path.Links != 1 || !xP->Call) myMutex.UnLock();
-      else {myMutex.UnLock();
+   hX = Shard(hP->Path);
+   hanLock[hX].WriteLock();
+   if (hP->Path.Links != 1 || !xP->Call) hanLock[hX].UnLock();
+      else {hanLock[hX].UnLock();
             xP->Call->Retired(hP);
            }
 
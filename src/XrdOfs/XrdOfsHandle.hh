@@ -36,6 +36,7 @@
 
 #include <stdlib.h>
 
+#include "XrdCks/XrdCksCalc.hh"
 #include "XrdOuc/XrdOucCRC.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
@@ -94,9 +95,9 @@ int            Remove(XrdOfsHandle *rip);
 
 // When allocateing a new nash, specify the required starting size. Make
 // sure that the previous number is the correct Fibonocci antecedent. The
-// series is simply n[j] = n[j-1] + n[j-2].
+// series is simply n[j] = n[j-1] + n[j-2]. The defaults are per shard.
 //
-    XrdOfsHanTab(int psize = 987, int size = 1597);
+    XrdOfsHanTab(int psize = 89, int size = 144);
    ~XrdOfsHanTab() {} // Never gets deleted
 
 private:
@@ -112,6 +113,49 @@ int              nashnum;
 int              Threshold;
 };
 
+/******************************************************************************/
+/*                    C l a s s   X r d O f s H a n C k s                     */
+/******************************************************************************/
+
+// The checksum of a file that is calculated as the file is being written. It
+// only stays valid as long as every write starts where the previous one ended.
+//
+class XrdOfsHanCks
+{
+public:
+
+XrdCksCalc         *Calc(long long &Len)
+                        {Len = Next; XrdCksCalc *csP = csCalc; csCalc = 0;
+                         return csP;
+                        }
+
+void                Trunc(long long flen)
+                         {csMutex.Lock();
+                          if (csCalc && flen != Next)
+                             {csCalc->Recycle(); csCalc = 0;}
+                          csMutex.UnLock();
+                         }
+
+void                Update(const char *buff, long long offs, int blen)
+                          {csMutex.Lock();
+                           if (csCalc)
+                              {if (offs == Next)
+                                  {csCalc->Update(buff, blen); Next += blen;}
+                                  else {csCalc->Recycle(); csCalc = 0;}
+                              }
+                           csMutex.UnLock();
+                          }
+
+                    XrdOfsHanCks(XrdCksCalc *csP) : csCalc(csP), Next(0) {}
+                   ~XrdOfsHanCks() {if (csCalc) csCalc->Recycle();}
+
+private:
+
+XrdSysMutex         csMutex;
+XrdCksCalc         *csCalc;    // Nil once a write was out of order
+long long           Next;      // Offset of the next byte in order
+};
+
 /******************************************************************************/
 /*                    C l a s s   X r d O f s H a n d l e                     */
 /******************************************************************************/
@@ -154,6 +198,9 @@ inline const char  *Name() {return Path.Val;}
              int    Retire(int &retc, long long *retsz=0,
                            char *buff=0, int blen=0);
 
+             int    Retire(int &retc, long long *retsz,
+                           char *buff, int blen, XrdOfsHanCks **wcks);
+
              int    Retire(XrdOfsHanCB *, int DSec);
 
 XrdOssDF           &Select(void) {return *ssi;}   // To allow for mt interfaces
@@ -171,6 +218,8 @@ inline       void   UnLock() {hMutex.UnLock();}
 
 private:
 static int           Alloc(XrdOfsHanKey, int Opts, XrdOfsHandle **Handle);
+static int           Shard(XrdOfsHanKey &Key)
+                          {return Key.Hash >> (32 - hanShardBits);}
        int           WaitLock(void);
 
 static const int     LockTries =   3; // Times to try for a lock
@@ -178,9 +227,20 @@ static const int     LockWait  = 333; // Mills to wait between tries
 static const int     nolokDelay=   3; // Secs to delay client when lock failed
 static const int     nomemDelay=  15; // Secs to delay client when ENOMEM
 
+// The handle tables are split into shards by path hash, each with its own
+// r/w lock. Lookups and link count changes of existing handles only need the
+// read lock; adding or removing a handle needs the write lock. The myMutex
+// only protects the free list and is always obtained after a shard lock.
+// The shard comes from the top bits of the hash because the tables use the
+// hash modulo their size, which would otherwise share factors with it.
+//
+static const int     hanShardBits = 5;
+static const int     hanShards = 1 << hanShardBits;
+
 static XrdSysMutex   myMutex;
-static XrdOfsHanTab  roTable;    // File handles open r/o
-static XrdOfsHanTab  rwTable;    // File Handles open r/w
+static XrdSysRWLock  hanLock[hanShards];  // Locks for each shard
+static XrdOfsHanTab  roTable[hanShards];  // File handles open r/o
+static XrdOfsHanTab  rwTable[hanShards];  // File Handles open r/w
 static XrdOssDF     *ossDF;      // Dummy storage sysem
 static XrdOfsHandle *Free;       // List of free handles
 
@@ -189,6 +249,12 @@ static XrdOfsHandle *Free;       // List of free handles
        XrdOfsHandle *Next;
        XrdOfsHanKey  Path;       // Path for this handle
        XrdOfsHanPsc *Posc;       // -> Info for posc-type files
+
+// Members added after this point so that the ones above keep their offsets
+//
+public:
+
+XrdOfsHanCks       *Wcks;         // -> Checksum calculated while writing
 };
   
 /******************************************************************************/
@@ -45,6 +45,7 @@
 
 #include "XrdOss/XrdOssApi.hh"
 #include "XrdOss/XrdOssTrace.hh"
+#include "XrdOss/XrdOssUring.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysPthread.hh"
@@ -96,6 +97,13 @@ const int OSS_AIO_WRITE_DONE = SIGRTMAX;
 int XrdOssFile::Fsync(XrdSfsAio *aiop)
 {
 
+// Use io_uring if it is available
+//
+   if (XrdOssUring::isOn())
+      {aiop->TIdent = tident;
+       if (XrdOssUring::Fsync(aiop, fd)) return 0;
+      }
+
 #ifdef _POSIX_ASYNCHRONOUS_IO
    int rc;
 
@@ -148,6 +156,13 @@ int XrdOssFile::Fsync(XrdSfsAio *aiop)
 int XrdOssFile::Read(XrdSfsAio *aiop)
 {
 
+// Use io_uring if it is available
+//
+   if (XrdOssUring::isOn())
+      {aiop->TIdent = tident;
+       if (XrdOssUring::Read(aiop, fd)) return 0;
+      }
+
 #ifdef _POSIX_ASYNCHRONOUS_IO
    EPNAME("AioRead");
    int rc;
@@ -205,6 +220,13 @@ int XrdOssFile::Read(XrdSfsAio *aiop)
   
 int XrdOssFile::Write(XrdSfsAio *aiop)
 {
+
+// Use io_uring if it is available
+//
+   if (XrdOssUring::isOn())
+      {aiop->TIdent = tident;
+       if (XrdOssUring::Write(aiop, fd)) return 0;
+      }
 #ifdef _POSIX_ASYNCHRONOUS_IO
    EPNAME("AioWrite");
    int rc;
@@ -32,8 +32,10 @@
 /******************************************************************************/
   
 #include <unistd.h>
+#include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <signal.h>
 #include <strings.h>
 #include <stdio.h>
@@ -41,6 +43,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/param.h>
+#include <sys/uio.h>
 #ifdef __solaris__
 #include <sys/vnode.h>
 #endif
@@ -54,6 +57,7 @@
 #include "XrdOss/XrdOssError.hh"
 #include "XrdOss/XrdOssMio.hh"
 #include "XrdOss/XrdOssTrace.hh"
+#include "XrdOss/XrdOssUring.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucName2Name.hh"
 #include "XrdOuc/XrdOucPinLoader.hh"
@@ -374,7 +378,10 @@ int XrdOssSys::Stats(char *buff, int blen)
 {
    static const char statfmt1[] = "<stats id=\"oss\" v=\"2\">";
    static const char statfmt2[] = "</stats>";
-   static const int  statflen = sizeof(statfmt1) + sizeof(statfmt2);
+   static const char statfmt3[] = "<readv><segs>%lld</segs>"
+                                  "<reads>%lld</reads></readv>";
+   static const int  statflen = sizeof(statfmt1) + sizeof(statfmt2)
+                              + sizeof(statfmt3) + 16*2;
    char *bp = buff;
    int n;
 
@@ -393,6 +400,13 @@ int XrdOssSys::Stats(char *buff, int blen)
    n = getStats(bp, blen);
    bp += n; blen -= n;
 
+// Generate vector read merging statistics
+//
+   if (rvGap >= 0 && blen > 0)
+      {n = snprintf(bp, blen, statfmt3, AtomicGet(rvSegs), AtomicGet(rvReads));
+       if (n < blen) {bp += n; blen -= n;}
+      }
+
 // Add trailer
 //
    if (blen >= (int)sizeof(statfmt2))
@@ -877,6 +891,15 @@ ssize_t XrdOssFile::ReadV(XrdOucIOVec *readV, int n)
    ssize_t rdsz, totBytes = 0;
    int i;
 
+// If merging is enabled, sort and coalesce the vector into fewer reads
+//
+   if (n > 1 && XrdOssSS->rvGap >= 0) return ReadVMerge(readV, n);
+
+// When io_uring is in use, all of the reads are given to the kernel at once
+// which makes pre-advising pointless.
+//
+   if (n > 1 && XrdOssUring::isOn()) return XrdOssUring::ReadV(fd, readV, n);
+
 // For platforms that support fadvise, pre-advise what we will be reading
 //
 #if defined(__linux__) && defined(HAVE_ATOMICS)
@@ -937,6 +960,144 @@ ssize_t XrdOssFile::ReadV(XrdOucIOVec *readV, int n)
    return totBytes;
 }
 
+/******************************************************************************/
+/*                            R e a d V M e r g e                             */
+/******************************************************************************/
+
+/*
+  Function: Perform all the reads specified in the readV vector by sorting the
+            elements by offset and merging neighbours that are no more than
+            rvGap bytes apart into a single scatter read.
+
+  Input:    readV     - A description of the reads to perform (see ReadV).
+            readCount - The size of the readV vector.
+
+  Output:   Returns the number of bytes read upon success and -errno o/w.
+            If the number of bytes read is less than requested, it is considered
+            an error.
+*/
+
+namespace
+{
+bool rvOrder(const XrdOucIOVec *a, const XrdOucIOVec *b)
+        {return a->offset < b->offset;}
+}
+
+ssize_t XrdOssFile::ReadVMerge(XrdOucIOVec *readV, int n)
+{
+#ifndef IOV_MAX
+   static const int IOV_MAX = 1024;
+#endif
+   const long long maxGap = XrdOssSS->rvGap;
+   const long long maxSz  = XrdOssSS->rvMaxSz;
+   XrdOucIOVec **segV = new XrdOucIOVec*[n];
+   XrdOucIOVec  *xtnV = new XrdOucIOVec[n];
+   struct iovec *iovV = new struct iovec[n*2];
+   ssize_t      *resV = new ssize_t[n];
+   int          *segX = new int[n+1];
+   ssize_t       rdsz, totBytes = 0;
+   long long     gap, xEnd = 0;
+   int i, nx = 0, niov = 0;
+
+// Sort the segments by offset leaving the caller's vector untouched
+//
+   for (i = 0; i < n; i++) segV[i] = &readV[i];
+   std::sort(segV, segV+n, rvOrder);
+
+// Build the extents. A segment is merged into the current extent when it does
+// not overlap it, the gap is small enough, and the extent stays within limits.
+// Gap bytes are read into a throw-away buffer. segX[x] records the first
+// sorted segment of extent x.
+//
+   for (i = 0; i < n; i++)
+       {XrdOucIOVec *sP = segV[i];
+        gap = sP->offset - xEnd;
+        if (nx && gap >= 0 && gap <= maxGap
+        &&  xtnV[nx-1].info + 2 <= IOV_MAX
+        &&  xtnV[nx-1].size + gap + sP->size <= maxSz)
+           {if (gap)
+               {iovV[niov].iov_base = XrdOssSS->rvGapBuff;
+                iovV[niov].iov_len  = gap;
+                niov++; xtnV[nx-1].info++;
+               }
+           } else {
+            segX[nx] = i;
+            xtnV[nx].offset = sP->offset;
+            xtnV[nx].size   = 0;
+            xtnV[nx].info   = 0;
+            xtnV[nx].data   = (char *)&iovV[niov];
+            nx++; gap = 0;
+           }
+        iovV[niov].iov_base = sP->data;
+        iovV[niov].iov_len  = sP->size;
+        niov++; xtnV[nx-1].info++;
+        xtnV[nx-1].size += gap + sP->size;
+        totBytes        += sP->size;
+        xEnd = sP->offset + sP->size;
+       }
+   segX[nx] = n;
+
+// Do the reads. With io_uring all of them are in flight at the same time.
+//
+   if (XrdOssUring::isOn()) XrdOssUring::ReadX(fd, xtnV, resV, nx);
+      else for (i = 0; i < nx; i++)
+               {do {rdsz = preadv(fd, (struct iovec *)xtnV[i].data,
+                                  xtnV[i].info, xtnV[i].offset);
+                   } while(rdsz < 0 && errno == EINTR);
+                resV[i] = (rdsz < 0 ? -errno : rdsz);
+               }
+
+// Any extent that was not fully read is redone segment by segment so that a
+// short read is handled exactly as it would have been without merging.
+//
+   for (i = 0; i < nx; i++)
+       if (resV[i] != xtnV[i].size)
+          {if (resV[i] < 0) rdsz = resV[i];
+              else rdsz = ReadVSegs(&segV[segX[i]], segX[i+1] - segX[i]);
+           if (rdsz < 0) {totBytes = rdsz; break;}
+          }
+
+// Update statistics
+//
+   AtomicAdd(XrdOssSS->rvSegs,  n);
+   AtomicAdd(XrdOssSS->rvReads, nx);
+
+// All done
+//
+   delete [] segX; delete [] resV; delete [] iovV;
+   delete [] xtnV; delete [] segV;
+   return totBytes;
+}
+
+/******************************************************************************/
+/*                             R e a d V S e g s                              */
+/******************************************************************************/
+
+/*
+  Function: Read each segment in a vector of segment pointers.
+
+  Input:    segV      - The vector of pointers to segments.
+            n         - The size of the segV vector.
+
+  Output:   Returns the number of bytes read upon success and -errno o/w.
+            A short read is reported as -ESPIPE.
+*/
+
+ssize_t XrdOssFile::ReadVSegs(XrdOucIOVec **segV, int n)
+{
+   ssize_t rdsz, totBytes = 0;
+   int i;
+
+   for (i = 0; i < n; i++)
+       {do {rdsz = pread(fd, segV[i]->data, segV[i]->size, segV[i]->offset);}
+           while(rdsz < 0 && errno == EINTR);
+        if (rdsz < 0) return -errno;
+        if (rdsz != segV[i]->size) return -ESPIPE;
+        totBytes += rdsz;
+       }
+   return totBytes;
+}
+
 /******************************************************************************/
 /*                               R e a d R a w                                */
 /******************************************************************************/
@@ -1000,6 +1161,65 @@ ssize_t XrdOssFile::Write(const void *buff, off_t offset, size_t blen)
      return retval;
 }
 
+/******************************************************************************/
+/*                                W r i t e V                                 */
+/******************************************************************************/
+
+/*
+  Function: Write the segments in `writeV' to the associated file. Runs of
+            segments that are adjacent in the file are written with a single
+            pwritev() call.
+
+  Input:    writeV    - The vector of segments to write.
+            n         - The number of elements in writeV.
+
+  Output:   Returns the number of bytes written upon success and -errno o/w.
+*/
+
+ssize_t XrdOssFile::WriteV(XrdOucIOVec *writeV, int n)
+{
+#ifndef IOV_MAX
+   static const int IOV_MAX = 1024;
+#endif
+   struct iovec *iovV;
+   ssize_t wrsz, totBytes = 0;
+   long long runBytes;
+   int i, j;
+
+   if (fd < 0) return (ssize_t)-XRDOSS_E8004;
+
+// A single segment or a compressed file is simply written as before
+//
+   if (n < 2 || cxobj) return XrdOssDF::WriteV(writeV, n);
+   iovV = new struct iovec[n < IOV_MAX ? n : IOV_MAX];
+
+// Find each run of adjacent segments and write it out
+//
+   for (i = 0; i < n; i = j)
+       {runBytes = writeV[i].size;
+        iovV[0].iov_base = writeV[i].data;
+        iovV[0].iov_len  = writeV[i].size;
+        for (j = i+1; j < n && j-i < IOV_MAX
+                   && writeV[j].offset == writeV[j-1].offset+writeV[j-1].size; j++)
+            {iovV[j-i].iov_base = writeV[j].data;
+             iovV[j-i].iov_len  = writeV[j].size;
+             runBytes += writeV[j].size;
+            }
+        if (XrdOssSS->MaxSize && writeV[i].offset+runBytes > XrdOssSS->MaxSize)
+           {totBytes = (ssize_t)-XRDOSS_E8007; break;}
+        do {wrsz = pwritev(fd, iovV, j-i, writeV[i].offset);}
+           while(wrsz < 0 && errno == EINTR);
+        if (wrsz < 0 || wrsz != runBytes)
+           {totBytes = (wrsz < 0 ? -errno : -ESPIPE); break;}
+        totBytes += wrsz;
+       }
+
+// All done
+//
+   delete [] iovV;
+   return totBytes;
+}
+
 /******************************************************************************/
 /*                                F c h m o d                                 */
 /******************************************************************************/
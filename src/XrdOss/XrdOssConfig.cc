@@ -52,6 +52,7 @@
 #include "XrdOss/XrdOssOpaque.hh"
 #include "XrdOss/XrdOssSpace.hh"
 #include "XrdOss/XrdOssTrace.hh"
+#include "XrdOss/XrdOssUring.hh"
 #include "XrdOuc/XrdOuca2x.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdSys/XrdSysError.hh"
@@ -212,6 +213,13 @@ XrdOssSys::XrdOssSys()
    prActive      = 0;
    prDepth       = 0;
    prQSize       = 0;
+   urRings       = 0;
+   urDepth       = 256;
+   rvGapBuff     = 0;
+   rvSegs        = 0;
+   rvReads       = 0;
+   rvGap         = -1;
+   rvMaxSz       = 1048576;
    STT_Lib       = 0;
    STT_Parms     = 0;
    STT_Func      = 0;
@@ -305,6 +313,16 @@ int XrdOssSys::Configure(const char *configfn, XrdSysError &Eroute,
 //
    if (!NoGo) NoGo = !AioInit();
 
+// Allocate the buffer that receives bytes skipped when merging readv segments
+//
+   if (!NoGo && rvGap > 0 && !(rvGapBuff = (char *)malloc(rvGap)))
+      {Eroute.Emsg("Config", ENOMEM, "allocate readv gap buffer"); NoGo = 1;}
+
+// Configure io_uring, if wanted. If it is not available we use standard I/O.
+//
+   if (!NoGo && urRings && !XrdOssUring::Init(&Eroute, urRings, urDepth))
+      Eroute.Say("Config warning: io_uring unavailable; using standard I/O.");
+
 // Initialize memory mapping setting to speed execution
 //
    if (!NoGo) ConfigMio(Eroute);
@@ -948,11 +966,13 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
    TS_Xeq("cachescan",     xcachescan);
    TS_Xeq("defaults",      xdefault);
    TS_Xeq("fdlimit",       xfdlimit);
+   TS_Xeq("iouring",       xiouring);
    TS_Xeq("maxsize",       xmaxsz);
    TS_Xeq("memfile",       xmemf);
    TS_Xeq("namelib",       xnml);
    TS_Xeq("path",          xpath);
    TS_Xeq("preread",       xprerd);
+   TS_Xeq("readv",         xreadv);
    TS_Xeq("space",         xspace);
    TS_Xeq("stagecmd",      xstg);
    TS_Xeq("statlib",       xstl);
@@ -1158,6 +1178,62 @@ int XrdOssSys::xfdlimit(XrdOucStream &Config, XrdSysError &Eroute)
     return 0;
 }
   
+/******************************************************************************/
+/*                              x i o u r i n g                               */
+/******************************************************************************/
+
+/* Function: xiouring
+
+   Purpose:  To parse the directive: iouring {off | on} [rings <n>] [qdepth <q>]
+
+             off      do not use io_uring (the default).
+             on       use io_uring for asynchronous reads and writes as well
+                      as for vector reads, when the kernel supports it.
+             <n>      the number of rings, each with its own completion thread.
+                      The default is 2.
+             <q>      the number of submission entries per ring. The default
+                      is 256.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xiouring(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val;
+    int nrings = 2, qdepth = 256;
+
+      if (!(val = Config.GetWord()))
+         {Eroute.Emsg("Config", "iouring option not specified"); return 1;}
+
+           if (!strcmp(val, "off")) nrings = 0;
+      else if (strcmp(val, "on"))
+              {Eroute.Emsg("Config", "invalid iouring option -", val); return 1;}
+
+      while((val = Config.GetWord()))
+           {     if (!strcmp(val, "rings"))
+                    {if (!(val = Config.GetWord()))
+                        {Eroute.Emsg("Config","iouring rings not specified");
+                         return 1;
+                        }
+                     if (XrdOuca2x::a2i(Eroute,"iouring rings",val,&nrings,1,64))
+                        return 1;
+                    }
+            else if (!strcmp(val, "qdepth"))
+                    {if (!(val = Config.GetWord()))
+                        {Eroute.Emsg("Config","iouring qdepth not specified");
+                         return 1;
+                        }
+                     if (XrdOuca2x::a2i(Eroute,"iouring qdepth",val,&qdepth,
+                                        8, 4096)) return 1;
+                    }
+            else {Eroute.Emsg("Config","invalid iouring option -",val); return 1;}
+           }
+
+      urRings = nrings;
+      urDepth = qdepth;
+      return 0;
+}
+
 /******************************************************************************/
 /*                                x m a x s z                                 */
 /******************************************************************************/
@@ -1407,6 +1483,61 @@ int XrdOssSys::xprerd(XrdOucStream &Config, XrdSysError &Eroute)
       return 0;
 }
   
+/******************************************************************************/
+/*                                x r e a d v                                 */
+/******************************************************************************/
+
+/* Function: xreadv
+
+   Purpose:  To parse the directive: readv [coalesce {off | <gap>}]
+                                           [maxsz <bytes>]
+
+             <gap>    segments of a vector read that are no more than <gap>
+                      bytes apart are merged into a single read. Segments are
+                      sorted by offset first. Specify 0 to merge only adjacent
+                      segments. The default is off (each segment is read
+                      separately). The maximum is 1M.
+             <bytes>  the maximum size of a merged read. The default is 1M
+                      and the maximum is 64M.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xreadv(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    static const long long m1  =  1048576LL;
+    static const long long m64 = 67108864LL;
+    long long gap = rvGap, msz = rvMaxSz;
+    char *val;
+
+      if (!(val = Config.GetWord()))
+         {Eroute.Emsg("Config", "readv option not specified"); return 1;}
+
+      do {     if (!strcmp(val, "coalesce"))
+                  {if (!(val = Config.GetWord()))
+                      {Eroute.Emsg("Config","readv coalesce not specified");
+                       return 1;
+                      }
+                   if (!strcmp(val, "off")) gap = -1;
+                      else if (XrdOuca2x::a2sz(Eroute,"readv coalesce",val,
+                                               &gap, 0, m1)) return 1;
+                  }
+          else if (!strcmp(val, "maxsz"))
+                  {if (!(val = Config.GetWord()))
+                      {Eroute.Emsg("Config","readv maxsz not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2sz(Eroute,"readv maxsz",val,&msz,4096,m64))
+                      return 1;
+                  }
+          else {Eroute.Emsg("Config","invalid readv option -",val); return 1;}
+         } while((val = Config.GetWord()));
+
+      rvGap   = static_cast<int>(gap);
+      rvMaxSz = static_cast<int>(msz);
+      return 0;
+}
+  
 /******************************************************************************/
 /*                                x s p a c e                                 */
 /******************************************************************************/
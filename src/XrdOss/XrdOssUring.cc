@@ -0,0 +1,656 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O s s U r i n g . c c                         */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#ifdef __NR_io_uring_setup
+#include <linux/io_uring.h>
+#if defined(IO_URING_OP_SUPPORTED) && defined(HAVE_ATOMICS)
+#define XRDOSS_URING 1
+#endif
+#endif
+#endif
+
+#include "XrdOss/XrdOssUring.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
+#include "XrdSfs/XrdSfsAio.hh"
+#include "XrdSys/XrdSysAtomics.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+int XrdOssUring::numRings = 0;
+
+#ifdef XRDOSS_URING
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+// Each submission carries a tagged pointer as its user data. Request objects
+// are at least 4-byte aligned so the low two bits identify what completed.
+//
+static const unsigned long long tagRead  = 0;  // -> XrdSfsAio, doneRead()
+static const unsigned long long tagWrite = 1;  // -> XrdSfsAio, doneWrite()
+static const unsigned long long tagRVSeg = 2;  // -> XrdOssUringSeg
+static const unsigned long long tagStop  = 3;  // Reaper is to return
+static const unsigned long long tagMask  = 3;
+
+// Vector reads are submitted in batches of at most this many segments
+//
+static const int maxRVSegs = 256;
+
+struct XrdOssUringSeg;
+
+struct XrdOssUringRV
+{
+XrdSysSemaphore  rvDone;
+int              rvPend;
+
+                 XrdOssUringRV() : rvDone(0, "uring readv"), rvPend(0) {}
+                ~XrdOssUringRV() {}
+};
+
+struct XrdOssUringSeg
+{
+XrdOssUringRV   *rvCtl;
+ssize_t          rvRes;
+};
+
+struct XrdOssUringReq
+{
+unsigned long long udata;
+void              *buff;
+off_t              offset;
+unsigned int       blen;
+int                fd;
+unsigned char      opcode;
+};
+
+/******************************************************************************/
+/*                       C l a s s   X r d O s s R i n g                      */
+/******************************************************************************/
+
+class XrdOssRing
+{
+public:
+
+void   Close();
+
+bool   Init(int qdepth);
+
+void   Reap();
+
+bool   Stop();
+
+int    Submit(XrdOssUringReq *reqs, int n);
+
+       XrdOssRing() : sqes(0), sqMap(0), cqMap(0), ringFD(-1), isDead(false) {}
+      ~XrdOssRing() {}
+
+private:
+
+int    Enter(unsigned int tosub, unsigned int minc, unsigned int flags)
+            {return syscall(__NR_io_uring_enter, ringFD, tosub, minc, flags,
+                            (void *)0, 0);
+            }
+
+XrdSysMutex          sqMutex;
+struct io_uring_sqe *sqes;
+unsigned int        *sqHead;
+unsigned int        *sqTail;
+unsigned int        *sqArray;
+unsigned int         sqMask;
+unsigned int         sqEntries;
+struct io_uring_cqe *cqes;
+unsigned int        *cqHead;
+unsigned int        *cqTail;
+unsigned int         cqMask;
+char                *sqMap;
+char                *cqMap;
+size_t               sqLen;
+size_t               cqLen;
+size_t               sqesLen;
+int                  ringFD;
+bool                 isDead;
+};
+
+/******************************************************************************/
+/*                     L o c a l   D a t a   &   F u n c s                    */
+/******************************************************************************/
+
+XrdOssRing   *Rings = 0;
+unsigned int  nextRing = 0;
+unsigned int  ringCnt  = 1;
+XrdSysError  *eDest = 0;
+
+XrdOssRing *getRing()
+{
+   unsigned int rnum = AtomicInc(nextRing);
+   return &Rings[rnum % ringCnt];
+}
+
+void *Reaper(void *carg)
+{
+   XrdOssRing *rP = (XrdOssRing *)carg;
+   rP->Reap();
+   return (void *)0;
+}
+
+// Undo a partial initialization. The reapers that were started are stopped
+// and, once none is left using them, the rings are released.
+//
+void Shutdown(pthread_t *tids, int ntids, int nrings)
+{
+   bool stuck = false;
+   int i;
+
+   for (i = 0; i < ntids; i++)
+       if (Rings[i].Stop()) XrdSysThread::Join(tids[i], 0);
+          else {XrdSysThread::Detach(tids[i]); stuck = true;}
+
+   if (stuck)
+      {eDest->Emsg("Uring", "Unable to stop io_uring reaper; rings kept.");
+       Rings = 0;
+       return;
+      }
+
+   for (i = 0; i < nrings; i++) Rings[i].Close();
+   delete [] Rings;
+   Rings = 0;
+}
+}
+
+/******************************************************************************/
+/*                      X r d O s s R i n g : : C l o s e                     */
+/******************************************************************************/
+
+void XrdOssRing::Close()
+{
+   if (sqes) munmap(sqes, sqesLen);
+   if (cqMap && cqMap != sqMap) munmap(cqMap, cqLen);
+   if (sqMap) munmap(sqMap, sqLen);
+   if (ringFD >= 0) close(ringFD);
+   sqes  = 0;
+   sqMap = cqMap = 0;
+   ringFD = -1;
+}
+
+/******************************************************************************/
+/*                       X r d O s s R i n g : : I n i t                      */
+/******************************************************************************/
+
+bool XrdOssRing::Init(int qdepth)
+{
+   static const unsigned char needOps[] = {IORING_OP_READ, IORING_OP_READV,
+                                           IORING_OP_WRITE, IORING_OP_FSYNC};
+   struct io_uring_params rParms;
+   struct io_uring_probe *probe;
+   size_t pLen;
+   void *mP;
+   unsigned int i;
+   int rc;
+
+// Create the ring. We need the kernel to never drop completions.
+//
+   memset(&rParms, 0, sizeof(rParms));
+   if ((ringFD = syscall(__NR_io_uring_setup, qdepth, &rParms)) < 0)
+      return false;
+   if (!(rParms.features & IORING_FEAT_NODROP)) {errno = ENOTSUP; return false;}
+
+// Verify that the operations we need are supported
+//
+   pLen  = sizeof(struct io_uring_probe) + 256*sizeof(struct io_uring_probe_op);
+   probe = (struct io_uring_probe *)calloc(1, pLen);
+   rc = syscall(__NR_io_uring_register, ringFD, IORING_REGISTER_PROBE,
+                probe, 256);
+   if (rc < 0) {free(probe); return false;}
+   for (i = 0; i < sizeof(needOps); i++)
+       if (needOps[i] > probe->last_op
+       ||  !(probe->ops[needOps[i]].flags & IO_URING_OP_SUPPORTED))
+          {free(probe); errno = ENOTSUP; return false;}
+   free(probe);
+
+// Map the submission and completion rings (a single map if the kernel can)
+//
+   sqLen = rParms.sq_off.array + rParms.sq_entries*sizeof(unsigned int);
+   cqLen = rParms.cq_off.cqes  + rParms.cq_entries*sizeof(struct io_uring_cqe);
+   if (rParms.features & IORING_FEAT_SINGLE_MMAP)
+      {if (cqLen > sqLen) sqLen = cqLen;
+       cqLen = sqLen;
+      }
+   mP = mmap(0, sqLen, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+             ringFD, IORING_OFF_SQ_RING);
+   if (mP == MAP_FAILED) return false;
+   sqMap = (char *)mP;
+   if (rParms.features & IORING_FEAT_SINGLE_MMAP) cqMap = sqMap;
+      else {mP = mmap(0, cqLen, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                      ringFD, IORING_OFF_CQ_RING);
+            if (mP == MAP_FAILED) return false;
+            cqMap = (char *)mP;
+           }
+   sqesLen = rParms.sq_entries*sizeof(struct io_uring_sqe);
+   mP = mmap(0, sqesLen, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+             ringFD, IORING_OFF_SQES);
+   if (mP == MAP_FAILED) return false;
+   sqes = (struct io_uring_sqe *)mP;
+
+// Locate the ring fields
+//
+   sqHead    = (unsigned int *)(sqMap + rParms.sq_off.head);
+   sqTail    = (unsigned int *)(sqMap + rParms.sq_off.tail);
+   sqArray   = (unsigned int *)(sqMap + rParms.sq_off.array);
+   sqMask    = *(unsigned int *)(sqMap + rParms.sq_off.ring_mask);
+   sqEntries = rParms.sq_entries;
+   cqHead    = (unsigned int *)(cqMap + rParms.cq_off.head);
+   cqTail    = (unsigned int *)(cqMap + rParms.cq_off.tail);
+   cqMask    = *(unsigned int *)(cqMap + rParms.cq_off.ring_mask);
+   cqes      = (struct io_uring_cqe *)(cqMap + rParms.cq_off.cqes);
+   return true;
+}
+
+/******************************************************************************/
+/*                       X r d O s s R i n g : : R e a p                      */
+/******************************************************************************/
+
+void XrdOssRing::Reap()
+{
+   struct {unsigned long long udata; int res;} done[64];
+   XrdOssUringSeg *segP;
+   XrdSfsAio *aiop;
+   unsigned int head, tail;
+   int i, n;
+
+// Wait for completions and dispatch them. We copy them out and free the ring
+// slots before running callbacks as those may take a while (e.g. a send).
+//
+   while(1)
+        {head = *cqHead;
+         tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+         if (head == tail)
+            {if (Enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+                {eDest->Emsg("Uring", errno, "wait for io_uring completions");
+                 sleep(1);
+                }
+             continue;
+            }
+         for (n = 0; head != tail && n < (int)(sizeof(done)/sizeof(done[0]));
+              n++, head++)
+             {done[n].udata = cqes[head & cqMask].user_data;
+              done[n].res   = cqes[head & cqMask].res;
+             }
+         __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+         for (i = 0; i < n; i++)
+             {switch(done[i].udata & tagMask)
+                    {case tagRead:
+                          aiop = (XrdSfsAio *)(done[i].udata & ~tagMask);
+                          aiop->Result = done[i].res;
+                          aiop->doneRead();
+                          break;
+                     case tagWrite:
+                          aiop = (XrdSfsAio *)(done[i].udata & ~tagMask);
+                          aiop->Result = done[i].res;
+                          aiop->doneWrite();
+                          break;
+                     case tagStop:
+                          return;
+                     default:
+                          segP = (XrdOssUringSeg *)(done[i].udata & ~tagMask);
+                          segP->rvRes = done[i].res;
+                          if (AtomicDec(segP->rvCtl->rvPend) == 1)
+                             segP->rvCtl->rvDone.Post();
+                          break;
+                    }
+             }
+        }
+}
+
+/******************************************************************************/
+/*                       X r d O s s R i n g : : S t o p                      */
+/******************************************************************************/
+
+// Only used while nothing else is using the ring. A no-op is submitted whose
+// completion tells the reaper to return.
+
+bool XrdOssRing::Stop()
+{
+   XrdOssUringReq rq;
+
+   rq.udata  = tagStop;
+   rq.buff   = 0;
+   rq.offset = 0;
+   rq.blen   = 0;
+   rq.fd     = -1;
+   rq.opcode = IORING_OP_NOP;
+   return Submit(&rq, 1) == 1;
+}
+
+/******************************************************************************/
+/*                     X r d O s s R i n g : : S u b m i t                    */
+/******************************************************************************/
+
+// Returns the number of requests actually submitted. Requests that were not
+// submitted were never given to the kernel and must be handled by the caller.
+
+int XrdOssRing::Submit(XrdOssUringReq *reqs, int n)
+{
+   struct io_uring_sqe *sqe;
+   unsigned int head, tail, idx, batch;
+   int i, rc, done = 0;
+
+// If the ring failed then the caller must handle all of the requests
+//
+   XrdSysMutexHelper sqHelp(sqMutex);
+   if (isDead) return 0;
+
+// All the requests are placed in the ring and passed to the kernel with as
+// few system calls as possible, normally only one.
+//
+   while(done < n)
+        {head  = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+         tail  = *sqTail;
+         batch = sqEntries - (tail - head);
+         if (batch > (unsigned int)(n - done)) batch = n - done;
+         for (i = 0; i < (int)batch; i++, tail++)
+             {XrdOssUringReq &rq = reqs[done+i];
+              idx = tail & sqMask;
+              sqe = &sqes[idx];
+              memset(sqe, 0, sizeof(*sqe));
+              sqe->opcode    = rq.opcode;
+              sqe->fd        = rq.fd;
+              sqe->off       = rq.offset;
+              sqe->addr      = (unsigned long long)rq.buff;
+              sqe->len       = rq.blen;
+              sqe->user_data = rq.udata;
+              sqArray[idx]   = idx;
+             }
+         __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+      // Hand the entries to the kernel. EBUSY and EAGAIN mean that the kernel
+      // is short of resources or completions so we give the reaper a chance.
+      // Should the ring fail, entries left in it are never consumed since we
+      // never ask the kernel to submit anything again.
+      //
+         while(batch)
+              {if ((rc = Enter(batch, 0, 0)) > 0)
+                  {batch -= rc; done += rc; continue;}
+               if (rc < 0 && errno == EINTR) continue;
+               if (rc < 0 && (errno == EAGAIN || errno == EBUSY))
+                  {sched_yield(); continue;}
+               eDest->Emsg("Uring", (rc ? errno : EIO),
+                           "submit io_uring requests; io_uring disabled");
+               isDead = true;
+               return done;
+              }
+        }
+
+// Return the number of requests that were submitted
+//
+   return done;
+}
+
+#endif
+
+/******************************************************************************/
+/*                                 F s y n c                                  */
+/******************************************************************************/
+
+bool XrdOssUring::Fsync(XrdSfsAio *aiop, int fd)
+{
+#ifdef XRDOSS_URING
+   XrdOssUringReq rq;
+
+   rq.udata  = (unsigned long long)aiop | tagWrite;
+   rq.buff   = 0;
+   rq.offset = 0;
+   rq.blen   = 0;
+   rq.fd     = fd;
+   rq.opcode = IORING_OP_FSYNC;
+   return getRing()->Submit(&rq, 1) == 1;
+#else
+   return false;
+#endif
+}
+
+/******************************************************************************/
+/*                                  I n i t                                   */
+/******************************************************************************/
+
+bool XrdOssUring::Init(XrdSysError *errP, int nrings, int qdepth)
+{
+#ifdef XRDOSS_URING
+   pthread_t *tids;
+   int i, rc;
+
+// Create all of the rings. Should one fail, release those already created
+// so that the fallback path does not carry them around.
+//
+   eDest = errP;
+   Rings = new XrdOssRing[nrings];
+   for (i = 0; i < nrings; i++)
+       if (!Rings[i].Init(qdepth))
+          {eDest->Emsg("Uring", errno, "create io_uring; io_uring disabled");
+           Shutdown(0, 0, nrings);
+           return false;
+          }
+
+// Start a completion thread for each ring. They are joinable until all of
+// them are running so that a failure can stop the ones already started.
+//
+   tids = new pthread_t[nrings];
+   for (i = 0; i < nrings; i++)
+       if ((rc = XrdSysThread::Run(&tids[i], Reaper, (void *)&Rings[i],
+                                   XRDSYSTHREAD_HOLD, "io_uring reaper")))
+          {eDest->Emsg("Uring", rc, "create io_uring reaper; io_uring disabled");
+           Shutdown(tids, i, nrings);
+           delete [] tids;
+           return false;
+          }
+   for (i = 0; i < nrings; i++) XrdSysThread::Detach(tids[i]);
+   delete [] tids;
+
+// All done
+//
+   ringCnt  = nrings;
+   numRings = nrings;
+   return true;
+#else
+   errP->Say("Config warning: io_uring not supported on this platform.");
+   return false;
+#endif
+}
+
+/******************************************************************************/
+/*                                  R e a d                                   */
+/******************************************************************************/
+
+bool XrdOssUring::Read(XrdSfsAio *aiop, int fd)
+{
+#ifdef XRDOSS_URING
+   XrdOssUringReq rq;
+
+   rq.udata  = (unsigned long long)aiop | tagRead;
+   rq.buff   = (void *)aiop->sfsAio.aio_buf;
+   rq.offset = aiop->sfsAio.aio_offset;
+   rq.blen   = aiop->sfsAio.aio_nbytes;
+   rq.fd     = fd;
+   rq.opcode = IORING_OP_READ;
+   return getRing()->Submit(&rq, 1) == 1;
+#else
+   return false;
+#endif
+}
+
+/******************************************************************************/
+/*                                 R e a d V                                  */
+/******************************************************************************/
+
+ssize_t XrdOssUring::ReadV(int fd, XrdOucIOVec *readV, int n)
+{
+#ifdef XRDOSS_URING
+   ssize_t rdsz, rlen, totBytes = 0;
+   ssize_t rvRes[maxRVSegs];
+   int i, k, batch;
+
+// Read the vector in batches and verify the results. The kernel may return a
+// short read (e.g. when only part of the data was cached) so complete those
+// synchronously.
+//
+   for (k = 0; k < n; k += batch)
+       {batch = (n - k < maxRVSegs ? n - k : maxRVSegs);
+        Batch(fd, readV+k, rvRes, batch, false);
+        for (i = 0; i < batch; i++)
+            {if ((rdsz = rvRes[i]) < 0) return rdsz;
+             while(rdsz < readV[k+i].size)
+                  {rlen = pread(fd, readV[k+i].data + rdsz,
+                                readV[k+i].size - rdsz,
+                                readV[k+i].offset + rdsz);
+                   if (rlen < 0 && errno == EINTR) continue;
+                   if (rlen < 0) return -errno;
+                   if (!rlen) return -ESPIPE;
+                   rdsz += rlen;
+                  }
+             totBytes += rdsz;
+            }
+       }
+
+// All done
+//
+   return totBytes;
+#else
+   return -ENOTSUP;
+#endif
+}
+
+/******************************************************************************/
+/*                                 R e a d X                                  */
+/******************************************************************************/
+
+void XrdOssUring::ReadX(int fd, XrdOucIOVec *readX, ssize_t *rdRes, int n)
+{
+#ifdef XRDOSS_URING
+   int k, batch;
+
+   for (k = 0; k < n; k += batch)
+       {batch = (n - k < maxRVSegs ? n - k : maxRVSegs);
+        Batch(fd, readX+k, rdRes+k, batch, true);
+       }
+#endif
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                 B a t c h                                  */
+/******************************************************************************/
+
+// Submits at most maxRVSegs reads at once and waits for all of them. Reads
+// that could not be submitted are done here. Scatter reads have their
+// iovec array in the data member and the number of elements in info.
+
+void XrdOssUring::Batch(int fd, XrdOucIOVec *vec, ssize_t *res, int n,
+                        bool isX)
+{
+#ifdef XRDOSS_URING
+   XrdOssUringRV  rvCtl;
+   XrdOssUringSeg segs[maxRVSegs];
+   XrdOssUringReq reqs[maxRVSegs];
+   ssize_t rdsz;
+   int i, nsub, nleft;
+
+// Construct the requests
+//
+   rvCtl.rvPend = n;
+   for (i = 0; i < n; i++)
+       {segs[i].rvCtl  = &rvCtl;
+        segs[i].rvRes  = 0;
+        reqs[i].udata  = (unsigned long long)&segs[i] | tagRVSeg;
+        reqs[i].buff   = vec[i].data;
+        reqs[i].offset = vec[i].offset;
+        reqs[i].blen   = (isX ? vec[i].info : vec[i].size);
+        reqs[i].fd     = fd;
+        reqs[i].opcode = (isX ? IORING_OP_READV : IORING_OP_READ);
+       }
+   nsub = getRing()->Submit(reqs, n);
+
+// Anything that could not be submitted is read here. Whoever brings the
+// pending count to zero knows that the batch is complete.
+//
+   if (nsub < n)
+      {for (i = nsub; i < n; i++)
+           {do {rdsz = (isX ? preadv(fd, (struct iovec *)vec[i].data,
+                                     vec[i].info, vec[i].offset)
+                            : pread (fd, vec[i].data, vec[i].size,
+                                     vec[i].offset));
+               } while(rdsz < 0 && errno == EINTR);
+            segs[i].rvRes = (rdsz < 0 ? -errno : rdsz);
+           }
+       nleft = n - nsub;
+       if (AtomicSub(rvCtl.rvPend, nleft) != nleft) rvCtl.rvDone.Wait();
+      } else rvCtl.rvDone.Wait();
+
+// Return the results
+//
+   for (i = 0; i < n; i++) res[i] = segs[i].rvRes;
+#endif
+}
+
+/******************************************************************************/
+/*                                 W r i t e                                  */
+/******************************************************************************/
+
+bool XrdOssUring::Write(XrdSfsAio *aiop, int fd)
+{
+#ifdef XRDOSS_URING
+   XrdOssUringReq rq;
+
+   rq.udata  = (unsigned long long)aiop | tagWrite;
+   rq.buff   = (void *)aiop->sfsAio.aio_buf;
+   rq.offset = aiop->sfsAio.aio_offset;
+   rq.blen   = aiop->sfsAio.aio_nbytes;
+   rq.fd     = fd;
+   rq.opcode = IORING_OP_WRITE;
+   return getRing()->Submit(&rq, 1) == 1;
+#else
+   return false;
+#endif
+}
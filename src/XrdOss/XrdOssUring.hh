@@ -0,0 +1,146 @@
+#ifndef __XRDOSSURING_HH__
+#define __XRDOSSURING_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O s s U r i n g . h h                         */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <sys/types.h>
+
+struct XrdOucIOVec;
+class  XrdSfsAio;
+class  XrdSysError;
+
+//-----------------------------------------------------------------------------
+//! XrdOssUring performs file I/O using Linux io_uring. Requests are placed on
+//! one of several rings by the calling thread and completions are reaped by
+//! a dedicated thread per ring, which then runs the usual XrdSfsAio completion
+//! callbacks. The kernel interface is used directly so no additional library
+//! is needed. When io_uring is unavailable Init() fails and callers continue
+//! to use the standard I/O paths.
+//-----------------------------------------------------------------------------
+
+class XrdOssUring
+{
+public:
+
+//-----------------------------------------------------------------------------
+//! Start an asynchronous fsync. Completion is signalled via aiop->doneWrite().
+//!
+//! @param  aiop   - the aio request.
+//! @param  fd     - the file descriptor to sync.
+//!
+//! @return true   - request queued.
+//! @return false  - request not queued, the caller must handle it.
+//-----------------------------------------------------------------------------
+
+static bool    Fsync(XrdSfsAio *aiop, int fd);
+
+//-----------------------------------------------------------------------------
+//! Create the rings and start their completion threads. This must be called
+//! once at configuration time before any other method is used.
+//!
+//! @param  eDest  - the message routing object.
+//! @param  nrings - the number of rings (hence completion threads) to use.
+//! @param  qdepth - the number of submission entries per ring.
+//!
+//! @return true   - io_uring is now in use.
+//! @return false  - io_uring is not available, a message has been issued.
+//-----------------------------------------------------------------------------
+
+static bool    Init(XrdSysError *eDest, int nrings, int qdepth);
+
+//-----------------------------------------------------------------------------
+//! Determine whether or not io_uring is in use.
+//!
+//! @return true if Init() succeeded, false otherwise.
+//-----------------------------------------------------------------------------
+
+static bool    isOn() {return numRings > 0;}
+
+//-----------------------------------------------------------------------------
+//! Start an asynchronous read. Completion is signalled via aiop->doneRead().
+//!
+//! @param  aiop   - the aio request describing the read.
+//! @param  fd     - the file descriptor to read.
+//!
+//! @return true   - request queued.
+//! @return false  - request not queued, the caller must handle it.
+//-----------------------------------------------------------------------------
+
+static bool    Read(XrdSfsAio *aiop, int fd);
+
+//-----------------------------------------------------------------------------
+//! Perform a vector read. All of the segments are submitted at once and the
+//! call returns when every segment has been read.
+//!
+//! @param  fd     - the file descriptor to read.
+//! @param  readV  - the read vector.
+//! @param  n      - the number of elements in readV.
+//!
+//! @return >= 0   - the number of bytes read.
+//! @return <  0   - -errno; -ESPIPE if a segment could not be fully read.
+//-----------------------------------------------------------------------------
+
+static ssize_t ReadV(int fd, XrdOucIOVec *readV, int n);
+
+//-----------------------------------------------------------------------------
+//! Perform a set of scatter reads. All of the reads are submitted at once and
+//! the call returns when every one of them has completed.
+//!
+//! @param  fd     - the file descriptor to read.
+//! @param  readX  - the reads; for each element data points to an array of
+//!                  struct iovec describing where the data goes, info holds
+//!                  the number of elements in that array and offset is the
+//!                  file offset. The size member is ignored.
+//! @param  rdRes  - receives the result of each read, as returned by preadv().
+//!                  A short read is not completed; that is up to the caller.
+//! @param  n      - the number of elements in readX and rdRes.
+//-----------------------------------------------------------------------------
+
+static void    ReadX(int fd, XrdOucIOVec *readX, ssize_t *rdRes, int n);
+
+//-----------------------------------------------------------------------------
+//! Start an asynchronous write. Completion is signalled via aiop->doneWrite().
+//!
+//! @param  aiop   - the aio request describing the write.
+//! @param  fd     - the file descriptor to write.
+//!
+//! @return true   - request queued.
+//! @return false  - request not queued, the caller must handle it.
+//-----------------------------------------------------------------------------
+
+static bool    Write(XrdSfsAio *aiop, int fd);
+
+               XrdOssUring() {}
+              ~XrdOssUring() {}
+
+private:
+
+static void    Batch(int fd, XrdOucIOVec *vec, ssize_t *res, int n, bool isX);
+
+static int     numRings;
+};
+#endif
@@ -44,7 +44,16 @@
    Status:
       Public Domain
 */
+#include <string.h>
+
 #include "XrdOucCRC.hh"
+#include "XrdSys/XrdSysPlatform.hh"
+
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ > 4 \
+    || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define XRDOUCCRC_SSE42 1
+#include <nmmintrin.h>
+#endif
 
 /*****************************************************************/
 /*                                                               */
@@ -138,6 +147,110 @@ unsigned int XrdOucCRC::crctable[256] =
 /*                   End of CRC Lookup Table                     */
 /*****************************************************************/
 
+/******************************************************************************/
+/*                   S l i c e - b y - 8   C R C   T a b l e s                */
+/******************************************************************************/
+
+/* The slice-by-8 method consumes 8 bytes per step using 8 tables, where entry
+   i of table k is the crc of byte i followed by k zero bytes. The tables for
+   CRC-32 (0xEDB88320 reflected) and CRC-32C (0x82F63B78 reflected) are built
+   when the library is loaded. Until then the byte-at-a-time method is used.
+*/
+namespace
+{
+struct XrdOucCRCTables
+      {unsigned int crc32[8][256];
+       unsigned int crc32c[8][256];
+       bool         hw32C;
+       bool         Ready;
+
+       void Fill(unsigned int T[8][256], unsigned int poly)
+                {unsigned int crc;
+                 int i, j;
+                 for (i = 0; i < 256; i++)
+                     {crc = i;
+                      for (j = 0; j < 8; j++)
+                          crc = (crc >> 1) ^ (crc & 1 ? poly : 0);
+                      T[0][i] = crc;
+                     }
+                 for (i = 0; i < 256; i++)
+                     for (j = 1; j < 8; j++)
+                         T[j][i] = (T[j-1][i] >> 8) ^ T[0][T[j-1][i] & 0xff];
+                }
+
+       XrdOucCRCTables()
+                {Fill(crc32,  0xEDB88320);
+                 Fill(crc32c, 0x82F63B78);
+#ifdef XRDOUCCRC_SSE42
+                 __builtin_cpu_init();
+                 hw32C = __builtin_cpu_supports("sse4.2");
+#else
+                 hw32C = false;
+#endif
+                 Ready = true;
+                }
+      } crcTab;
+
+/******************************************************************************/
+/*                                S l i c e 8                                 */
+/******************************************************************************/
+
+unsigned int Slice8(const unsigned int T[8][256], unsigned int crc,
+                    const unsigned char *p, size_t n)
+{
+#ifndef Xrd_Big_Endian
+   uint32_t w1, w2;
+
+// Align the input and then process 8 bytes at a time
+//
+   while(n && ((uintptr_t)p & 3))
+        {crc = T[0][(crc ^ *p++) & 0xff] ^ (crc >> 8); n--;}
+
+   while(n >= 8)
+        {memcpy(&w1, p, 4); memcpy(&w2, p+4, 4);
+         w1 ^= crc;
+         crc = T[7][ w1        & 0xff] ^ T[6][(w1 >>  8) & 0xff]
+             ^ T[5][(w1 >> 16) & 0xff] ^ T[4][ w1 >> 24        ]
+             ^ T[3][ w2        & 0xff] ^ T[2][(w2 >>  8) & 0xff]
+             ^ T[1][(w2 >> 16) & 0xff] ^ T[0][ w2 >> 24        ];
+         p += 8; n -= 8;
+        }
+#endif
+
+// Process the trailing bytes
+//
+   while(n--) crc = T[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+   return crc;
+}
+
+/******************************************************************************/
+/*                             C a l c 3 2 C H W                              */
+/******************************************************************************/
+
+#ifdef XRDOUCCRC_SSE42
+__attribute__((target("sse4.2")))
+uint32_t Calc32CHW(uint32_t crc, const unsigned char *p, size_t n)
+{
+   uint64_t crc64, w;
+
+// Align the input and then use the 8 byte form of the crc32 instruction
+//
+   while(n && ((uintptr_t)p & 7)) {crc = _mm_crc32_u8(crc, *p++); n--;}
+
+   crc64 = crc;
+   while(n >= 8)
+        {memcpy(&w, p, 8);
+         crc64 = _mm_crc32_u64(crc64, w);
+         p += 8; n -= 8;
+        }
+   crc = (uint32_t)crc64;
+
+   while(n--) crc = _mm_crc32_u8(crc, *p++);
+   return crc;
+}
+#endif
+}
+
 /* Calculate CRC-32 Checksum for NAACCR Record,
    skipping area of record containing checksum field.
 
@@ -168,11 +281,39 @@ unsigned int XrdOucCRC::CRC32(const unsigned char *p, int reclen)
    const unsigned int CRC32_XOROT = 0xffffffff;
    unsigned int crc = CRC32_XINIT;
 
-// Process each byte
+// Process the buffer, byte by byte if the slice tables are not yet built
 //
-   while(reclen-- > 0) crc = crctable[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+   if (reclen <= 0) return crc ^ CRC32_XOROT;
+   if (crcTab.Ready) crc = Slice8(crcTab.crc32, crc, p, reclen);
+      else while(reclen-- > 0) crc = crctable[(crc ^ *p++) & 0xff] ^ (crc >> 8);
 
 // Return XOR out value
 //
    return crc ^ CRC32_XOROT;
 }
+
+/******************************************************************************/
+/*                               C a l c 3 2 C                                */
+/******************************************************************************/
+
+uint32_t XrdOucCRC::Calc32C(const void *data, size_t count, uint32_t prevcs)
+{
+   const unsigned char *p = (const unsigned char *)data;
+   uint32_t crc = ~prevcs;
+   int i;
+
+// Use the crc32 instruction if we can, the tables otherwise
+//
+#ifdef XRDOUCCRC_SSE42
+   if (crcTab.hw32C) return ~Calc32CHW(crc, p, count);
+#endif
+   if (crcTab.Ready) return ~Slice8(crcTab.crc32c, crc, p, count);
+
+// The tables are not built yet, compute the crc bit by bit
+//
+   while(count--)
+        {crc ^= *p++;
+         for (i = 0; i < 8; i++) crc = (crc >> 1) ^ (crc & 1 ? 0x82F63B78 : 0);
+        }
+   return ~crc;
+}
@@ -30,12 +30,21 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <sys/types.h>
+#include <inttypes.h>
+
 class XrdOucCRC
 {
 public:
 
 static unsigned int CRC32(const unsigned char *rec, int reclen);
 
+// Calc32C computes the CRC-32C (Castagnoli) checksum of a buffer. To checksum
+// data in pieces pass the result of the previous call as prevcs. The SSE4.2
+// crc32 instruction is used when the cpu supports it.
+//
+static uint32_t     Calc32C(const void *data, size_t count, uint32_t prevcs=0);
+
                     XrdOucCRC() {}
                    ~XrdOucCRC() {}
 
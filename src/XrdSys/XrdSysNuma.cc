@@ -0,0 +1,202 @@
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d S y s N u m a . c c                          */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#endif
+
+#include "XrdSys/XrdSysNuma.hh"
+
+/******************************************************************************/
+/*                        S t a t i c   O b j e c t s                         */
+/******************************************************************************/
+
+signed char *XrdSysNuma::cpu2Node = 0;
+int          XrdSysNuma::numCPUs  = 0;
+int          XrdSysNuma::numNodes = 1;
+
+/******************************************************************************/
+/*                                  B i n d                                   */
+/******************************************************************************/
+  
+bool XrdSysNuma::Bind(void *addr, size_t alen, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+   static const int mpolPreferred = 1; // MPOL_PREFERRED
+   unsigned long nodeMask;
+
+// Nothing to do if there is only one node
+//
+   if (numNodes <= 1) return true;
+   if (node < 0 || node >= numNodes || node >= (int)sizeof(nodeMask)*8)
+      {errno = EINVAL; return false;}
+
+// Set the policy for this range of memory
+//
+   nodeMask = 1UL << node;
+   return syscall(SYS_mbind, addr, alen, mpolPreferred, &nodeMask,
+                  sizeof(nodeMask)*8, 0) == 0;
+#else
+   return true;
+#endif
+}
+
+/******************************************************************************/
+/*                                  C P U s                                   */
+/******************************************************************************/
+  
+int XrdSysNuma::CPUs(int node)
+{
+   int cpu, n = 0;
+
+   if (node < 0 || node >= numNodes) return 0;
+   if (!cpu2Node) return 1;
+   for (cpu = 0; cpu < numCPUs; cpu++) if (cpu2Node[cpu] == node) n++;
+   return n;
+}
+
+/******************************************************************************/
+/*                               C u r N o d e                                */
+/******************************************************************************/
+  
+int XrdSysNuma::CurNode()
+{
+#ifdef __linux__
+   return (numNodes > 1 ? CPUNode(sched_getcpu()) : 0);
+#else
+   return 0;
+#endif
+}
+
+/******************************************************************************/
+/*                                F D N o d e                                 */
+/******************************************************************************/
+  
+int XrdSysNuma::FDNode(int fd)
+{
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+   socklen_t optLen = sizeof(int);
+   int cpu;
+
+   if (numNodes <= 1) return 0;
+   if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &optLen)
+   ||  cpu < 0 || cpu >= numCPUs) return -1;
+   return cpu2Node[cpu];
+#else
+   return (numNodes <= 1 ? 0 : -1);
+#endif
+}
+
+/******************************************************************************/
+/*                                  I n i t                                   */
+/******************************************************************************/
+  
+int XrdSysNuma::Init()
+{
+#ifdef __linux__
+   static const char *nodeDir = "/sys/devices/system/node";
+   struct dirent *dP;
+   DIR  *DFD;
+   FILE *cpuList;
+   char  path[PATH_MAX], *cP, *eP;
+   int   node, cpu, cEnd, maxNode = 0;
+
+// Establish the number of processors and assume they are all on node 0
+//
+   if (cpu2Node) return numNodes;
+   if ((numCPUs = sysconf(_SC_NPROCESSORS_CONF)) <= 0) numCPUs = 1;
+   cpu2Node = (signed char *)calloc(numCPUs, sizeof(signed char));
+
+// Each node has a directory that lists its processors in a compact form
+// (e.g. 0-7,16-23). Should we not find any, we have a single node.
+//
+   if (!(DFD = opendir(nodeDir))) return numNodes;
+   while((dP = readdir(DFD)))
+        {if (strncmp(dP->d_name, "node", 4)) continue;
+         node = strtol(dP->d_name+4, &eP, 10);
+         if (*eP || node < 0 || node >= maxNodes) continue;
+         snprintf(path, sizeof(path), "%s/%s/cpulist", nodeDir, dP->d_name);
+         if (!(cpuList = fopen(path, "r"))) continue;
+         if (fgets(path, sizeof(path), cpuList))
+            {cP = path;
+             while(*cP && *cP != '\n')
+                  {cpu = cEnd = strtol(cP, &eP, 10);
+                   if (eP == cP) break;
+                   if (*eP == '-') {cP = eP+1; cEnd = strtol(cP, &eP, 10);}
+                   for ( ; cpu <= cEnd; cpu++)
+                       if (cpu >= 0 && cpu < numCPUs) cpu2Node[cpu] = node;
+                   cP = (*eP == ',' ? eP+1 : eP);
+                  }
+            }
+         fclose(cpuList);
+         if (node > maxNode) maxNode = node;
+        }
+   closedir(DFD);
+
+// All done
+//
+   numNodes = maxNode+1;
+#endif
+   return numNodes;
+}
+
+/******************************************************************************/
+/*                                   P i n                                    */
+/******************************************************************************/
+  
+bool XrdSysNuma::Pin(int node)
+{
+#ifdef __linux__
+   cpu_set_t cpuSet;
+   int cpu, rc;
+
+// Construct the set of processors on this node
+//
+   if (node < 0 || node >= numNodes) {errno = EINVAL; return false;}
+   CPU_ZERO(&cpuSet);
+   for (cpu = 0; cpu < numCPUs && cpu < CPU_SETSIZE; cpu++)
+       if (cpu2Node[cpu] == node) CPU_SET(cpu, &cpuSet);
+
+// Restrict ourselves to that set
+//
+   if ((rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet)))
+      {errno = rc; return false;}
+#endif
+   return true;
+}
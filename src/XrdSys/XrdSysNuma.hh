@@ -0,0 +1,133 @@
+#ifndef __XRDSYSNUMA_HH__
+#define __XRDSYSNUMA_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d S y s N u m a . h h                          */
+/*                                                                            */
+/* (c) 2026 by the XRootD contributors                                        */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+//! XrdSysNuma provides the minimal NUMA topology and placement services used
+//! by the server. It talks directly to the kernel (sysfs and system calls) so
+//! that no additional library is needed. On platforms without NUMA support
+//! the system appears to have a single node and all placement calls succeed
+//! without doing anything.
+//-----------------------------------------------------------------------------
+
+class XrdSysNuma
+{
+public:
+
+//-----------------------------------------------------------------------------
+//! Ask the kernel to place memory on a particular node. This must be called
+//! before the memory is first touched.
+//!
+//! @param  addr   - page aligned address of the memory.
+//! @param  alen   - length of the memory.
+//! @param  node   - the node where the memory should preferably live.
+//!
+//! @return true   - placement set.
+//! @return false  - placement not set, errno has the reason.
+//-----------------------------------------------------------------------------
+
+static bool        Bind(void *addr, size_t alen, int node);
+
+//-----------------------------------------------------------------------------
+//! Get the node of the processor the calling thread is running on.
+//!
+//! @return the node number (0 if it cannot be determined).
+//-----------------------------------------------------------------------------
+
+static int         CurNode();
+
+//-----------------------------------------------------------------------------
+//! Get the number of processors on a node. Nodes that only provide memory
+//! have none and threads cannot be pinned to them.
+//!
+//! @param  node   - the node in question.
+//!
+//! @return the number of processors on the node.
+//-----------------------------------------------------------------------------
+
+static int         CPUs(int node);
+
+//-----------------------------------------------------------------------------
+//! Get the node that handles incoming traffic for a socket. This is the node
+//! of the processor that last processed packets for the socket, which is
+//! normally the one servicing the network card's receive queue.
+//!
+//! @param  fd     - the socket file descriptor.
+//!
+//! @return >=0    - the node number.
+//! @return < 0    - the node could not be determined.
+//-----------------------------------------------------------------------------
+
+static int         FDNode(int fd);
+
+//-----------------------------------------------------------------------------
+//! Discover the NUMA topology. This must be called once before any other
+//! method is used. It is not MT-safe.
+//!
+//! @return the number of nodes (1 when the system is not NUMA).
+//-----------------------------------------------------------------------------
+
+static int         Init();
+
+//-----------------------------------------------------------------------------
+//! Get the number of nodes discovered by Init().
+//!
+//! @return the number of nodes.
+//-----------------------------------------------------------------------------
+
+static int         Nodes() {return numNodes;}
+
+//-----------------------------------------------------------------------------
+//! Restrict the calling thread to run only on the processors of a node.
+//!
+//! @param  node   - the node to run on.
+//!
+//! @return true   - thread pinned.
+//! @return false  - thread not pinned, errno has the reason.
+//-----------------------------------------------------------------------------
+
+static bool        Pin(int node);
+
+static const int   maxNodes = 64;  // Highest number of nodes supported
+
+                   XrdSysNuma() {}
+                  ~XrdSysNuma() {}
+
+private:
+
+static int   CPUNode(int cpu)
+                    {return (cpu >= 0 && cpu < numCPUs ? cpu2Node[cpu] : 0);}
+
+static signed char *cpu2Node;
+static int          numCPUs;
+static int          numNodes;
+};
+#endif
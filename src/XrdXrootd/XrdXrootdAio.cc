@@ -33,6 +33,7 @@
 #include "Xrd/XrdBuffer.hh"
 #include "Xrd/XrdLink.hh"
 #include "XProtocol/XProtocol.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
@@ -573,6 +574,9 @@ void XrdXrootdAioReq::endRead()
 //
    if (!numActive) 
       {myFile->Stats.rdOps(aioTotal);
+       AtomicBeg(XrdXrootdAio::SI->statsMutex);
+       AtomicAdd(XrdXrootdAio::SI->rdCopyB, aioTotal);
+       AtomicEnd(XrdXrootdAio::SI->statsMutex);
        Recycle(1, aiop);
       }
       else {aiop->Next = aioFree, aioFree = aiop;
@@ -482,6 +482,7 @@ int XrdXrootdProtocol::Config(const char *ConfigFN)
              else if TS_Xeq("monitor",       xmon);
              else if TS_Xeq("pidpath",       xpidf);
              else if TS_Xeq("prep",          xprep);
+             else if TS_Xeq("readv",         xreadv);
              else if TS_Xeq("redirect",      xred);
              else if TS_Xeq("seclib",        xsecl);
              else if TS_Xeq("trace",         xtrace);
@@ -1259,6 +1260,61 @@ int XrdXrootdProtocol::xprep(XrdOucStream &Config)
    return 0;
 }
 
+/******************************************************************************/
+/*                                x r e a d v                                 */
+/******************************************************************************/
+
+/* Function: xreadv
+
+   Purpose:  To parse the directive: readv [pipeline {off | <nbuf>}]
+                                           [maxsegs <nseg>]
+
+             <nbuf>    the number of buffers used to overlap reading the data
+                       for a large vector read with sending it to the client.
+                       While one buffer is being sent the remaining ones are
+                       being filled. The value must be between 2 and 16. The
+                       default is off, which reads and sends one buffer at a
+                       time.
+             <nseg>    the maximum number of segments in a vector read when the
+                       pipeline is on. The default is 1024, the maximum 65536.
+                       Without the pipeline the limit is always 1024.
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdXrootdProtocol::xreadv(XrdOucStream &Config)
+{
+    char *val;
+    int nbuf = rvPipe, nseg = rvMaxSegs;
+
+    if (!(val = Config.GetWord()))
+       {eDest.Emsg("Config", "readv option not specified"); return 1;}
+
+    do {     if (!strcmp(val, "pipeline"))
+                {if (!(val = Config.GetWord()))
+                    {eDest.Emsg("Config", "readv pipeline not specified");
+                     return 1;
+                    }
+                 if (!strcmp(val, "off")) nbuf = 0;
+                    else if (XrdOuca2x::a2i(eDest, "readv pipeline", val,
+                                            &nbuf, 2, 16)) return 1;
+                }
+        else if (!strcmp(val, "maxsegs"))
+                {if (!(val = Config.GetWord()))
+                    {eDest.Emsg("Config", "readv maxsegs not specified");
+                     return 1;
+                    }
+                 if (XrdOuca2x::a2i(eDest, "readv maxsegs", val, &nseg,
+                                    1, 65536)) return 1;
+                }
+        else {eDest.Emsg("Config", "invalid readv option -", val); return 1;}
+       } while((val = Config.GetWord()));
+
+    rvPipe    = nbuf;
+    rvMaxSegs = nseg;
+    return 0;
+}
+
 /******************************************************************************/
 /*                                  x r e d                                   */
 /******************************************************************************/
@@ -34,6 +34,7 @@
 #include "Xrd/XrdLink.hh"
 #include "XProtocol/XProtocol.hh"
 #include "XrdOuc/XrdOucStream.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdXrootd/XrdXrootdAio.hh"
 #include "XrdXrootd/XrdXrootdFile.hh"
@@ -92,6 +93,8 @@ XrdNetSocket         *XrdXrootdProtocol::AdminSock= 0;
 int                   XrdXrootdProtocol::hcMax        = 28657; // const for now
 int                   XrdXrootdProtocol::maxBuffsz;
 int                   XrdXrootdProtocol::maxTransz    = 262144; // 256KB
+int                   XrdXrootdProtocol::rvPipe       = 0;
+int                   XrdXrootdProtocol::rvMaxSegs    = maxRvecsz;
 int                   XrdXrootdProtocol::as_maxperlnk = 8;   // Max ops per link
 int                   XrdXrootdProtocol::as_maxperreq = 8;   // Max ops per request
 int                   XrdXrootdProtocol::as_maxpersrv = 4096;// Max ops per server
@@ -586,6 +589,8 @@ int XrdXrootdProtocol::Stats(char *buff, int blen, int do_sync)
        cumSegsV += numSegsV; numSegsV = 0;
        SI->writeCnt += numWrites;
        cumWrites+= numWrites;numWrites = 0;
+       AtomicAdd(SI->rdCopyB, numCopyB); numCopyB = 0;
+       AtomicAdd(SI->rdZcpyB, numZcpyB); numZcpyB = 0;
        SI->statsMutex.UnLock();
       }
 
@@ -675,6 +680,7 @@ void XrdXrootdProtocol::Cleanup()
 //
    SI->statsMutex.Lock();
    SI->readCnt += numReads; SI->writeCnt += numWrites;
+   AtomicAdd(SI->rdCopyB, numCopyB); AtomicAdd(SI->rdZcpyB, numZcpyB);
    SI->statsMutex.UnLock();
 
 // Handle authentication protocol
@@ -736,6 +742,8 @@ void XrdXrootdProtocol::Reset()
    numSegsV           = 0;
    numWrites          = 0;
    numFiles           = 0;
+   numCopyB           = 0;
+   numZcpyB           = 0;
    cumReads           = 0;
    cumReadV           = 0;
    cumSegsV           = 0;
@@ -66,6 +66,7 @@
 
 class XrdNetSocket;
 class XrdOucErrInfo;
+struct XrdOucIOVec;
 class XrdOucReqID;
 class XrdOucStream;
 class XrdOucTList;
@@ -159,6 +160,8 @@ enum RD_func {RD_chmod = 0, RD_chksum,  RD_dirlist, RD_locate, RD_mkdir,
        int   do_Qxattr();
        int   do_Read();
        int   do_ReadV();
+       int   do_ReadVP(XrdOucIOVec *rdVec, int rdVecNum);
+       int   do_ReadVS(XrdOucIOVec *rdVec, int rdVecNum);
        int   do_ReadAll(int asyncOK=1);
        int   do_ReadNone(int &retc, int &pathID);
        int   do_Rm();
@@ -189,6 +192,7 @@ static int   Config(const char *fn);
        int   fsRedir(RD_func xfnc);
        int   fsRedirNoEnt(const char *eMsg, char *Cgi, int popt);
        int   getBuff(const int isRead, int Quantum);
+       void  rvStats(XrdOucIOVec *rdVec, int rdVecNum);
        int   getData(const char *dtype, char *buff, int blen);
        void  logLogin(bool xauth=false);
 static int   mapMode(int mode);
@@ -210,6 +214,7 @@ static int   xpidf(XrdOucStream &Config);
 static int   xprep(XrdOucStream &Config);
 static int   xlog(XrdOucStream &Config);
 static int   xmon(XrdOucStream &Config);
+static int   xreadv(XrdOucStream &Config);
 static int   xred(XrdOucStream &Config);
 static void  xred_set(RD_func func, char *rHost[2], int rPort[2]);
 static bool  xred_xok(int     func, char *rHost[2], int rPort[2]);
@@ -292,6 +297,8 @@ static int                 as_syncw;     // writes to be synchronous
 static int                 maxBuffsz;    // Maximum buffer size we can have
 static int                 maxTransz;    // Maximum transfer size we can have
 static const int           maxRvecsz = 1024;   // Maximum read vector size
+static int                 rvPipe;       // readv pipeline buffers (0 -> off)
+static int                 rvMaxSegs;    // readv maximum segments if pipelined
 
 // Statistical area
 //
@@ -302,6 +309,8 @@ int                        numReadV;     // Count for kR_readv
 int                        numSegsV;     // Count for kR_readv segmens
 int                        numWrites;    // Count
 int                        numFiles;     // Count
+long long                  numCopyB;     // Bytes read via a buffer copy
+long long                  numZcpyB;     // Bytes read without a copy
 
 int                        cumReads;     // Count less numReads
 int                        cumReadP;     // Count less numReadP
@@ -319,6 +319,37 @@ int XrdXrootdResponse::Send(XrdOucSFVec *sfvec, int sfvnum, int dlen)
 
 /******************************************************************************/
 
+int XrdXrootdResponse::Send(XResponseType rcode, XrdOucSFVec *sfvec,
+                            int sfvnum, int dlen)
+{
+
+   TRACES(RSP, "sendfile " <<dlen <<" data bytes; status=" <<rcode);
+
+// A bridge can only accept a final response in this form
+//
+   if (Bridge)
+      {if (rcode == kXR_ok && Bridge->Send(sfvec, sfvnum, dlen) >= 0)
+          return 0;
+       return Link->setEtext("send failure");
+      }
+
+// We are only called should sendfile be enabled for this response
+//
+   Resp.status = static_cast<kXR_unt16>(htons(rcode));
+   Resp.dlen   = static_cast<kXR_int32>(htonl(dlen));
+   sfvec[0].buffer = (char *)&Resp;
+   sfvec[0].sendsz = sizeof(Resp);
+   sfvec[0].fdnum  = -1;
+
+// Send off the request
+//
+    if (Link->Send(sfvec, sfvnum) < 0)
+       return Link->setEtext("sendfile failure");
+    return 0;
+}
+
+/******************************************************************************/
+
 int XrdXrootdResponse::Send(XrdXrootdReqID &ReqID, 
                             XResponseType   Status,
                             struct iovec   *IOResp, 
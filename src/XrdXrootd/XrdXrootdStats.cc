@@ -62,6 +62,8 @@ AsyncNum = 0;     // Stats: Number of async ops
 AsyncMax = 0;     // Stats: Number of async max
 AsyncRej = 0;     // Stats: Number of async rejected
 AsyncNow = 0;     // Stats: Number of async now (not locked)
+rdCopyB  = 0;     // Stats: Bytes read via a buffer copy
+rdZcpyB  = 0;     // Stats: Bytes read without a buffer copy
 Refresh  = 0;     // Stats: Number of refresh requests
 LoginAT  = 0;     // Stats: Number of   attempted     logins
 LoginAU  = 0;     // Stats: Number of   authenticated logins
@@ -80,6 +82,7 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
    "<rv>%lld</rv><rs>%lld</rs><wr>%lld</wr>"
    "<sync>%d</sync><getf>%d</getf><putf>%d</putf><misc>%d</misc></ops>"
    "<aio><num>%lld</num><max>%d</max><rej>%lld</rej></aio>"
+   "<xfr><cp>%lld</cp><zc>%lld</zc></xfr>"
    "<err>%d</err><rdr>%lld</rdr><dly>%d</dly>"
    "<lgn><num>%d</num><af>%d</af><au>%d</au><ua>%d</ua></lgn></stats>";
 //                                   1 2 3 4 5 6 7 8
@@ -94,7 +97,7 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
        len = snprintf(dummy, sizeof(dummy), statfmt, INMax, INMax, INMax, LLMax,
                       LLMax, LLMax, LLMax, LLMax, INMax, INMax,
                       INMax, INMax,
-                      LLMax, INMax, LLMax, INMax, LLMax, INMax,
+                      LLMax, INMax, LLMax, LLMax, LLMax, INMax, LLMax, INMax,
                       INMax, INMax, INMax, INMax);
        return len + (fsP ? fsP->getStats(0,0) : 0);
       }
@@ -105,7 +108,8 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
    len = snprintf(buff, blen, statfmt, Count, openCnt, Refresh, readCnt,
                   prerCnt, rvecCnt, rsegCnt, writeCnt, syncCnt, getfCnt,
                   putfCnt, miscCnt,
-                  AsyncNum, AsyncMax, AsyncRej, errorCnt, redirCnt, stallCnt,
+                  AsyncNum, AsyncMax, AsyncRej, rdCopyB, rdZcpyB,
+                  errorCnt, redirCnt, stallCnt,
                   LoginAT, AuthBad, LoginAU, LoginUA);
    statsMutex.UnLock();
 
@@ -56,6 +56,8 @@ int              miscCnt;      // Stats: Number of miscellaneous
 long long        AsyncNum;     // Stats: Number of async ops
 long long        AsyncRej;     // Stats: Number of async rejected
 long long        AsyncNow;     // Stats: Number of async now (not locked)
+long long        rdCopyB;      // Stats: Bytes read via a buffer copy
+long long        rdZcpyB;      // Stats: Bytes read without a buffer copy
 int              AsyncMax;     // Stats: Number of async max
 int              Refresh;      // Stats: Number of refresh requests
 int              LoginAT;      // Stats: Number of   attempted     logins
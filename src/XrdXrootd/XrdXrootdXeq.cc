@@ -40,7 +40,9 @@
 #include "XrdOuc/XrdOucTokenizer.hh"
 #include "XrdSec/XrdSecInterface.hh"
 #include "Xrd/XrdBuffer.hh"
+#include "Xrd/XrdJob.hh"
 #include "Xrd/XrdLink.hh"
+#include "Xrd/XrdScheduler.hh"
 #include "XrdXrootd/XrdXrootdAio.hh"
 #include "XrdXrootd/XrdXrootdCallBack.hh"
 #include "XrdXrootd/XrdXrootdFile.hh"
@@ -87,6 +89,204 @@ struct XrdXrootdSessID
        ~XrdXrootdSessID() {}
        };
 
+// Frees a read vector that was too large to be placed on the stack
+//
+struct XrdXrootdIOVHelper
+       {XrdOucIOVec *vP;
+
+        XrdXrootdIOVHelper() : vP(0) {}
+       ~XrdXrootdIOVHelper() {if (vP) delete [] vP;}
+       };
+
+// Reads one buffer's worth of a pipelined readv. Each element of the read
+// vector has its file in the parallel fileV vector. The job is owned jointly
+// by the scheduler and the requesting thread. Whoever claims it first does
+// the reads so the requester never waits for a job that has not started.
+//
+class XrdXrootdRVJob : public XrdJob
+{
+public:
+
+bool            Claim() {rvMutex.Lock();
+                         bool isMine = !rvClaimed; rvClaimed = true;
+                         rvMutex.UnLock();
+                         return isMine;
+                        }
+
+void            DoIt() {if (Claim()) {Read(); rvDone.Post();}
+                        Recycle();
+                       }
+
+void            Read();
+
+void            Recycle() {rvMutex.Lock(); int n = --rvRefs; rvMutex.UnLock();
+                           if (!n) delete this;
+                          }
+
+XrdSysSemaphore rvDone;
+XrdOucIOVec    *rdVec;
+XrdXrootdFile **fileV;
+XrdXrootdFile  *errFile;
+int             vBeg;
+int             vEnd;
+int             rvRC;
+
+                XrdXrootdRVJob(XrdOucIOVec *vec, XrdXrootdFile **fvec,
+                               int vb, int ve)
+                              : XrdJob("readv pipe"), rvDone(0),
+                                rdVec(vec), fileV(fvec), errFile(0),
+                                vBeg(vb), vEnd(ve), rvRC(0),
+                                rvRefs(2), rvClaimed(false) {}
+private:
+               ~XrdXrootdRVJob() {}
+
+XrdSysMutex     rvMutex;
+int             rvRefs;
+bool            rvClaimed;
+};
+
+void XrdXrootdRVJob::Read()
+{
+   XrdSfsXferSize rdVAmt, xfrSZ;
+   int i, j;
+
+// Issue one readv() for each run of elements that refer to the same file
+//
+   for (i = vBeg; i < vEnd; i = j)
+       {rdVAmt = rdVec[i].size;
+        for (j = i+1; j < vEnd && fileV[j] == fileV[i]; j++)
+            rdVAmt += rdVec[j].size;
+        xfrSZ = fileV[i]->XrdSfsp->readv(&rdVec[i], j-i);
+        if (xfrSZ != rdVAmt)
+           {if (xfrSZ >= 0)
+               {xfrSZ = SFS_ERROR;
+                fileV[i]->XrdSfsp->error.setErrInfo(-ENODATA,"readv past EOF");
+               }
+            rvRC = xfrSZ; errFile = fileV[i];
+            return;
+           }
+       }
+}
+
+// Holds the buffers and outstanding jobs of a pipelined readv. Upon
+// destruction all jobs are finished and all buffers are returned.
+//
+class XrdXrootdRVPipe
+{
+public:
+
+bool            Alloc(int bsz);
+
+void            Drain();
+
+int             Fill(int slot, XrdOucIOVec *rdVec, int vBeg, int vNum);
+
+int             Finish(int slot, XrdXrootdFile *&eFile, bool doRead=true);
+
+XrdXrootdFile **fileV;
+XrdBuffer     **buffV;
+int            *bLen;
+int            *vEnd;
+
+                XrdXrootdRVPipe(XrdBuffManager *bp, XrdScheduler *sp,
+                                int nvec, int nslots);
+               ~XrdXrootdRVPipe();
+private:
+
+XrdBuffManager  *bPool;
+XrdScheduler    *Sched;
+XrdXrootdRVJob **jobV;
+int              maxLen;
+int              numSlots;
+};
+
+XrdXrootdRVPipe::XrdXrootdRVPipe(XrdBuffManager *bp, XrdScheduler *sp,
+                                 int nvec, int nslots)
+                : bPool(bp), Sched(sp), maxLen(0), numSlots(nslots)
+{
+   fileV = new XrdXrootdFile*[nvec];
+   buffV = new XrdBuffer*[nslots];
+   jobV  = new XrdXrootdRVJob*[nslots];
+   bLen  = new int[nslots];
+   vEnd  = new int[nslots];
+   memset(buffV, 0, sizeof(XrdBuffer *)*nslots);
+   memset(jobV,  0, sizeof(XrdXrootdRVJob *)*nslots);
+}
+
+XrdXrootdRVPipe::~XrdXrootdRVPipe()
+{
+   int i;
+
+   Drain();
+   for (i = 0; i < numSlots; i++) if (buffV[i]) bPool->Release(buffV[i]);
+   delete [] fileV; delete [] buffV; delete [] jobV;
+   delete [] bLen;  delete [] vEnd;
+}
+
+bool XrdXrootdRVPipe::Alloc(int bsz)
+{
+   int i;
+
+   for (i = 0; i < numSlots; i++)
+       if (!(buffV[i] = bPool->Obtain(bsz))) return false;
+   maxLen = bsz;
+   return true;
+}
+
+void XrdXrootdRVPipe::Drain()
+{
+   XrdXrootdFile *eFile;
+   int i;
+
+   for (i = 0; i < numSlots; i++) if (jobV[i]) Finish(i, eFile, false);
+}
+
+int XrdXrootdRVPipe::Fill(int slot, XrdOucIOVec *rdVec, int vBeg, int vNum)
+{
+   const int hdrSZ = sizeof(readahead_list);
+   struct readahead_list respHdr;
+   char *buffp = buffV[slot]->buff;
+   int i, n = 0;
+
+// Lay out as many elements as will fit in the buffer. The caller has already
+// made sure that any single element fits.
+//
+   for (i = vBeg; i < vNum && n + rdVec[i].size + hdrSZ <= maxLen; i++)
+       {memcpy(respHdr.fhandle, &rdVec[i].info, sizeof(respHdr.fhandle));
+        respHdr.rlen   = htonl(rdVec[i].size);
+        respHdr.offset = htonll(rdVec[i].offset);
+        memcpy(buffp, &respHdr, hdrSZ);
+        rdVec[i].data = buffp + hdrSZ;
+        buffp += rdVec[i].size + hdrSZ; n += rdVec[i].size + hdrSZ;
+       }
+   bLen[slot] = n; vEnd[slot] = i;
+
+// Have the reads done in the background
+//
+   jobV[slot] = new XrdXrootdRVJob(rdVec, fileV, vBeg, i);
+   Sched->Schedule(jobV[slot]);
+   return i;
+}
+
+int XrdXrootdRVPipe::Finish(int slot, XrdXrootdFile *&eFile, bool doRead)
+{
+   XrdXrootdRVJob *jP = jobV[slot];
+   int rc;
+
+// If the job has not yet started we do the reads ourselves (or skip them),
+// otherwise wait for it to complete.
+//
+   if (jP->Claim()) {if (doRead) jP->Read();}
+      else jP->rvDone.Wait();
+
+// Return the result and let go of the job
+//
+   rc = jP->rvRC; eFile = jP->errFile;
+   jobV[slot] = 0;
+   jP->Recycle();
+   return rc;
+}
+
 /******************************************************************************/
 /*                         L o c a l   D e f i n e s                          */
 /******************************************************************************/
@@ -1601,7 +1801,7 @@ int XrdXrootdProtocol::do_Qconf()
             bp += n; bleft -= n;
            }
    else if (!strcmp("readv_iov_max", val)) 
-           {n = snprintf(bp, bleft, "%d\n", maxRvecsz);
+           {n = snprintf(bp, bleft, "%d\n", (rvPipe ? rvMaxSegs : maxRvecsz));
             bp += n; bleft -= n;
            }
    else if (!strcmp("role", val))
@@ -1919,11 +2119,11 @@ int XrdXrootdProtocol::do_ReadAll(int asyncOK)
    if (myFile->isMMapped)
       {if (myOffset >= myFile->Stats.fSize) return Response.Send();
        if (myOffset+myIOLen <= myFile->Stats.fSize)
-          {myFile->Stats.rdOps(myIOLen);
+          {myFile->Stats.rdOps(myIOLen); numZcpyB += myIOLen;
            return Response.Send(myFile->mmAddr+myOffset, myIOLen);
           }
        xframt = myFile->Stats.fSize -myOffset;
-       myFile->Stats.rdOps(xframt);
+       myFile->Stats.rdOps(xframt); numZcpyB += xframt;
        return Response.Send(myFile->mmAddr+myOffset, xframt);
       }
 
@@ -1933,7 +2133,9 @@ int XrdXrootdProtocol::do_ReadAll(int asyncOK)
    &&  myOffset+myIOLen <= myFile->Stats.fSize)
       {myFile->Stats.rdOps(myIOLen);
        if (myFile->fdNum >= 0)
-          return Response.Send(myFile->fdNum, myOffset, myIOLen);
+          {numZcpyB += myIOLen;
+           return Response.Send(myFile->fdNum, myOffset, myIOLen);
+          }
        rc = myFile->XrdSfsp->SendData((XrdSfsDio *)this, myOffset, myIOLen);
        if (rc == SFS_OK)
           {if (!myIOLen)    return 0;
@@ -1961,6 +2163,7 @@ int XrdXrootdProtocol::do_ReadAll(int asyncOK)
 //
    myFile->Stats.rdOps(myIOLen);
    do {if ((xframt = myFile->XrdSfsp->read(myOffset, buff, Quantum)) <= 0) break;
+       numCopyB += xframt;
        if (xframt >= myIOLen) return Response.Send(buff, xframt);
        if (Response.Send(kXR_oksofar, buff, xframt) < 0) return -1;
        myOffset += xframt; myIOLen -= xframt;
@@ -2034,8 +2237,9 @@ int XrdXrootdProtocol::do_ReadV()
 // The readv file system code originally added by Brian Bockelman, UNL.
 //
    const int hdrSZ = sizeof(readahead_list);
-   struct XrdOucIOVec     rdVec[maxRvecsz+1];
+   struct XrdOucIOVec     rdVecS[maxRvecsz+1], *rdVec = rdVecS;
    struct readahead_list *raVec, respHdr;
+   XrdXrootdIOVHelper     rdVecHelp;
    long long totSZ;
    XrdSfsXferSize rdVAmt, rdVXfr, xfrSZ = 0;
    int rdVBeg, rdVBreak, rdVNow, rdVNum, rdVecNum;
@@ -2056,7 +2260,10 @@ int XrdXrootdProtocol::do_ReadV()
 // prevent cross-cpu memory cache synchronization.
 //
    if (rdVecNum > maxRvecsz)
-      return Response.Send(kXR_ArgTooLong, "Read vector is too long");
+      {if (!rvPipe || rdVecNum > rvMaxSegs)
+          return Response.Send(kXR_ArgTooLong, "Read vector is too long");
+       rdVec = rdVecHelp.vP = new XrdOucIOVec[rdVecNum+1];
+      }
 
 // So, now we account for the number of readv requests and total segments
 //
@@ -2091,6 +2298,17 @@ int XrdXrootdProtocol::do_ReadV()
    if (totSZ > 0x7fffffffLL)
       return Response.Send(kXR_NoMemory, "Total readv transfer is too large");
 
+// If the segments are large enough to be worth it, try to send the data
+// directly from the files instead of copying it into our buffers.
+//
+   if (totSZ - rdVecLen >= (long long)rdVBreak * as_minsfsz
+   &&  (k = do_ReadVS(rdVec, rdVBreak)) != -EAGAIN) return k;
+
+// If the response needs more than one buffer and pipelining is enabled, read
+// ahead into some buffers while sending others.
+//
+   if (rvPipe && totSZ > maxTransz) return do_ReadVP(rdVec, rdVBreak);
+
 // Calculate the transfer unit which will be the smaller of the maximum
 // transfer unit and the actual amount we need to transfer.
 //
@@ -2128,7 +2346,7 @@ int XrdXrootdProtocol::do_ReadV()
            {xfrSZ = myFile->XrdSfsp->readv(&rdVec[rdVNow], i-rdVNow);
             if (xfrSZ != rdVAmt) break;
             rdVNum = i - rdVBeg; rdVXfr += rdVAmt;
-            myFile->Stats.rvOps(rdVXfr, rdVNum);
+            myFile->Stats.rvOps(rdVXfr, rdVNum); numCopyB += rdVXfr;
             if (rvMon)
                {Monitor.Agent->Add_rv(myFile->Stats.FileID, htonl(rdVXfr),
                                               htons(rdVNum), rvSeq, vType);
@@ -2181,6 +2399,138 @@ int XrdXrootdProtocol::do_ReadV()
    return (Quantum != Qleft ? Response.Send(argp->buff, Quantum-Qleft) : 0);
 }
 
+/******************************************************************************/
+/*                             d o _ R e a d V P                              */
+/******************************************************************************/
+  
+int XrdXrootdProtocol::do_ReadVP(XrdOucIOVec *rdVec, int rdVecNum)
+{
+// This is the pipelined version of do_ReadV() used when the response spans
+// more than one buffer. Up to rvPipe buffers are filled by scheduler threads
+// while this thread sends completed ones, in order, to the client.
+//
+   XrdXrootdRVPipe rvPipeline(BPool, Sched, rdVecNum, rvPipe);
+   XrdXrootdFile *eFile;
+   int i, k, n, rc, last, nextV = 0;
+
+// Resolve every file handle up front as the reads happen in other threads
+//
+   if (!FTab) return Response.Send(kXR_FileNotOpen,
+                              "readv does not refer to an open file");
+   for (i = 0; i < rdVecNum; i++)
+       if (!(rvPipeline.fileV[i] = FTab->Get(rdVec[i].info)))
+          return Response.Send(kXR_FileNotOpen,
+                               "readv does not refer to an open file");
+
+// Obtain the buffers we will be cycling through
+//
+   if (!rvPipeline.Alloc(maxTransz))
+      return Response.Send(kXR_NoMemory, "insufficient memory for readv");
+
+// Start filling as many buffers as we can
+//
+   for (n = 0; n < rvPipe && nextV < rdVecNum; n++)
+       nextV = rvPipeline.Fill(n, rdVec, nextV, rdVecNum);
+   TRACEP(FS, "readV " <<rdVecNum <<" segs pipelined over " <<n <<" buffers");
+
+// Send each buffer as it completes and reuse it for the next set of elements
+//
+   for (k = 0; ; k = (k+1) % n)
+       {if ((rc = rvPipeline.Finish(k, eFile)))
+           {rvPipeline.Drain();
+            return fsError(rc, 0, eFile->XrdSfsp->error, 0, 0);
+           }
+        if (rvPipeline.vEnd[k] >= rdVecNum) {last = k; break;}
+        if (Response.Send(kXR_oksofar, rvPipeline.buffV[k]->buff,
+                          rvPipeline.bLen[k]) < 0) return -1;
+        if (nextV < rdVecNum)
+           nextV = rvPipeline.Fill(k, rdVec, nextV, rdVecNum);
+       }
+
+// Account for the reads
+//
+   rvStats(rdVec, rdVecNum);
+   for (i = 0; i < rdVecNum; i++) numCopyB += rdVec[i].size;
+
+// All done, send the last buffer
+//
+   return Response.Send(rvPipeline.buffV[last]->buff, rvPipeline.bLen[last]);
+}
+
+/******************************************************************************/
+/*                             d o _ R e a d V S                              */
+/******************************************************************************/
+  
+int XrdXrootdProtocol::do_ReadVS(XrdOucIOVec *rdVec, int rdVecNum)
+{
+// This sends a readv response without copying the data into our buffers.
+// It is only used when every element can be sent via sendfile() or from a
+// memory mapped file. The response header of each element is identical to
+// the corresponding request element so it is sent from the request buffer.
+// We return -EAGAIN if the request must be handled by copying the data.
+//
+   const int hdrSZ = sizeof(readahead_list);
+   XrdOucSFVec sfVec[XrdOucSFVec::sfMax];
+   readahead_list *raVec = (readahead_list *)argp->buff;
+   XrdXrootdFile *fP = 0;
+   int i, dlen, sfN, currFH;
+
+// Make sure that every element can be sent directly. We let the standard
+// path diagnose any errors.
+//
+   if (!FTab || !Response.isOurs()) return -EAGAIN;
+   currFH = rdVec[0].info;
+   for (i = 0; i < rdVecNum; i++)
+       {if (!fP || rdVec[i].info != currFH)
+           {currFH = rdVec[i].info;
+            if (!(fP = FTab->Get(currFH))) return -EAGAIN;
+            if (!fP->isMMapped && !(fP->sfEnabled && fP->fdNum >= 0))
+               return -EAGAIN;
+           }
+        if (rdVec[i].offset < 0
+        ||  rdVec[i].offset > fP->Stats.fSize - rdVec[i].size) return -EAGAIN;
+       }
+
+// Send the elements in as many frames as needed. Each element needs a slot
+// for its header and one for its data (the first slot is the response).
+//
+   i = 0; fP = 0;
+   do {sfN = 1; dlen = 0;
+       while(i < rdVecNum && sfN+2 <= XrdOucSFVec::sfMax
+       &&    dlen + hdrSZ + rdVec[i].size <= maxTransz)
+            {if (!fP || rdVec[i].info != currFH)
+                {currFH = rdVec[i].info; fP = FTab->Get(currFH);}
+             sfVec[sfN].buffer = (char *)&raVec[i];
+             sfVec[sfN].sendsz = hdrSZ;
+             sfVec[sfN].fdnum  = -1;
+             sfN++;
+             if (rdVec[i].size)
+                {if (fP->isMMapped)
+                    {sfVec[sfN].buffer = fP->mmAddr + rdVec[i].offset;
+                     sfVec[sfN].fdnum  = -1;
+                    } else {
+                     sfVec[sfN].offset = rdVec[i].offset;
+                     sfVec[sfN].fdnum  = fP->fdNum;
+                    }
+                 sfVec[sfN].sendsz = rdVec[i].size;
+                 sfN++;
+                }
+             dlen += hdrSZ + rdVec[i].size;
+             numZcpyB += rdVec[i].size;
+             TRACEP(FS, "fh=" <<currFH <<" readV " <<rdVec[i].size <<'@'
+                        <<rdVec[i].offset <<" zero-copy");
+             i++;
+            }
+       if (Response.Send((i < rdVecNum ? kXR_oksofar : kXR_ok),
+                         sfVec, sfN, dlen) < 0) return -1;
+      } while(i < rdVecNum);
+
+// Account for the reads
+//
+   rvStats(rdVec, rdVecNum);
+   return 0;
+}
+
 /******************************************************************************/
 /*                                 d o _ R m                                  */
 /******************************************************************************/
@@ -2758,6 +3108,7 @@ int XrdXrootdProtocol::SendFile(int fildes)
 
 // Send off the data
 //
+   numZcpyB += myIOLen;
    myIOLen = Response.Send(fildes, myOffset, myIOLen);
    return myIOLen;
 }
@@ -2777,6 +3128,12 @@ int XrdXrootdProtocol::SendFile(XrdOucSFVec *sfvec, int sfvnum)
    for (i = 1; i < sfvnum; i++) xframt += sfvec[i].sendsz;
    if (xframt > myIOLen) return 1;
 
+// Account for the data that comes directly from a file
+//
+   for (i = 1; i < sfvnum; i++)
+       if (sfvec[i].fdnum >= 0) numZcpyB += sfvec[i].sendsz;
+          else numCopyB += sfvec[i].sendsz;
+
 // Send off the data
 //
    if (xframt) myIOLen = Response.Send(sfvec, sfvnum, xframt);
@@ -3139,6 +3496,38 @@ int XrdXrootdProtocol::rpEmsg(const char *op, char *fn)
    return Response.Send(kXR_NotAuthorized, buff);
 }
  
+/******************************************************************************/
+/*                               r v S t a t s                                */
+/******************************************************************************/
+
+void XrdXrootdProtocol::rvStats(XrdOucIOVec *rdVec, int rdVecNum)
+{
+   long long rdVXfr;
+   int i, k, n, rdVNum;
+   int rvMon = Monitor.InOut();
+   int ioMon = (rvMon > 1);
+   char vType = (ioMon ? XROOTD_MON_READU : XROOTD_MON_READV);
+
+// Record one entry for each run of elements that refer to the same file. All
+// of the handles have already been verified by the caller.
+//
+   rvSeq++;
+   for (i = 0; i < rdVecNum; i = k)
+       {rdVXfr = 0;
+        for (k = i; k < rdVecNum && rdVec[k].info == rdVec[i].info; k++)
+            rdVXfr += rdVec[k].size;
+        rdVNum = k - i; myFile = FTab->Get(rdVec[i].info);
+        myFile->Stats.rvOps(rdVXfr, rdVNum);
+        if (rvMon)
+           {Monitor.Agent->Add_rv(myFile->Stats.FileID, htonl(rdVXfr),
+                                          htons(rdVNum), rvSeq, vType);
+            if (ioMon) for (n = i; n < k; n++)
+                Monitor.Agent->Add_rd(myFile->Stats.FileID,
+                        htonl(rdVec[n].size), htonll(rdVec[n].offset));
+           }
+       }
+}
+
 /******************************************************************************/
 /*                                 S e t S F                                  */
 /******************************************************************************/
@@ -32,6 +32,7 @@
 #include "XrdCl/XrdClMessageUtils.hh"
 #include "XrdCl/XrdClXRootDMsgHandler.hh"
 #include "XrdCl/XrdClCopyProcess.hh"
+#include <cstdlib>
 
 using namespace XrdClTests;
 
@@ -46,6 +47,7 @@ class FileTest: public CppUnit::TestCase
       CPPUNIT_TEST( ReadTest );
       CPPUNIT_TEST( WriteTest );
       CPPUNIT_TEST( VectorReadTest );
+      CPPUNIT_TEST( ReadCoalesceTest );
       CPPUNIT_TEST( VirtualRedirectorTest );
       CPPUNIT_TEST( PlugInTest );
     CPPUNIT_TEST_SUITE_END();
@@ -53,6 +55,7 @@ class FileTest: public CppUnit::TestCase
     void ReadTest();
     void WriteTest();
     void VectorReadTest();
+    void ReadCoalesceTest();
     void VirtualRedirectorTest();
     void PlugInTest();
 };
@@ -288,6 +291,69 @@ void FileTest::WriteTest()
   delete [] buffer4;
 }
 
+//------------------------------------------------------------------------------
+// Read coalescing test
+//------------------------------------------------------------------------------
+void FileTest::ReadCoalesceTest()
+{
+  using namespace XrdCl;
+
+  //----------------------------------------------------------------------------
+  // Initialize
+  //----------------------------------------------------------------------------
+  Env *testEnv = TestEnv::GetEnv();
+
+  std::string address;
+  std::string dataPath;
+
+  CPPUNIT_ASSERT( testEnv->GetString( "MainServerURL", address ) );
+  CPPUNIT_ASSERT( testEnv->GetString( "DataPath", dataPath ) );
+
+  URL url( address );
+  CPPUNIT_ASSERT( url.IsValid() );
+
+  std::string filePath = dataPath + "/a048e67f-4397-4bb8-85eb-8d7e40d90763.dat";
+  std::string fileUrl = address + "/";
+  fileUrl += filePath;
+
+  //----------------------------------------------------------------------------
+  // Issue the chunks of the vector read test as separate reads, they should
+  // be merged into a few vector reads
+  //----------------------------------------------------------------------------
+  const uint32_t MB = 1024*1024;
+  char *buffer = new char[40*256000];
+  File f;
+
+  Env *env = DefaultEnv::GetEnv();
+  env->PutInt( "ReadCoalesceWindow", 100 );
+  CPPUNIT_ASSERT_XRDST( f.Open( fileUrl, OpenFlags::Read ) );
+  env->PutInt( "ReadCoalesceWindow", 0 );
+
+  SyncResponseHandler handlers[40];
+  for( int i = 0; i < 40; ++i )
+    CPPUNIT_ASSERT_XRDST( f.Read( (i+1)*10*MB, 256000, buffer+i*256000,
+                                  &handlers[i] ) );
+
+  for( int i = 0; i < 40; ++i )
+  {
+    ChunkInfo *chunk = 0;
+    CPPUNIT_ASSERT_XRDST( MessageUtils::WaitForResponse( &handlers[i], chunk ) );
+    CPPUNIT_ASSERT( chunk->length == 256000 );
+    delete chunk;
+  }
+
+  uint32_t crc = Utils::ComputeCRC32( buffer, 40*256000 );
+  CPPUNIT_ASSERT( crc == 3492603530UL );
+
+  std::string ratio;
+  CPPUNIT_ASSERT( f.GetProperty( "ReadMergeRatio", ratio ) );
+  CPPUNIT_ASSERT( atof( ratio.c_str() ) > 1.0 );
+
+  CPPUNIT_ASSERT_XRDST( f.Close() );
+
+  delete [] buffer;
+}
+
 //------------------------------------------------------------------------------
 // Vector read test
 //------------------------------------------------------------------------------
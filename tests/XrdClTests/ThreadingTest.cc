@@ -23,9 +23,12 @@
 #include "XrdCl/XrdClFile.hh"
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdCl/XrdClUtils.hh"
+#include "XrdSys/XrdSysPthread.hh"
 #include <pthread.h>
 #include <unistd.h>
 #include <cstdlib>
+#include <vector>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include "XrdCks/XrdCksData.hh"
@@ -60,6 +63,7 @@ class ThreadingTest: public CppUnit::TestCase
       CPPUNIT_TEST( ReadForkTest );
       CPPUNIT_TEST( MultiStreamReadForkTest );
       CPPUNIT_TEST( MultiStreamReadMonitorTest );
+      CPPUNIT_TEST( AsyncReadThroughputTest );
     CPPUNIT_TEST_SUITE_END();
     void ReadTestFunc( TransferCallback transferCallback );
     void ReadTest();
@@ -67,6 +71,7 @@ class ThreadingTest: public CppUnit::TestCase
     void ReadForkTest();
     void MultiStreamReadForkTest();
     void MultiStreamReadMonitorTest();
+    void AsyncReadThroughputTest();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ThreadingTest );
@@ -346,3 +351,176 @@ void ThreadingTest::MultiStreamReadMonitorTest()
   env->PutInt( "SubStreamsPerChannel", 4 );
   ReadTestFunc(0);
 }
+
+//------------------------------------------------------------------------------
+// Keeps a fixed number of asynchronous reads in flight, each read uses a slot
+// of the window that is only handed out again once the read has finished
+//------------------------------------------------------------------------------
+class AsyncReadWindow
+{
+  public:
+    AsyncReadWindow( int size ): pSem( size ), pFailed( 0 )
+    {
+      for( int i = 0; i < size; ++i )
+      {
+        pHandlers.push_back( new Handler( this, i ) );
+        pFree.push_back( i );
+      }
+    }
+
+    ~AsyncReadWindow()
+    {
+      for( size_t i = 0; i < pHandlers.size(); ++i )
+        delete pHandlers[i];
+    }
+
+    //--------------------------------------------------------------------------
+    // Wait for a free slot and take it
+    //--------------------------------------------------------------------------
+    int Acquire()
+    {
+      pSem.Wait();
+      XrdSysMutexHelper scopedLock( pMutex );
+      int slot = pFree.back();
+      pFree.pop_back();
+      return slot;
+    }
+
+    //--------------------------------------------------------------------------
+    // Give a slot back
+    //--------------------------------------------------------------------------
+    void Release( int slot )
+    {
+      {
+        XrdSysMutexHelper scopedLock( pMutex );
+        pFree.push_back( slot );
+      }
+      pSem.Post();
+    }
+
+    XrdCl::ResponseHandler *GetHandler( int slot )
+    {
+      return pHandlers[slot];
+    }
+
+    uint64_t GetFailed()
+    {
+      XrdSysMutexHelper scopedLock( pMutex );
+      return pFailed;
+    }
+
+  private:
+    //--------------------------------------------------------------------------
+    // Handler of the read using a slot
+    //--------------------------------------------------------------------------
+    class Handler: public XrdCl::ResponseHandler
+    {
+      public:
+        Handler( AsyncReadWindow *window, int slot ):
+          pWindow( window ), pSlot( slot ) {}
+
+        virtual void HandleResponse( XrdCl::XRootDStatus *status,
+                                     XrdCl::AnyObject    *response )
+        {
+          if( !status->IsOK() )
+          {
+            XrdSysMutexHelper scopedLock( pWindow->pMutex );
+            ++pWindow->pFailed;
+          }
+          delete status;
+          delete response;
+          pWindow->Release( pSlot );
+        }
+
+      private:
+        AsyncReadWindow *pWindow;
+        int              pSlot;
+    };
+
+    XrdSysSemaphore         pSem;
+    XrdSysMutex             pMutex;
+    uint64_t                pFailed;
+    std::vector<Handler*>   pHandlers;
+    std::vector<int>        pFree;
+};
+
+//------------------------------------------------------------------------------
+// Async read throughput - issue lots of small reads with many of them in
+// flight, this mostly exercises the SID allocation and response routing;
+// the default count is small, set XRDTEST_ASYNCREADS to eg. 1000000 to use
+// it as a benchmark
+//------------------------------------------------------------------------------
+void ThreadingTest::AsyncReadThroughputTest()
+{
+  using namespace XrdCl;
+
+  //----------------------------------------------------------------------------
+  // Initialize
+  //----------------------------------------------------------------------------
+  Env *testEnv = XrdClTests::TestEnv::GetEnv();
+  Log *log     = XrdClTests::TestEnv::GetLog();
+
+  std::string address;
+  std::string dataPath;
+  int         numReads = 10000;
+
+  CPPUNIT_ASSERT( testEnv->GetString( "MainServerURL", address ) );
+  CPPUNIT_ASSERT( testEnv->GetString( "DataPath", dataPath ) );
+  testEnv->GetInt( "AsyncReads", numReads );
+
+  std::string fileUrl = address + "/" + dataPath;
+  fileUrl += "/1db882c8-8cd6-4df1-941f-ce669bad3458.dat";
+
+  File      file;
+  StatInfo *si = 0;
+  CPPUNIT_ASSERT_XRDST( file.Open( fileUrl, OpenFlags::Read ) );
+  CPPUNIT_ASSERT_XRDST( file.Stat( false, si ) );
+  CPPUNIT_ASSERT( si && si->GetSize() > 4*MB );
+  uint64_t fileSize = si->GetSize();
+  delete si;
+
+  //----------------------------------------------------------------------------
+  // Read 1k chunks all over the file with 4096 requests in flight
+  //----------------------------------------------------------------------------
+  const int       window    = 4096;
+  const uint32_t  chunkSize = 1024;
+  char           *buffer    = new char[window*chunkSize];
+  AsyncReadWindow handler( window );
+  timeval         start, end;
+
+  XRootDStatus st;
+  int          issued = 0;
+
+  gettimeofday( &start, 0 );
+  for( ; issued < numReads; ++issued )
+  {
+    int slot = handler.Acquire();
+    uint64_t offset = ((uint64_t)issued * 7919 * chunkSize) %
+                      (fileSize - chunkSize);
+    st = file.Read( offset, chunkSize, buffer + slot * chunkSize,
+                    handler.GetHandler( slot ) );
+    if( !st.IsOK() )
+    {
+      handler.Release( slot );
+      break;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // The reads in flight use the buffer and the handler, so wait for all of
+  // them before checking anything
+  //----------------------------------------------------------------------------
+  for( int i = 0; i < window; ++i )
+    handler.Acquire();
+  gettimeofday( &end, 0 );
+
+  double secs = (end.tv_sec - start.tv_sec) +
+                (end.tv_usec - start.tv_usec) / 1000000.0;
+  log->Info( 1, "%d async reads of %d bytes in %.2f s: %.0f reads/s",
+             issued, chunkSize, secs, issued / secs );
+
+  delete [] buffer;
+  CPPUNIT_ASSERT_XRDST( st );
+  CPPUNIT_ASSERT( handler.GetFailed() == 0 );
+  CPPUNIT_ASSERT_XRDST( file.Close() );
+}
@@ -29,6 +29,7 @@
 #include "XrdCl/XrdClTaskManager.hh"
 #include "XrdCl/XrdClSIDManager.hh"
 #include "XrdCl/XrdClPropertyList.hh"
+#include <cstring>
 
 //------------------------------------------------------------------------------
 // Declaration
@@ -406,6 +407,34 @@ void UtilsTest::SIDManagerTest()
   CPPUNIT_ASSERT( manager.IsTimedOut( sid5 ) == false );
   manager.ReleaseAllTimedOut();
   CPPUNIT_ASSERT( manager.NumberOfTimedOutSIDs() == 0 );
+
+  //----------------------------------------------------------------------------
+  // A released SID is not reused right away and all but 0 and 0xffff can
+  // be used
+  //----------------------------------------------------------------------------
+  SIDManager manager2;
+  uint16_t   sid;
+  uint8_t    sidBuf[2];
+  CPPUNIT_ASSERT_XRDST( manager2.AllocateSID( sid1 ) );
+  CPPUNIT_ASSERT_XRDST( manager2.AllocateSID( sid2 ) );
+  manager2.ReleaseSID( sid1 );
+  CPPUNIT_ASSERT_XRDST( manager2.AllocateSID( sid3 ) );
+  CPPUNIT_ASSERT( sid1[0] != sid3[0] || sid1[1] != sid3[1] );
+  manager2.TimeOutSID( sid2 );
+  CPPUNIT_ASSERT( manager2.GetNumberOfAllocatedSIDs() == 1 );
+
+  int numAllocated = 2;
+  while( manager2.AllocateSID( sidBuf ).IsOK() )
+  {
+    memcpy( &sid, sidBuf, 2 );
+    CPPUNIT_ASSERT( sid != 0 && sid != 0xffff );
+    ++numAllocated;
+  }
+  CPPUNIT_ASSERT( numAllocated == 0xfffe );
+  CPPUNIT_ASSERT( manager2.IsTimedOut( sid2 ) );
+  manager2.ReleaseTimedOut( sid2 );
+  CPPUNIT_ASSERT_XRDST( manager2.AllocateSID( sid4 ) );
+  CPPUNIT_ASSERT( sid2[0] == sid4[0] && sid2[1] == sid4[1] );
 }
 
 //------------------------------------------------------------------------------